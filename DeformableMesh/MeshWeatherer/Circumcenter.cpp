@@ -8,7 +8,7 @@
 /**
  * Default constructor
  */
-Circumcenter::Circumcenter() : point(), cell() {
+Circumcenter::Circumcenter() : point(), cell(), index( 0 ) {
 
 	return;
 }
@@ -18,8 +18,9 @@ Circumcenter::Circumcenter() : point(), cell() {
  * Full constructor
  * @param point The location of the circumcenter
  * @param cell The cell the circumcenter belongs to
+ * @param index The index of the circumcenter's result when relabeling a list of pairs (default 0)
  */
-Circumcenter::Circumcenter( const Point3D & point, Cell_handle & cell ) : point( point ), cell( cell ) {
+Circumcenter::Circumcenter( const Point3D & point, Cell_handle & cell, int index ) : point( point ), cell( cell ), index( index ) {
 	
 	return;
 }
@@ -32,7 +33,7 @@ Circumcenter::Circumcenter( const Point3D & point, Cell_handle & cell ) : point(
  * @param z The z-coordinate of the point
  * @param cell The cell the circumcenter belongs to
  */
-Circumcenter::Circumcenter( double x, double y, double z, Cell_handle & cell ) : point( x, y, z ), cell( cell ) {
+Circumcenter::Circumcenter( double x, double y, double z, Cell_handle & cell ) : point( x, y, z ), cell( cell ), index( 0 ) {
 	
 	return;
 }
@@ -42,7 +43,7 @@ Circumcenter::Circumcenter( double x, double y, double z, Cell_handle & cell ) :
  * Copy constructor
  * @param other The circumcenter to copy
  */
-Circumcenter::Circumcenter( const Circumcenter & other ) : point( other.point ), cell( other.cell ) {
+Circumcenter::Circumcenter( const Circumcenter & other ) : point( other.point ), cell( other.cell ), index( other.index ) {
 
 	return;
 }
@@ -24,6 +24,11 @@ struct Circumcenter {
 	 */
 	Cell_handle cell;
 
+	/**
+	 * The index of the circumcenter's result when relabeling a list of pairs
+	 */
+	int index;
+
 
 	//-------------
 	// CONSTRUCTORS
@@ -39,8 +44,9 @@ struct Circumcenter {
 	 * Full constructor
 	 * @param point The location of the circumcenter
 	 * @param cell The cell the circumcenter belongs to
+	 * @param index The index of the circumcenter's result when relabeling a list of pairs (default 0)
 	 */
-	Circumcenter( const Point3D & point, Cell_handle & cell );
+	Circumcenter( const Point3D & point, Cell_handle & cell, int index = 0 );
 
 
 	/**
@@ -0,0 +1,314 @@
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "DurabilityCache.h"
+
+using namespace std;
+
+
+/**
+ * The fraction of the requested region added to each side of the cache, so small motions don't fall outside it
+ */
+#define DURABILITY_CACHE_PADDING 0.05
+
+
+//-------------
+// CONSTRUCTORS
+//-------------
+
+/**
+ * Full constructor
+ * @param field The function that computes the durability at a point
+ * @param row The function that computes the durability along a row of points, used to fill the cache a row at a time (default NULL)
+ * @param resolution The number of samples along each axis (default DURABILITY_CACHE_RESOLUTION)
+ */
+DurabilityCache::DurabilityCache( double ( *field )( double x, double y, double z ), void ( *row )( const double * x, double y, double z, double * result, int count ), unsigned int resolution ) : field( field ), row( row ), samples( NULL ), resolution( resolution < 2 ? 2 : resolution ), xmin( numeric_limits<double>::infinity() ), ymin( numeric_limits<double>::infinity() ), zmin( numeric_limits<double>::infinity() ), xmax( -numeric_limits<double>::infinity() ), ymax( -numeric_limits<double>::infinity() ), zmax( -numeric_limits<double>::infinity() ), inv_Xsize( 0.0 ), inv_Ysize( 0.0 ), inv_Zsize( 0.0 ), valid( false ) {
+
+	return;
+}
+
+
+/**
+ * Destructor
+ */
+DurabilityCache::~DurabilityCache() {
+
+	if ( samples ) {
+
+		delete[] samples;
+		samples = NULL;
+	}
+}
+
+
+//----------
+// FUNCTIONS
+//----------
+
+/**
+ * Sets the region covered by the cache (only invalidates the cache if the region grows)
+ * @param minPoint The minimum extent of the region
+ * @param maxPoint The maximum extent of the region
+ */
+void DurabilityCache::setBounds( const double * minPoint, const double * maxPoint ) {
+
+	if ( minPoint[ 0 ] >= xmin && minPoint[ 1 ] >= ymin && minPoint[ 2 ] >= zmin && maxPoint[ 0 ] <= xmax && maxPoint[ 1 ] <= ymax && maxPoint[ 2 ] <= zmax ) {
+
+		return;
+	}
+
+	double padX = ( maxPoint[ 0 ] - minPoint[ 0 ] ) * DURABILITY_CACHE_PADDING;
+	double padY = ( maxPoint[ 1 ] - minPoint[ 1 ] ) * DURABILITY_CACHE_PADDING;
+	double padZ = ( maxPoint[ 2 ] - minPoint[ 2 ] ) * DURABILITY_CACHE_PADDING;
+
+	xmin = minPoint[ 0 ] - padX;
+	ymin = minPoint[ 1 ] - padY;
+	zmin = minPoint[ 2 ] - padZ;
+	xmax = maxPoint[ 0 ] + padX;
+	ymax = maxPoint[ 1 ] + padY;
+	zmax = maxPoint[ 2 ] + padZ;
+
+	// A flat region still needs a non-zero sample spacing
+	inv_Xsize = ( xmax > xmin ) ? ( resolution - 1 ) / ( xmax - xmin ) : 0.0;
+	inv_Ysize = ( ymax > ymin ) ? ( resolution - 1 ) / ( ymax - ymin ) : 0.0;
+	inv_Zsize = ( zmax > zmin ) ? ( resolution - 1 ) / ( zmax - zmin ) : 0.0;
+
+	valid = false;
+}
+
+
+/**
+ * Sets the number of samples along each axis (invalidates the cache)
+ * @param n The new resolution
+ */
+void DurabilityCache::setResolution( unsigned int n ) {
+
+	if ( n < 2 ) {
+
+		n = 2;
+	}
+
+	if ( n == resolution ) {
+
+		return;
+	}
+
+	if ( samples ) {
+
+		delete[] samples;
+		samples = NULL;
+	}
+
+	resolution = n;
+	inv_Xsize = ( xmax > xmin ) ? ( resolution - 1 ) / ( xmax - xmin ) : 0.0;
+	inv_Ysize = ( ymax > ymin ) ? ( resolution - 1 ) / ( ymax - ymin ) : 0.0;
+	inv_Zsize = ( zmax > zmin ) ? ( resolution - 1 ) / ( zmax - zmin ) : 0.0;
+	valid = false;
+}
+
+
+/**
+ * Recomputes every sample from the field
+ */
+void DurabilityCache::rebuild() {
+
+	if ( !( xmax >= xmin && ymax >= ymin && zmax >= zmin ) ) {
+
+		// No region has been set yet, so every lookup goes straight to the field
+		return;
+	}
+
+	if ( !samples ) {
+
+		samples = new float[ resolution * resolution * resolution ];
+	}
+
+	int n = resolution;
+	double dx = ( n > 1 ) ? ( xmax - xmin ) / ( n - 1 ) : 0.0;
+	double dy = ( n > 1 ) ? ( ymax - ymin ) / ( n - 1 ) : 0.0;
+	double dz = ( n > 1 ) ? ( zmax - zmin ) / ( n - 1 ) : 0.0;
+	int z;
+
+	// The x-coordinates are the same for every row
+	double * xs = new double[ n ];
+
+	for ( int x = 0; x < n; ++x ) {
+
+		xs[ x ] = xmin + x * dx;
+	}
+
+	#pragma omp parallel for schedule( dynamic )
+	for ( z = 0; z < n; ++z ) {
+
+		float * slice = samples + z * n * n;
+		double * values = new double[ n ];
+		double pz = zmin + z * dz;
+
+		for ( int y = 0; y < n; ++y ) {
+
+			double py = ymin + y * dy;
+
+			if ( row ) {
+
+				row( xs, py, pz, values, n );
+			}
+			else {
+
+				for ( int x = 0; x < n; ++x ) {
+
+					values[ x ] = field( xs[ x ], py, pz );
+				}
+			}
+
+			for ( int x = 0; x < n; ++x ) {
+
+				slice[ y * n + x ] = ( float ) values[ x ];
+			}
+		}
+
+		delete[] values;
+	}
+
+	delete[] xs;
+
+	// The samples have to be visible before the flag is, since evaluate() reads the flag outside the critical section
+	#pragma omp flush
+	valid = true;
+	#pragma omp flush
+}
+
+
+/**
+ * Looks up the durability at the given point, rebuilding the samples first if they are out of date
+ * @param x The x-coordinate of the point
+ * @param y The y-coordinate of the point
+ * @param z The z-coordinate of the point
+ * @return The trilinearly interpolated durability at the given point
+ */
+double DurabilityCache::evaluate( double x, double y, double z ) {
+
+	if ( x < xmin || x > xmax || y < ymin || y > ymax || z < zmin || z > zmax ) {
+
+		return field( x, y, z );
+	}
+
+	// Double-checked: only the first thread to find the samples out of date rebuilds them
+	#pragma omp flush
+	if ( !valid ) {
+
+		#pragma omp critical( durabilityCache )
+		{
+			if ( !valid ) {
+
+				rebuild();
+			}
+		}
+	}
+
+	return interpolate( x, y, z );
+}
+
+
+/**
+ * Compares the cache against the field at random points in the cached region
+ * @param count The number of points to test
+ * @param maxError Stores the largest absolute error
+ * @param meanError Stores the mean absolute error
+ */
+void DurabilityCache::measureError( unsigned int count, double & maxError, double & meanError ) {
+
+	maxError = 0.0;
+	meanError = 0.0;
+
+	if ( count == 0 || !( xmax >= xmin && ymax >= ymin && zmax >= zmin ) ) {
+
+		return;
+	}
+
+	if ( !valid ) {
+
+		rebuild();
+	}
+
+	double x;
+	double y;
+	double z;
+	double error;
+
+	// Use a fixed seed so that every resolution is compared at the same points
+	srand( 0 );
+
+	for ( unsigned int i = 0; i < count; ++i ) {
+
+		x = xmin + ( rand() / ( double ) RAND_MAX ) * ( xmax - xmin );
+		y = ymin + ( rand() / ( double ) RAND_MAX ) * ( ymax - ymin );
+		z = zmin + ( rand() / ( double ) RAND_MAX ) * ( zmax - zmin );
+		error = fabs( interpolate( x, y, z ) - field( x, y, z ) );
+		meanError += error;
+
+		if ( error > maxError ) {
+
+			maxError = error;
+		}
+	}
+
+	meanError /= count;
+}
+
+
+/**
+ * Helper to look up a point known to be inside the cached region
+ * @param x The x-coordinate of the point
+ * @param y The y-coordinate of the point
+ * @param z The z-coordinate of the point
+ * @return The trilinearly interpolated durability at the given point
+ */
+double DurabilityCache::interpolate( double x, double y, double z ) const {
+
+	if ( !samples ) {
+
+		return field( x, y, z );
+	}
+
+	unsigned int last = resolution - 2;
+	double fx = ( x - xmin ) * inv_Xsize;
+	double fy = ( y - ymin ) * inv_Ysize;
+	double fz = ( z - zmin ) * inv_Zsize;
+	unsigned int ix = ( unsigned int ) fx;
+	unsigned int iy = ( unsigned int ) fy;
+	unsigned int iz = ( unsigned int ) fz;
+
+	// Points exactly on the maximum face use the last cell
+	if ( ix > last ) {
+
+		ix = last;
+	}
+
+	if ( iy > last ) {
+
+		iy = last;
+	}
+
+	if ( iz > last ) {
+
+		iz = last;
+	}
+
+	fx -= ix;
+	fy -= iy;
+	fz -= iz;
+
+	unsigned int n = resolution;
+	const float * s = samples + ( iz * n + iy ) * n + ix;
+
+	double c00 = s[ 0 ] * ( 1.0 - fx ) + s[ 1 ] * fx;
+	double c10 = s[ n ] * ( 1.0 - fx ) + s[ n + 1 ] * fx;
+	double c01 = s[ n * n ] * ( 1.0 - fx ) + s[ n * n + 1 ] * fx;
+	double c11 = s[ n * n + n ] * ( 1.0 - fx ) + s[ n * n + n + 1 ] * fx;
+
+	double c0 = c00 * ( 1.0 - fy ) + c10 * fy;
+	double c1 = c01 * ( 1.0 - fy ) + c11 * fy;
+
+	return c0 * ( 1.0 - fz ) + c1 * fz;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+
+
+/**
+ * Determines the default number of samples along each axis of the cache
+ */
+#define DURABILITY_CACHE_RESOLUTION 64u
+
+
+/**
+ * Caches a durability (softness) field in a regular 3D grid of samples, like a 3D texture,
+ * so that the layers and perlin noise only have to be evaluated once per durability change
+ * rather than once per vertex per step. Points outside the cached region fall through to the field.
+ */
+class DurabilityCache {
+
+	//------------
+	// MEMBER DATA
+	//------------
+
+	/**
+	 * The function that computes the (uncached) durability at a point
+	 */
+	double ( *field )( double x, double y, double z );
+
+	/**
+	 * The function that computes the (uncached) durability along a row of points sharing y and z (optional)
+	 */
+	void ( *row )( const double * x, double y, double z, double * result, int count );
+
+	/**
+	 * The array of samples (of size resolution^3, x varying fastest)
+	 */
+	float * samples;
+
+	/**
+	 * The number of samples along each axis
+	 */
+	unsigned int resolution;
+
+	/**
+	 * The coordinates of the minimum extent of the cache
+	 */
+	double xmin;
+	double ymin;
+	double zmin;
+
+	/**
+	 * The coordinates of the maximum extent of the cache
+	 */
+	double xmax;
+	double ymax;
+	double zmax;
+
+	/**
+	 * The inverse of the spacing between samples along each axis
+	 */
+	double inv_Xsize;
+	double inv_Ysize;
+	double inv_Zsize;
+
+	/**
+	 * Flag for when the samples match the field (flushed around rebuild(), since evaluate() reads it without locking)
+	 */
+	volatile bool valid;
+
+
+public:
+
+	//-------------
+	// CONSTRUCTORS
+	//-------------
+
+	/**
+	 * Full constructor
+	 * @param field The function that computes the durability at a point
+	 * @param row The function that computes the durability along a row of points, used to fill the cache a row at a time (default NULL)
+	 * @param resolution The number of samples along each axis (default DURABILITY_CACHE_RESOLUTION)
+	 */
+	DurabilityCache( double ( *field )( double x, double y, double z ), void ( *row )( const double * x, double y, double z, double * result, int count ) = NULL, unsigned int resolution = DURABILITY_CACHE_RESOLUTION );
+
+
+	/**
+	 * Destructor
+	 */
+	~DurabilityCache();
+
+
+	//----------
+	// FUNCTIONS
+	//----------
+
+	/**
+	 * Sets the region covered by the cache (only invalidates the cache if the region grows)
+	 * @param minPoint The minimum extent of the region
+	 * @param maxPoint The maximum extent of the region
+	 */
+	void setBounds( const double * minPoint, const double * maxPoint );
+
+
+	/**
+	 * Sets the number of samples along each axis (invalidates the cache)
+	 * @param n The new resolution
+	 */
+	void setResolution( unsigned int n );
+
+
+	/**
+	 * Gets the number of samples along each axis
+	 * @return The resolution of the cache
+	 */
+	inline unsigned int getResolution() const {
+
+		return resolution;
+	}
+
+
+	/**
+	 * Marks the samples as out of date (they are recomputed on the next lookup)
+	 */
+	inline void invalidate() {
+
+		valid = false;
+	}
+
+
+	/**
+	 * Determines if the samples match the field
+	 * @return TRUE if the cache is up to date, FALSE otherwise
+	 */
+	inline bool isValid() const {
+
+		return valid;
+	}
+
+
+	/**
+	 * Recomputes every sample from the field
+	 */
+	void rebuild();
+
+
+	/**
+	 * Looks up the durability at the given point, rebuilding the samples first if they are out of date
+	 * @param x The x-coordinate of the point
+	 * @param y The y-coordinate of the point
+	 * @param z The z-coordinate of the point
+	 * @return The trilinearly interpolated durability at the given point
+	 */
+	double evaluate( double x, double y, double z );
+
+
+	/**
+	 * Compares the cache against the field at random points in the cached region
+	 * @param count The number of points to test
+	 * @param maxError Stores the largest absolute error
+	 * @param meanError Stores the mean absolute error
+	 */
+	void measureError( unsigned int count, double & maxError, double & meanError );
+
+
+protected:
+
+	/**
+	 * Helper to look up a point known to be inside the cached region
+	 * @param x The x-coordinate of the point
+	 * @param y The y-coordinate of the point
+	 * @param z The z-coordinate of the point
+	 * @return The trilinearly interpolated durability at the given point
+	 */
+	double interpolate( double x, double y, double z ) const;
+};
@@ -2,6 +2,7 @@
 
 #include "DurabilityTool.h"
 #include "Layer.h"
+#include "NumberEntry.h"
 
 
 /**
@@ -39,6 +40,21 @@ durabilityTool durability;
  */
 durabilityTool lockedDurability;
 
+/**
+ * The widget the locked durability widget was last copied from (to detect changes)
+ */
+durabilityTool lockedDurabilitySource;
+
+/**
+ * The noise power the locked durability widget was last evaluated with
+ */
+double lockedDurabilityNoisePower = -1.0;
+
+/**
+ * The sampled locked durability, read by softness() (rebuilt only when the locked widget changes)
+ */
+DurabilityCache softnessCache( uncachedSoftness, uncachedSoftness );
+
 
 /**
  * Finds the nearest division to the given y value
@@ -424,9 +440,18 @@ bool durabilityTool::normalize() {
  */
 void updateLockedDurability() {
 
+	// Called every step, so only copy (and throw away the cached samples) when the widget was edited
+	if ( durability == lockedDurabilitySource && getNoisePower() == lockedDurabilityNoisePower ) {
+
+		return;
+	}
+
 	lockedDurability = durability;
 
 	lockedDurability.normalize();
+	lockedDurabilitySource = durability;
+	lockedDurabilityNoisePower = getNoisePower();
+	softnessCache.invalidate();
 }
 
 
@@ -439,7 +464,7 @@ void updateLockedDurability() {
  */
 double softness( double x, double y, double z ) {
 
-	return lockedDurability.evaluate( x, y, z );
+	return softnessCache.evaluate( x, y, z );
 }
 
 
@@ -454,3 +479,51 @@ double liveSoftness( double x, double y, double z ) {
 
 	return durability.evaluate( x, y, z );
 }
+
+
+/**
+ * Computes the softness at the given point directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinate of the point
+ * @param y The y-coordinate of the point
+ * @param z The z-coordinate of the point
+ * @return The softness of the object at the given point
+ */
+double uncachedSoftness( double x, double y, double z ) {
+
+	return lockedDurability.evaluate( x, y, z );
+}
+
+
+/**
+ * Computes the softness along a row of points that share y and z directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinates of the points
+ * @param y The y-coordinate of the row
+ * @param z The z-coordinate of the row
+ * @param result Stores the softness of the object at each point
+ * @param count The number of points
+ */
+void uncachedSoftness( const double * x, double y, double z, double * result, int count ) {
+
+	lockedDurability.evaluate( x, y, z, result, count );
+}
+
+
+/**
+ * Sets the region in which the locked softness is cached
+ * @param minPoint The minimum extent of the object
+ * @param maxPoint The maximum extent of the object
+ */
+void setSoftnessBounds( const double * minPoint, const double * maxPoint ) {
+
+	softnessCache.setBounds( minPoint, maxPoint );
+}
+
+
+/**
+ * Gets the cache that softness() reads from
+ * @return The softness cache
+ */
+DurabilityCache & getSoftnessCache() {
+
+	return softnessCache;
+}
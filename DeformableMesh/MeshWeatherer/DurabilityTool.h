@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include "DurabilityCache.h"
 #include "Layer.h"
 #include "Include\IntTypes.h"
 
@@ -121,6 +122,24 @@ struct durabilityTool {
 	}
 
 
+	/**
+	 * Evaluates the durability of the object along a row of points that share y and z
+	 * @param x The x-coordinates of the points
+	 * @param y The y-coordinate of the row
+	 * @param z The z-coordinate of the row
+	 * @param result Stores the durability of the object at each point
+	 * @param count The number of points
+	 * @param useGrain Whether or not to use the grain (default TRUE)
+	 */
+	inline void evaluate( const double * x, double y, double z, double * result, int count, bool useGrain = true ) const {
+
+		int temp;
+		const layer * l = layerAt( y, &temp );
+
+		l->evaluate( x, y, z, result, count, temp, useGrain );
+	}
+
+
 	/**
 	 * Draws the durability widget
 	 * @param minY The minimum y-coordinate
@@ -135,6 +154,21 @@ struct durabilityTool {
 	 * @return ???
 	 */
 	bool normalize();
+
+
+	//----------
+	// OPERATORS
+	//----------
+
+	/**
+	 * Equality operator
+	 * @param other The durability widget to compare against
+	 * @return TRUE if both widgets have the same splits and layers, FALSE otherwise
+	 */
+	inline bool operator == ( const durabilityTool & other ) const {
+
+		return dividers == other.dividers && layers == other.layers;
+	}
 };
 
 
@@ -162,3 +196,39 @@ double softness( double x, double y, double z );
  * @return The softness of the given point if it is live
  */
 double liveSoftness( double x, double y, double z );
+
+
+/**
+ * Computes the softness at the given point directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinate of the point
+ * @param y The y-coordinate of the point
+ * @param z The z-coordinate of the point
+ * @return The softness of the object at the given point
+ */
+double uncachedSoftness( double x, double y, double z );
+
+
+/**
+ * Computes the softness along a row of points that share y and z directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinates of the points
+ * @param y The y-coordinate of the row
+ * @param z The z-coordinate of the row
+ * @param result Stores the softness of the object at each point
+ * @param count The number of points
+ */
+void uncachedSoftness( const double * x, double y, double z, double * result, int count );
+
+
+/**
+ * Sets the region in which the locked softness is cached
+ * @param minPoint The minimum extent of the object
+ * @param maxPoint The maximum extent of the object
+ */
+void setSoftnessBounds( const double * minPoint, const double * maxPoint );
+
+
+/**
+ * Gets the cache that softness() reads from
+ * @return The softness cache
+ */
+DurabilityCache & getSoftnessCache();
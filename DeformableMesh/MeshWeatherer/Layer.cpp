@@ -44,3 +44,66 @@ double layer::evaluate( double x, double y, double z, uint32_t seed, bool useGra
 		return base.evaluate( y ) * ( 1.0 - fixNoise( perlin1D( y * yNoiseFrequency, 4, seed ) ) * yNoiseAmplitude );
 	}
 }
+
+
+/**
+ * The number of points layer::evaluate works on at once along a row
+ */
+#define LAYER_ROW_BLOCK 64
+
+
+/**
+ * Evaluates the layer along a row of points that share y and z (the base and y-noise are computed once for the row)
+ * @param x The x-coordinates of the points
+ * @param y The y-coordinate of the row
+ * @param z The z-coordinate of the row
+ * @param result Stores the durability of the layer at each point
+ * @param count The number of points
+ * @param seed The seed value for random number generator (default 0)
+ * @param userGrain Whether or not to use the grain (default TRUE)
+ */
+void layer::evaluate( const double * x, double y, double z, double * result, int count, uint32_t seed, bool useGrain ) const {
+
+	double shared = base.evaluate( y ) * ( 1.0 - fixNoise( perlin1D( y * yNoiseFrequency, 4, seed ) ) * yNoiseAmplitude );
+	int i;
+
+	if ( !useGrain ) {
+
+		for ( i = 0; i < count; ++i ) {
+
+			result[ i ] = shared;
+		}
+
+		return;
+	}
+
+	double gx[ LAYER_ROW_BLOCK ];
+	double gy[ LAYER_ROW_BLOCK ];
+	double gz[ LAYER_ROW_BLOCK ];
+	double grain[ LAYER_ROW_BLOCK ];
+	int start;
+	int n;
+
+	for ( i = 0; i < LAYER_ROW_BLOCK; ++i ) {
+
+		gy[ i ] = y * grainFrequency;
+		gz[ i ] = z * grainFrequency;
+	}
+
+	for ( start = 0; start < count; start += LAYER_ROW_BLOCK ) {
+
+		n = ( count - start < LAYER_ROW_BLOCK ) ? ( count - start ) : LAYER_ROW_BLOCK;
+
+		for ( i = 0; i < n; ++i ) {
+
+			gx[ i ] = x[ start + i ] * grainFrequency;
+		}
+
+		perlin3D( gx, gy, gz, grain, n, 4, seed + 0x005a5a5a );
+
+		for ( i = 0; i < n; ++i ) {
+
+			result[ start + i ] = shared * ( 1.0 - fixNoise( grain[ i ] ) * grainAmplitude );
+		}
+	}
+}
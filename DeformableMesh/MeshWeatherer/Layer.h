@@ -68,6 +68,19 @@ struct layer {
 	double evaluate( double x, double y, double z, uint32_t seed = 0, bool useGrain = true ) const;
 
 
+	/**
+	 * Evaluates the layer along a row of points that share y and z (the base and y-noise are computed once for the row)
+	 * @param x The x-coordinates of the points
+	 * @param y The y-coordinate of the row
+	 * @param z The z-coordinate of the row
+	 * @param result Stores the durability of the layer at each point
+	 * @param count The number of points
+	 * @param seed The seed value for random number generator (default 0)
+	 * @param userGrain Whether or not to use the grain (default TRUE)
+	 */
+	void evaluate( const double * x, double y, double z, double * result, int count, uint32_t seed = 0, bool useGrain = true ) const;
+
+
 	//----------
 	// OPERATORS
 	//----------
@@ -96,4 +109,15 @@ struct layer {
 
 		return *this;
 	}
+
+
+	/**
+	 * Equality operator
+	 * @param other The layer to compare against
+	 * @return TRUE if both layers evaluate identically, FALSE otherwise
+	 */
+	inline bool operator == ( const layer & other ) const {
+
+		return base == other.base && yNoiseFrequency == other.yNoiseFrequency && yNoiseAmplitude == other.yNoiseAmplitude && grainFrequency == other.grainFrequency && grainAmplitude == other.grainAmplitude;
+	}
 };
@@ -0,0 +1,528 @@
+#include <cstring>
+#include <limits>
+#include <omp.h>
+
+#include "LinearOctTree.h"
+
+using namespace std;
+
+
+#define MIN(a,b) ((a)<(b)?(a):(b))
+#define MAX(a,b) ((a)>(b)?(a):(b))
+
+/**
+ * Determines the number of key bits sorted per radix sort pass
+ */
+#define RADIX_BITS 10u
+
+/**
+ * The number of buckets in each radix sort pass
+ */
+#define RADIX_BUCKETS ( 1u << RADIX_BITS )
+
+
+/**
+ * Spreads the lowest 10 bits of a value out so there are two zero bits between each of them
+ * @param v The value to spread out
+ * @return The spread out value
+ */
+static inline unsigned int expandBits( unsigned int v ) {
+
+	v = ( v * 0x00010001u ) & 0xFF0000FFu;
+	v = ( v * 0x00000101u ) & 0x0F00F00Fu;
+	v = ( v * 0x00000011u ) & 0xC30C30C3u;
+	v = ( v * 0x00000005u ) & 0x49249249u;
+
+	return v;
+}
+
+
+/**
+ * Converts a scaled coordinate to a Morton cell index, clamped to the tree
+ * @param value The coordinate, already offset and scaled to Morton cells
+ * @return The index of the Morton cell
+ */
+static inline unsigned int quantize( double value ) {
+
+	// Also catches NaN from an empty tree
+	if ( !( value > 0.0 ) ) {
+
+		return 0;
+	}
+
+	if ( value >= ( double ) ( ( 1u << LINEAR_OCT_TREE_LEVELS ) - 1 ) ) {
+
+		return ( 1u << LINEAR_OCT_TREE_LEVELS ) - 1;
+	}
+
+	return ( unsigned int ) value;
+}
+
+
+/**
+ * Sorts a list of keys with a parallel LSD radix sort (stable)
+ * @param keys The keys to sort (replaced by the sorted keys)
+ * @param order Stores the original index of each sorted key
+ * @param count The number of keys
+ */
+void radixSort( unsigned int * keys, unsigned int * order, int count ) {
+
+	int i;
+
+	for ( i = 0; i < count; ++i ) {
+
+		order[ i ] = i;
+	}
+
+	if ( count < 2 ) {
+
+		return;
+	}
+
+	unsigned int maxKey = 0;
+
+	for ( i = 0; i < count; ++i ) {
+
+		maxKey = MAX( maxKey, keys[ i ] );
+	}
+
+	// Each chunk of the input is counted and scattered by one thread
+	int chunks = omp_get_max_threads();
+	int chunkSize = ( count + chunks - 1 ) / chunks;
+	unsigned int * histograms = new unsigned int[ chunks * RADIX_BUCKETS ];
+	unsigned int * srcKeys = keys;
+	unsigned int * srcOrder = order;
+	unsigned int * dstKeys = new unsigned int[ count ];
+	unsigned int * dstOrder = new unsigned int[ count ];
+	unsigned int * temp;
+	unsigned int shift;
+	unsigned int bucket;
+	unsigned int offset;
+	unsigned int n;
+	int c;
+
+	for ( shift = 0; shift < 32 && ( maxKey >> shift ) != 0; shift += RADIX_BITS ) {
+
+		memset( histograms, 0, chunks * RADIX_BUCKETS * sizeof( unsigned int ) );
+
+		#pragma omp parallel for
+		for ( c = 0; c < chunks; ++c ) {
+
+			unsigned int * histogram = histograms + c * RADIX_BUCKETS;
+			int end = MIN( count, ( c + 1 ) * chunkSize );
+
+			for ( int j = c * chunkSize; j < end; ++j ) {
+
+				++histogram[ ( srcKeys[ j ] >> shift ) & ( RADIX_BUCKETS - 1 ) ];
+			}
+		}
+
+		// Turn the counts into starting offsets (bucket-major, so earlier chunks stay ahead of later ones within a bucket)
+		offset = 0;
+
+		for ( bucket = 0; bucket < RADIX_BUCKETS; ++bucket ) {
+
+			for ( c = 0; c < chunks; ++c ) {
+
+				n = histograms[ c * RADIX_BUCKETS + bucket ];
+				histograms[ c * RADIX_BUCKETS + bucket ] = offset;
+				offset += n;
+			}
+		}
+
+		#pragma omp parallel for
+		for ( c = 0; c < chunks; ++c ) {
+
+			unsigned int * histogram = histograms + c * RADIX_BUCKETS;
+			int end = MIN( count, ( c + 1 ) * chunkSize );
+
+			for ( int j = c * chunkSize; j < end; ++j ) {
+
+				unsigned int destination = histogram[ ( srcKeys[ j ] >> shift ) & ( RADIX_BUCKETS - 1 ) ]++;
+				dstKeys[ destination ] = srcKeys[ j ];
+				dstOrder[ destination ] = srcOrder[ j ];
+			}
+		}
+
+		temp = srcKeys;
+		srcKeys = dstKeys;
+		dstKeys = temp;
+		temp = srcOrder;
+		srcOrder = dstOrder;
+		dstOrder = temp;
+	}
+
+	// After an odd number of passes the result is in the scratch arrays
+	if ( srcKeys != keys ) {
+
+		memcpy( keys, srcKeys, count * sizeof( unsigned int ) );
+		memcpy( order, srcOrder, count * sizeof( unsigned int ) );
+		dstKeys = srcKeys;
+		dstOrder = srcOrder;
+	}
+
+	delete[] dstKeys;
+	delete[] dstOrder;
+	delete[] histograms;
+}
+
+
+//-------------
+// CONSTRUCTORS
+//-------------
+
+/**
+ * Range constructor
+ * @param begin The index of the first tetrahedron in the node
+ * @param end One past the index of the last tetrahedron in the node
+ */
+LinearOctTreeNode::LinearOctTreeNode( unsigned int begin, unsigned int end ) : box( 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 ), begin( begin ), end( end ), firstChild( 0 ), numChildren( 0 ) {
+
+	return;
+}
+
+
+/**
+ * Default constructor
+ */
+LinearOctTree::LinearOctTree() : tetrahedrons(), nodes(), xmin( numeric_limits<double>::infinity() ), ymin( numeric_limits<double>::infinity() ), zmin( numeric_limits<double>::infinity() ), xmax( -numeric_limits<double>::infinity() ), ymax( -numeric_limits<double>::infinity() ), zmax( -numeric_limits<double>::infinity() ), inv_Xsize( 0.0 ), inv_Ysize( 0.0 ), inv_Zsize( 0.0 ) {
+
+	return;
+}
+
+
+/**
+ * Destructor
+ */
+LinearOctTree::~LinearOctTree() {
+
+	clear();
+}
+
+
+//----------
+// FUNCTIONS
+//----------
+
+/**
+ * Adds a new tetrahedron to the tree
+ * @param cell The cell associated with the tetrahedron
+ */
+void LinearOctTree::add( Cell_handle cell ) {
+
+	Point3D v0( cell->vertex( 0 )->point().x(), cell->vertex( 0 )->point().y(), cell->vertex( 0 )->point().z() );
+	Point3D v1( cell->vertex( 1 )->point().x(), cell->vertex( 1 )->point().y(), cell->vertex( 1 )->point().z() );
+	Point3D v2( cell->vertex( 2 )->point().x(), cell->vertex( 2 )->point().y(), cell->vertex( 2 )->point().z() );
+	Point3D v3( cell->vertex( 3 )->point().x(), cell->vertex( 3 )->point().y(), cell->vertex( 3 )->point().z() );
+
+	tetrahedrons.push_back( Tetrahedron( v0, v1, v2, v3, cell ) );
+
+	xmin = MIN( xmin, tetrahedrons.back().box.xmin );
+	ymin = MIN( ymin, tetrahedrons.back().box.ymin );
+	zmin = MIN( zmin, tetrahedrons.back().box.zmin );
+
+	xmax = MAX( xmax, tetrahedrons.back().box.xmax );
+	ymax = MAX( ymax, tetrahedrons.back().box.ymax );
+	zmax = MAX( zmax, tetrahedrons.back().box.zmax );
+}
+
+
+/**
+ * Removes every tetrahedron and node
+ */
+void LinearOctTree::clear() {
+
+	tetrahedrons.clear();
+	nodes.clear();
+
+	xmin = numeric_limits<double>::infinity();
+	ymin = numeric_limits<double>::infinity();
+	zmin = numeric_limits<double>::infinity();
+	xmax = -numeric_limits<double>::infinity();
+	ymax = -numeric_limits<double>::infinity();
+	zmax = -numeric_limits<double>::infinity();
+	inv_Xsize = 0.0;
+	inv_Ysize = 0.0;
+	inv_Zsize = 0.0;
+}
+
+
+/**
+ * Tells the tree that all the tetrahedrons are added, and it's OK to go ahead and build the nodes
+ */
+void LinearOctTree::build() {
+
+	nodes.clear();
+
+	int count = tetrahedrons.size();
+	int i;
+
+	if ( count == 0 ) {
+
+		return;
+	}
+
+	inv_Xsize = ( xmax > xmin ) ? ( 1u << LINEAR_OCT_TREE_LEVELS ) / ( xmax - xmin ) : 0.0;
+	inv_Ysize = ( ymax > ymin ) ? ( 1u << LINEAR_OCT_TREE_LEVELS ) / ( ymax - ymin ) : 0.0;
+	inv_Zsize = ( zmax > zmin ) ? ( 1u << LINEAR_OCT_TREE_LEVELS ) / ( zmax - zmin ) : 0.0;
+
+	// Sort the tetrahedrons by the key of their centroids
+	unsigned int * keys = new unsigned int[ count ];
+	unsigned int * order = new unsigned int[ count ];
+
+	#pragma omp parallel for
+	for ( i = 0; i < count; ++i ) {
+
+		const Tetrahedron & t = tetrahedrons[ i ];
+		keys[ i ] = mortonKey(
+			( t.v0.x + t.v1.x + t.v2.x + t.v3.x ) * 0.25,
+			( t.v0.y + t.v1.y + t.v2.y + t.v3.y ) * 0.25,
+			( t.v0.z + t.v1.z + t.v2.z + t.v3.z ) * 0.25
+		);
+	}
+
+	radixSort( keys, order, count );
+
+	vector<Tetrahedron> sorted( count );
+
+	#pragma omp parallel for
+	for ( i = 0; i < count; ++i ) {
+
+		sorted[ i ] = tetrahedrons[ order[ i ] ];
+	}
+
+	tetrahedrons.swap( sorted );
+	delete[] order;
+
+	// Build the tree one level at a time (the tetrahedrons in a node share the leading 3 * level bits of their keys)
+	nodes.push_back( LinearOctTreeNode( 0, count ) );
+
+	unsigned int levelBegin = 0;
+	unsigned int levelEnd = 1;
+	unsigned int level;
+	unsigned int next;
+
+	for ( level = 0; levelBegin < levelEnd; ++level ) {
+
+		int levelSize = levelEnd - levelBegin;
+		unsigned int shift = ( level < LINEAR_OCT_TREE_LEVELS ) ? 3 * ( LINEAR_OCT_TREE_LEVELS - 1 - level ) : 0;
+
+		// Fit each node's box and count its children
+		#pragma omp parallel for schedule( dynamic )
+		for ( i = 0; i < levelSize; ++i ) {
+
+			LinearOctTreeNode & node = nodes[ levelBegin + i ];
+			node.box = tetrahedrons[ node.begin ].box;
+
+			for ( unsigned int t = node.begin + 1; t < node.end; ++t ) {
+
+				const Bbox & box = tetrahedrons[ t ].box;
+				node.box.xmin = MIN( node.box.xmin, box.xmin );
+				node.box.ymin = MIN( node.box.ymin, box.ymin );
+				node.box.zmin = MIN( node.box.zmin, box.zmin );
+				node.box.xmax = MAX( node.box.xmax, box.xmax );
+				node.box.ymax = MAX( node.box.ymax, box.ymax );
+				node.box.zmax = MAX( node.box.zmax, box.zmax );
+			}
+
+			node.numChildren = 0;
+
+			if ( node.end - node.begin > LINEAR_OCT_TREE_LEAF_SIZE && level < LINEAR_OCT_TREE_LEVELS ) {
+
+				node.numChildren = 1;
+
+				for ( unsigned int t = node.begin + 1; t < node.end; ++t ) {
+
+					if ( ( ( keys[ t ] >> shift ) & 7u ) != ( ( keys[ t - 1 ] >> shift ) & 7u ) ) {
+
+						++node.numChildren;
+					}
+				}
+			}
+		}
+
+		// Lay out the next level
+		next = levelEnd;
+
+		for ( i = 0; i < levelSize; ++i ) {
+
+			nodes[ levelBegin + i ].firstChild = next;
+			next += nodes[ levelBegin + i ].numChildren;
+		}
+
+		nodes.resize( next );
+
+		#pragma omp parallel for schedule( dynamic )
+		for ( i = 0; i < levelSize; ++i ) {
+
+			const LinearOctTreeNode & node = nodes[ levelBegin + i ];
+
+			if ( node.numChildren == 0 ) {
+
+				continue;
+			}
+
+			unsigned int child = node.firstChild;
+			unsigned int start = node.begin;
+
+			for ( unsigned int t = node.begin + 1; t < node.end; ++t ) {
+
+				if ( ( ( keys[ t ] >> shift ) & 7u ) != ( ( keys[ t - 1 ] >> shift ) & 7u ) ) {
+
+					nodes[ child++ ] = LinearOctTreeNode( start, t );
+					start = t;
+				}
+			}
+
+			nodes[ child ] = LinearOctTreeNode( start, node.end );
+		}
+
+		levelBegin = levelEnd;
+		levelEnd = next;
+	}
+
+	delete[] keys;
+}
+
+
+/**
+ * Checks to see if the given point is in the tree's space
+ * @param point The point to check
+ * @return TRUE if the point is in the root node, FALSE otherwise
+ */
+bool LinearOctTree::contains( const Point3D & point ) const {
+
+	return !nodes.empty() && nodes[ 0 ].contains( point );
+}
+
+
+/**
+ * Finds the tetrahedron that contains the given point
+ * @param point The point to check
+ * @return The tetrahedron containing the point, or NULL if there isn't one
+ */
+const Tetrahedron * LinearOctTree::locate( const Point3D & point ) const {
+
+	if ( nodes.empty() ) {
+
+		return NULL;
+	}
+
+	// Each level replaces one node with at most eight, so this is deep enough for any tree
+	unsigned int stack[ 8 * LINEAR_OCT_TREE_LEVELS + 1 ];
+	int top = 0;
+	unsigned int t;
+	unsigned int c;
+
+	stack[ top++ ] = 0;
+
+	while ( top > 0 ) {
+
+		const LinearOctTreeNode & node = nodes[ stack[ --top ] ];
+
+		if ( !node.contains( point ) ) {
+
+			continue;
+		}
+
+		if ( node.numChildren == 0 ) {
+
+			for ( t = node.begin; t < node.end; ++t ) {
+
+				if ( tetrahedrons[ t ].contains( point ) ) {
+
+					return &tetrahedrons[ t ];
+				}
+			}
+
+			continue;
+		}
+
+		for ( c = 0; c < node.numChildren; ++c ) {
+
+			stack[ top++ ] = node.firstChild + c;
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Labels each cell with the material of the tetrahedron containing its circumcenter, or AIR if there isn't one
+ * (the circumcenters are visited in Morton order so neighboring threads walk the same parts of the tree)
+ * @param points The circumcenters of the cells
+ * @param cells The cells to label
+ * @param count The number of cells
+ * @param midPoint Accumulates the weighted midpoint of non-air cells
+ * @param volume Accumulates the volume of non-air cells
+ */
+void LinearOctTree::label( const Point3D * points, Cell_handle * cells, int count, double * midPoint, double & volume ) const {
+
+	if ( count <= 0 ) {
+
+		return;
+	}
+
+	unsigned int * keys = new unsigned int[ count ];
+	unsigned int * order = new unsigned int[ count ];
+	int i;
+
+	#pragma omp parallel for
+	for ( i = 0; i < count; ++i ) {
+
+		keys[ i ] = mortonKey( points[ i ].x, points[ i ].y, points[ i ].z );
+	}
+
+	radixSort( keys, order, count );
+
+	double midX = 0.0;
+	double midY = 0.0;
+	double midZ = 0.0;
+	double totalVolume = 0.0;
+
+	#pragma omp parallel for reduction( +: midX, midY, midZ, totalVolume ) schedule( dynamic, 256 )
+	for ( i = 0; i < count; ++i ) {
+
+		unsigned int j = order[ i ];
+		const Tetrahedron * tetrahedron = locate( points[ j ] );
+
+		if ( !tetrahedron ) {
+
+			cells[ j ]->info() = AIR;
+			continue;
+		}
+
+		cells[ j ]->info() = tetrahedron->cell->info();
+
+		if ( cells[ j ]->info() > AIR ) {
+
+			double tetrahedronVolume = Tetrahedron::volume( cells[ j ] );
+			totalVolume += tetrahedronVolume;
+			midX += points[ j ].x * tetrahedronVolume;
+			midY += points[ j ].y * tetrahedronVolume;
+			midZ += points[ j ].z * tetrahedronVolume;
+		}
+	}
+
+	midPoint[ 0 ] += midX;
+	midPoint[ 1 ] += midY;
+	midPoint[ 2 ] += midZ;
+	volume += totalVolume;
+
+	delete[] keys;
+	delete[] order;
+}
+
+
+/**
+ * Helper to compute the Morton key of a point
+ * @param x The x-coordinate of the point
+ * @param y The y-coordinate of the point
+ * @param z The z-coordinate of the point
+ * @return The key (the bits of the three quantized coordinates interleaved, x lowest)
+ */
+unsigned int LinearOctTree::mortonKey( double x, double y, double z ) const {
+
+	return expandBits( quantize( ( x - xmin ) * inv_Xsize ) ) | ( expandBits( quantize( ( y - ymin ) * inv_Ysize ) ) << 1 ) | ( expandBits( quantize( ( z - zmin ) * inv_Zsize ) ) << 2 );
+}
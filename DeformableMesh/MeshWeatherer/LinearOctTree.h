@@ -0,0 +1,219 @@
+#pragma once
+
+#include <vector>
+
+#include "Bbox.h"
+#include "CGAL_typedefs.h"
+#include "Point3D.h"
+#include "StoneWeatherer.h"
+#include "Tetrahedron.h"
+
+using namespace std;
+
+
+/**
+ * Determines the number of bits per axis in the Morton keys (and so the deepest level of the tree)
+ */
+#define LINEAR_OCT_TREE_LEVELS 10u
+
+/**
+ * Determines the largest number of tetrahedrons in a leaf
+ */
+#define LINEAR_OCT_TREE_LEAF_SIZE 8u
+
+
+/**
+ * A single node in the linear oct tree (the children of a node are stored next to each other)
+ */
+struct LinearOctTreeNode {
+
+	//------------
+	// MEMBER DATA
+	//------------
+
+	/**
+	 * The bounding box of the tetrahedrons in the node
+	 */
+	Bbox box;
+
+	/**
+	 * The index of the first tetrahedron in the node
+	 */
+	unsigned int begin;
+
+	/**
+	 * One past the index of the last tetrahedron in the node
+	 */
+	unsigned int end;
+
+	/**
+	 * The index of the first child node
+	 */
+	unsigned int firstChild;
+
+	/**
+	 * The number of child nodes (0 for a leaf)
+	 */
+	unsigned int numChildren;
+
+
+	//-------------
+	// CONSTRUCTORS
+	//-------------
+
+	/**
+	 * Range constructor
+	 * @param begin The index of the first tetrahedron in the node
+	 * @param end One past the index of the last tetrahedron in the node
+	 */
+	LinearOctTreeNode( unsigned int begin = 0, unsigned int end = 0 );
+
+
+	//----------
+	// FUNCTIONS
+	//----------
+
+	/**
+	 * Determines whether or not the node contains the given point
+	 * @param point The point to check
+	 * @return TRUE if the box contains the point, FALSE otherwise
+	 */
+	inline bool contains( const Point3D & point ) const {
+
+		return ( point.x >= box.xmin ) && ( point.x <= box.xmax ) && ( point.y >= box.ymin ) && ( point.y <= box.ymax ) && ( point.z >= box.zmin ) && ( point.z <= box.zmax );
+	}
+};
+
+
+/**
+ * An oct tree stored as a flat array of nodes over tetrahedrons sorted by the Morton key of their centroids.
+ * The keys (for both the tetrahedrons and the circumcenters being labeled) are sorted with a parallel radix sort,
+ * the tree is built one level at a time, and lookups walk the tree with a small stack rather than recursion.
+ */
+class LinearOctTree {
+
+	//------------
+	// MEMBER DATA
+	//------------
+
+	/**
+	 * The list of tetrahedrons in the scene (in Morton order once the tree is built)
+	 */
+	vector<Tetrahedron> tetrahedrons;
+
+	/**
+	 * The nodes of the tree (the root is first, and every level follows the one above it)
+	 */
+	vector<LinearOctTreeNode> nodes;
+
+	/**
+	 * The coordinates of the minimum extent of the tree
+	 */
+	double xmin;
+	double ymin;
+	double zmin;
+
+	/**
+	 * The coordinates of the maximum extent of the tree
+	 */
+	double xmax;
+	double ymax;
+	double zmax;
+
+	/**
+	 * The number of Morton cells per unit length along each axis
+	 */
+	double inv_Xsize;
+	double inv_Ysize;
+	double inv_Zsize;
+
+
+public:
+
+	//-------------
+	// CONSTRUCTORS
+	//-------------
+
+	/**
+	 * Default constructor
+	 */
+	LinearOctTree();
+
+
+	/**
+	 * Destructor
+	 */
+	~LinearOctTree();
+
+
+	//----------
+	// FUNCTIONS
+	//----------
+
+	/**
+	 * Adds a new tetrahedron to the tree
+	 * @param cell The cell associated with the tetrahedron
+	 */
+	void add( Cell_handle cell );
+
+
+	/**
+	 * Removes every tetrahedron and node
+	 */
+	void clear();
+
+
+	/**
+	 * Tells the tree that all the tetrahedrons are added, and it's OK to go ahead and build the nodes
+	 */
+	void build();
+
+
+	/**
+	 * Checks to see if the given point is in the tree's space
+	 * @param point The point to check
+	 * @return TRUE if the point is in the root node, FALSE otherwise
+	 */
+	bool contains( const Point3D & point ) const;
+
+
+	/**
+	 * Finds the tetrahedron that contains the given point
+	 * @param point The point to check
+	 * @return The tetrahedron containing the point, or NULL if there isn't one
+	 */
+	const Tetrahedron * locate( const Point3D & point ) const;
+
+
+	/**
+	 * Labels each cell with the material of the tetrahedron containing its circumcenter, or AIR if there isn't one
+	 * (the circumcenters are visited in Morton order so neighboring threads walk the same parts of the tree)
+	 * @param points The circumcenters of the cells
+	 * @param cells The cells to label
+	 * @param count The number of cells
+	 * @param midPoint Accumulates the weighted midpoint of non-air cells
+	 * @param volume Accumulates the volume of non-air cells
+	 */
+	void label( const Point3D * points, Cell_handle * cells, int count, double * midPoint, double & volume ) const;
+
+
+protected:
+
+	/**
+	 * Helper to compute the Morton key of a point
+	 * @param x The x-coordinate of the point
+	 * @param y The y-coordinate of the point
+	 * @param z The z-coordinate of the point
+	 * @return The key (the bits of the three quantized coordinates interleaved, x lowest)
+	 */
+	unsigned int mortonKey( double x, double y, double z ) const;
+};
+
+
+/**
+ * Sorts a list of keys with a parallel LSD radix sort (stable)
+ * @param keys The keys to sort (replaced by the sorted keys)
+ * @param order Stores the original index of each sorted key
+ * @param count The number of keys
+ */
+void radixSort( unsigned int * keys, unsigned int * order, int count );
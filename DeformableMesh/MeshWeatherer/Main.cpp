@@ -1,9 +1,12 @@
 #include "CGAL_typedefs.h"
 #include "Utils.h"
 #include "EulerFluid.h"
+#include "PerlinNoise.h"
+#include "Relabel.h"
 #include "ScreenRegion.h"
 #include "StoneWeatherer.h"
 #include "SurfaceMesh.h"
+#include "UniformGrid.h"
 
 #include <CGAL/Timer.h>
 #include <GL/glut.h>
@@ -320,7 +323,7 @@ Point erodePoint( const Point & p, const VertexData & d, const StoneWeatherer *
 bool isSolid( const Point & p ) {
 
 	//return sw.getContents( p ) == ROCK;
-	return sw.getContents( p ) != AIR;
+	return sw.getMaterialType( p ) != AIR;
 }
 
 
@@ -411,6 +414,8 @@ void threadIdle( void ) {
 		fluid->minPoint[ 2 ] = minPoint[ 2 ] - 2 * h;
 		fluid->setAllOpenEdges();
 		cout << "Created fluid grid with " << fluid->length << " cells\n";
+
+		setSoftnessBounds( minPoint, maxPoint );
 	}
 
 	updateLockedDurability();
@@ -484,6 +489,434 @@ void idle() {
 }
 
 
+/**
+ * Prints the accuracy of the softness cache at several resolutions, along with the cost of one step's worth of softness lookups with and without it
+ */
+void reportSoftnessCache() {
+
+	static const unsigned int resolutions[] = { 16, 32, 64, 128 };
+	static const unsigned int numSamples = 100000;
+
+	vector<Point> points;
+	sw.getPoints( points );
+
+	if ( points.empty() ) {
+
+		return;
+	}
+
+	double low[ 3 ] = { +1.0e300, +1.0e300, +1.0e300 };
+	double high[ 3 ] = { -1.0e300, -1.0e300, -1.0e300 };
+	unsigned int i;
+	int j;
+
+	for ( i = 0; i < points.size(); ++i ) {
+
+		for ( j = 0; j < 3; ++j ) {
+
+			low[ j ] = ( points[ i ][ j ] < low[ j ] ) ? points[ i ][ j ] : low[ j ];
+			high[ j ] = ( points[ i ][ j ] > high[ j ] ) ? points[ i ][ j ] : high[ j ];
+		}
+	}
+
+	updateLockedDurability();
+	setSoftnessBounds( low, high );
+
+	DurabilityCache & cache = getSoftnessCache();
+	unsigned int original = cache.getResolution();
+	CGAL::Timer timer;
+	double sum = 0.0;
+	double direct;
+	double build;
+	double cached;
+	double maxError;
+	double meanError;
+
+	timer.start();
+	timer.reset();
+
+	for ( i = 0; i < points.size(); ++i ) {
+
+		sum += uncachedSoftness( points[ i ].x(), points[ i ].y(), points[ i ].z() );
+	}
+
+	direct = timer.time();
+
+	printf( "\nSoftness cache (%u vertices, uncached lookups %4.6f seconds)\n", ( unsigned int ) points.size(), direct );
+	printf( "   resolution   max error   mean error   build seconds   lookup seconds\n" );
+
+	for ( j = 0; j < ( int ) ( sizeof( resolutions ) / sizeof( resolutions[ 0 ] ) ); ++j ) {
+
+		cache.setResolution( resolutions[ j ] );
+		timer.reset();
+		cache.rebuild();
+		build = timer.time();
+		cache.measureError( numSamples, maxError, meanError );
+		timer.reset();
+
+		for ( i = 0; i < points.size(); ++i ) {
+
+			sum += softness( points[ i ].x(), points[ i ].y(), points[ i ].z() );
+		}
+
+		cached = timer.time();
+		printf( "   %10u   %9.6f   %10.6f   %13.6f   %14.6f\n", resolutions[ j ], maxError, meanError, build, cached );
+	}
+
+	timer.stop();
+	cache.setResolution( original );
+
+	// Keeps the lookups from being optimized away
+	printf( "   (checksum %f)\n", sum );
+}
+
+
+/**
+ * Prints the throughput of scalar and batch perlin noise (grain settings: 4 octaves), and the largest difference between them
+ */
+void reportNoiseThroughput() {
+
+	static const int numSamples = 1000000;
+
+	vector<double> x( numSamples );
+	vector<double> y( numSamples );
+	vector<double> z( numSamples );
+	vector<double> batch( numSamples );
+	int i;
+
+	srand( 0 );
+
+	for ( i = 0; i < numSamples; ++i ) {
+
+		x[ i ] = ( rand() / ( double ) RAND_MAX ) * 64.0 - 32.0;
+		y[ i ] = ( rand() / ( double ) RAND_MAX ) * 64.0 - 32.0;
+		z[ i ] = ( rand() / ( double ) RAND_MAX ) * 64.0 - 32.0;
+	}
+
+	CGAL::Timer timer;
+	double scalarSeconds;
+	double batchSeconds;
+	double maxDifference = 0.0;
+	double difference;
+
+	timer.start();
+	timer.reset();
+	perlin3D( &x[ 0 ], &y[ 0 ], &z[ 0 ], &batch[ 0 ], numSamples, 4, 0x005a5a5a );
+	batchSeconds = timer.time();
+	timer.reset();
+
+	for ( i = 0; i < numSamples; ++i ) {
+
+		difference = fabs( perlin3D( x[ i ], y[ i ], z[ i ], 4, 0x005a5a5a ) - batch[ i ] );
+
+		if ( difference > maxDifference ) {
+
+			maxDifference = difference;
+		}
+	}
+
+	scalarSeconds = timer.time();
+	timer.stop();
+
+	printf( "\nperlin3D (4 octaves, %d samples)\n   scalar - %12.0f samples per second\n   batch  - %12.0f samples per second\n   max difference - %g\n", numSamples, numSamples / scalarSeconds, numSamples / batchSeconds, maxDifference );
+}
+
+
+/**
+ * Times material lookups for one set of points with the triangulation, a fresh grid per lookup (extrapolated from a few lookups), the persistent grid, and the batch query
+ * @param name The use case being timed
+ * @param points The points to look up
+ */
+void reportMaterialLookup( const char * name, const vector<Point> & points ) {
+
+	static const unsigned int numRebuilds = 8;
+
+	if ( points.empty() ) {
+
+		return;
+	}
+
+	vector<Contents> located( points.size() );
+	vector<Contents> batch( points.size() );
+	CGAL::Timer timer;
+	double locateSeconds;
+	double rebuildSeconds;
+	double cachedSeconds;
+	double batchSeconds;
+	unsigned int mismatches = 0;
+	unsigned int i;
+	int sum = 0;
+
+	timer.start();
+	timer.reset();
+
+	for ( i = 0; i < points.size(); ++i ) {
+
+		located[ i ] = sw.getContents( points[ i ] );
+	}
+
+	locateSeconds = timer.time();
+	timer.reset();
+
+	for ( i = 0; i < numRebuilds && i < points.size(); ++i ) {
+
+		sw.rebuildMaterialGrid();
+		sum += sw.getMaterialType( points[ i ] );
+	}
+
+	rebuildSeconds = timer.time() * points.size() / i;
+	timer.reset();
+
+	for ( i = 0; i < points.size(); ++i ) {
+
+		sum += sw.getMaterialType( points[ i ] );
+	}
+
+	cachedSeconds = timer.time();
+	timer.reset();
+	sw.getMaterialTypes( &points[ 0 ], &batch[ 0 ], ( int ) points.size() );
+	batchSeconds = timer.time();
+	timer.stop();
+
+	for ( i = 0; i < points.size(); ++i ) {
+
+		if ( located[ i ] != batch[ i ] ) {
+
+			++mismatches;
+		}
+	}
+
+	printf( "\n%s (%u points)\n", name, ( unsigned int ) points.size() );
+	printf( "   triangulation locate - %10.6f seconds\n", locateSeconds );
+	printf( "   grid per lookup      - %10.6f seconds (estimated)\n", rebuildSeconds );
+	printf( "   persistent grid      - %10.6f seconds (%.1fx)\n", cachedSeconds, rebuildSeconds / ( cachedSeconds > 0.0 ? cachedSeconds : 1.0e-9 ) );
+	printf( "   batch (%2d threads)   - %10.6f seconds (%.1fx)\n", omp_get_max_threads(), batchSeconds, rebuildSeconds / ( batchSeconds > 0.0 ? batchSeconds : 1.0e-9 ) );
+	printf( "   %u points labeled differently from the triangulation (checksum %d)\n", mismatches, sum );
+}
+
+
+/**
+ * Benchmarks the material lookups done when marking solid fluid cells and when sampling a cross-section for the layer pane
+ */
+void reportMaterialLookups() {
+
+	static const unsigned int paneSize = 256;
+
+	vector<Point> points;
+	unsigned int x;
+	unsigned int y;
+	unsigned int z;
+
+	if ( fluid ) {
+
+		double h = fluid->scale;
+
+		for ( x = 0; x < fluid->dimensions[ 0 ]; ++x ) {
+
+			for ( y = 0; y < fluid->dimensions[ 1 ]; ++y ) {
+
+				for ( z = 0; z < fluid->dimensions[ 2 ]; ++z ) {
+
+					double dx = fluid->minPoint[ 0 ] + x * h;
+					double dy = fluid->minPoint[ 1 ] + y * h;
+					double dz = fluid->minPoint[ 2 ] + z * h;
+
+					// One sample per face, the same as FluidGrid3D::setSolidity
+					points.push_back( Point( dx, dy + 0.5 * h, dz + 0.5 * h ) );
+					points.push_back( Point( dx + 0.5 * h, dy, dz + 0.5 * h ) );
+					points.push_back( Point( dx + 0.5 * h, dy + 0.5 * h, dz ) );
+				}
+			}
+		}
+
+		reportMaterialLookup( "Fluid solidity", points );
+		points.clear();
+	}
+
+	double midZ = ( minPoint[ 2 ] + maxPoint[ 2 ] ) * 0.5;
+
+	for ( y = 0; y < paneSize; ++y ) {
+
+		for ( x = 0; x < paneSize; ++x ) {
+
+			points.push_back( Point(
+				minPoint[ 0 ] + ( maxPoint[ 0 ] - minPoint[ 0 ] ) * ( x + 0.5 ) / paneSize,
+				minPoint[ 1 ] + ( maxPoint[ 1 ] - minPoint[ 1 ] ) * ( y + 0.5 ) / paneSize,
+				midZ
+			) );
+		}
+	}
+
+	reportMaterialLookup( "Layer pane cross-section", points );
+}
+
+
+/**
+ * Names of the relabel backends (indexed by StoneWeatherer::RelabelBackend)
+ */
+const char * relabelBackendNames[ StoneWeatherer::NUMBER_OF_RELABEL_BACKENDS ] = { "uniform grid", "oct tree", "linear oct tree" };
+
+
+/**
+ * Times relabeling the current mesh from the previous one with each relabel backend, and counts the cells each labels differently from the uniform grid
+ * (ignores point motion, and puts the mesh's labels back afterward)
+ */
+void reportRelabelBackends() {
+
+	static const int numRuns = 3;
+
+	if ( sw.oldDT->number_of_finite_cells() == 0 ) {
+
+		printf( "\nRelabel backends need a previous mesh (run a step first)\n" );
+
+		return;
+	}
+
+	vector<Contents> original;
+	vector<Contents> reference;
+	vector<Contents> labels;
+	map<Point,Point> pointMap;
+	double midPoint[ 3 ];
+	CGAL::Timer timer;
+	unsigned int mismatches;
+	unsigned int i;
+	int backend;
+	int run;
+
+	for ( All_Cell_iterator it = sw.newDT->all_cells_begin(); it != sw.newDT->all_cells_end(); ++it ) {
+
+		original.push_back( it->info() );
+	}
+
+	StoneWeatherer::RelabelBackend selected = sw.relabelBackend;
+
+	printf( "\nRelabel backends (%u new cells, %u old cells, best of %d)\n", ( unsigned int ) original.size(), ( unsigned int ) sw.oldDT->number_of_finite_cells(), numRuns );
+
+	for ( backend = 0; backend < StoneWeatherer::NUMBER_OF_RELABEL_BACKENDS; ++backend ) {
+
+		double best = 1.0e300;
+
+		sw.setRelabelBackend( ( StoneWeatherer::RelabelBackend ) backend );
+
+		for ( run = 0; run < numRuns; ++run ) {
+
+			timer.reset();
+			timer.start();
+			sw.setContentFlags( midPoint, pointMap );
+			timer.stop();
+			best = ( timer.time() < best ) ? timer.time() : best;
+		}
+
+		labels.clear();
+
+		for ( All_Cell_iterator it = sw.newDT->all_cells_begin(); it != sw.newDT->all_cells_end(); ++it ) {
+
+			labels.push_back( it->info() );
+		}
+
+		if ( backend == StoneWeatherer::UNIFORM_GRID_RELABEL ) {
+
+			reference = labels;
+		}
+
+		mismatches = 0;
+
+		for ( i = 0; i < labels.size(); ++i ) {
+
+			if ( labels[ i ] != reference[ i ] ) {
+
+				++mismatches;
+			}
+		}
+
+		printf( "   %-16s - %10.6f seconds, %u cells labeled differently\n", relabelBackendNames[ backend ], best, mismatches );
+	}
+
+	sw.setRelabelBackend( selected );
+	i = 0;
+
+	for ( All_Cell_iterator it = sw.newDT->all_cells_begin(); it != sw.newDT->all_cells_end(); ++it ) {
+
+		it->info() = original[ i++ ];
+	}
+}
+
+
+/**
+ * Pairs each of the current mesh's circumcenters with the previous mesh's tetrahedrons that might contain it, then checks and times each relabel device against the reference
+ */
+void reportRelabelDevices() {
+
+	static const char * deviceNames[] = { "cpu", "cuda" };
+
+	if ( sw.oldDT->number_of_finite_cells() == 0 ) {
+
+		printf( "\nRelabel devices need a previous mesh (run a step first)\n" );
+
+		return;
+	}
+
+	UniformGrid grid;
+
+	for ( Cell_iterator it = sw.oldDT->finite_cells_begin(); it != sw.oldDT->finite_cells_end(); ++it ) {
+
+		if ( it->info() > AIR ) {
+
+			grid.add( it );
+		}
+	}
+
+	grid.partition();
+
+	vector<Pair> pairs;
+	vector<const Tetrahedron*> candidates;
+	Point circumCenter;
+	int index = 0;
+	unsigned int i;
+
+	for ( Cell_iterator it = sw.newDT->finite_cells_begin(); it != sw.newDT->finite_cells_end(); ++it, ++index ) {
+
+		Cell_handle cell = it;
+		computeCircumcenter( cell, circumCenter );
+		Point3D p( circumCenter.x(), circumCenter.y(), circumCenter.z() );
+
+		if ( !grid.contains( p ) ) {
+
+			continue;
+		}
+
+		candidates.clear();
+		grid.getCandidates( p, candidates );
+
+		for ( i = 0; i < candidates.size(); ++i ) {
+
+			pairs.push_back( Pair( Circumcenter( p, cell, index ), *candidates[ i ] ) );
+		}
+	}
+
+	if ( pairs.empty() ) {
+
+		return;
+	}
+
+	printf( "\nRelabel devices (%u pairs, %d circumcenters)\n", ( unsigned int ) pairs.size(), index );
+
+	for ( int device = RELABEL_CPU; device <= RELABEL_CUDA; ++device ) {
+
+		if ( !relabelDeviceAvailable( ( RelabelDevice ) device ) ) {
+
+			printf( "   %-4s - not available in this build\n", deviceNames[ device ] );
+			continue;
+		}
+
+		double seconds;
+		int mismatches = checkRelabelParity( &pairs[ 0 ], ( int ) pairs.size(), index, ( RelabelDevice ) device, seconds );
+
+		printf( "   %-4s - %10.6f seconds (%12.0f pairs per second), %d labels differ from the reference\n", deviceNames[ device ], seconds, pairs.size() / ( seconds > 0.0 ? seconds : 1.0e-9 ), mismatches );
+	}
+}
+
+
 #include <fstream>
 
 void saveRocks (int saved) 
@@ -546,6 +979,37 @@ void asciiKeys( unsigned char key, int x, int y ) {
 			saveRocks(saved); 
 		} break;
 
+		case 'd':
+
+			reportSoftnessCache();
+			break;
+
+		case 'n':
+
+			reportNoiseThroughput();
+			break;
+
+		case 'm':
+
+			reportMaterialLookups();
+			break;
+
+		case 'o':
+
+			reportRelabelBackends();
+			break;
+
+		case 'p':
+
+			reportRelabelDevices();
+			break;
+
+		case 'r':
+
+			sw.setRelabelBackend( ( StoneWeatherer::RelabelBackend ) ( ( sw.relabelBackend + 1 ) % StoneWeatherer::NUMBER_OF_RELABEL_BACKENDS ) );
+			printf( "Relabeling with the %s\n", relabelBackendNames[ sw.relabelBackend ] );
+			break;
+
 		case 'l':
 
 			glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
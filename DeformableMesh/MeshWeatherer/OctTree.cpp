@@ -8,7 +8,7 @@
 /**
  * Default constructor
  */
-OctTree::OctTree() : root( new OctTreeNode() ), circumcenters(), tetrahedrons() {
+OctTree::OctTree() : circumcenters(), tetrahedrons(), root( new OctTreeNode() ) {
 
 	return;
 }
@@ -24,6 +24,16 @@ OctTree::~OctTree() {
 		delete root;
 	}
 
+	for ( unsigned int i = 0; i < circumcenters.size(); ++i ) {
+
+		delete circumcenters[ i ];
+	}
+
+	for ( unsigned int i = 0; i < tetrahedrons.size(); ++i ) {
+
+		delete tetrahedrons[ i ];
+	}
+
 	circumcenters.clear();
 	tetrahedrons.clear();
 }
@@ -38,7 +48,7 @@ OctTree::~OctTree() {
  * @param point The location of the circumcenter
  * @param cell The cell associated with the circumcenter
  */
-void OctTree::add( const Point & point, Cell_handle cell ) {
+void OctTree::add( const Point3D & point, Cell_handle cell ) {
 
 	circumcenters.push_back( new Circumcenter( point, cell ) );
 	root->add( circumcenters.back(), false );
@@ -51,7 +61,12 @@ void OctTree::add( const Point & point, Cell_handle cell ) {
  */
 void OctTree::add( Cell_handle cell ) {
 
-	tetrahedrons.push_back( new Tetrahedron( cell ) );
+	Point3D v0( cell->vertex( 0 )->point().x(), cell->vertex( 0 )->point().y(), cell->vertex( 0 )->point().z() );
+	Point3D v1( cell->vertex( 1 )->point().x(), cell->vertex( 1 )->point().y(), cell->vertex( 1 )->point().z() );
+	Point3D v2( cell->vertex( 2 )->point().x(), cell->vertex( 2 )->point().y(), cell->vertex( 2 )->point().z() );
+	Point3D v3( cell->vertex( 3 )->point().x(), cell->vertex( 3 )->point().y(), cell->vertex( 3 )->point().z() );
+
+	tetrahedrons.push_back( new Tetrahedron( v0, v1, v2, v3, cell ) );
 	root->add( tetrahedrons.back(), true );
 }
 
@@ -61,48 +76,19 @@ void OctTree::add( Cell_handle cell ) {
  * @param point The point to check
  * @return TRUE if the point is in the root node, FALSE otherwise
  */
-bool OctTree::contains( const Point & point ) const {
+bool OctTree::contains( const Point3D & point ) const {
 
 	return root->contains( point );
 }
 
 
 /**
- * Computes the list of pairs to check by partitioning the space
- * @param pairs The list of pairs to add to while partitioning
+ * Partitions the space and labels each circumcenter's cell with the material of the tetrahedron that contains it
+ * (cells whose circumcenter isn't in any tetrahedron keep their current label)
+ * @param midPoint Accumulates the weighted midpoint of non-air cells
+ * @param volume Accumulates the volume of non-air cells
  */
-void OctTree::partition( vector< pair< Circumcenter*, vector<Tetrahedron*> > > & pairs ) {
-
-	vector<OctTreeNode*> nodesToProcess;
-	root->split( 0, nodesToProcess );
-	int size = nodesToProcess.size();
-	int csize;
-	int tsize;
-	int c;
-	int t;
-	vector<Tetrahedron*> tets;
+void OctTree::label( double * midPoint, double & volume ) {
 
-	#pragma omp parallel for private(csize,tsize,c,t,tets)
-	for ( int i = 0; i < size; ++i ) {
-
-		// TODO: Eventually this list will be a GPU-ready list of GPU-ready objects or object pairs (THRUST)
-		
-		csize = nodesToProcess[ i ]->circumcenters.size();
-		tsize = nodesToProcess[ i ]->tetrahedrons.size();
-
-		for ( c = 0; c < csize; ++c ) {
-
-			tets.clear();
-
-			for ( t = 0; t < tsize; ++t ) {
-
-				tets.push_back( nodesToProcess[ i ]->tetrahedrons[ t ] );
-			}
-
-			#pragma omp critical(addToPairs)
-			{
-				pairs.push_back( pair< Circumcenter*, vector<Tetrahedron*> >( nodesToProcess[ i ]->circumcenters[ c ], tets ) );
-			}
-		}
-	}
+	root->split( 0, midPoint, volume );
 }
@@ -21,16 +21,6 @@ private:
 	// MEMBER DATA
 	//------------
 
-	/**
-	 * The type of points
-	 */
-	typedef StoneWeatherer::Point Point;
-
-	/**
-	 * The type of cell handle
-	 */
-	typedef StoneWeatherer::Cell_handle Cell_handle;
-
 	/**
 	 * The list of circumcenters in the scene
 	 */
@@ -75,7 +65,7 @@ public:
 	 * @param point The location of the circumcenter
 	 * @param cell The cell associated with the circumcenter
 	 */
-	void add( const Point & point, Cell_handle cell );
+	void add( const Point3D & point, Cell_handle cell );
 
 
 	/**
@@ -90,12 +80,14 @@ public:
 	 * @param point The point to check
 	 * @return TRUE if the point is in the root node, FALSE otherwise
 	 */
-	bool contains( const Point & point ) const;
+	bool contains( const Point3D & point ) const;
 
 
 	/**
-	 * Computes the list of pairs to check by partitioning the space
-	 * @param pairs The list of pairs to add to while partitioning
+	 * Partitions the space and labels each circumcenter's cell with the material of the tetrahedron that contains it
+	 * (cells whose circumcenter isn't in any tetrahedron keep their current label)
+	 * @param midPoint Accumulates the weighted midpoint of non-air cells
+	 * @param volume Accumulates the volume of non-air cells
 	 */
-	void partition( vector< pair< Circumcenter*, vector<Tetrahedron*> > > & pairs );
+	void label( double * midPoint, double & volume );
 };
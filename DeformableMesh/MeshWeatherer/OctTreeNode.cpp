@@ -150,7 +150,7 @@ void OctTreeNode::split( int depth, double * midPoint, double & volume ) {
 	}
 
 	// No more splitting, so make list of pairs
-	if ( tetrahedrons.size() < MIN_TETRAHEDRONS || circumcenters.size() < MIN_CIRCUMCENTERS ) {
+	if ( tetrahedrons.size() < MIN_TETRAHEDRONS || circumcenters.size() < MIN_CIRCUMCENTERS || depth >= OCT_TREE_MAX_DEPTH ) {
 
 		//CGAL::Timer timer;
 		//timer.start();
@@ -171,7 +171,7 @@ void OctTreeNode::split( int depth, double * midPoint, double & volume ) {
 
 					circumcenters[ c ]->cell->info() = tetrahedrons[ t ]->cell->info();
 
-					if ( circumcenters[ c ]->cell->info() != StoneWeatherer::AIR ) {
+					if ( circumcenters[ c ]->cell->info() != AIR ) {
 
 						double tetrahedronVolume = Tetrahedron::volume( circumcenters[ c ]->cell );
 						tempVolume += tetrahedronVolume;
@@ -180,7 +180,7 @@ void OctTreeNode::split( int depth, double * midPoint, double & volume ) {
 						tempMidpoint[ 2 ] += circumcenters[ c ]->point.z * tetrahedronVolume;
 					}
 
-					continue;
+					break;
 				}
 			}
 		}
@@ -3,9 +3,13 @@
 #define MIN_CIRCUMCENTERS 20
 #define MIN_TETRAHEDRONS MIN_CIRCUMCENTERS
 
+/**
+ * Determines the deepest a node can be split (tetrahedrons overlapping many nodes would otherwise never drop below MIN_TETRAHEDRONS)
+ */
+#define OCT_TREE_MAX_DEPTH 10
+
 #include "Circumcenter.h"
 #include "Tetrahedron.h"
-#include "Pair.h"
 #include "StoneWeatherer.h"
 #include "Bbox.h"
 
@@ -56,16 +60,9 @@ inline double max( double a, double b ) {
  */
 class OctTreeNode {
 
+	friend class OctTree;
 	friend class SpatialPartitionHierarchy;
 
-public:
-
-	/**
-	 * The triangulation data structure
-	 */
-	typedef StoneWeatherer::TDS TDS;
-
-
 private:
 
 	//------------
@@ -3,9 +3,15 @@
 #include "Circumcenter.h"
 #include "Tetrahedron.h"
 
+// Only the CUDA build needs the CUDA headers (the CPU relabel backend uses the same pairs)
 #ifndef __host__
+#ifdef USE_CUDA
 #include <cuda.h>
 #include <host_defines.h>
+#else
+#define __host__
+#define __device__
+#endif
 #endif
 
 struct Pair {
@@ -1,11 +1,25 @@
 #include "PerlinNoise.h"
 
+#include <cstring>
+
+// SSE2 is enough to run four copies of the mix function side by side (it only needs 32-bit add, xor and shifts)
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define PERLIN_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 /**
  * Used to scale random number from range [0x00000000,0xffffffff] to range [0.0,1.0)
  */
 #define RAND_MAX_DOUBLE 4294967296.0
 
 
+/**
+ * The number of points the batch functions work on at once (sized so the scratch arrays stay on the stack and in cache)
+ */
+#define PERLIN_BLOCK 64
+
+
 /**
  * Rotates the bits of x as part of Robert Jenkins' 96-bit mix function (compiles down to ror or rol instruction with reasonably optimizing compiler)
  * @param x The bits to rotate
@@ -230,3 +244,380 @@ double perlin3D( double x, double y, double z, int octaves, int seed ) {
 
 	return result;
 }
+
+
+// ***** BATCH EVALUATION ***** //
+
+#ifdef PERLIN_USE_SSE2
+
+/**
+ * Rotates the bits of four packed 32-bit values (the SSE2 counterpart of rotate)
+ */
+#define ROTATE4( x, k ) _mm_or_si128( _mm_slli_epi32( ( x ), ( k ) ), _mm_srli_epi32( ( x ), 32 - ( k ) ) )
+
+
+/**
+ * Four lanes of Robert Jenkins' 96-bit mix function (produces exactly what mix produces for each lane)
+ * @param a First set of initialized random bits
+ * @param b Second set of initialized random bits
+ * @param c The input keys
+ * @return The hash results
+ */
+inline __m128i mix4( __m128i a, __m128i b, __m128i c ) {
+
+	c = _mm_xor_si128( c, b );
+	b = ROTATE4( b, 14 );
+	c = _mm_sub_epi32( c, b );
+
+	a = _mm_xor_si128( a, c );
+	c = ROTATE4( c, 11 );
+	a = _mm_sub_epi32( a, c );
+
+	b = _mm_xor_si128( b, a );
+	a = ROTATE4( a, 25 );
+	b = _mm_sub_epi32( b, a );
+
+	c = _mm_xor_si128( c, b );
+	b = ROTATE4( b, 16 );
+	c = _mm_sub_epi32( c, b );
+
+	a = _mm_xor_si128( a, c );
+	c = ROTATE4( c, 4 );
+	a = _mm_sub_epi32( a, c );
+
+	b = _mm_xor_si128( b, a );
+	a = ROTATE4( a, 14 );
+	b = _mm_sub_epi32( b, a );
+
+	c = _mm_xor_si128( c, b );
+	b = ROTATE4( b, 24 );
+	c = _mm_sub_epi32( c, b );
+
+	return c;
+}
+
+#endif
+
+
+/**
+ * Generates random numbers in the range [0,1) for arrays of keys (matches random for each key, four keys at a time when SSE2 is available)
+ * @param a First set of initialized random bits for each key
+ * @param b Second set of initialized random bits for each key
+ * @param c The input keys
+ * @param result Stores the random number for each key
+ * @param count The number of keys
+ */
+static void randomBatch( const int * a, const int * b, const int * c, double * result, int count ) {
+
+	int i = 0;
+
+#ifdef PERLIN_USE_SSE2
+	// SSE2 only converts signed integers, so flip the top bit and add it back as 2^31 (exact in double precision)
+	const __m128i signBit = _mm_set1_epi32( 0x80000000 );
+	const __m128d half = _mm_set1_pd( 2147483648.0 );
+	const __m128d scale = _mm_set1_pd( 1.0 / RAND_MAX_DOUBLE );
+	__m128i hash;
+
+	for ( ; i + 4 <= count; i += 4 ) {
+
+		hash = _mm_xor_si128( mix4( _mm_loadu_si128( ( const __m128i * ) ( a + i ) ), _mm_loadu_si128( ( const __m128i * ) ( b + i ) ), _mm_loadu_si128( ( const __m128i * ) ( c + i ) ) ), signBit );
+
+		_mm_storeu_pd( result + i + 0, _mm_mul_pd( _mm_add_pd( _mm_cvtepi32_pd( hash ), half ), scale ) );
+		_mm_storeu_pd( result + i + 2, _mm_mul_pd( _mm_add_pd( _mm_cvtepi32_pd( _mm_shuffle_epi32( hash, _MM_SHUFFLE( 3, 2, 3, 2 ) ) ), half ), scale ) );
+	}
+#endif
+
+	for ( ; i < count; ++i ) {
+
+		result[ i ] = random( a[ i ], b[ i ], c[ i ] );
+	}
+}
+
+
+/**
+ * The Perlin noise function in 1D for a block of values (at most PERLIN_BLOCK)
+ * @param x The frequencies
+ * @param result Stores the noise to add for each value
+ * @param count The number of values
+ * @param seed The seed for the random number generation
+ */
+static void random1DBlock( const double * x, double * result, int count, int seed ) {
+
+	int ix0[ PERLIN_BLOCK ];
+	int ix1[ PERLIN_BLOCK ];
+	int iy[ PERLIN_BLOCK ];
+	int iz[ PERLIN_BLOCK ];
+	double fx[ PERLIN_BLOCK ];
+	double r0[ PERLIN_BLOCK ];
+	double r1[ PERLIN_BLOCK ];
+	int i;
+
+	for ( i = 0; i < count; ++i ) {
+
+		ix0[ i ] = ifloor( x[ i ] );
+		ix1[ i ] = 1 + ix0[ i ];
+		iy[ i ] = seed;
+		iz[ i ] = 0;
+		fx[ i ] = x[ i ] - ix0[ i ];
+	}
+
+	randomBatch( ix0, iy, iz, r0, count );
+	randomBatch( ix1, iy, iz, r1, count );
+
+	for ( i = 0; i < count; ++i ) {
+
+		result[ i ] = r0[ i ] * ( 1 - fx[ i ] ) + r1[ i ] * fx[ i ];
+	}
+}
+
+
+/**
+ * The Perlin noise function in 2D for a block of points (at most PERLIN_BLOCK)
+ * @param x The frequencies in x
+ * @param y The frequencies in y
+ * @param result Stores the noise to add for each point
+ * @param count The number of points
+ * @param seed The seed for the random number generation
+ */
+static void random2DBlock( const double * x, const double * y, double * result, int count, int seed ) {
+
+	int ix0[ PERLIN_BLOCK ];
+	int ix1[ PERLIN_BLOCK ];
+	int iy0[ PERLIN_BLOCK ];
+	int iy1[ PERLIN_BLOCK ];
+	int iz[ PERLIN_BLOCK ];
+	double fx[ PERLIN_BLOCK ];
+	double fy[ PERLIN_BLOCK ];
+	double r00[ PERLIN_BLOCK ];
+	double r01[ PERLIN_BLOCK ];
+	double r10[ PERLIN_BLOCK ];
+	double r11[ PERLIN_BLOCK ];
+	int i;
+
+	for ( i = 0; i < count; ++i ) {
+
+		ix0[ i ] = ifloor( x[ i ] );
+		iy0[ i ] = ifloor( y[ i ] );
+		ix1[ i ] = 1 + ix0[ i ];
+		iy1[ i ] = 1 + iy0[ i ];
+		iz[ i ] = seed;
+		fx[ i ] = x[ i ] - ix0[ i ];
+		fy[ i ] = y[ i ] - iy0[ i ];
+	}
+
+	randomBatch( ix0, iy0, iz, r00, count );
+	randomBatch( ix0, iy1, iz, r01, count );
+	randomBatch( ix1, iy0, iz, r10, count );
+	randomBatch( ix1, iy1, iz, r11, count );
+
+	for ( i = 0; i < count; ++i ) {
+
+		result[ i ] = r00[ i ] * ( 1 - fx[ i ] ) * ( 1 - fy[ i ] ) +
+			r01[ i ] * ( 1 - fx[ i ] ) * ( fy[ i ] ) +
+			r10[ i ] * ( fx[ i ] ) * ( 1 - fy[ i ] ) +
+			r11[ i ] * ( fx[ i ] ) * ( fy[ i ] );
+	}
+}
+
+
+/**
+ * The Perlin noise function in 3D for a block of points (at most PERLIN_BLOCK)
+ * @param x The frequencies in x
+ * @param y The frequencies in y
+ * @param z The frequencies in z
+ * @param result Stores the noise to add for each point
+ * @param count The number of points
+ * @param seed The seed for the random number generation
+ */
+static void random3DBlock( const double * x, const double * y, const double * z, double * result, int count, int seed ) {
+
+	int ix[ 2 ][ PERLIN_BLOCK ];
+	int iy[ 2 ][ PERLIN_BLOCK ];
+	int iz[ 2 ][ PERLIN_BLOCK ];
+	double fx[ PERLIN_BLOCK ];
+	double fy[ PERLIN_BLOCK ];
+	double fz[ PERLIN_BLOCK ];
+	double r[ 8 ][ PERLIN_BLOCK ];
+	double pz;
+	int i;
+	int corner;
+
+	for ( i = 0; i < count; ++i ) {
+
+		pz = z[ i ] + ( seed * 53813 );
+		ix[ 0 ][ i ] = ifloor( x[ i ] );
+		iy[ 0 ][ i ] = ifloor( y[ i ] );
+		iz[ 0 ][ i ] = ifloor( pz );
+		ix[ 1 ][ i ] = 1 + ix[ 0 ][ i ];
+		iy[ 1 ][ i ] = 1 + iy[ 0 ][ i ];
+		iz[ 1 ][ i ] = 1 + iz[ 0 ][ i ];
+		fx[ i ] = x[ i ] - ix[ 0 ][ i ];
+		fy[ i ] = y[ i ] - iy[ 0 ][ i ];
+		fz[ i ] = pz - iz[ 0 ][ i ];
+	}
+
+	// Corners are numbered by their (x,y,z) offsets as bits, in the same order random3D adds them
+	for ( corner = 0; corner < 8; ++corner ) {
+
+		randomBatch( ix[ ( corner >> 2 ) & 1 ], iy[ ( corner >> 1 ) & 1 ], iz[ corner & 1 ], r[ corner ], count );
+	}
+
+	for ( i = 0; i < count; ++i ) {
+
+		result[ i ] = r[ 0 ][ i ] * ( 1 - fx[ i ] ) * ( 1 - fy[ i ] ) * ( 1 - fz[ i ] ) +
+			r[ 1 ][ i ] * ( 1 - fx[ i ] ) * ( 1 - fy[ i ] ) * ( fz[ i ] ) +
+			r[ 2 ][ i ] * ( 1 - fx[ i ] ) * ( fy[ i ] ) * ( 1 - fz[ i ] ) +
+			r[ 3 ][ i ] * ( 1 - fx[ i ] ) * ( fy[ i ] ) * ( fz[ i ] ) +
+			r[ 4 ][ i ] * ( fx[ i ] ) * ( 1 - fy[ i ] ) * ( 1 - fz[ i ] ) +
+			r[ 5 ][ i ] * ( fx[ i ] ) * ( 1 - fy[ i ] ) * ( fz[ i ] ) +
+			r[ 6 ][ i ] * ( fx[ i ] ) * ( fy[ i ] ) * ( 1 - fz[ i ] ) +
+			r[ 7 ][ i ] * ( fx[ i ] ) * ( fy[ i ] ) * ( fz[ i ] );
+	}
+}
+
+
+/**
+ * Generates one-dimensional perlin noise for an array of values (matches perlin1D for each value, several values at a time)
+ * @param x The values to perturb
+ * @param result Stores the amount of noise to add to each value
+ * @param count The number of values
+ * @param octaves The number of successive noise functions to add (default 0)
+ * @param seed The seed for the random number generator (default 0)
+ */
+void perlin1D( const double * x, double * result, int count, int octaves, int seed ) {
+
+	double px[ PERLIN_BLOCK ];
+	double noise[ PERLIN_BLOCK ];
+	double chop;
+	int start;
+	int n;
+	int i;
+	int j;
+
+	for ( start = 0; start < count; start += PERLIN_BLOCK ) {
+
+		n = ( count - start < PERLIN_BLOCK ) ? ( count - start ) : PERLIN_BLOCK;
+		memcpy( px, x + start, n * sizeof( double ) );
+		random1DBlock( px, result + start, n, seed );
+		chop = 1.0;
+
+		for ( i = 0; i < octaves; ++i ) {
+
+			chop /= 2.0;
+
+			for ( j = 0; j < n; ++j ) {
+
+				px[ j ] *= 2.0;
+			}
+
+			random1DBlock( px, noise, n, seed + i + 1 );
+
+			for ( j = 0; j < n; ++j ) {
+
+				result[ start + j ] += chop * noise[ j ];
+			}
+		}
+	}
+}
+
+
+/**
+ * Generates two-dimensional perlin noise for an array of points (matches perlin2D for each point, several points at a time)
+ * @param x The x-coordinates of the points to perturb
+ * @param y The y-coordinates of the points to perturb
+ * @param result Stores the amount of noise to add to each point
+ * @param count The number of points
+ * @param octaves The number of successive noise functions to add (default 0)
+ * @param seed The seed for the random number generator (default 0)
+ */
+void perlin2D( const double * x, const double * y, double * result, int count, int octaves, int seed ) {
+
+	double px[ PERLIN_BLOCK ];
+	double py[ PERLIN_BLOCK ];
+	double noise[ PERLIN_BLOCK ];
+	double chop;
+	int start;
+	int n;
+	int i;
+	int j;
+
+	for ( start = 0; start < count; start += PERLIN_BLOCK ) {
+
+		n = ( count - start < PERLIN_BLOCK ) ? ( count - start ) : PERLIN_BLOCK;
+		memcpy( px, x + start, n * sizeof( double ) );
+		memcpy( py, y + start, n * sizeof( double ) );
+		random2DBlock( px, py, result + start, n, seed );
+		chop = 1.0;
+
+		for ( i = 0; i < octaves; ++i ) {
+
+			chop /= 2.0;
+
+			for ( j = 0; j < n; ++j ) {
+
+				px[ j ] *= 2.0;
+				py[ j ] *= 2.0;
+			}
+
+			random2DBlock( px, py, noise, n, seed + i + 1 );
+
+			for ( j = 0; j < n; ++j ) {
+
+				result[ start + j ] += chop * noise[ j ];
+			}
+		}
+	}
+}
+
+
+/**
+ * Generates three-dimensional perlin noise for an array of points (matches perlin3D for each point, several points at a time)
+ * @param x The x-coordinates of the points to perturb
+ * @param y The y-coordinates of the points to perturb
+ * @param z The z-coordinates of the points to perturb
+ * @param result Stores the amount of noise to add to each point
+ * @param count The number of points
+ * @param octaves The number of successive noise functions to add (default 0)
+ * @param seed The seed for the random number generator (default 0)
+ */
+void perlin3D( const double * x, const double * y, const double * z, double * result, int count, int octaves, int seed ) {
+
+	double px[ PERLIN_BLOCK ];
+	double py[ PERLIN_BLOCK ];
+	double pz[ PERLIN_BLOCK ];
+	double noise[ PERLIN_BLOCK ];
+	double chop;
+	int start;
+	int n;
+	int i;
+	int j;
+
+	for ( start = 0; start < count; start += PERLIN_BLOCK ) {
+
+		n = ( count - start < PERLIN_BLOCK ) ? ( count - start ) : PERLIN_BLOCK;
+		memcpy( px, x + start, n * sizeof( double ) );
+		memcpy( py, y + start, n * sizeof( double ) );
+		memcpy( pz, z + start, n * sizeof( double ) );
+		random3DBlock( px, py, pz, result + start, n, seed );
+		chop = 1.0;
+
+		for ( i = 0; i < octaves; ++i ) {
+
+			chop /= 2.0;
+
+			for ( j = 0; j < n; ++j ) {
+
+				px[ j ] *= 2.0;
+				py[ j ] *= 2.0;
+				pz[ j ] *= 2.0;
+			}
+
+			random3DBlock( px, py, pz, noise, n, seed + i + 1 );
+
+			for ( j = 0; j < n; ++j ) {
+
+				result[ start + j ] += chop * noise[ j ];
+			}
+		}
+	}
+}
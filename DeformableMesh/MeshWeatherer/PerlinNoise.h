@@ -56,3 +56,39 @@ double perlin2D( double x, double y, int octaves = 0, int seed = 0 );
  * @return The amount of noise to add to (x,y,z)
  */
 double perlin3D( double x, double y, double z, int octaves = 0, int seed = 0 );
+
+
+/**
+ * Generates one-dimensional perlin noise for an array of values (matches perlin1D for each value, several values at a time)
+ * @param x The values to perturb
+ * @param result Stores the amount of noise to add to each value
+ * @param count The number of values
+ * @param octaves The number of successive noise functions to add (default 0)
+ * @param seed The seed for the random number generator (default 0)
+ */
+void perlin1D( const double * x, double * result, int count, int octaves = 0, int seed = 0 );
+
+
+/**
+ * Generates two-dimensional perlin noise for an array of points (matches perlin2D for each point, several points at a time)
+ * @param x The x-coordinates of the points to perturb
+ * @param y The y-coordinates of the points to perturb
+ * @param result Stores the amount of noise to add to each point
+ * @param count The number of points
+ * @param octaves The number of successive noise functions to add (default 0)
+ * @param seed The seed for the random number generator (default 0)
+ */
+void perlin2D( const double * x, const double * y, double * result, int count, int octaves = 0, int seed = 0 );
+
+
+/**
+ * Generates three-dimensional perlin noise for an array of points (matches perlin3D for each point, several points at a time)
+ * @param x The x-coordinates of the points to perturb
+ * @param y The y-coordinates of the points to perturb
+ * @param z The z-coordinates of the points to perturb
+ * @param result Stores the amount of noise to add to each point
+ * @param count The number of points
+ * @param octaves The number of successive noise functions to add (default 0)
+ * @param seed The seed for the random number generator (default 0)
+ */
+void perlin3D( const double * x, const double * y, const double * z, double * result, int count, int octaves = 0, int seed = 0 );
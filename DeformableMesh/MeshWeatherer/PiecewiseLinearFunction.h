@@ -123,4 +123,15 @@ struct piecewiseLinearFunction {
 	 * @return A reference to the function after shrinking
 	 */
 	piecewiseLinearFunction & operator /= ( double s );
+
+
+	/**
+	 * Equality operator
+	 * @param other The function to compare against
+	 * @return TRUE if both functions have the same keys, FALSE otherwise
+	 */
+	inline bool operator == ( const piecewiseLinearFunction & other ) const {
+
+		return keys == other.keys;
+	}
 };
@@ -0,0 +1,269 @@
+#include <CGAL/Timer.h>
+#include <vector>
+
+#include "Relabel.h"
+
+#ifdef USE_CUDA
+#include "MyCuda.h"
+#endif
+
+// SSE2 is enough to run the containment test for two pairs side by side
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define RELABEL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+
+/**
+ * Determines the number of pairs each thread takes at a time
+ */
+#define RELABEL_BLOCK 1024
+
+
+#ifdef RELABEL_USE_SSE2
+
+/**
+ * Computes the determinant of two 3x3 matrices at once (in the same order as the scalar determinant, so the results match bit for bit)
+ * @return The determinant of each matrix
+ */
+static inline __m128d determinant2( __m128d m00, __m128d m01, __m128d m02, __m128d m10, __m128d m11, __m128d m12, __m128d m20, __m128d m21, __m128d m22 ) {
+
+	__m128d result = _mm_mul_pd( _mm_mul_pd( m00, m11 ), m22 );
+	result = _mm_add_pd( result, _mm_mul_pd( _mm_mul_pd( m01, m12 ), m20 ) );
+	result = _mm_add_pd( result, _mm_mul_pd( _mm_mul_pd( m02, m10 ), m21 ) );
+	result = _mm_sub_pd( result, _mm_mul_pd( _mm_mul_pd( m02, m11 ), m20 ) );
+	result = _mm_sub_pd( result, _mm_mul_pd( _mm_mul_pd( m01, m10 ), m22 ) );
+	result = _mm_sub_pd( result, _mm_mul_pd( _mm_mul_pd( m00, m12 ), m21 ) );
+
+	return result;
+}
+
+
+/**
+ * Computes the determinant of two 4x4 matrices at once, where each row is a point with a 1 in the last column
+ * @param a The first row of each matrix (x, y, z)
+ * @param b The second row of each matrix (x, y, z)
+ * @param c The third row of each matrix (x, y, z)
+ * @param d The fourth row of each matrix (x, y, z)
+ * @return The determinant of each matrix
+ */
+static inline __m128d determinant2( const __m128d * a, const __m128d * b, const __m128d * c, const __m128d * d ) {
+
+	__m128d one = _mm_set1_pd( 1.0 );
+	__m128d result = _mm_mul_pd( a[ 0 ], determinant2( b[ 1 ], b[ 2 ], one, c[ 1 ], c[ 2 ], one, d[ 1 ], d[ 2 ], one ) );
+	result = _mm_sub_pd( result, _mm_mul_pd( a[ 1 ], determinant2( b[ 0 ], b[ 2 ], one, c[ 0 ], c[ 2 ], one, d[ 0 ], d[ 2 ], one ) ) );
+	result = _mm_add_pd( result, _mm_mul_pd( a[ 2 ], determinant2( b[ 0 ], b[ 1 ], one, c[ 0 ], c[ 1 ], one, d[ 0 ], d[ 1 ], one ) ) );
+	result = _mm_sub_pd( result, _mm_mul_pd( one, determinant2( b[ 0 ], b[ 1 ], b[ 2 ], c[ 0 ], c[ 1 ], c[ 2 ], d[ 0 ], d[ 1 ], d[ 2 ] ) ) );
+
+	return result;
+}
+
+
+/**
+ * Determines if the tetrahedron of each of two pairs contains its circumcenter (the same rules as Tetrahedron::contains)
+ * @param first The first pair
+ * @param second The second pair
+ * @return A mask with bit 0 set if the first pair matches and bit 1 set if the second pair matches
+ */
+static inline int contains2( const Pair & first, const Pair & second ) {
+
+	const Tetrahedron & t0 = first.tetrahedron;
+	const Tetrahedron & t1 = second.tetrahedron;
+	const Point3D & p0 = first.circumcenter.point;
+	const Point3D & p1 = second.circumcenter.point;
+
+	__m128d v0[ 3 ] = { _mm_set_pd( t1.v0.x, t0.v0.x ), _mm_set_pd( t1.v0.y, t0.v0.y ), _mm_set_pd( t1.v0.z, t0.v0.z ) };
+	__m128d v1[ 3 ] = { _mm_set_pd( t1.v1.x, t0.v1.x ), _mm_set_pd( t1.v1.y, t0.v1.y ), _mm_set_pd( t1.v1.z, t0.v1.z ) };
+	__m128d v2[ 3 ] = { _mm_set_pd( t1.v2.x, t0.v2.x ), _mm_set_pd( t1.v2.y, t0.v2.y ), _mm_set_pd( t1.v2.z, t0.v2.z ) };
+	__m128d v3[ 3 ] = { _mm_set_pd( t1.v3.x, t0.v3.x ), _mm_set_pd( t1.v3.y, t0.v3.y ), _mm_set_pd( t1.v3.z, t0.v3.z ) };
+	__m128d p[ 3 ] = { _mm_set_pd( p1.x, p0.x ), _mm_set_pd( p1.y, p0.y ), _mm_set_pd( p1.z, p0.z ) };
+	__m128d zero = _mm_setzero_pd();
+
+	__m128d d0 = determinant2( v0, v1, v2, v3 );
+	__m128d d[ 4 ] = {
+		determinant2( p, v1, v2, v3 ),
+		determinant2( v0, p, v2, v3 ),
+		determinant2( v0, v1, p, v3 ),
+		determinant2( v0, v1, v2, p )
+	};
+
+	// Degenerate tetrahedrons never match
+	int result = ~_mm_movemask_pd( _mm_cmpeq_pd( d0, zero ) ) & 3;
+	int onFace = 0;
+	int isZero;
+	int signDiffers;
+
+	// The scalar test stops at the first face the point is on (a match) or the first sign that differs from d0 (a miss)
+	for ( int i = 0; i < 4; ++i ) {
+
+		isZero = _mm_movemask_pd( _mm_cmpeq_pd( d[ i ], zero ) );
+		signDiffers = _mm_movemask_pd( _mm_xor_pd( d0, d[ i ] ) );
+		result &= onFace | isZero | ~signDiffers;
+		onFace |= isZero;
+	}
+
+	return result;
+}
+
+#endif
+
+
+/**
+ * Determines if the given device can be used in this build
+ * @param device The device to check
+ * @return TRUE if the device is available, FALSE otherwise
+ */
+bool relabelDeviceAvailable( RelabelDevice device ) {
+
+	switch ( device ) {
+
+		case RELABEL_CPU:
+
+			return true;
+
+		case RELABEL_CUDA:
+
+			#ifdef USE_CUDA
+			return true;
+			#else
+			return false;
+			#endif
+
+		default:
+
+			return false;
+	}
+}
+
+
+/**
+ * Relabels a list of pairs on the given device (the CPU is used when the device isn't available).
+ * For each pair whose tetrahedron contains its circumcenter, sets results[ circumcenter.index ] to the tetrahedron's type.
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param results The labels, indexed by circumcenter (entries without a containing tetrahedron are left alone)
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ * @param device The device to relabel on
+ * @return The device that did the relabeling
+ */
+RelabelDevice relabel( const Pair * pairs, int * results, int pairsSize, int resultsSize, RelabelDevice device ) {
+
+	#ifdef USE_CUDA
+	if ( device == RELABEL_CUDA ) {
+
+		relabel( pairs, results, pairsSize, resultsSize );
+
+		return RELABEL_CUDA;
+	}
+	#endif
+
+	relabelCPU( pairs, results, pairsSize, resultsSize );
+
+	return RELABEL_CPU;
+}
+
+
+/**
+ * Relabels a list of pairs on the CPU (the same contract as the CUDA relabel kernel).
+ * Pairs are split into blocks across the OpenMP threads, and each block tests two pairs at a time with SSE2 when available.
+ * The labels are written afterwards on one thread, in pair order, so they don't depend on how the blocks were scheduled.
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param results The labels, indexed by circumcenter (entries without a containing tetrahedron are left alone)
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ */
+void relabelCPU( const Pair * pairs, int * results, int pairsSize, int resultsSize ) {
+
+	int numBlocks = ( pairsSize + RELABEL_BLOCK - 1 ) / RELABEL_BLOCK;
+	int block;
+
+	// Pairs in different blocks can share a circumcenter, so the threads only mark the matches
+	vector<char> matched( pairsSize );
+
+	#pragma omp parallel for schedule( static )
+	for ( block = 0; block < numBlocks; ++block ) {
+
+		int i = block * RELABEL_BLOCK;
+		int end = ( i + RELABEL_BLOCK < pairsSize ) ? i + RELABEL_BLOCK : pairsSize;
+
+		#ifdef RELABEL_USE_SSE2
+		for ( ; i + 1 < end; i += 2 ) {
+
+			int matches = contains2( pairs[ i ], pairs[ i + 1 ] );
+			matched[ i ] = ( char ) ( matches & 1 );
+			matched[ i + 1 ] = ( char ) ( ( matches >> 1 ) & 1 );
+		}
+		#endif
+
+		for ( ; i < end; ++i ) {
+
+			matched[ i ] = pairs[ i ].tetrahedron.contains( pairs[ i ].circumcenter.point ) ? 1 : 0;
+		}
+	}
+
+	// Write in pair order so the later pair wins, like the reference
+	for ( int i = 0; i < pairsSize; ++i ) {
+
+		if ( matched[ i ] ) {
+
+			results[ pairs[ i ].circumcenter.index ] = pairs[ i ].tetrahedron.type;
+		}
+	}
+}
+
+
+/**
+ * Relabels a list of pairs one at a time with Tetrahedron::contains (the reference every device is checked against)
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param results The labels, indexed by circumcenter (entries without a containing tetrahedron are left alone)
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ */
+void relabelReference( const Pair * pairs, int * results, int pairsSize, int resultsSize ) {
+
+	for ( int i = 0; i < pairsSize; ++i ) {
+
+		if ( pairs[ i ].tetrahedron.contains( pairs[ i ].circumcenter.point ) ) {
+
+			results[ pairs[ i ].circumcenter.index ] = pairs[ i ].tetrahedron.type;
+		}
+	}
+}
+
+
+/**
+ * Checks a device against the reference relabel (the parity test shared by every device)
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ * @param device The device to check
+ * @param seconds Stores the time the device took
+ * @return The number of labels that differ from the reference
+ */
+int checkRelabelParity( const Pair * pairs, int pairsSize, int resultsSize, RelabelDevice device, double & seconds ) {
+
+	// Zero isn't a material, so it marks circumcenters no pair matched
+	vector<int> expected( resultsSize, 0 );
+	vector<int> results( resultsSize, 0 );
+	CGAL::Timer timer;
+	int mismatches = 0;
+
+	relabelReference( pairs, expected.empty() ? NULL : &expected[ 0 ], pairsSize, resultsSize );
+
+	timer.start();
+	relabel( pairs, results.empty() ? NULL : &results[ 0 ], pairsSize, resultsSize, device );
+	timer.stop();
+	seconds = timer.time();
+
+	for ( int i = 0; i < resultsSize; ++i ) {
+
+		if ( results[ i ] != expected[ i ] ) {
+
+			++mismatches;
+		}
+	}
+
+	return mismatches;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Pair.h"
+
+
+/**
+ * The devices that can relabel a list of pairs
+ */
+enum RelabelDevice { RELABEL_CPU = 0, RELABEL_CUDA = 1 };
+
+
+/**
+ * Determines if the given device can be used in this build
+ * @param device The device to check
+ * @return TRUE if the device is available, FALSE otherwise
+ */
+bool relabelDeviceAvailable( RelabelDevice device );
+
+
+/**
+ * Relabels a list of pairs on the given device (the CPU is used when the device isn't available).
+ * For each pair whose tetrahedron contains its circumcenter, sets results[ circumcenter.index ] to the tetrahedron's type.
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param results The labels, indexed by circumcenter (entries without a containing tetrahedron are left alone)
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ * @param device The device to relabel on
+ * @return The device that did the relabeling
+ */
+RelabelDevice relabel( const Pair * pairs, int * results, int pairsSize, int resultsSize, RelabelDevice device );
+
+
+/**
+ * Relabels a list of pairs on the CPU (the same contract as the CUDA relabel kernel).
+ * Pairs are split into blocks across the OpenMP threads, and each block tests two pairs at a time with SSE2 when available.
+ * The labels are written afterwards on one thread, in pair order, so they don't depend on how the blocks were scheduled.
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param results The labels, indexed by circumcenter (entries without a containing tetrahedron are left alone)
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ */
+void relabelCPU( const Pair * pairs, int * results, int pairsSize, int resultsSize );
+
+
+/**
+ * Relabels a list of pairs one at a time with Tetrahedron::contains (the reference every device is checked against)
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param results The labels, indexed by circumcenter (entries without a containing tetrahedron are left alone)
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ */
+void relabelReference( const Pair * pairs, int * results, int pairsSize, int resultsSize );
+
+
+/**
+ * Checks a device against the reference relabel (the parity test shared by every device)
+ * @param pairs The circumcenter/tetrahedron pairs to check
+ * @param pairsSize The number of pairs
+ * @param resultsSize The number of labels
+ * @param device The device to check
+ * @param seconds Stores the time the device took
+ * @return The number of labels that differ from the reference
+ */
+int checkRelabelParity( const Pair * pairs, int pairsSize, int resultsSize, RelabelDevice device, double & seconds );
@@ -22,6 +22,21 @@ durabilityTool dt;
  */
 durabilityTool lockedDt;
 
+/**
+ * The widget the locked durability widget was last copied from (to detect changes)
+ */
+durabilityTool lockedDtSource;
+
+/**
+ * The noise power the locked durability widget was last evaluated with
+ */
+double lockedDtNoisePower = -1.0;
+
+/**
+ * The sampled locked durability, read by softness() (rebuilt only when the locked widget changes)
+ */
+DurabilityCache softnessCache( uncachedSoftness, uncachedSoftness );
+
 /**
  * The number of result labels
  */
@@ -1060,6 +1075,69 @@ double layer::evaluate( double x, double y, double z, uint32_t seed, bool useGra
 }
 
 
+/**
+ * The number of points layer::evaluate works on at once along a row
+ */
+#define LAYER_ROW_BLOCK 64
+
+
+/**
+ * Evaluates the layer along a row of points that share y and z (the base and y-noise are computed once for the row)
+ * @param x The x-coordinates of the points
+ * @param y The y-coordinate of the row
+ * @param z The z-coordinate of the row
+ * @param result Stores the durability of the layer at each point
+ * @param count The number of points
+ * @param seed The seed value for random number generator (default 0)
+ * @param userGrain Whether or not to use the grain (default TRUE)
+ */
+void layer::evaluate( const double * x, double y, double z, double * result, int count, uint32_t seed, bool useGrain ) const {
+
+	double shared = base.evaluate( y ) * ( 1.0 - fixNoise( perlin1D( y * yNoiseFrequency, 4, seed ) ) * yNoiseAmplitude );
+	int i;
+
+	if ( !useGrain ) {
+
+		for ( i = 0; i < count; ++i ) {
+
+			result[ i ] = shared;
+		}
+
+		return;
+	}
+
+	double gx[ LAYER_ROW_BLOCK ];
+	double gy[ LAYER_ROW_BLOCK ];
+	double gz[ LAYER_ROW_BLOCK ];
+	double grain[ LAYER_ROW_BLOCK ];
+	int start;
+	int n;
+
+	for ( i = 0; i < LAYER_ROW_BLOCK; ++i ) {
+
+		gy[ i ] = y * grainFrequency;
+		gz[ i ] = z * grainFrequency;
+	}
+
+	for ( start = 0; start < count; start += LAYER_ROW_BLOCK ) {
+
+		n = ( count - start < LAYER_ROW_BLOCK ) ? ( count - start ) : LAYER_ROW_BLOCK;
+
+		for ( i = 0; i < n; ++i ) {
+
+			gx[ i ] = x[ start + i ] * grainFrequency;
+		}
+
+		perlin3D( gx, gy, gz, grain, n, 4, seed + 0x005a5a5a );
+
+		for ( i = 0; i < n; ++i ) {
+
+			result[ start + i ] = shared * ( 1.0 - fixNoise( grain[ i ] ) * grainAmplitude );
+		}
+	}
+}
+
+
 // ***** DURABILITY TOOL ***** //
 
 /**
@@ -1460,12 +1538,21 @@ bool durabilityTool::normalize() {
  */
 void updateLockedDurability() {
 
+	// Called every step, so only copy (and throw away the cached samples) when the widget was edited
+	if ( dt == lockedDtSource && getNoisePower() == lockedDtNoisePower ) {
+
+		return;
+	}
+
 	//#pragma omp critical( softnessCopier )
 	//{
 		lockedDt = dt;
 	//}
 
 	lockedDt.normalize();
+	lockedDtSource = dt;
+	lockedDtNoisePower = getNoisePower();
+	softnessCache.invalidate();
 }
 
 
@@ -1478,7 +1565,7 @@ void updateLockedDurability() {
  */
 double softness( double x, double y, double z ) {
 
-	return lockedDt.evaluate( x, y, z );
+	return softnessCache.evaluate( x, y, z );
 }
 
 
@@ -1495,6 +1582,54 @@ double liveSoftness( double x, double y, double z ) {
 }
 
 
+/**
+ * Computes the softness at the given point directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinate of the point
+ * @param y The y-coordinate of the point
+ * @param z The z-coordinate of the point
+ * @return The softness of the object at the given point
+ */
+double uncachedSoftness( double x, double y, double z ) {
+
+	return lockedDt.evaluate( x, y, z );
+}
+
+
+/**
+ * Computes the softness along a row of points that share y and z directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinates of the points
+ * @param y The y-coordinate of the row
+ * @param z The z-coordinate of the row
+ * @param result Stores the softness of the object at each point
+ * @param count The number of points
+ */
+void uncachedSoftness( const double * x, double y, double z, double * result, int count ) {
+
+	lockedDt.evaluate( x, y, z, result, count );
+}
+
+
+/**
+ * Sets the region in which the locked softness is cached
+ * @param minPoint The minimum extent of the object
+ * @param maxPoint The maximum extent of the object
+ */
+void setSoftnessBounds( const double * minPoint, const double * maxPoint ) {
+
+	softnessCache.setBounds( minPoint, maxPoint );
+}
+
+
+/**
+ * Gets the cache that softness() reads from
+ * @return The softness cache
+ */
+DurabilityCache & getSoftnessCache() {
+
+	return softnessCache;
+}
+
+
 // ***** LAYER PANE ***** //
 
 /**
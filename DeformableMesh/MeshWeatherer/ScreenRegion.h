@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Include\IntTypes.h"
+#include "DurabilityCache.h"
 #include "StoneWeatherer.h"
 #include "StepResults.h"
 
@@ -593,6 +594,17 @@ struct piecewiseLinearFunction {
 	 * @return A reference to the function after shrinking
 	 */
 	piecewiseLinearFunction & operator /= ( double s );
+
+
+	/**
+	 * Equality operator
+	 * @param other The function to compare against
+	 * @return TRUE if both functions have the same keys, FALSE otherwise
+	 */
+	inline bool operator == ( const piecewiseLinearFunction & other ) const {
+
+		return keys == other.keys;
+	}
 };
 
 
@@ -913,6 +925,19 @@ struct layer {
 	double evaluate( double x, double y, double z, uint32_t seed = 0, bool useGrain = true ) const;
 
 
+	/**
+	 * Evaluates the layer along a row of points that share y and z (the base and y-noise are computed once for the row)
+	 * @param x The x-coordinates of the points
+	 * @param y The y-coordinate of the row
+	 * @param z The z-coordinate of the row
+	 * @param result Stores the durability of the layer at each point
+	 * @param count The number of points
+	 * @param seed The seed value for random number generator (default 0)
+	 * @param userGrain Whether or not to use the grain (default TRUE)
+	 */
+	void evaluate( const double * x, double y, double z, double * result, int count, uint32_t seed = 0, bool useGrain = true ) const;
+
+
 	//----------
 	// OPERATORS
 	//----------
@@ -941,6 +966,17 @@ struct layer {
 
 		return *this;
 	}
+
+
+	/**
+	 * Equality operator
+	 * @param other The layer to compare against
+	 * @return TRUE if both layers evaluate identically, FALSE otherwise
+	 */
+	inline bool operator == ( const layer & other ) const {
+
+		return base == other.base && yNoiseFrequency == other.yNoiseFrequency && yNoiseAmplitude == other.yNoiseAmplitude && grainFrequency == other.grainFrequency && grainAmplitude == other.grainAmplitude;
+	}
 };
 
 
@@ -1058,6 +1094,24 @@ struct durabilityTool {
 	}
 
 
+	/**
+	 * Evaluates the durability of the object along a row of points that share y and z
+	 * @param x The x-coordinates of the points
+	 * @param y The y-coordinate of the row
+	 * @param z The z-coordinate of the row
+	 * @param result Stores the durability of the object at each point
+	 * @param count The number of points
+	 * @param useGrain Whether or not to use the grain (default TRUE)
+	 */
+	inline void evaluate( const double * x, double y, double z, double * result, int count, bool useGrain = true ) const {
+
+		int temp;
+		const layer * l = layerAt( y, &temp );
+
+		l->evaluate( x, y, z, result, count, temp, useGrain );
+	}
+
+
 	/**
 	 * Draws the durability widget
 	 * @param minY The minimum y-coordinate
@@ -1072,6 +1126,21 @@ struct durabilityTool {
 	 * @return ???
 	 */
 	bool normalize();
+
+
+	//----------
+	// OPERATORS
+	//----------
+
+	/**
+	 * Equality operator
+	 * @param other The durability widget to compare against
+	 * @return TRUE if both widgets have the same splits and layers, FALSE otherwise
+	 */
+	inline bool operator == ( const durabilityTool & other ) const {
+
+		return dividers == other.dividers && layers == other.layers;
+	}
 };
 
 
@@ -1101,6 +1170,42 @@ double softness( double x, double y, double z );
 double liveSoftness( double x, double y, double z );
 
 
+/**
+ * Computes the softness at the given point directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinate of the point
+ * @param y The y-coordinate of the point
+ * @param z The z-coordinate of the point
+ * @return The softness of the object at the given point
+ */
+double uncachedSoftness( double x, double y, double z );
+
+
+/**
+ * Computes the softness along a row of points that share y and z directly from the locked durability widget (bypasses the cache)
+ * @param x The x-coordinates of the points
+ * @param y The y-coordinate of the row
+ * @param z The z-coordinate of the row
+ * @param result Stores the softness of the object at each point
+ * @param count The number of points
+ */
+void uncachedSoftness( const double * x, double y, double z, double * result, int count );
+
+
+/**
+ * Sets the region in which the locked softness is cached
+ * @param minPoint The minimum extent of the object
+ * @param maxPoint The maximum extent of the object
+ */
+void setSoftnessBounds( const double * minPoint, const double * maxPoint );
+
+
+/**
+ * Gets the cache that softness() reads from
+ * @return The softness cache
+ */
+DurabilityCache & getSoftnessCache();
+
+
 /**
  * Pane to hold the durability widget
  */
@@ -5,7 +5,9 @@
 #include <fstream>
 #include <iostream>
 
+#include "LinearOctTree.h"
 #include "MultiOBJReader.h"
+#include "OctTree.h"
 #include "StoneWeatherer.h"
 #include "UniformGrid.h"
 
@@ -29,7 +31,7 @@ CGAL::Random random;
 /**
  * Default constructor
  */
-StoneWeatherer::StoneWeatherer() : newDT( dt + 0 ), oldDT( dt + 1 ), live( trueXYZ ), startsFilled( trueXYZ ), initialPoints() {
+StoneWeatherer::StoneWeatherer() : newDT( dt + 0 ), oldDT( dt + 1 ), live( trueXYZ ), startsFilled( trueXYZ ), initialPoints(), materialGrid( new UniformGrid() ), relabelBackend( UNIFORM_GRID_RELABEL ) {
 
 	return;
 }
@@ -40,6 +42,7 @@ StoneWeatherer::StoneWeatherer() : newDT( dt + 0 ), oldDT( dt + 1 ), live( trueX
  */
 StoneWeatherer::~StoneWeatherer() {
 
+	delete materialGrid;
 	newDT->clear();
 	oldDT->clear();
 }
@@ -137,6 +140,16 @@ void StoneWeatherer::setLiveRegion( bool ( *nlive )( double x, double y, double
 }
 
 
+/**
+ * Sets the structure used to relabel the new mesh each step
+ * @param backend The relabel backend to use
+ */
+void StoneWeatherer::setRelabelBackend( RelabelBackend backend ) {
+
+	relabelBackend = backend;
+}
+
+
 /**
  * Gets the material for the given point
  * @param p The point to get the material for
@@ -190,21 +203,15 @@ void StoneWeatherer::setContentFlags( double midPoint[ 3 ], map<Point,Point> & p
 		cells[ i++ ] = it;
 	}
 
-	UniformGrid grid;
+	// Find where each new cell's circumcenter was before the points moved
+	Point3D * centers = new Point3D[ size ];
+	bool * located = new bool[ size ];
 
-	for ( Cell_iterator it = oldDT->finite_cells_begin(); it != oldDT->finite_cells_end(); ++it ) {
-
-		if ( it->info() > AIR && !oldDT->is_infinite( it ) ) {
-
-			grid.add( it );
-		}
-	}
-
-	grid.partition();
-	
 	#pragma omp parallel for private( circumCenter ) schedule( dynamic )
 	for ( i = 0; i < size; ++i ) {
 
+		located[ i ] = false;
+
 		if ( newDT->is_infinite( cells[ i ] ) ) {
 
 			cells[ i ]->info() = AIR;
@@ -233,18 +240,103 @@ void StoneWeatherer::setContentFlags( double midPoint[ 3 ], map<Point,Point> & p
 			( ( p.z() - p_old.z() ) + ( q.z() - q_old.z() ) + ( r.z() - r_old.z() ) + ( s.z() - s_old.z() ) ) * 0.25
 		);
 
-		circumCenter = Point( circumCenter.x() - avg.x(), circumCenter.y() - avg.y(), circumCenter.z() - avg.z() );
+		centers[ i ] = Point3D( circumCenter.x() - avg.x(), circumCenter.y() - avg.y(), circumCenter.z() - avg.z() );
+		located[ i ] = true;
+	}
 
-		if ( grid.contains( Point3D( circumCenter.x(), circumCenter.y(), circumCenter.z() ) ) ) {
+	// Label each cell with the material of the old tetrahedron containing its circumcenter
+	switch ( relabelBackend ) {
 
-			grid.locateAndLabel( circumCenter, cells[ i ], midPoint, volume );
-		}
-		else {
+		case OCT_TREE_RELABEL: {
 
-			cells[ i ]->info() = AIR;
-		}
+			OctTree tree;
+
+			for ( Cell_iterator it = oldDT->finite_cells_begin(); it != oldDT->finite_cells_end(); ++it ) {
+
+				if ( it->info() > AIR && !oldDT->is_infinite( it ) ) {
+
+					tree.add( it );
+				}
+			}
+
+			for ( i = 0; i < size; ++i ) {
+
+				if ( located[ i ] ) {
+
+					// Circumcenters that aren't in any tetrahedron stay air
+					cells[ i ]->info() = AIR;
+					tree.add( centers[ i ], cells[ i ] );
+				}
+			}
+
+			tree.label( midPoint, volume );
+		} break;
+
+		case LINEAR_OCT_TREE_RELABEL: {
+
+			LinearOctTree tree;
+
+			for ( Cell_iterator it = oldDT->finite_cells_begin(); it != oldDT->finite_cells_end(); ++it ) {
+
+				if ( it->info() > AIR && !oldDT->is_infinite( it ) ) {
+
+					tree.add( it );
+				}
+			}
+
+			tree.build();
+
+			// Only the cells with a circumcenter get labeled
+			int count = 0;
+
+			for ( i = 0; i < size; ++i ) {
+
+				if ( located[ i ] ) {
+
+					centers[ count ] = centers[ i ];
+					cells[ count++ ] = cells[ i ];
+				}
+			}
+
+			tree.label( centers, cells, count, midPoint, volume );
+		} break;
+
+		default: {
+
+			UniformGrid grid;
+
+			for ( Cell_iterator it = oldDT->finite_cells_begin(); it != oldDT->finite_cells_end(); ++it ) {
+
+				if ( it->info() > AIR && !oldDT->is_infinite( it ) ) {
+
+					grid.add( it );
+				}
+			}
+
+			grid.partition();
+
+			#pragma omp parallel for schedule( dynamic )
+			for ( i = 0; i < size; ++i ) {
+
+				if ( !located[ i ] ) {
+
+					continue;
+				}
+
+				if ( grid.contains( centers[ i ] ) ) {
+
+					grid.locateAndLabel( Point( centers[ i ].x, centers[ i ].y, centers[ i ].z ), cells[ i ], midPoint, volume );
+				}
+				else {
+
+					cells[ i ]->info() = AIR;
+				}
+			}
+		} break;
 	}
-	
+
+	delete[] centers;
+	delete[] located;
 	delete[] cells;
 
 	if ( volume > 0.0 ) {
@@ -741,6 +833,7 @@ stepResults StoneWeatherer::doOneCustomStep( double ( *averageEdgeLength )( cons
 
 	// Update vertex information
 	setVertexInfo();
+	rebuildMaterialGrid();
 
 	result.secondsTotal += ( result.secondsAnalysis = timestamp.time() );
 	timestamp.reset();
@@ -953,6 +1046,7 @@ bool StoneWeatherer::setInitialMesh( const char * objFileName ) {
 	cout << "Filled " << rock << " with rock, " << moreRock << " with more rock, " << dirt << " with dirt, and " << air << " with air.\n";
 
 	this->setVertexInfo();
+	this->rebuildMaterialGrid();
 
 	return true;
 }
@@ -999,22 +1093,53 @@ void StoneWeatherer::getTetrahedrons( vector<Tetrahedron> & tetrahedrons ) const
  */
 Contents StoneWeatherer::getMaterialType( const Point & point ) const {
 
-	UniformGrid grid;
+	Point3D p( point.x(), point.y(), point.z() );
 
-	for ( Cell_iterator it = newDT->finite_cells_begin(); it != newDT->finite_cells_end(); ++it ) {
+	if ( materialGrid->contains( p ) ) {
 
-		if ( it->info() > AIR && !newDT->is_infinite( it ) ) {
+		return materialGrid->getLabel( p );
+	}
+	else {
 
-			grid.add( it );
-		}
+		return AIR;
 	}
+}
+
 
-	if ( grid.contains( Point3D( point.x(), point.y(), point.z() ) ) ) {
+/**
+ * Gets the type of material at each of the given points (in parallel).
+ * Safe to call from several threads at once, as long as no step is running.
+ * @param points The points to check
+ * @param results Stores the material type at each point
+ * @param count The number of points
+ */
+void StoneWeatherer::getMaterialTypes( const Point * points, Contents * results, int count ) const {
 
-		return grid.getLabel( point );
+	int i;
+
+	#pragma omp parallel for schedule( static )
+	for ( i = 0; i < count; ++i ) {
+
+		Point3D p( points[ i ].x(), points[ i ].y(), points[ i ].z() );
+		results[ i ] = materialGrid->contains( p ) ? materialGrid->getLabel( p ) : AIR;
 	}
-	else {
+}
 
-		return AIR;
+
+/**
+ * Rebuilds the search structure used to answer material queries from the current mesh
+ */
+void StoneWeatherer::rebuildMaterialGrid() {
+
+	materialGrid->clear();
+
+	for ( Cell_iterator it = newDT->finite_cells_begin(); it != newDT->finite_cells_end(); ++it ) {
+
+		if ( it->info() > AIR && !newDT->is_infinite( it ) ) {
+
+			materialGrid->add( it );
+		}
 	}
+
+	materialGrid->partition();
 }
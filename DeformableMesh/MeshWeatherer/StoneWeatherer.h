@@ -16,6 +16,7 @@ using namespace std;
 
 void saveRocks (int saved); 
 struct Tetrahedron;
+class UniformGrid;
 
 //extern double relabelTime;
 
@@ -52,6 +53,11 @@ public:
 	//enum { NUMBER_OF_SOLID_MATERIAL_TYPES = 2 };
 	enum { NUMBER_OF_SOLID_MATERIAL_TYPES = 3 };
 
+	/**
+	 * The structures that can be used to find which old tetrahedron contains each new circumcenter (relabeling)
+	 */
+	enum RelabelBackend { UNIFORM_GRID_RELABEL = 0, OCT_TREE_RELABEL = 1, LINEAR_OCT_TREE_RELABEL = 2, NUMBER_OF_RELABEL_BACKENDS = 3 };
+
 
 	//------------
 	// MEMBER DATA
@@ -119,6 +125,18 @@ public:
 	vector<Point> initialPoints;
 
 
+	/**
+	 * The search structure over the solid tetrahedrons of the current mesh, used to answer material queries
+	 * (rebuilt once per step rather than once per query)
+	 */
+	UniformGrid * materialGrid;
+
+	/**
+	 * The structure used to relabel the new mesh each step
+	 */
+	RelabelBackend relabelBackend;
+
+
 	//-------------
 	// CONSTRUCTORS
 	//-------------
@@ -159,6 +177,13 @@ public:
 	void setLiveRegion( bool ( *nlive )( double x, double y, double z ) );
 
 
+	/**
+	 * Sets the structure used to relabel the new mesh each step
+	 * @param backend The relabel backend to use
+	 */
+	void setRelabelBackend( RelabelBackend backend );
+
+
 	/**
 	 * Sets the initial inside/outside test and initial points. Uses odd/even crossing rule for insideness.
 	 * @param objFileName The file containing the initial mesh
@@ -189,6 +214,16 @@ public:
 	Contents getMaterialType( const Point & point ) const;
 
 
+	/**
+	 * Gets the type of material at each of the given points (in parallel).
+	 * Safe to call from several threads at once, as long as no step is running.
+	 * @param points The points to check
+	 * @param results Stores the material type at each point
+	 * @param count The number of points
+	 */
+	void getMaterialTypes( const Point * points, Contents * results, int count ) const;
+
+
 	//----------------
 	// MAIN SIMULATION
 	//----------------
@@ -265,6 +300,12 @@ public:
 	 * Sets the new vertex info for the vertices in the new mesh
 	 */
 	void setVertexInfo();
+
+
+	/**
+	 * Rebuilds the search structure used to answer material queries from the current mesh
+	 */
+	void rebuildMaterialGrid();
 };
 
 
@@ -11,7 +11,7 @@
 /**
  * Default constructor
  */
-Tetrahedron::Tetrahedron() : v0(), v1(), v2(), v3(), cell(), box( 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 ), _volume( 0.0 ) {
+Tetrahedron::Tetrahedron() : v0(), v1(), v2(), v3(), cell(), box( 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 ), _volume( 0.0 ), type( AIR ) {
 
 	return;
 }
@@ -25,7 +25,7 @@ Tetrahedron::Tetrahedron() : v0(), v1(), v2(), v3(), cell(), box( 0.0, 0.0, 0.0,
  * @param v2 The first vertex of the tetrahedron
  * @param type The material type
  */
-Tetrahedron::Tetrahedron( const Point3D & v0, const Point3D & v1, const Point3D & v2, const Point3D & v3, Cell_handle & cell ) : v0( v0 ), v1( v1 ), v2( v2 ), v3( v3 ), cell( cell ), box( MIN( MIN( v0.x, v1.x ), MIN( v2.x, v3.x ) ),  MIN( MIN( v0.y, v1.y ), MIN( v2.y, v3.y ) ),  MIN( MIN( v0.z, v1.z ), MIN( v2.z, v3.z ) ),  MAX( MAX( v0.x, v1.x ), MAX( v2.x, v3.x ) ), MAX( MAX( v0.y, v1.y ), MAX( v2.y, v3.y ) ), MAX( MAX( v0.z, v1.z ), MAX( v2.z, v3.z ) ) ) {
+Tetrahedron::Tetrahedron( const Point3D & v0, const Point3D & v1, const Point3D & v2, const Point3D & v3, Cell_handle & cell ) : v0( v0 ), v1( v1 ), v2( v2 ), v3( v3 ), cell( cell ), box( MIN( MIN( v0.x, v1.x ), MIN( v2.x, v3.x ) ),  MIN( MIN( v0.y, v1.y ), MIN( v2.y, v3.y ) ),  MIN( MIN( v0.z, v1.z ), MIN( v2.z, v3.z ) ),  MAX( MAX( v0.x, v1.x ), MAX( v2.x, v3.x ) ), MAX( MAX( v0.y, v1.y ), MAX( v2.y, v3.y ) ), MAX( MAX( v0.z, v1.z ), MAX( v2.z, v3.z ) ) ), type( cell->info() ) {
 
 	_volume = MACRO_ABS( determinant(
 		v0.x, v0.y, v0.z, 1.0,
@@ -40,7 +40,7 @@ Tetrahedron::Tetrahedron( const Point3D & v0, const Point3D & v1, const Point3D
  * Copy constructor
  * @param other The tetrahedron to copy
  */
-Tetrahedron::Tetrahedron( const Tetrahedron & other ) : v0( other.v0 ), v1( other.v1 ), v2( other.v2 ), v3( other.v3 ), cell( cell ), box( other.box ) {
+Tetrahedron::Tetrahedron( const Tetrahedron & other ) : v0( other.v0 ), v1( other.v1 ), v2( other.v2 ), v3( other.v3 ), cell( other.cell ), box( other.box ), type( other.type ) {
 
 	_volume = other._volume;
 }
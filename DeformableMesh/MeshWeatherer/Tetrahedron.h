@@ -51,6 +51,11 @@ struct Tetrahedron {
 	 */
 	double _volume;
 
+	/**
+	 * The material type of the cell when the tetrahedron was made (so relabeling doesn't need the cell)
+	 */
+	int type;
+
 
 	//------------
 	// CONSTRUCTOR
@@ -24,17 +24,7 @@ UniformGrid::UniformGrid() : tetrahedrons(), grid( NULL ), L( NULL ), xmin( nume
  */
 UniformGrid::~UniformGrid() {
 
-	tetrahedrons.clear();
-
-	if ( grid ) {
-
-		delete[] grid;
-	}
-
-	if ( L ) {
-
-		delete[] L;
-	}
+	clear();
 }
 
 
@@ -68,18 +58,67 @@ void UniformGrid::add( Cell_handle cell ) {
 }
 
 
+/**
+ * Removes every tetrahedron and resets the grid so it can be refilled
+ */
+void UniformGrid::clear() {
+
+	for ( unsigned int i = 0; i < tetrahedrons.size(); ++i ) {
+
+		delete tetrahedrons[ i ];
+	}
+
+	tetrahedrons.clear();
+
+	if ( grid ) {
+
+		delete[] grid;
+		grid = NULL;
+	}
+
+	if ( L ) {
+
+		delete[] L;
+		L = NULL;
+	}
+
+	xmin = numeric_limits<double>::infinity();
+	ymin = numeric_limits<double>::infinity();
+	zmin = numeric_limits<double>::infinity();
+	xmax = -numeric_limits<double>::infinity();
+	ymax = -numeric_limits<double>::infinity();
+	zmax = -numeric_limits<double>::infinity();
+	Mx = 0;
+	My = 0;
+	Mz = 0;
+	inv_Xsize = 0.0;
+	inv_Ysize = 0.0;
+	inv_Zsize = 0.0;
+}
+
+
 /**
  * Tells the grid that all the tetrahedrons are added, and it's OK to go ahead and divide up the space
  */
 void UniformGrid::partition() {
 
+	if ( tetrahedrons.empty() ) {
+
+		// Nothing to partition, and contains() is FALSE for every point
+		return;
+	}
+
 	// Expand the bounds slightly so we don't hit exactly on the edge of the bounding volume
-	xmin *= 1.01;
-	ymin *= 1.01;
-	zmin *= 1.01;
-	xmax *= 1.01;
-	ymax *= 1.01;
-	zmax *= 1.01;
+	// (by a fraction of the extent, since scaling the coordinates shrinks the box on any side with a positive coordinate)
+	double xpad = ( xmax - xmin ) * 0.01;
+	double ypad = ( ymax - ymin ) * 0.01;
+	double zpad = ( zmax - zmin ) * 0.01;
+	xmin -= xpad;
+	ymin -= ypad;
+	zmin -= zpad;
+	xmax += xpad;
+	ymax += ypad;
+	zmax += zpad;
 
 	if ( grid ) {
 
@@ -104,6 +143,11 @@ void UniformGrid::partition() {
 	My = ( unsigned int ) ( sy * scale );
 	Mz = ( unsigned int ) ( sz * scale );
 
+	// A thin or sparse region still needs at least one cell along each axis
+	Mx = Mx ? Mx : 1;
+	My = My ? My : 1;
+	Mz = Mz ? Mz : 1;
+
 	inv_Xsize = Mx / sx;
 	inv_Ysize = My / sy;
 	inv_Zsize = Mz / sz;
@@ -241,11 +285,26 @@ void UniformGrid::locateAndLabel( const Point & point, Cell_handle & cell, doubl
  */
 Contents UniformGrid::getLabel( const Point & point ) const {
 
-	Point3D p( point.x(), point.y(), point.z() );
+	return getLabel( Point3D( point.x(), point.y(), point.z() ) );
+}
+
+
+/**
+ * Finds the label (material type) for the given point
+ * @param p The point to check
+ * @return The label (material type) for the given point
+ */
+Contents UniformGrid::getLabel( const Point3D & p ) const {
+
 	unsigned int x = ( unsigned int ) ( ( p.x - xmin ) * inv_Xsize );
 	unsigned int y = ( unsigned int ) ( ( p.y - ymin ) * inv_Ysize );
 	unsigned int z = ( unsigned int ) ( ( p.z - zmin ) * inv_Zsize );
 
+	// Points exactly on the maximum face belong to the last cell
+	x = ( x < Mx ) ? x : Mx - 1;
+	y = ( y < My ) ? y : My - 1;
+	z = ( z < Mz ) ? z : Mz - 1;
+
 	unsigned int i = ( ( ( My * z ) + y ) * Mx ) + x;
 	unsigned int start = grid[ i ];
 	unsigned int end = grid[ i + 1 ];
@@ -254,9 +313,34 @@ Contents UniformGrid::getLabel( const Point & point ) const {
 
 		if ( tetrahedrons[ L[ i ] ]->contains( p ) ) {
 
-			return tetrahedrons[ L[ i ] ]->cell->info();;
+			return tetrahedrons[ L[ i ] ]->cell->info();
 		}
 	}
 
 	return AIR;
 }
+
+
+/**
+ * Gets the tetrahedrons stored in the grid cell containing the given point (the ones that might contain it)
+ * @param p The point to check (must be in the grid)
+ * @param candidates Stores the tetrahedrons
+ */
+void UniformGrid::getCandidates( const Point3D & p, vector<const Tetrahedron*> & candidates ) const {
+
+	unsigned int x = ( unsigned int ) ( ( p.x - xmin ) * inv_Xsize );
+	unsigned int y = ( unsigned int ) ( ( p.y - ymin ) * inv_Ysize );
+	unsigned int z = ( unsigned int ) ( ( p.z - zmin ) * inv_Zsize );
+
+	// Points exactly on the maximum face belong to the last cell
+	x = ( x < Mx ) ? x : Mx - 1;
+	y = ( y < My ) ? y : My - 1;
+	z = ( z < Mz ) ? z : Mz - 1;
+
+	unsigned int i = ( ( ( My * z ) + y ) * Mx ) + x;
+
+	for ( unsigned int j = grid[ i ]; j < grid[ i + 1 ]; ++j ) {
+
+		candidates.push_back( tetrahedrons[ L[ j ] ] );
+	}
+}
@@ -102,6 +102,12 @@ public:
 	void add( Cell_handle cell );
 
 
+	/**
+	 * Removes every tetrahedron and resets the grid so it can be refilled
+	 */
+	void clear();
+
+
 	/**
 	 * Tells the grid that all the tetrahedrons are added, and it's OK to go ahead and divide up the space
 	 */
@@ -132,4 +138,20 @@ public:
 	 * @return The label (material type) for the given point
 	 */
 	Contents getLabel( const Point & point ) const;
+
+
+	/**
+	 * Finds the label (material type) for the given point
+	 * @param point The point to check
+	 * @return The label (material type) for the given point
+	 */
+	Contents getLabel( const Point3D & point ) const;
+
+
+	/**
+	 * Gets the tetrahedrons stored in the grid cell containing the given point (the ones that might contain it)
+	 * @param point The point to check (must be in the grid)
+	 * @param candidates Stores the tetrahedrons
+	 */
+	void getCandidates( const Point3D & point, vector<const Tetrahedron*> & candidates ) const;
 };
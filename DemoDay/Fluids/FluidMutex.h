@@ -0,0 +1,34 @@
+#pragma once
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// A lock shared by a fluid's worker thread and the threads that query it (the renderer and the haptics)
+class FluidMutex {
+private:
+#if defined(_WIN32)
+	CRITICAL_SECTION section;
+#else
+	pthread_mutex_t mutex;
+#endif
+
+	// Not copyable
+	FluidMutex(const FluidMutex&);
+	FluidMutex& operator=(const FluidMutex&);
+
+public:
+#if defined(_WIN32)
+	FluidMutex(void) { InitializeCriticalSection(&section); }
+	~FluidMutex(void) { DeleteCriticalSection(&section); }
+	void Lock(void) { EnterCriticalSection(&section); }
+	void Unlock(void) { LeaveCriticalSection(&section); }
+#else
+	FluidMutex(void) { pthread_mutex_init(&mutex, 0); }
+	~FluidMutex(void) { pthread_mutex_destroy(&mutex); }
+	void Lock(void) { pthread_mutex_lock(&mutex); }
+	void Unlock(void) { pthread_mutex_unlock(&mutex); }
+#endif
+};
\ No newline at end of file
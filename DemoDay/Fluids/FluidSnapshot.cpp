@@ -0,0 +1,120 @@
+#include <math.h>
+
+#include "FluidSnapshot.h"
+
+FluidSnapshot::FluidSnapshot(void) : cellSize(1), time(0), maxSpeed(0) {
+	gridRes[0] = gridRes[1] = gridRes[2] = 1;
+	cellStart.assign(2, 0);
+}
+
+int FluidSnapshot::GetCell(const cVector3d& position, int axis) const {
+	int cell = (int) floor((position[axis] - gridMin[axis]) / cellSize);
+	if (cell < 0) { return 0; }
+	if (cell >= gridRes[axis]) { return gridRes[axis] - 1; }
+	return cell;
+}
+
+int FluidSnapshot::GetCellIndex(const cVector3d& position) const {
+	return (GetCell(position, 2) * gridRes[1] + GetCell(position, 1)) * gridRes[0] + GetCell(position, 0);
+}
+
+void FluidSnapshot::BuildGrid(double minCellSize) {
+	int count = positions.size();
+
+	// Fit the grid to the particles
+	cVector3d gridMax(0, 0, 0);
+	gridMin.zero();
+	if (count > 0) {
+		gridMin = gridMax = positions[0];
+	}
+	for (int i = 1; i < count; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			if (positions[i][axis] < gridMin[axis]) { gridMin[axis] = positions[i][axis]; }
+			if (positions[i][axis] > gridMax[axis]) { gridMax[axis] = positions[i][axis]; }
+		}
+	}
+
+	cVector3d extent = gridMax - gridMin;
+	cellSize = (minCellSize > 0) ? minCellSize : 1;
+	for (int axis = 0; axis < 3; axis++) {
+		if (extent[axis] / cellSize > FLUID_SNAPSHOT_MAX_GRID_RES) {
+			cellSize = extent[axis] / FLUID_SNAPSHOT_MAX_GRID_RES;
+		}
+	}
+	for (int axis = 0; axis < 3; axis++) {
+		gridRes[axis] = (int) ceil(extent[axis] / cellSize);
+		if (gridRes[axis] < 1) {
+			gridRes[axis] = 1;
+		}
+	}
+
+	// Count the particles in each cell
+	cellParticles.resize(count);
+	cellStart.assign(gridRes[0] * gridRes[1] * gridRes[2] + 1, 0);
+	for (int i = 0; i < count; i++) {
+		cellStart[GetCellIndex(positions[i]) + 1]++;
+	}
+
+	// Counting sort the particles by cell
+	for (unsigned int c = 1; c < cellStart.size(); c++) {
+		cellStart[c] += cellStart[c - 1];
+	}
+	for (int i = 0; i < count; i++) {
+		// cellStart[cell] is used as the insertion point, so it ends up where cell + 1 started
+		cellParticles[cellStart[GetCellIndex(positions[i])]++] = i;
+	}
+	for (int c = (int) cellStart.size() - 1; c > 0; c--) {
+		cellStart[c] = cellStart[c - 1];
+	}
+	cellStart[0] = 0;
+}
+
+void FluidSnapshot::ComputeSpeedStats(void) {
+	int count = positions.size();
+	speedStats.Compute(count ? &positions[0] : 0, count ? &velocities[0] : 0, count);
+}
+
+void FluidSnapshot::GetVelocityAt(cVector3d& velocity, const cVector3d& location, double radius) const {
+	double radius2 = radius * radius;
+	double totalWeight = 0;
+	cVector3d sum(0, 0, 0);
+
+	int low[3], high[3];
+	for (int axis = 0; axis < 3; axis++) {
+		low[axis] = GetCell(location - cVector3d(radius, radius, radius), axis);
+		high[axis] = GetCell(location + cVector3d(radius, radius, radius), axis);
+	}
+
+	for (int z = low[2]; z <= high[2]; z++) {
+		for (int y = low[1]; y <= high[1]; y++) {
+			for (int x = low[0]; x <= high[0]; x++) {
+				int cell = (z * gridRes[1] + y) * gridRes[0] + x;
+				for (int n = cellStart[cell]; n < cellStart[cell + 1]; n++) {
+					int i = cellParticles[n];
+					double distance2 = cDistanceSq(positions[i], location);
+					if (distance2 >= radius2) {
+						continue;
+					}
+
+					// Poly6-shaped weight: 1 at the sample point, falling smoothly to 0 at the radius
+					double falloff = 1.0 - distance2 / radius2;
+					double weight = falloff * falloff * falloff;
+					sum += weight * velocities[i];
+					totalWeight += weight;
+				}
+			}
+		}
+	}
+
+	if (totalWeight > 0) {
+		sum.mul(1.0 / totalWeight);
+	}
+	velocity.copyfrom(sum);
+}
+
+void FluidSnapshot::GetFrame(FluidFrame& frame, unsigned int version) const {
+	frame.count = positions.size();
+	frame.positions = frame.count ? &positions[0] : 0;
+	frame.velocities = frame.count ? &velocities[0] : 0;
+	frame.version = version;
+}
\ No newline at end of file
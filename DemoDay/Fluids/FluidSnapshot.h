@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "chai3d.h"
+
+#include "IFluid.h"
+#include "FluidSpeedStats.h"
+
+// The most grid cells along each axis of a snapshot's velocity lookup grid
+#define FLUID_SNAPSHOT_MAX_GRID_RES 32
+
+// One frame of a fluid's live particles, in world coordinates, with a grid for velocity lookups.
+// Fill in the positions and velocities, then call BuildGrid before querying it.
+class FluidSnapshot {
+protected:
+	// The lookup grid covers the particles' bounding box
+	cVector3d gridMin;
+	double cellSize;
+	int gridRes[3];
+	// The particles grouped by grid cell: cell c holds cellParticles[cellStart[c]] to cellParticles[cellStart[c + 1] - 1]
+	std::vector<int> cellStart;
+	std::vector<int> cellParticles;
+
+	// Finds the grid cell along 'axis' that holds 'position' (positions outside the grid land in the border cells)
+	int GetCell(const cVector3d& position, int axis) const;
+	// Finds the index of the grid cell that holds 'position'
+	int GetCellIndex(const cVector3d& position) const;
+
+public:
+	std::vector<cVector3d> positions;
+	std::vector<cVector3d> velocities;
+	// The time of the frame, in seconds
+	double time;
+	// The fastest speed a particle has reached (kept by whoever fills the snapshot)
+	double maxSpeed;
+	// The speeds of this snapshot's particles (filled in by ComputeSpeedStats)
+	FluidSpeedStats speedStats;
+
+	FluidSnapshot(void);
+
+	// Computes speedStats from the particles
+	void ComputeSpeedStats(void);
+	// Sorts the particles into grid cells of at least 'minCellSize' (cells grow if the grid would be too fine)
+	void BuildGrid(double minCellSize);
+	// Finds the velocity at 'location' (a poly6-weighted average of the particles closer than 'radius')
+	void GetVelocityAt(cVector3d& velocity, const cVector3d& location, double radius) const;
+	// Points 'frame' at the snapshot's particles
+	void GetFrame(FluidFrame& frame, unsigned int version) const;
+	// Returns the number of particles in the snapshot
+	int GetCount(void) const { return (int) positions.size(); }
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#include "FluidSpeedStats.h"
+
+// Returns the speed that 'fraction' of 'speeds' are at or under (reorders 'speeds')
+static double GetPercentile(std::vector<double>& speeds, double fraction) {
+	int index = (int) (fraction * (speeds.size() - 1) + 0.5);
+	std::nth_element(speeds.begin(), speeds.begin() + index, speeds.end());
+	return speeds[index];
+}
+
+void FluidSpeedStats::Compute(const cVector3d* positions, const cVector3d* velocities, int count) {
+	if (count <= 0) {
+		SetUniform(0);
+		return;
+	}
+	this->count = count;
+
+	// Fit the field to the particles
+	cVector3d fieldMax = positions[0];
+	fieldMin = positions[0];
+	for (int i = 1; i < count; i++) {
+		for (int axis = 0; axis < 3; axis++) {
+			if (positions[i][axis] < fieldMin[axis]) { fieldMin[axis] = positions[i][axis]; }
+			if (positions[i][axis] > fieldMax[axis]) { fieldMax[axis] = positions[i][axis]; }
+		}
+	}
+	for (int axis = 0; axis < 3; axis++) {
+		fieldCellSize[axis] = (fieldMax[axis] - fieldMin[axis]) / FLUID_SPEED_FIELD_RES;
+	}
+	for (int c = 0; c < FLUID_SPEED_FIELD_RES * FLUID_SPEED_FIELD_RES * FLUID_SPEED_FIELD_RES; c++) {
+		fieldMaxSpeed[c] = 0;
+	}
+
+	std::vector<double> speeds(count);
+	maxSpeed = 0;
+	for (int i = 0; i < count; i++) {
+		speeds[i] = velocities[i].length();
+		if (speeds[i] > maxSpeed) {
+			maxSpeed = speeds[i];
+		}
+
+		int cell[3];
+		for (int axis = 0; axis < 3; axis++) {
+			cell[axis] = (fieldCellSize[axis] > 0) ? (int) ((positions[i][axis] - fieldMin[axis]) / fieldCellSize[axis]) : 0;
+			if (cell[axis] < 0) { cell[axis] = 0; }
+			if (cell[axis] >= FLUID_SPEED_FIELD_RES) { cell[axis] = FLUID_SPEED_FIELD_RES - 1; }
+		}
+		float& cellSpeed = fieldMaxSpeed[(cell[2] * FLUID_SPEED_FIELD_RES + cell[1]) * FLUID_SPEED_FIELD_RES + cell[0]];
+		if (speeds[i] > cellSpeed) {
+			cellSpeed = (float) speeds[i];
+		}
+	}
+
+	medianSpeed = GetPercentile(speeds, 0.5);
+	p90Speed = GetPercentile(speeds, 0.9);
+	p99Speed = GetPercentile(speeds, 0.99);
+}
+
+void FluidSpeedStats::SetUniform(double speed) {
+	count = 0;
+	maxSpeed = medianSpeed = p90Speed = p99Speed = speed;
+	fieldMin.zero();
+	fieldCellSize.zero();
+	for (int c = 0; c < FLUID_SPEED_FIELD_RES * FLUID_SPEED_FIELD_RES * FLUID_SPEED_FIELD_RES; c++) {
+		fieldMaxSpeed[c] = (float) speed;
+	}
+}
+
+double FluidSpeedStats::GetFieldSpeedAt(const cVector3d& location) const {
+	int cell[3];
+	for (int axis = 0; axis < 3; axis++) {
+		cell[axis] = (fieldCellSize[axis] > 0) ? (int) floor((location[axis] - fieldMin[axis]) / fieldCellSize[axis]) : 0;
+		if (cell[axis] < 0) { cell[axis] = 0; }
+		if (cell[axis] >= FLUID_SPEED_FIELD_RES) { cell[axis] = FLUID_SPEED_FIELD_RES - 1; }
+	}
+	return fieldMaxSpeed[(cell[2] * FLUID_SPEED_FIELD_RES + cell[1]) * FLUID_SPEED_FIELD_RES + cell[0]];
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "chai3d.h"
+
+// The coarse speed field has this many cells along each axis
+#define FLUID_SPEED_FIELD_RES 4
+// Speeds that forces are normalized against never go below this, so callers can divide by them
+#define FLUID_MIN_REFERENCE_SPEED 0.001
+
+// Speed statistics of one frame of a fluid, computed when the frame is loaded or advanced
+//  so the haptics thread only has to copy them
+struct FluidSpeedStats {
+	int count;
+	double maxSpeed;
+	double medianSpeed;
+	double p90Speed;
+	double p99Speed;
+
+	// The fastest particle in each cell of a coarse grid over the particles' bounding box
+	cVector3d fieldMin;
+	cVector3d fieldCellSize;
+	float fieldMaxSpeed[FLUID_SPEED_FIELD_RES * FLUID_SPEED_FIELD_RES * FLUID_SPEED_FIELD_RES];
+
+	FluidSpeedStats(void) { SetUniform(0); }
+
+	// Computes the statistics of 'count' particles
+	void Compute(const cVector3d* positions, const cVector3d* velocities, int count);
+	// Describes a fluid that moves at 'speed' everywhere (for fluids without particles)
+	void SetUniform(double speed);
+	// Returns the fastest speed in the field cell around 'location' (locations outside the field use the nearest cell)
+	double GetFieldSpeedAt(const cVector3d& location) const;
+};
\ No newline at end of file
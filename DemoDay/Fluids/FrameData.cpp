@@ -50,6 +50,17 @@ FrameData::FrameData(int totalPartCount, int livePartCount, map<int, GEOParticle
 	qsort(xSortedPartIDs, livePartCount, sizeof(GEOParticleSortData), comparePartSortData);
 	qsort(ySortedPartIDs, livePartCount, sizeof(GEOParticleSortData), comparePartSortData);
 	qsort(zSortedPartIDs, livePartCount, sizeof(GEOParticleSortData), comparePartSortData);
+
+	// Pack the live particles so they can be read without going through GEOParticle
+	livePositions.resize(livePartCount);
+	liveVelocities.resize(livePartCount);
+	liveIndexByID.assign(totalPartCount + 1, -1);
+	for (int i = 0; i < livePartCount; i++) {
+		int curID = xSortedPartIDs[i].id;
+		particleList[curID]->GetPosition(livePositions[i]);
+		particleList[curID]->GetVelocity(liveVelocities[i]);
+		liveIndexByID[curID] = i;
+	}
 }
 
 FrameData::FrameData(void) : _totalPartCount(-1), _livePartCount(-1) {
@@ -21,6 +21,7 @@ int comparePartSortData(const void* first, const void* second);
 class FrameData {
 	friend class GEOFileFluid;
 	friend class TreeLoader;
+	friend class StreamingGEOFluid;
 private:
 	// The total number of particles in the simulation
 	int _totalPartCount;
@@ -35,6 +36,12 @@ private:
 	GEOParticleSortData* ySortedPartIDs;
 	GEOParticleSortData* zSortedPartIDs;
 
+	// The live particles' positions and velocities, packed in the same order as xSortedPartIDs.
+	vector<cVector3d> livePositions;
+	vector<cVector3d> liveVelocities;
+	// Maps a particle ID to its index in the packed arrays (-1 if the particle is dead)
+	vector<int> liveIndexByID;
+
 	// Finds all IDs that have a sort value between startVal and endVal
 	std::set<int> GetIDsInRange(const GEOParticleSortData* list, const double startVal, const double endVal);
 
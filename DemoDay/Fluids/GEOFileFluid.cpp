@@ -2,11 +2,12 @@
 #include "FrameDataParser.h"
 
 GEOFileFluid::GEOFileFluid(const string& baseFileName, int startFrame, int endFrame) : 
-	frameCount(endFrame - startFrame + 1), currentFrame(0), maxSimParticles(0)
+	frameCount(endFrame - startFrame + 1), currentFrame(0), maxSimParticles(0), maxSpeed(0), frameVersion(0)
 {
 	printf("Loading .geo files\n");
 
 	frames = new FrameData*[frameCount];
+	frameStats = new FluidSpeedStats[frameCount];
 	double incrementPercent = 1.0 / frameCount;
 	double percent = 0;
 	for (int i = startFrame; i <= endFrame; i++) {
@@ -20,6 +21,13 @@ GEOFileFluid::GEOFileFluid(const string& baseFileName, int startFrame, int endFr
 			maxSimParticles = curActiveParticles; 
 		}
 
+		FluidSpeedStats& stats = frameStats[i - startFrame];
+		stats.Compute(curActiveParticles ? &currentFrame->livePositions[0] : 0,
+			curActiveParticles ? &currentFrame->liveVelocities[0] : 0, curActiveParticles);
+		if (maxSpeed < stats.maxSpeed) {
+			maxSpeed = stats.maxSpeed;
+		}
+
 		// Just for display
 		percent += incrementPercent;
 		if (percent > 0.05) {
@@ -38,6 +46,7 @@ GEOFileFluid::~GEOFileFluid(void) {
 	}
 
 	delete[] frames;
+	delete[] frameStats;
 }
 
 void GEOFileFluid::GetFullPointList(std::vector<IFluidParticle*>& destination) {
@@ -47,29 +56,33 @@ void GEOFileFluid::GetFullPointList(std::vector<IFluidParticle*>& destination) {
 void GEOFileFluid::GetAllPoints(std::vector<IFluidParticle*>& destination) {
 	FrameData* frame = frames[currentFrame];
 	GEOParticleSortData* liveParticleList = frame->xSortedPartIDs;
-	destination = std::vector<IFluidParticle*>(frame->_livePartCount, 0);
+	destination.resize(frame->_livePartCount);
 	for (int i = 0; i < frame->_livePartCount; i++) {
 		int index = liveParticleList[i].id;
 		destination[i] = frame->particleList[index];
 	}
 }
 
+void GEOFileFluid::GetFrame(FluidFrame& frame) {
+	FrameData* data = frames[currentFrame];
+	frame.count = data->_livePartCount;
+	frame.positions = frame.count ? &data->livePositions[0] : 0;
+	frame.velocities = frame.count ? &data->liveVelocities[0] : 0;
+	frame.version = frameVersion;
+}
+
 int GEOFileFluid::GetCurrentPointCount(void) {
 	return frames[currentFrame]->_livePartCount;
 }
 
 void GEOFileFluid::GetVelocityAt(cVector3d& velocity, const cVector3d& location) {
-	printf("asking for velocity\n");
 	FrameData* currentData = frames[currentFrame];
 	std::set<int> ids = currentData->GetIDsInNeighborhood(NEIGHBORHOOD_SIZE, location);
-	GEOParticle* currentParticle;
 	cVector3d averageSum;
 	for (std::set<int>::iterator partIter = ids.begin(); partIter != ids.end(); partIter++) {
-		currentParticle = currentData->GetParticleByID(*partIter);
-		cVector3d currentVelocity, currentPosition;
-		currentParticle->GetPosition(currentPosition);
-		currentPosition -= location;
-		currentParticle->GetVelocity(currentVelocity);
+		int liveIndex = currentData->liveIndexByID[*partIter];
+		cVector3d currentPosition = currentData->livePositions[liveIndex] - location;
+		const cVector3d& currentVelocity = currentData->liveVelocities[liveIndex];
 
 		double weight = 1.0 / pow(currentPosition.length(), 3);
 		averageSum += weight * currentVelocity;
@@ -80,8 +93,11 @@ void GEOFileFluid::GetVelocityAt(cVector3d& velocity, const cVector3d& location)
 }
 
 double GEOFileFluid::GetMaxParticleSpeed(void) {
-	//TODO: Decide if it's worth looking through the data and calculating the actual fastest speed that a particle achieves
-	return 20;
+	return (maxSpeed > FLUID_MIN_REFERENCE_SPEED) ? maxSpeed : FLUID_MIN_REFERENCE_SPEED;
+}
+
+void GEOFileFluid::GetSpeedStats(FluidSpeedStats& stats) {
+	stats = frameStats[currentFrame];
 }
 
 int GEOFileFluid::GetMaxSimulatedParticles() {
@@ -91,4 +107,5 @@ int GEOFileFluid::GetMaxSimulatedParticles() {
 void GEOFileFluid::AdvanceFrame(void) { 
 	currentFrame++; 
 	currentFrame %= frameCount;
+	frameVersion++;
 }
\ No newline at end of file
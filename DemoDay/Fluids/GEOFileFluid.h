@@ -15,10 +15,14 @@
 class GEOFileFluid : public SPHFluid {
 protected:
 	FrameData** frames;
+	// The speed statistics of each frame, computed as the frames are loaded
+	FluidSpeedStats* frameStats;
 	
 	int frameCount;
 	int currentFrame;
 	int maxSimParticles;
+	double maxSpeed;
+	unsigned int frameVersion;
 
 public:
 	// Creates a GEOFileFluid by loading in a set of .geo files with the 
@@ -30,6 +34,8 @@ public:
 
 	// Finds all the live points in the fluid simulation and copies them into the list 'destination'
 	virtual void GetAllPoints(std::vector<IFluidParticle*>& destination);
+	// Points 'frame' at the current frame's packed particle data
+	virtual void GetFrame(FluidFrame& frame);
 	// Finds all the points in the fluid simulation and copies them into the list 'destination'
 	// If the particle is dead, the vector will contain a null pointer.
 	virtual void GetFullPointList(std::vector<IFluidParticle*>& destination);
@@ -37,8 +43,10 @@ public:
 	virtual int GetCurrentPointCount(void);
 	// Finds the velocity of the fluid at the given point and copies it into 'velocity'
 	virtual void GetVelocityAt(cVector3d& velocity, const cVector3d& location);
-	// Returns the fastest possible speed of a particle
+	// Returns the fastest speed a particle reaches in any of the frames
 	virtual double GetMaxParticleSpeed(void);
+	// Copies the speed statistics of the current frame
+	virtual void GetSpeedStats(FluidSpeedStats& stats);
 	// Max number of particles being simulated at any given time
 	virtual int GetMaxSimulatedParticles();
 	// Advances the fluid simulation one frame
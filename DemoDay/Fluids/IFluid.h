@@ -5,8 +5,18 @@
 #include "chai3d.h"
 
 #include "IFluidParticle.h"
+#include "FluidSpeedStats.h"
 
-#define MAX_NUMBER_OF_PARTICLES 1000
+// A read-only view of the live particles in a fluid's current frame.
+// positions[i] and velocities[i] belong to the same particle. The arrays are
+// owned by the fluid and stay valid until its next AdvanceFrame.
+struct FluidFrame {
+	const cVector3d* positions;
+	const cVector3d* velocities;
+	int count;
+	// Changes every time the fluid moves to a new frame
+	unsigned int version;
+};
 
 class IFluid {
 
@@ -15,12 +25,16 @@ public:
 
 	// Finds all the points in the fluid simulation and copies them into the list 'allParticles'
 	virtual void GetAllPoints(vector<IFluidParticle*>& allParticles) = 0;
+	// Points 'frame' at the current frame's particle data (nothing is copied)
+	virtual void GetFrame(FluidFrame& frame) = 0;
 	// Returns the number of particles in the simulation's current frame
 	virtual int GetCurrentPointCount(void) = 0;
 	// Finds the velocity of the fluid at the given point and copies it into 'velocity'
 	virtual void GetVelocityAt(cVector3d& velocity, const cVector3d& location) = 0;
 	// Returns the fastest possible speed of a particle
 	virtual double GetMaxParticleSpeed(void) = 0;
+	// Copies the speed statistics of the current frame into 'stats' (cheap enough to call every haptic tick)
+	virtual void GetSpeedStats(FluidSpeedStats& stats) = 0;
 	// Advances the fluid simulation one frame
 	virtual void AdvanceFrame(void) = 0;
 	// Max number of particles being simulated at any given time
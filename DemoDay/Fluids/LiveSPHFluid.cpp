@@ -0,0 +1,436 @@
+#include <math.h>
+#include <string.h>
+
+#include "LiveSPHFluid.h"
+#include "fluid_system.h"
+
+LiveSPHFluid* LiveSPHFluid::simulating = 0;
+
+// Cells across one smoothing radius. Narrower cells fit the sphere of neighbors more closely, at the cost of more,
+//  shorter runs of cells to read.
+#define LIVE_SPH_CELLS_PER_RADIUS 1
+
+// FluidSystem::Run prints the time of every stage and computes pressures and forces on one core. Its grid has cells
+//  twice the smoothing radius wide, chained through the particles, so each particle tests the particles in a box
+//  4 smoothing radii wide, one linked-list hop at a time, and every pair is found and summed from both ends.
+// This runs the same CPU stages quietly. Every step it counting-sorts the particles into cells one smoothing radius
+//  wide, with their positions copied in cell order, so each particle tests the particles in runs of adjacent cells
+//  read in sequence. Each pair is found once, from the particle earlier in cell order, and its density and force
+//  terms (the force is equal and opposite) are added to both particles.
+// The pair search is spread over the cores; the sums over the pairs are not, since both ends are written.
+// The neighbor tables hold the pairs: m_Neighbor[i] lists the neighbors of i later in cell order.
+class LiveFluidSystem : public FluidSystem {
+private:
+	// Copies of FluidSystem's (private) smoothing kernels, from the same formulas
+	double r2, poly6Kern, spikyKern, lapKern;
+
+	// The cells cover the simulation volume (particles outside it land in the border cells)
+	float cellMin[3];
+	float cellDelta[3];
+	int cellRes[3];
+	// Cell c holds sortedIndex[cellStart[c]] to sortedIndex[cellStart[c + 1] - 1], with their positions (scaled to
+	//  simulation units, like the smoothing radius) in sortedPos, 3 floats each
+	std::vector<int> cellStart;
+	std::vector<int> sortedIndex;
+	std::vector<float> sortedPos;
+	std::vector<int> particleCell;
+
+	// Finds the cell along 'axis' that holds 'position'
+	int GetCell(float position, int axis) {
+		int cell = (int) floor((position - cellMin[axis]) * cellDelta[axis]);
+		if (cell < 0) return 0;
+		if (cell >= cellRes[axis]) return cellRes[axis] - 1;
+		return cell;
+	}
+
+	// Sorts the particles into cells, keeping their order within each cell
+	void SortIntoCells(void) {
+		int count = NumPoints();
+		int numCells = cellRes[0] * cellRes[1] * cellRes[2];
+		cellStart.assign(numCells + 1, 0);
+		particleCell.resize(count);
+		sortedIndex.resize(count);
+		sortedPos.resize(3 * count);
+		float scale = m_Param[SPH_SIMSCALE];
+
+		for (int i = 0; i < count; i++) {
+			Fluid* p = (Fluid*) GetElem(0, i);
+			int cell = (GetCell(p->pos.z, 2) * cellRes[1] + GetCell(p->pos.y, 1)) * cellRes[0] + GetCell(p->pos.x, 0);
+			particleCell[i] = cell;
+			cellStart[cell + 1]++;
+		}
+		for (int c = 0; c < numCells; c++) {
+			cellStart[c + 1] += cellStart[c];
+		}
+
+		// Fill each cell from its start, then shift the starts back
+		for (int i = 0; i < count; i++) {
+			Fluid* p = (Fluid*) GetElem(0, i);
+			int at = cellStart[particleCell[i]]++;
+			sortedIndex[at] = i;
+			sortedPos[3 * at] = p->pos.x * scale;
+			sortedPos[3 * at + 1] = p->pos.y * scale;
+			sortedPos[3 * at + 2] = p->pos.z * scale;
+		}
+		for (int c = numCells; c > 0; c--) {
+			cellStart[c] = cellStart[c - 1];
+		}
+		cellStart[0] = 0;
+	}
+
+	// Finds each pair of particles closer than the smoothing radius once, and adds its density term to both ends
+	void ComputePressure(void) {
+		int count = NumPoints();
+		int slot;
+
+		SortIntoCells();
+
+		// Each iteration only writes its own particle and neighbor row, in cell order so neighboring iterations read
+		//  the same runs of cells
+		#pragma omp parallel for schedule(dynamic, 64)
+		for (slot = 0; slot < count; slot++) {
+			int i = sortedIndex[slot];
+			Fluid* p = (Fluid*) GetElem(0, i);
+			// Copied into the loop body, since the neighbor stores could otherwise alias the shared copies and force
+			//  a reload on every test
+			float radius2 = (float) r2;
+			int reach = LIVE_SPH_CELLS_PER_RADIUS;
+			const float* pos = &sortedPos[0];
+			const int* index = &sortedIndex[0];
+			float px = pos[3 * slot];
+			float py = pos[3 * slot + 1];
+			float pz = pos[3 * slot + 2];
+			// One spare slot, so a full list can keep writing without a branch
+			unsigned short neighbor[MAX_NEIGHBOR + 1];
+			float distance[MAX_NEIGHBOR + 1];
+			float sum = 0.0;
+			int found = 0;
+
+			int x = GetCell(p->pos.x, 0);
+			int y = GetCell(p->pos.y, 1);
+			int z = GetCell(p->pos.z, 2);
+			int lowX = (x - reach > 0) ? x - reach : 0;
+			int highX = (x + reach < cellRes[0]) ? x + reach : cellRes[0] - 1;
+			int ownRow = (z * cellRes[1] + y) * cellRes[0];
+
+			for (int cz = z - reach; cz <= z + reach; cz++) {
+				if (cz < 0 || cz >= cellRes[2]) {
+					continue;
+				}
+				for (int cy = y - reach; cy <= y + reach; cy++) {
+					if (cy < 0 || cy >= cellRes[1]) {
+						continue;
+					}
+					// The cells along x are next to each other in the sorted order, and only the particles after
+					//  this one are tested (the earlier rows were paired from their own side)
+					int row = (cz * cellRes[1] + cy) * cellRes[0];
+					if (row < ownRow) {
+						continue;
+					}
+					int first = (row == ownRow) ? slot + 1 : cellStart[row + lowX];
+					int last = cellStart[row + highX + 1];
+					for (int j = first; j < last; j++) {
+						float dx = px - pos[3 * j];
+						float dy = py - pos[3 * j + 1];
+						float dz = pz - pos[3 * j + 2];
+						float dsq = dx * dx + dy * dy + dz * dz;
+						// About two in three tests miss, in no predictable order, so the test is folded into the
+						//  arithmetic instead of branched on
+						int hit = (radius2 > dsq);
+						float c = radius2 - dsq;
+						sum += (float) hit * c * c * c;
+						neighbor[found] = index[j];
+						distance[found] = dsq;
+						found += hit;
+						found = (found < MAX_NEIGHBOR) ? found : MAX_NEIGHBOR;
+					}
+				}
+			}
+			memcpy(m_Neighbor[i], neighbor, found * sizeof(unsigned short));
+			memcpy(m_NDist[i], distance, found * sizeof(float));
+			m_NC[i] = found;
+			p->density = sum;
+		}
+
+		// The later end of each pair
+		float radius2 = (float) r2;
+		for (int i = 0; i < count; i++) {
+			for (int n = 0; n < m_NC[i]; n++) {
+				Fluid* pcurr = (Fluid*) GetElem(0, m_Neighbor[i][n]);
+				float c = radius2 - m_NDist[i][n];
+				pcurr->density += c * c * c;
+				m_NDist[i][n] = sqrt(m_NDist[i][n]);
+			}
+		}
+
+		for (int i = 0; i < count; i++) {
+			Fluid* p = (Fluid*) GetElem(0, i);
+			p->density = p->density * m_Param[SPH_PMASS] * poly6Kern;
+			p->pressure = (p->density - m_Param[SPH_RESTDENSITY]) * m_Param[SPH_INTSTIFF];
+			p->density = 1.0f / p->density;
+		}
+	}
+
+	// SPH_ComputeForceGridNC over the pairs: the force on the later end is the opposite of the force on the earlier
+	void ComputeForce(void) {
+		int count = NumPoints();
+		float d = m_Param[SPH_SIMSCALE];
+		float mR = m_Param[SPH_SMOOTHRADIUS];
+		float vterm = lapKern * m_Param[SPH_VISC];
+
+		for (int i = 0; i < count; i++) {
+			((Fluid*) GetElem(0, i))->sph_force.Set(0, 0, 0);
+		}
+
+		for (int i = 0; i < count; i++) {
+			Fluid* p = (Fluid*) GetElem(0, i);
+
+			for (int j = 0; j < m_NC[i]; j++) {
+				Fluid* pcurr = (Fluid*) GetElem(0, m_Neighbor[i][j]);
+				float dx = (p->pos.x - pcurr->pos.x) * d;
+				float dy = (p->pos.y - pcurr->pos.y) * d;
+				float dz = (p->pos.z - pcurr->pos.z) * d;
+				float c = mR - m_NDist[i][j];
+				float pterm = -0.5f * c * spikyKern * (p->pressure + pcurr->pressure) / m_NDist[i][j];
+				float dterm = c * p->density * pcurr->density;
+				Vector3DF force;
+				force.x = (pterm * dx + vterm * (pcurr->vel_eval.x - p->vel_eval.x)) * dterm;
+				force.y = (pterm * dy + vterm * (pcurr->vel_eval.y - p->vel_eval.y)) * dterm;
+				force.z = (pterm * dz + vterm * (pcurr->vel_eval.z - p->vel_eval.z)) * dterm;
+				p->sph_force += force;
+				pcurr->sph_force -= force;
+			}
+		}
+	}
+
+public:
+	// Must be called after the scene is created (SPH_CreateExample recomputes the kernels and sets the volume)
+	void ComputeKernels(void) {
+		double h = m_Param[SPH_SMOOTHRADIUS];
+		r2 = h * h;
+		poly6Kern = 315.0f / (64.0f * 3.141592 * pow(h, 9));
+		spikyKern = -45.0f / (3.141592 * pow(h, 6));
+		lapKern = 45.0f / (3.141592 * pow(h, 6));
+
+		// Cells a fraction of the smoothing radius wide, in solver positions
+		float cellSize = m_Param[SPH_SMOOTHRADIUS] / m_Param[SPH_SIMSCALE] / LIVE_SPH_CELLS_PER_RADIUS;
+		float volumeMin[3] = { m_Vec[SPH_VOLMIN].x, m_Vec[SPH_VOLMIN].y, m_Vec[SPH_VOLMIN].z };
+		float volumeMax[3] = { m_Vec[SPH_VOLMAX].x, m_Vec[SPH_VOLMAX].y, m_Vec[SPH_VOLMAX].z };
+		for (int axis = 0; axis < 3; axis++) {
+			cellMin[axis] = volumeMin[axis];
+			cellDelta[axis] = 1.0f / cellSize;
+			cellRes[axis] = (int) ceil((volumeMax[axis] - volumeMin[axis]) / cellSize);
+			if (cellRes[axis] < 1) {
+				cellRes[axis] = 1;
+			}
+		}
+	}
+
+	virtual void Run() {
+		float ss = m_Param[SPH_PDIST] / m_Param[SPH_SIMSCALE];
+		if (m_Vec[EMIT_RATE].x > 0 && (++m_Frame) % (int) m_Vec[EMIT_RATE].x == 0) {
+			Emit(ss);
+		}
+
+		ComputePressure();
+		ComputeForce();
+		Advance();
+	}
+};
+
+LiveSPHFluid::LiveSPHFluid(int example, int maxParticles, const cVector3d& offset, double scale) :
+	maxParticles(maxParticles), offset(offset), scale(scale),
+	front(0), pending(1), back(2), pendingReady(false), frameVersion(0), particlesVersion(0),
+	running(true), stopped(false), stepCount(0), lag(0)
+{
+	if (this->maxParticles > LIVE_SPH_MAX_PARTICLES) {
+		this->maxParticles = LIVE_SPH_MAX_PARTICLES;
+	}
+
+	// The solver's neighbor tables make it too big for the stack
+	LiveFluidSystem* system = new LiveFluidSystem();
+	system->Initialize(BFLUID, this->maxParticles);
+	system->SPH_CreateExample(example, this->maxParticles);
+	system->ComputeKernels();
+	solver = system;
+
+	// Solver positions move by vel * dt / simscale each step
+	velocityScale = scale / solver->GetParam(SPH_SIMSCALE);
+
+	// Sample velocities over two smoothing radii
+	_neighborhoodRadius = 2.0 * scale * solver->GetParam(SPH_SMOOTHRADIUS) / solver->GetParam(SPH_SIMSCALE);
+
+	fastestSpeed = 0;
+	for (int i = 0; i < LIVE_SPH_SNAPSHOTS; i++) {
+		readers[i] = 0;
+	}
+
+	// Publish the starting state so there is something to draw before the first step
+	Publish(0);
+	AdvanceFrame();
+
+	simulating = this;
+	thread = new cThread();
+	thread->set(LiveSPHFluid::SimulationThread, CHAI_THREAD_PRIORITY_GRAPHICS);
+}
+
+LiveSPHFluid::~LiveSPHFluid(void) {
+	// Let the solver thread finish its step before tearing it down
+	running = false;
+	while (!stopped) { cSleepMs(1); }
+	simulating = 0;
+
+	delete thread;
+	delete solver;
+}
+
+void LiveSPHFluid::SimulationThread(void) {
+	simulating->Simulate();
+}
+
+void LiveSPHFluid::Simulate(void) {
+	cPrecisionClock clock;
+	clock.start(true);
+	double simulated = 0;
+	double published = 0;
+	double dt = solver->GetDT();
+
+	while (running) {
+		double now = clock.getCurrentTimeSeconds();
+
+		// Ahead of the wall clock: wait for it
+		if (simulated > now) {
+			cSleepMs(1);
+			continue;
+		}
+
+		// Too far behind to catch up: drop the backlog rather than fall further behind
+		if (now - simulated > LIVE_SPH_MAX_LAG) {
+			simulated = now - LIVE_SPH_MAX_LAG;
+		}
+
+		solver->Run();
+		simulated += dt;
+		stepCount++;
+		lag = now - simulated;
+
+		// Behind the wall clock: only publish often enough for the haptics, and spend the rest on catching up
+		if (simulated > clock.getCurrentTimeSeconds() || simulated - published >= LIVE_SPH_PUBLISH_INTERVAL) {
+			Publish(simulated);
+			published = simulated;
+		}
+	}
+
+	stopped = true;
+}
+
+void LiveSPHFluid::Publish(double time) {
+	FluidSnapshot& snapshot = snapshots[back];
+	int count = solver->NumPoints();
+
+	snapshot.positions.resize(count);
+	snapshot.velocities.resize(count);
+	snapshot.time = time;
+
+	// Copy the particles into world coordinates
+	for (int i = 0; i < count; i++) {
+		Fluid* fluid = solver->GetFluid(i);
+		snapshot.positions[i].set(fluid->pos.x, fluid->pos.y, fluid->pos.z);
+		snapshot.positions[i].mul(scale);
+		snapshot.positions[i].add(offset);
+		snapshot.velocities[i].set(fluid->vel_eval.x, fluid->vel_eval.y, fluid->vel_eval.z);
+		snapshot.velocities[i].mul(velocityScale);
+
+		double speed = snapshot.velocities[i].length();
+		if (speed > fastestSpeed) {
+			fastestSpeed = speed;
+		}
+	}
+	snapshot.maxSpeed = fastestSpeed;
+	snapshot.BuildGrid(_neighborhoodRadius);
+	snapshot.ComputeSpeedStats();
+
+	// Hand the snapshot over, and fill one nobody is showing or reading next (the previous pending one is free again
+	//  if AdvanceFrame hasn't taken it)
+	snapshotLock.Lock();
+	pending = back;
+	pendingReady = true;
+	for (int i = 0; i < LIVE_SPH_SNAPSHOTS; i++) {
+		if (i != front && i != pending && readers[i] == 0) {
+			back = i;
+			break;
+		}
+	}
+	snapshotLock.Unlock();
+}
+
+void LiveSPHFluid::AdvanceFrame(void) {
+	snapshotLock.Lock();
+	if (pendingReady) {
+		front = pending;
+		pendingReady = false;
+		frameVersion++;
+	}
+	snapshotLock.Unlock();
+}
+
+void LiveSPHFluid::GetFrame(FluidFrame& frame) {
+	snapshots[front].GetFrame(frame, frameVersion);
+}
+
+void LiveSPHFluid::GetAllPoints(std::vector<IFluidParticle*>& allParticles) {
+	FluidSnapshot& snapshot = snapshots[front];
+	int count = snapshot.GetCount();
+
+	if (particlesVersion != frameVersion || (int) particles.size() != count) {
+		particles.resize(count);
+		for (int i = 0; i < count; i++) {
+			particles[i] = BasicFluidParticle(snapshot.positions[i], snapshot.velocities[i]);
+		}
+		particlesVersion = frameVersion;
+	}
+
+	allParticles.resize(count);
+	for (int i = 0; i < count; i++) {
+		allParticles[i] = &particles[i];
+	}
+}
+
+int LiveSPHFluid::GetCurrentPointCount(void) {
+	snapshotLock.Lock();
+	int count = snapshots[front].GetCount();
+	snapshotLock.Unlock();
+	return count;
+}
+
+void LiveSPHFluid::GetVelocityAt(cVector3d& velocity, const cVector3d& location) {
+	// The haptics thread can call this while AdvanceFrame swaps snapshots, so pin the front one (Publish won't refill
+	//  it) and query it outside the lock
+	snapshotLock.Lock();
+	int reading = front;
+	readers[reading]++;
+	snapshotLock.Unlock();
+
+	snapshots[reading].GetVelocityAt(velocity, location, _neighborhoodRadius);
+
+	snapshotLock.Lock();
+	readers[reading]--;
+	snapshotLock.Unlock();
+}
+
+double LiveSPHFluid::GetMaxParticleSpeed(void) {
+	snapshotLock.Lock();
+	double fastest = snapshots[front].maxSpeed;
+	snapshotLock.Unlock();
+	return (fastest > FLUID_MIN_REFERENCE_SPEED) ? fastest : FLUID_MIN_REFERENCE_SPEED;
+}
+
+void LiveSPHFluid::GetSpeedStats(FluidSpeedStats& stats) {
+	snapshotLock.Lock();
+	stats = snapshots[front].speedStats;
+	snapshotLock.Unlock();
+}
+
+int LiveSPHFluid::GetMaxSimulatedParticles() {
+	return maxParticles;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+
+#include "chai3d.h"
+
+#include "SPHFluid.h"
+#include "BasicFluidParticle.h"
+#include "FluidMutex.h"
+#include "FluidSnapshot.h"
+
+// The FLUIDS solver is only seen through a pointer, so its headers stay out of the renderers
+class FluidSystem;
+
+// The most particles the FLUIDS solver can hold (its neighbor tables are 16 bit)
+#define LIVE_SPH_MAX_PARTICLES 65535
+// How far the simulation may fall behind the wall clock before the backlog is dropped (seconds)
+#define LIVE_SPH_MAX_LAG 0.25
+// Snapshots kept: one shown, one handed over, one being filled, and one the haptics can hold on to
+#define LIVE_SPH_SNAPSHOTS 4
+// The longest the solver goes without publishing a snapshot while it is catching up (simulated seconds)
+#define LIVE_SPH_PUBLISH_INTERVAL 0.01
+
+// A fluid simulated live by the FLUIDS SPH solver (Fluids/fluids) instead of read from baked frames.
+// The solver steps on its own thread, keeping pace with the wall clock, and publishes each step as a snapshot.
+// AdvanceFrame picks up the newest snapshot, and every query reads that snapshot until the next AdvanceFrame.
+// Only snapshot indices change hands under the lock, so the solver, the renderer, and the haptics never wait on each
+//  other's work.
+// Only one LiveSPHFluid can be simulating at a time.
+class LiveSPHFluid : public SPHFluid {
+protected:
+	FluidSystem* solver;
+	int maxParticles;
+
+	// Maps solver coordinates to world coordinates: world = offset + scale * solver
+	cVector3d offset;
+	double scale;
+	double velocityScale;
+
+	// The solver fills 'back', hands it over as 'pending', and AdvanceFrame makes it 'front'
+	// (a snapshot's time is simulated seconds since the fluid was created)
+	FluidSnapshot snapshots[LIVE_SPH_SNAPSHOTS];
+	int front, pending, back;
+	bool pendingReady;
+	// How many GetVelocityAt calls are reading each snapshot (Publish never refills one being read)
+	int readers[LIVE_SPH_SNAPSHOTS];
+	unsigned int frameVersion;
+	// The fastest speed published so far (only touched by the solver thread)
+	double fastestSpeed;
+
+	// GetAllPoints hands out these, rebuilt from the front snapshot when the frame changes
+	std::vector<BasicFluidParticle> particles;
+	unsigned int particlesVersion;
+
+	cThread* thread;
+	volatile bool running;
+	volatile bool stopped;
+	volatile int stepCount;
+	volatile double lag;
+
+	FluidMutex snapshotLock;
+
+	static LiveSPHFluid* simulating;
+	static void SimulationThread(void);
+
+	void Simulate(void);
+	void Publish(double time);
+
+public:
+	// Creates a fluid from one of the FLUIDS example scenes (0 is the wave pool) and starts simulating it.
+	// Solver positions are mapped to world positions with 'offset' + 'scale' * position.
+	LiveSPHFluid(int example = 0, int maxParticles = 4096, const cVector3d& offset = cVector3d(0, 0, 0), double scale = 0.1);
+	virtual ~LiveSPHFluid(void);
+
+	// Finds all the points in the fluid simulation and copies them into the list 'allParticles'
+	virtual void GetAllPoints(std::vector<IFluidParticle*>& allParticles);
+	// Points 'frame' at the current snapshot (call from the thread that calls AdvanceFrame)
+	virtual void GetFrame(FluidFrame& frame);
+	// Returns the number of particles in the current snapshot
+	virtual int GetCurrentPointCount(void);
+	// Finds the velocity of the fluid at the given point (a smoothed average of the nearby particles)
+	virtual void GetVelocityAt(cVector3d& velocity, const cVector3d& location);
+	// Returns the fastest speed a particle has reached so far
+	virtual double GetMaxParticleSpeed(void);
+	// Copies the speed statistics of the current snapshot
+	virtual void GetSpeedStats(FluidSpeedStats& stats);
+	// Moves to the newest snapshot the solver has published (does nothing if there isn't a new one)
+	virtual void AdvanceFrame(void);
+	// Max number of particles being simulated at any given time
+	virtual int GetMaxSimulatedParticles();
+
+	// Returns the number of solver steps taken so far
+	int GetStepCount(void) { return stepCount; }
+	// Returns how far the solver is behind the wall clock, in seconds
+	double GetLag(void) { return lag; }
+	// Returns the simulated time of the current snapshot, in seconds
+	double GetSimulatedTime(void) { return snapshots[front].time; }
+};
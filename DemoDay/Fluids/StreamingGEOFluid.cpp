@@ -0,0 +1,226 @@
+#include <stdio.h>
+
+#include "StreamingGEOFluid.h"
+#include "FrameData.h"
+#include "FrameDataParser.h"
+
+StreamingGEOFluid* StreamingGEOFluid::streaming = 0;
+
+StreamingGEOFluid::StreamingGEOFluid(const std::string& baseFileName, int startFrame, int endFrame, int substeps) :
+	baseFileName(baseFileName), startFrame(startFrame), frameCount(endFrame - startFrame + 1),
+	substeps(substeps > 0 ? substeps : 1), currentStep(0), substep(0),
+	front(0), frameVersion(0), maxSimParticles(0), fastestSpeed(0), particlesVersion(0),
+	running(true), stopped(false), stallCount(0)
+{
+	for (int i = 0; i < GEO_STREAM_RING_SIZE; i++) {
+		ring[i] = 0;
+		ringStep[i] = -1;
+	}
+
+	streaming = this;
+	thread = new cThread();
+	thread->set(StreamingGEOFluid::LoaderThread, CHAI_THREAD_PRIORITY_GRAPHICS);
+
+	// Wait for the first two frames so there is something to draw (that wait isn't a stall)
+	Blend();
+	stallCount = 0;
+}
+
+StreamingGEOFluid::~StreamingGEOFluid(void) {
+	// Let the loader finish the frame it is decoding
+	running = false;
+	while (!stopped) { cSleepMs(1); }
+	streaming = 0;
+
+	delete thread;
+	for (int i = 0; i < GEO_STREAM_RING_SIZE; i++) {
+		delete ring[i];
+	}
+}
+
+void StreamingGEOFluid::LoaderThread(void) {
+	streaming->Load();
+}
+
+int StreamingGEOFluid::GetWindow(void) {
+	// With fewer frames than slots, stop before the same frame would be loaded twice
+	return (frameCount < GEO_STREAM_RING_SIZE) ? frameCount : GEO_STREAM_RING_SIZE;
+}
+
+void StreamingGEOFluid::Load(void) {
+	while (running) {
+		// Find the nearest step that isn't in the ring yet
+		int step = -1;
+		lock.Lock();
+		for (int i = 0; i < GetWindow(); i++) {
+			if (ringStep[(currentStep + i) % GEO_STREAM_RING_SIZE] != currentStep + i) {
+				step = currentStep + i;
+				break;
+			}
+		}
+		lock.Unlock();
+
+		if (step < 0) {
+			cSleepMs(1);
+			continue;
+		}
+
+		// Decode without holding the lock, so AdvanceFrame and the haptics never wait on the disk
+		char intConvert[21];
+		sprintf(intConvert, "%03d", startFrame + step % frameCount);
+		FrameData* data = FrameDataParse::ParseFrame(baseFileName + intConvert + ".geo");
+
+		// Only keep it if AdvanceFrame hasn't moved past it in the meantime.
+		// The slot's old frame is never one being blended, since those are both still in the window.
+		FrameData* evicted = data;
+		lock.Lock();
+		if (step >= currentStep && step < currentStep + GetWindow()) {
+			int slot = step % GEO_STREAM_RING_SIZE;
+			evicted = ring[slot];
+			ring[slot] = data;
+			ringStep[slot] = step;
+		}
+		lock.Unlock();
+
+		delete evicted;
+	}
+
+	stopped = true;
+}
+
+FrameData* StreamingGEOFluid::WaitForStep(int step) {
+	int slot = step % GEO_STREAM_RING_SIZE;
+	bool stalled = false;
+
+	while (true) {
+		lock.Lock();
+		FrameData* data = (ringStep[slot] == step) ? ring[slot] : 0;
+		lock.Unlock();
+
+		if (data) {
+			return data;
+		}
+
+		if (!stalled) {
+			stallCount++;
+			stalled = true;
+		}
+		cSleepMs(1);
+	}
+}
+
+int StreamingGEOFluid::GetLiveIndex(const FrameData* data, int id) {
+	if (id < 0 || id >= (int) data->liveIndexByID.size()) {
+		return -1;
+	}
+	return data->liveIndexByID[id];
+}
+
+void StreamingGEOFluid::Blend(void) {
+	FrameData* from = WaitForStep(currentStep);
+	// The last frame holds still rather than blending into the first one when the frames loop
+	FrameData* to = (currentStep % frameCount + 1 < frameCount) ? WaitForStep(currentStep + 1) : from;
+	double t = (double) substep / substeps;
+
+	FluidSnapshot& blend = blends[1 - front];
+	blend.positions.clear();
+	blend.velocities.clear();
+
+	// Particles in both frames move between them; ones only in one frame appear or vanish halfway
+	for (int i = 0; i < from->_livePartCount; i++) {
+		int j = GetLiveIndex(to, from->xSortedPartIDs[i].id);
+		if (j >= 0) {
+			blend.positions.push_back(from->livePositions[i] + t * (to->livePositions[j] - from->livePositions[i]));
+			blend.velocities.push_back(from->liveVelocities[i] + t * (to->liveVelocities[j] - from->liveVelocities[i]));
+		} else if (t < 0.5) {
+			blend.positions.push_back(from->livePositions[i]);
+			blend.velocities.push_back(from->liveVelocities[i]);
+		}
+	}
+	if (t >= 0.5) {
+		for (int j = 0; j < to->_livePartCount; j++) {
+			if (GetLiveIndex(from, to->xSortedPartIDs[j].id) < 0) {
+				blend.positions.push_back(to->livePositions[j]);
+				blend.velocities.push_back(to->liveVelocities[j]);
+			}
+		}
+	}
+
+	blend.BuildGrid(_neighborhoodRadius);
+	blend.ComputeSpeedStats();
+	if (blend.GetCount() > maxSimParticles) {
+		maxSimParticles = blend.GetCount();
+	}
+	if (blend.speedStats.maxSpeed > fastestSpeed) {
+		fastestSpeed = blend.speedStats.maxSpeed;
+	}
+
+	lock.Lock();
+	front = 1 - front;
+	frameVersion++;
+	lock.Unlock();
+}
+
+void StreamingGEOFluid::AdvanceFrame(void) {
+	substep++;
+	if (substep >= substeps) {
+		substep = 0;
+
+		// Moving the window on lets the loader replace the frame that was just left
+		lock.Lock();
+		currentStep++;
+		lock.Unlock();
+	}
+
+	Blend();
+}
+
+void StreamingGEOFluid::GetFrame(FluidFrame& frame) {
+	blends[front].GetFrame(frame, frameVersion);
+}
+
+void StreamingGEOFluid::GetAllPoints(std::vector<IFluidParticle*>& allParticles) {
+	FluidSnapshot& blend = blends[front];
+	int count = blend.GetCount();
+
+	if (particlesVersion != frameVersion || (int) particles.size() != count) {
+		particles.resize(count);
+		for (int i = 0; i < count; i++) {
+			particles[i] = BasicFluidParticle(blend.positions[i], blend.velocities[i]);
+		}
+		particlesVersion = frameVersion;
+	}
+
+	allParticles.resize(count);
+	for (int i = 0; i < count; i++) {
+		allParticles[i] = &particles[i];
+	}
+}
+
+int StreamingGEOFluid::GetCurrentPointCount(void) {
+	lock.Lock();
+	int count = blends[front].GetCount();
+	lock.Unlock();
+	return count;
+}
+
+void StreamingGEOFluid::GetVelocityAt(cVector3d& velocity, const cVector3d& location) {
+	// The haptics thread can call this while AdvanceFrame swaps blends, so hold the front one still
+	lock.Lock();
+	blends[front].GetVelocityAt(velocity, location, _neighborhoodRadius);
+	lock.Unlock();
+}
+
+double StreamingGEOFluid::GetMaxParticleSpeed(void) {
+	return (fastestSpeed > FLUID_MIN_REFERENCE_SPEED) ? fastestSpeed : FLUID_MIN_REFERENCE_SPEED;
+}
+
+void StreamingGEOFluid::GetSpeedStats(FluidSpeedStats& stats) {
+	lock.Lock();
+	stats = blends[front].speedStats;
+	lock.Unlock();
+}
+
+int StreamingGEOFluid::GetMaxSimulatedParticles() {
+	return maxSimParticles;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "chai3d.h"
+
+#include "SPHFluid.h"
+#include "BasicFluidParticle.h"
+#include "FluidMutex.h"
+#include "FluidSnapshot.h"
+
+class FrameData;
+
+// How many decoded frames are kept: the two being blended and the ones prefetched after them
+#define GEO_STREAM_RING_SIZE 8
+// How many AdvanceFrame calls it takes to move from one baked frame to the next by default
+#define GEO_STREAM_SUBSTEPS 4
+
+// A fluid played back from baked .geo files like GEOFileFluid, without loading every frame up front.
+// A loader thread decodes the frames just ahead of the current one into a small ring, and AdvanceFrame
+//  moves a fraction of a baked frame at a time, matching particles by ID to blend the two frames around it.
+// Each blend is built off to the side and swapped in, so velocity queries cost the same on every frame.
+// Only one StreamingGEOFluid can be streaming at a time.
+class StreamingGEOFluid : public SPHFluid {
+protected:
+	std::string baseFileName;
+	int startFrame;
+	int frameCount;
+	int substeps;
+
+	// How many baked frames have been passed since the start (it keeps counting when the frames loop),
+	//  and how many substeps toward the next one the blend is
+	int currentStep;
+	int substep;
+
+	// Step s lives in slot s % GEO_STREAM_RING_SIZE, holding frame s % frameCount; ringStep says which step a slot holds (-1 for none)
+	FrameData* ring[GEO_STREAM_RING_SIZE];
+	int ringStep[GEO_STREAM_RING_SIZE];
+
+	// AdvanceFrame fills the back blend and swaps it to the front
+	FluidSnapshot blends[2];
+	int front;
+	unsigned int frameVersion;
+	int maxSimParticles;
+	// The fastest speed blended so far
+	double fastestSpeed;
+
+	// GetAllPoints hands out these, rebuilt from the front blend when the frame changes
+	std::vector<BasicFluidParticle> particles;
+	unsigned int particlesVersion;
+
+	cThread* thread;
+	volatile bool running;
+	volatile bool stopped;
+	volatile int stallCount;
+
+	// Guards the ring (against the loader) and the front blend (against the haptics)
+	FluidMutex lock;
+
+	static StreamingGEOFluid* streaming;
+	static void LoaderThread(void);
+
+	void Load(void);
+	// Returns the number of steps the ring holds, starting at the current one
+	int GetWindow(void);
+	// Returns the decoded frame for 'step', waiting for the loader if it hasn't got there yet
+	FrameData* WaitForStep(int step);
+	// Blends the current frame into the next one and swaps the result to the front
+	void Blend(void);
+
+	static int GetLiveIndex(const FrameData* data, int id);
+
+public:
+	// Streams the files '[baseFileName][FRAME #].geo' for the frames in [startFrame, endFrame],
+	//  taking 'substeps' calls to AdvanceFrame to move from one to the next
+	StreamingGEOFluid(const std::string& baseFileName, int startFrame, int endFrame, int substeps = GEO_STREAM_SUBSTEPS);
+	virtual ~StreamingGEOFluid(void);
+
+	// Finds all the points in the fluid simulation and copies them into the list 'allParticles'
+	virtual void GetAllPoints(std::vector<IFluidParticle*>& allParticles);
+	// Points 'frame' at the current blend (call from the thread that calls AdvanceFrame)
+	virtual void GetFrame(FluidFrame& frame);
+	// Returns the number of particles in the current blend
+	virtual int GetCurrentPointCount(void);
+	// Finds the velocity of the fluid at the given point (a smoothed average of the nearby particles)
+	virtual void GetVelocityAt(cVector3d& velocity, const cVector3d& location);
+	// Returns the fastest speed a particle has reached so far (frames are only looked at once they are streamed in)
+	virtual double GetMaxParticleSpeed(void);
+	// Copies the speed statistics of the current blend
+	virtual void GetSpeedStats(FluidSpeedStats& stats);
+	// Moves one substep toward the next baked frame (the last frame loops back to the first)
+	virtual void AdvanceFrame(void);
+	// Max number of particles seen so far (frames are only looked at once they are streamed in)
+	virtual int GetMaxSimulatedParticles();
+
+	// Returns the baked frame the current blend starts from
+	int GetBakedFrame(void) { return startFrame + currentStep % frameCount; }
+	// Returns how far the current blend is toward the next baked frame, from 0 to 1
+	double GetBlend(void) { return (double) substep / substeps; }
+	// Returns how many times AdvanceFrame had to wait for the loader
+	int GetStallCount(void) { return stallCount; }
+};
\ No newline at end of file
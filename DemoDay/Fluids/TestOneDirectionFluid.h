@@ -15,6 +15,13 @@ public:
 		//allParticles = allParticlesO;
 		
 	}
+	// This fluid has no particles to draw
+	void GetFrame(FluidFrame& frame) {
+		frame.positions = 0;
+		frame.velocities = 0;
+		frame.count = 0;
+		frame.version = 0;
+	}
 	// Returns the number of particles in the simulation
 	int GetCurrentPointCount(void) {
 		return 1;
@@ -26,6 +33,10 @@ public:
 	double GetMaxParticleSpeed(void) {
 		return 2.0;
 	}
+	// This fluid has no particles, so it reports its top speed everywhere
+	void GetSpeedStats(FluidSpeedStats& stats) {
+		stats.SetUniform(GetMaxParticleSpeed());
+	}
 	// Advances the fluid simulation one frame
 	void AdvanceFrame(void) {
 	}
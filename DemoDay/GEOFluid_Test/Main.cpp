@@ -6,6 +6,7 @@
 
 #include "FluidRenderer.h"
 #include "GEOFileFluid.h"
+#include "StreamingGEOFluid.h"
 #include "IFluid.h"
 #include "IHapticDevice.h"
 #include "ITerrain.h"
@@ -14,16 +15,89 @@ IFluid* fluid = 0;
 ITerrain* terrain = 0;
 IHapticDevice* hapticDevice = 0;
 
-int main(void) {
-	GEOFileFluid geoFluid("../Fluids/fluidBake/brad_test_geometry", 50, 100);
-	fluid = &geoFluid;
+#define BAKE_FILE_NAME "../Fluids/fluidBake/brad_test_geometry"
+#define BAKE_START_FRAME 50
+#define BAKE_END_FRAME 100
+
+// The haptics loop queries the velocity about this often between two rendered frames
+#define QUERIES_PER_FRAME 16
+
+// Times the streamed fluid's frame changes and velocity queries, showing whether crossing into a new baked frame stalls a query
+int RunStreamingBenchmark(void) {
+	StreamingGEOFluid streamed(BAKE_FILE_NAME, BAKE_START_FRAME, BAKE_END_FRAME);
+	cPrecisionClock clock;
+
+	// [0] is for frames that just crossed into a new baked frame, [1] for the blends between them
+	double worstAdvance[2] = { 0, 0 };
+	double worstQuery[2] = { 0, 0 };
+	double totalQuery[2] = { 0, 0 };
+	int queryCount[2] = { 0, 0 };
+
+	int steps = 2 * (BAKE_END_FRAME - BAKE_START_FRAME + 1) * GEO_STREAM_SUBSTEPS;
+	for (int step = 0; step < steps; step++) {
+		clock.start(true);
+		streamed.AdvanceFrame();
+		double advance = clock.stop();
+
+		int kind = (streamed.GetBlend() == 0) ? 0 : 1;
+		if (advance > worstAdvance[kind]) {
+			worstAdvance[kind] = advance;
+		}
+
+		FluidFrame frame;
+		streamed.GetFrame(frame);
+		if (frame.count == 0) {
+			continue;
+		}
+
+		for (int i = 0; i < QUERIES_PER_FRAME; i++) {
+			cVector3d velocity;
+			const cVector3d& location = frame.positions[(i * frame.count) / QUERIES_PER_FRAME];
+
+			clock.start(true);
+			streamed.GetVelocityAt(velocity, location);
+			double query = clock.stop();
+
+			if (query > worstQuery[kind]) {
+				worstQuery[kind] = query;
+			}
+			totalQuery[kind] += query;
+			queryCount[kind]++;
+		}
+
+		// Give the loader the time a rendered frame would
+		cSleepMs(16);
+	}
+
+	const char* names[2] = { "baked frame", "blend" };
+	printf("%12s %18s %16s %16s\n", "frame", "worst advance (ms)", "mean query (us)", "worst query (us)");
+	for (int kind = 0; kind < 2; kind++) {
+		double mean = queryCount[kind] ? totalQuery[kind] / queryCount[kind] : 0;
+		printf("%12s %18.3f %16.3f %16.3f\n", names[kind], worstAdvance[kind] * 1000, mean * 1000000, worstQuery[kind] * 1000000);
+	}
+	printf("AdvanceFrame waited for the loader %d times in %d steps\n", streamed.GetStallCount(), steps);
+
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc > 1 && strcmp(argv[1], "--stream-benchmark") == 0) {
+		return RunStreamingBenchmark();
+	}
+
+	// --stream plays the frames back blended, decoding them as they are needed
+	if (argc > 1 && strcmp(argv[1], "--stream") == 0) {
+		fluid = new StreamingGEOFluid(BAKE_FILE_NAME, BAKE_START_FRAME, BAKE_END_FRAME);
+	} else {
+		fluid = new GEOFileFluid(BAKE_FILE_NAME, BAKE_START_FRAME, BAKE_END_FRAME);
+	}
 	
 	cWorld world;
 	FluidRenderer renderer;
 	renderer.InitFluids(&world, fluid);
 	
+	// UpdateFluid advances the fluid and reads its frame through IFluid::GetFrame
 	while(true) {
-		geoFluid.AdvanceFrame();
-		renderer.UpdateFluid(&world);
+		renderer.UpdateFluid();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,584 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "CollisionBenchmark.h"
+#include "ProxyBenchmark.h"
+
+static const char* detectorNames[COLLISION_DETECTOR_TYPE_COUNT] = { "brute force", "AABB", "sphere tree", "BVH" };
+
+// A uniform random number from 0 to 1
+static double randomFraction(void) {
+	return (double) rand() / RAND_MAX;
+}
+
+void CreateCollisionDetector(cMesh* mesh, CollisionDetectorType type, double radius) {
+	switch (type) {
+		case COLLISION_DETECTOR_BRUTE_FORCE:
+			mesh->createBruteForceCollisionDetector(true, false);
+			break;
+		case COLLISION_DETECTOR_AABB:
+			mesh->createAABBCollisionDetector(radius, true, false);
+			break;
+		case COLLISION_DETECTOR_SPHERE_TREE:
+			mesh->createSphereTreeCollisionDetector(radius, true, false);
+			break;
+		default:
+			mesh->createBVHCollisionDetector(radius, true, false);
+			break;
+	}
+}
+
+void MakeCollisionQueries(cMesh* mesh, int count, std::vector<CollisionQuery>& queries) {
+	cVector3d low = mesh->getBoundaryMin();
+	cVector3d size = cSub(mesh->getBoundaryMax(), low);
+	double length = COLLISION_BENCHMARK_SEGMENT_LENGTH * size.length();
+	low.sub(cMul(COLLISION_BENCHMARK_MARGIN, size));
+	size.mul(1 + 2 * COLLISION_BENCHMARK_MARGIN);
+
+	queries.resize(count);
+	for (int i = 0; i < count; i++) {
+		// A random direction, from a point picked uniformly in the sphere
+		cVector3d direction;
+		do {
+			direction.set(2 * randomFraction() - 1, 2 * randomFraction() - 1, 2 * randomFraction() - 1);
+		} while (direction.lengthsq() > 1 || direction.lengthsq() < 1e-6);
+		direction.normalize();
+
+		queries[i].start.set(low.x + size.x * randomFraction(), low.y + size.y * randomFraction(), low.z + size.z * randomFraction());
+		queries[i].end = cAdd(queries[i].start, cMul(length, direction));
+	}
+}
+
+void StoreRestPose(cMesh* mesh, CollisionRestPose& pose) {
+	unsigned int count = mesh->getNumVertices();
+	pose.meshes.push_back(mesh);
+	pose.positions.push_back(std::vector<cVector3d>(count));
+	for (unsigned int i = 0; i < count; i++) {
+		pose.positions.back()[i] = mesh->getVertex(i)->getPos();
+	}
+
+	for (unsigned int i = 0; i < mesh->getNumChildren(); i++) {
+		cMesh* child = dynamic_cast<cMesh*>(mesh->getChild(i));
+		if (child) {
+			StoreRestPose(child, pose);
+		}
+	}
+}
+
+void DeformMesh(CollisionRestPose& pose, double amplitude, double waveNumber, double phase) {
+	for (unsigned int m = 0; m < pose.meshes.size(); m++) {
+		const std::vector<cVector3d>& positions = pose.positions[m];
+		for (unsigned int i = 0; i < positions.size(); i++) {
+			const cVector3d& rest = positions[i];
+			// Neighboring vertices move together, so the surface bends rather than tears
+			cVector3d offset(sin(phase + waveNumber * rest.y), sin(phase + waveNumber * rest.z), sin(phase + waveNumber * rest.x));
+			pose.meshes[m]->getVertex(i)->setPos(cAdd(rest, cMul(amplitude, offset)));
+		}
+	}
+}
+
+// The settings the proxy queries with: nearest collision only
+static cCollisionSettings nearestCollisionSettings(double radius) {
+	cCollisionSettings settings;
+	settings.m_checkForNearestCollisionOnly = true;
+	settings.m_returnMinimalCollisionData = true;
+	settings.m_checkVisibleObjectsOnly = false;
+	settings.m_checkHapticObjectsOnly = false;
+	settings.m_checkBothSidesOfTriangles = true;
+	settings.m_adjustObjectMotion = false;
+	settings.m_useContactCache = false;
+	settings.m_collisionRadius = radius;
+	return settings;
+}
+
+double RunCollisionQueries(cMesh* mesh, const std::vector<CollisionQuery>& queries, int count, double radius, std::vector<CollisionAnswer>& answers) {
+	cCollisionSettings settings = nearestCollisionSettings(radius);
+	cCollisionRecorder recorder;
+	answers.resize(count);
+
+	cPrecisionClock clock;
+	clock.start(true);
+
+	for (int i = 0; i < count; i++) {
+		// The detectors may move the segment, so each query gets its own copy
+		cVector3d start = queries[i].start;
+		cVector3d end = queries[i].end;
+
+		recorder.clear();
+		answers[i].hit = mesh->computeCollisionDetection(start, end, recorder, settings);
+		answers[i].squareDistance = answers[i].hit ? recorder.m_nearestCollision.m_squareDistance : 0;
+	}
+
+	return clock.getCurrentTimeSeconds();
+}
+
+// Counts the queries (of those brute force answered) where 'answers' found a different nearest hit than 'reference'
+static unsigned int countMismatches(const std::vector<CollisionAnswer>& answers, const std::vector<CollisionAnswer>& reference, double diagonal) {
+	unsigned int mismatches = 0;
+	for (int i = 0; i < COLLISION_BENCHMARK_BRUTE_QUERIES; i++) {
+		if (answers[i].hit != reference[i].hit ||
+			fabs(answers[i].squareDistance - reference[i].squareDistance) > COLLISION_BENCHMARK_TOLERANCE * diagonal * diagonal) {
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+// Deforms the model frame by frame, refitting each tree detector, and checks the refitted trees against brute force
+static void benchmarkRefit(cMesh* mesh, const std::vector<CollisionQuery>& queries, double radius, double diagonal) {
+	CollisionRestPose pose;
+	StoreRestPose(mesh, pose);
+	double amplitude = COLLISION_BENCHMARK_DEFORM_AMPLITUDE * diagonal / sqrt(3.0);
+	double waveNumber = 2 * CHAI_PI * COLLISION_BENCHMARK_DEFORM_WAVES / diagonal;
+	double lastPhase = 2 * CHAI_PI * (COLLISION_BENCHMARK_DEFORM_FRAMES - 1) / COLLISION_BENCHMARK_DEFORM_FRAMES;
+
+	// What brute force finds in the last frame
+	std::vector<CollisionAnswer> reference;
+	DeformMesh(pose, amplitude, waveNumber, lastPhase);
+	CreateCollisionDetector(mesh, COLLISION_DETECTOR_BRUTE_FORCE, radius);
+	RunCollisionQueries(mesh, queries, COLLISION_BENCHMARK_BRUTE_QUERIES, radius, reference);
+
+	printf("Deformed by %g of its size over %d frames:\n", COLLISION_BENCHMARK_DEFORM_AMPLITUDE, COLLISION_BENCHMARK_DEFORM_FRAMES);
+	printf("%-12s %12s %12s %14s %14s %12s\n", "", "refit (ms)", "rebuild (ms)", "refit q/s", "rebuilt q/s", "mismatches");
+
+	std::vector<CollisionAnswer> answers;
+	for (int type = COLLISION_DETECTOR_AABB; type < COLLISION_DETECTOR_TYPE_COUNT; type++) {
+		// Build in the rest pose, then follow the deformation by refitting
+		DeformMesh(pose, 0, 0, 0);
+		CreateCollisionDetector(mesh, (CollisionDetectorType) type, radius);
+
+		cPrecisionClock clock;
+		double refitSeconds = 0;
+		for (int frame = 0; frame < COLLISION_BENCHMARK_DEFORM_FRAMES; frame++) {
+			DeformMesh(pose, amplitude, waveNumber, 2 * CHAI_PI * frame / COLLISION_BENCHMARK_DEFORM_FRAMES);
+			clock.start(true);
+			mesh->refitCollisionDetector(0, true);
+			refitSeconds += clock.getCurrentTimeSeconds();
+		}
+
+		double seconds = RunCollisionQueries(mesh, queries, COLLISION_BENCHMARK_QUERIES, radius, answers);
+		double refitRate = (seconds > 0) ? COLLISION_BENCHMARK_QUERIES / seconds : 0;
+		unsigned int mismatches = countMismatches(answers, reference, diagonal);
+
+		// A tree built for the deformed pose, to see how much the refitted one has degraded
+		clock.start(true);
+		CreateCollisionDetector(mesh, (CollisionDetectorType) type, radius);
+		double rebuildSeconds = clock.getCurrentTimeSeconds();
+		seconds = RunCollisionQueries(mesh, queries, COLLISION_BENCHMARK_QUERIES, radius, answers);
+		double rebuiltRate = (seconds > 0) ? COLLISION_BENCHMARK_QUERIES / seconds : 0;
+
+		printf("%-12s %12.3f %12.3f %14.0f %14.0f %12u\n", detectorNames[type], refitSeconds * 1000 / COLLISION_BENCHMARK_DEFORM_FRAMES,
+			rebuildSeconds * 1000, refitRate, rebuiltRate, mismatches);
+	}
+
+	DeformMesh(pose, 0, 0, 0);
+}
+
+// Gathers 'mesh' and the meshes below it
+static void collectMeshes(cMesh* mesh, std::vector<cMesh*>& meshes) {
+	meshes.push_back(mesh);
+	for (unsigned int i = 0; i < mesh->getNumChildren(); i++) {
+		cMesh* child = dynamic_cast<cMesh*>(mesh->getChild(i));
+		if (child) {
+			collectMeshes(child, meshes);
+		}
+	}
+}
+
+// Tests every triangle of the model in packets and one at a time, checking that the packets never drop a triangle that is hit
+static void benchmarkPackets(cMesh* mesh, const std::vector<CollisionQuery>& queries, double radius) {
+	std::vector<cMesh*> meshes;
+	collectMeshes(mesh, meshes);
+
+	// The packets the brute force detector would use
+	std::vector<std::vector<cTrianglePacket> > packets(meshes.size());
+	for (unsigned int m = 0; m < meshes.size(); m++) {
+		std::vector<cTriangle>* triangles = meshes[m]->pTriangles();
+		for (unsigned int i = 0; i < triangles->size(); i += CHAI_TRIANGLE_PACKET_SIZE) {
+			unsigned int indices[CHAI_TRIANGLE_PACKET_SIZE];
+			unsigned int count = cMin((unsigned int) triangles->size() - i, (unsigned int) CHAI_TRIANGLE_PACKET_SIZE);
+			for (unsigned int j = 0; j < count; j++) {
+				indices[j] = i + j;
+			}
+			packets[m].push_back(cTrianglePacket());
+			packets[m].back().set(triangles, indices, count);
+		}
+	}
+
+	unsigned int numTriangles = mesh->getNumTriangles(true);
+	int count = cMin((int) queries.size(), (int) (COLLISION_BENCHMARK_TRIANGLE_TESTS / cMax(numTriangles, 1u)));
+	double tests = (double) count * numTriangles;
+
+	printf("Segment-triangle tests, %d packed together:\n", CHAI_TRIANGLE_PACKET_SIZE);
+	printf("%-12s %14s %14s %10s %8s\n", "", "single t/s", "packet t/s", "kept (%)", "missed");
+
+	cCollisionRecorder recorder;
+	cTrianglePacketSegment segment;
+	cPrecisionClock clock;
+
+	for (int pass = 0; pass < 2; pass++) {
+		cCollisionSettings settings = nearestCollisionSettings(pass ? radius : 0);
+
+		// Every triangle hit on its own must be one the packet keeps
+		unsigned int kept = 0;
+		unsigned int missed = 0;
+		for (int q = 0; q < count; q++) {
+			cVector3d start = queries[q].start;
+			cVector3d end = queries[q].end;
+			segment.set(start, end, settings.m_collisionRadius);
+			for (unsigned int m = 0; m < meshes.size(); m++) {
+				for (unsigned int p = 0; p < packets[m].size(); p++) {
+					const cTrianglePacket& packet = packets[m][p];
+					unsigned int candidates = packet.computeCandidates(segment);
+					for (unsigned int i = 0; i < packet.getNumTriangles(); i++) {
+						bool candidate = ((candidates >> i) & 1) != 0;
+						recorder.clear();
+						if ((*meshes[m]->pTriangles())[packet.getTriangleIndex(i)].computeCollision(start, end, recorder, settings) && !candidate) {
+							missed++;
+						}
+						if (candidate) {
+							kept++;
+						}
+					}
+				}
+			}
+		}
+
+		clock.start(true);
+		for (int q = 0; q < count; q++) {
+			cVector3d start = queries[q].start;
+			cVector3d end = queries[q].end;
+			recorder.clear();
+			for (unsigned int m = 0; m < meshes.size(); m++) {
+				std::vector<cTriangle>& triangles = *meshes[m]->pTriangles();
+				for (unsigned int i = 0; i < triangles.size(); i++) {
+					triangles[i].computeCollision(start, end, recorder, settings);
+				}
+			}
+		}
+		double singleSeconds = clock.getCurrentTimeSeconds();
+
+		clock.start(true);
+		for (int q = 0; q < count; q++) {
+			cVector3d start = queries[q].start;
+			cVector3d end = queries[q].end;
+			recorder.clear();
+			segment.set(start, end, settings.m_collisionRadius);
+			for (unsigned int m = 0; m < meshes.size(); m++) {
+				for (unsigned int p = 0; p < packets[m].size(); p++) {
+					packets[m][p].computeCollision(meshes[m]->pTriangles(), start, end, segment, recorder, settings);
+				}
+			}
+		}
+		double packetSeconds = clock.getCurrentTimeSeconds();
+
+		printf("%-12s %14.0f %14.0f %10.2f %8u\n", pass ? "radius" : "no radius", (singleSeconds > 0) ? tests / singleSeconds : 0,
+			(packetSeconds > 0) ? tests / packetSeconds : 0, (tests > 0) ? 100 * kept / tests : 0, missed);
+	}
+}
+
+// Finds the point of the model nearest to each of the first 'count' query starts, no farther than 'maxDistance'
+//  (-1 where there is none), and returns how long that took
+static double runProximityQueries(const std::vector<cMesh*>& meshes, const std::vector<CollisionQuery>& queries, int count, double maxDistance, std::vector<double>& squareDistances) {
+	squareDistances.resize(count);
+
+	cPrecisionClock clock;
+	clock.start(true);
+
+	for (int i = 0; i < count; i++) {
+		cProximityEvent event;
+		for (unsigned int m = 0; m < meshes.size(); m++) {
+			cGenericCollision* detector = meshes[m]->getCollisionDetector();
+			if (detector) {
+				// Each detector works in its own mesh's frame
+				cVector3d point = cMul(cTrans(meshes[m]->getGlobalRot()), cSub(queries[i].start, meshes[m]->getGlobalPos()));
+				detector->computeClosestPoint(point, maxDistance, event);
+			}
+		}
+		squareDistances[i] = event.m_triangle ? event.m_squareDistance : -1;
+	}
+
+	return clock.getCurrentTimeSeconds();
+}
+
+// Finds the nearest point of the model with each detector that answers proximity queries, over the whole model and
+//  within a short distance, and checks them against brute force
+static void benchmarkProximity(cMesh* mesh, const std::vector<CollisionQuery>& queries, double radius, double diagonal) {
+	std::vector<cMesh*> meshes;
+	collectMeshes(mesh, meshes);
+	double maxDistances[2] = { CHAI_LARGE, COLLISION_BENCHMARK_PROXIMITY_DISTANCE * diagonal };
+
+	printf("Nearest point, anywhere and within %g of the model's size:\n", COLLISION_BENCHMARK_PROXIMITY_DISTANCE);
+	printf("%-12s %14s %14s %8s %12s\n", "", "anywhere q/s", "within q/s", "found", "mismatches");
+
+	std::vector<double> reference[2];
+	std::vector<double> answers;
+
+	for (int type = 0; type < COLLISION_DETECTOR_TYPE_COUNT; type++) {
+		// The sphere tree only answers segment queries
+		if (type == COLLISION_DETECTOR_SPHERE_TREE) {
+			continue;
+		}
+		CreateCollisionDetector(mesh, (CollisionDetectorType) type, radius);
+
+		int count = (type == COLLISION_DETECTOR_BRUTE_FORCE) ? COLLISION_BENCHMARK_BRUTE_QUERIES : COLLISION_BENCHMARK_QUERIES;
+		double rates[2];
+		unsigned int found = 0;
+		unsigned int mismatches = 0;
+
+		for (int pass = 0; pass < 2; pass++) {
+			double seconds = runProximityQueries(meshes, queries, count, maxDistances[pass], answers);
+			rates[pass] = (seconds > 0) ? count / seconds : 0;
+
+			if (type == COLLISION_DETECTOR_BRUTE_FORCE) {
+				reference[pass] = answers;
+			}
+			for (int i = 0; i < COLLISION_BENCHMARK_BRUTE_QUERIES; i++) {
+				if ((answers[i] < 0) != (reference[pass][i] < 0) ||
+					fabs(answers[i] - reference[pass][i]) > COLLISION_BENCHMARK_TOLERANCE * diagonal * diagonal) {
+					mismatches++;
+				}
+			}
+			if (pass == 1) {
+				for (int i = 0; i < count; i++) {
+					if (answers[i] >= 0) {
+						found++;
+					}
+				}
+			}
+		}
+
+		printf("%-12s %14.0f %14.0f %8u %12u\n", detectorNames[type], rates[0], rates[1], found, mismatches);
+	}
+}
+
+// Builds a floor of small triangles with large upright triangles standing on it, so that a large triangle's sphere
+//  often holds the spheres of the small triangles around it
+static void addMixedSizeMesh(cMesh* mesh) {
+	AddTerrainMesh(mesh, PROXY_BENCHMARK_TERRAIN_SIZE, COLLISION_BENCHMARK_MIXED_CELLS);
+
+	double half = 0.5 * PROXY_BENCHMARK_TERRAIN_SIZE;
+	for (int i = 0; i < COLLISION_BENCHMARK_MIXED_WALLS; i++) {
+		double x = half * (2 * randomFraction() - 1);
+		double y = half * (2 * randomFraction() - 1);
+		double angle = 2 * CHAI_PI * randomFraction();
+		cVector3d across(half * cos(angle), half * sin(angle), 0);
+		cVector3d foot(x, y, 0);
+		mesh->newTriangle(cSub(foot, across), cAdd(foot, across), cAdd(foot, cVector3d(0, 0, half)));
+	}
+}
+
+// Scores every detector on one mesh, printing a row for each
+static void benchmarkMesh(cWorld* world, cMesh* mesh, const std::string& name) {
+	mesh->computeBoundaryBox(true);
+	world->computeGlobalPositions(true);
+
+	double diagonal = cDistance(mesh->getBoundaryMin(), mesh->getBoundaryMax());
+	double radius = COLLISION_BENCHMARK_RADIUS * diagonal;
+
+	std::vector<CollisionQuery> queries;
+	srand(1);
+	MakeCollisionQueries(mesh, COLLISION_BENCHMARK_QUERIES, queries);
+
+	printf("\n%s: %u triangles\n", name.c_str(), mesh->getNumTriangles(true));
+	printf("%-12s %12s %14s %8s %12s\n", "", "build (ms)", "queries/s", "hits", "mismatches");
+
+	std::vector<CollisionAnswer> reference;
+	std::vector<CollisionAnswer> answers;
+
+	for (int type = 0; type < COLLISION_DETECTOR_TYPE_COUNT; type++) {
+		CollisionDetectorScore score;
+
+		cPrecisionClock clock;
+		clock.start(true);
+		CreateCollisionDetector(mesh, (CollisionDetectorType) type, radius);
+		score.buildSeconds = clock.getCurrentTimeSeconds();
+
+		// Brute force only answers enough queries to check the others against
+		int count = (type == COLLISION_DETECTOR_BRUTE_FORCE) ? COLLISION_BENCHMARK_BRUTE_QUERIES : COLLISION_BENCHMARK_QUERIES;
+		double seconds = RunCollisionQueries(mesh, queries, count, radius, answers);
+		score.queriesPerSecond = (seconds > 0) ? count / seconds : 0;
+
+		if (type == COLLISION_DETECTOR_BRUTE_FORCE) {
+			reference = answers;
+		}
+
+		score.hits = 0;
+		for (int i = 0; i < count; i++) {
+			if (answers[i].hit) {
+				score.hits++;
+			}
+		}
+		score.mismatches = countMismatches(answers, reference, diagonal);
+
+		printf("%-12s %12.2f %14.0f %8u %12u\n", detectorNames[type], score.buildSeconds * 1000, score.queriesPerSecond, score.hits, score.mismatches);
+	}
+
+	benchmarkRefit(mesh, queries, radius, diagonal);
+	benchmarkPackets(mesh, queries, radius);
+	benchmarkProximity(mesh, queries, radius, diagonal);
+}
+
+// Loads one model and scores every detector on it
+static bool benchmarkModel(const std::string& fileName) {
+	cWorld* world = new cWorld();
+	cMesh* mesh = new cMesh(world);
+	world->addChild(mesh);
+
+	if (!mesh->loadFromFile(fileName)) {
+		printf("Could not load %s\n", fileName.c_str());
+		delete world;
+		return false;
+	}
+
+	benchmarkMesh(world, mesh, fileName);
+	delete world;
+	return true;
+}
+
+int collisionBenchmark(int count, char* fileNames[]) {
+	std::vector<std::string> models;
+
+	if (count > 0) {
+		models.assign(fileNames, fileNames + count);
+	} else {
+		const char* root = getenv("CHAI_ROOT");
+		if (root == 0) {
+			printf("Set CHAI_ROOT or name the models to load\n");
+			return -1;
+		}
+
+		const char* defaults[] = COLLISION_BENCHMARK_DEFAULT_MODELS;
+		for (unsigned int i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+			models.push_back(std::string(root) + "/bin/resources/models/" + defaults[i]);
+		}
+	}
+
+	printf("%d segments per model (%d for brute force), %g of the model's size long\n",
+		COLLISION_BENCHMARK_QUERIES, COLLISION_BENCHMARK_BRUTE_QUERIES, COLLISION_BENCHMARK_SEGMENT_LENGTH);
+
+	int failures = 0;
+	for (unsigned int i = 0; i < models.size(); i++) {
+		if (!benchmarkModel(models[i])) {
+			failures++;
+		}
+	}
+
+	// Large triangles among small ones, which the sphere tree once fitted spheres too small for
+	cWorld* world = new cWorld();
+	cMesh* mesh = new cMesh(world);
+	world->addChild(mesh);
+	srand(2);
+	addMixedSizeMesh(mesh);
+	benchmarkMesh(world, mesh, "floor with walls");
+	delete world;
+
+	return (failures > 0) ? -1 : 0;
+}
+
+// A corner of a triangle, to sort by position
+struct NeighborCorner {
+	double x, y, z;
+	unsigned int triangle;
+
+	bool operator<(const NeighborCorner& other) const {
+		if (x != other.x) return x < other.x;
+		if (y != other.y) return y < other.y;
+		return z < other.z;
+	}
+};
+
+// Lists, for each triangle of 'mesh', the triangles with a corner at exactly the position of one of its own (itself included)
+static void sortedNeighbors(cMesh* mesh, std::vector<std::vector<unsigned int> >& neighbors) {
+	unsigned int numTriangles = mesh->getNumTriangles(false);
+	std::vector<NeighborCorner> corners(3 * numTriangles);
+	for (unsigned int i = 0; i < numTriangles; i++) {
+		for (int k = 0; k < 3; k++) {
+			cVector3d pos = mesh->getTriangle(i)->getVertex(k)->getPos();
+			NeighborCorner& corner = corners[3 * i + k];
+			corner.x = pos.x;
+			corner.y = pos.y;
+			corner.z = pos.z;
+			corner.triangle = i;
+		}
+	}
+	std::sort(corners.begin(), corners.end());
+
+	neighbors.assign(numTriangles, std::vector<unsigned int>());
+	unsigned int first = 0;
+	while (first < corners.size()) {
+		unsigned int last = first + 1;
+		while (last < corners.size() && !(corners[first] < corners[last])) {
+			last++;
+		}
+		for (unsigned int i = first; i < last; i++) {
+			for (unsigned int j = first; j < last; j++) {
+				neighbors[corners[i].triangle].push_back(corners[j].triangle);
+			}
+		}
+		first = last;
+	}
+
+	for (unsigned int i = 0; i < numTriangles; i++) {
+		std::sort(neighbors[i].begin(), neighbors[i].end());
+		neighbors[i].erase(std::unique(neighbors[i].begin(), neighbors[i].end()), neighbors[i].end());
+	}
+}
+
+// Counts the triangles whose neighbor list does not start with the triangle itself or holds other triangles than 'reference'
+static unsigned int countNeighborMismatches(cMesh* mesh, const std::vector<std::vector<unsigned int> >& reference) {
+	std::vector<cTriangle>& triangles = *mesh->pTriangles();
+	unsigned int mismatches = 0;
+	std::vector<unsigned int> found;
+
+	for (unsigned int i = 0; i < triangles.size(); i++) {
+		std::vector<cTriangle*>* neighbors = triangles[i].m_neighbors;
+		if (neighbors == 0 || neighbors->empty() || (*neighbors)[0] != &triangles[i]) {
+			mismatches++;
+			continue;
+		}
+
+		found.clear();
+		for (unsigned int j = 0; j < neighbors->size(); j++) {
+			found.push_back((unsigned int) ((*neighbors)[j] - &triangles[0]));
+		}
+		std::sort(found.begin(), found.end());
+		if (found != reference[i]) {
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+int neighborBenchmark(int cells) {
+	printf("%10s %12s %12s %12s\n", "triangles", "build (ms)", "neighbors", "mismatches");
+
+	for (int size = NEIGHBOR_BENCHMARK_SIZES - 1; size >= 0; size--) {
+		cWorld* world = new cWorld();
+		cMesh* mesh = new cMesh(world);
+		world->addChild(mesh);
+		AddTerrainMesh(mesh, PROXY_BENCHMARK_TERRAIN_SIZE, cells >> size);
+
+		cPrecisionClock clock;
+		clock.start(true);
+		mesh->createTriangleNeighborList(false);
+		double seconds = clock.getCurrentTimeSeconds();
+
+		std::vector<std::vector<unsigned int> > reference;
+		sortedNeighbors(mesh, reference);
+		unsigned int mismatches = countNeighborMismatches(mesh, reference);
+
+		unsigned int numTriangles = mesh->getNumTriangles(false);
+		double total = 0;
+		for (unsigned int i = 0; i < numTriangles; i++) {
+			total += mesh->getTriangle(i)->m_neighbors->size();
+		}
+
+		printf("%10u %12.1f %12.2f %12u\n", numTriangles, seconds * 1000, (numTriangles > 0) ? total / numTriangles : 0, mismatches);
+		delete world;
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "chai3d.h"
+
+// Segments per model, and how many of them brute force (which every other detector is checked against) gets
+#define COLLISION_BENCHMARK_QUERIES 200000
+#define COLLISION_BENCHMARK_BRUTE_QUERIES 500
+// Segment length and collision radius, as fractions of the model's bounding box diagonal
+//  (a proxy moves a short way each tick and has a small radius next to the object)
+#define COLLISION_BENCHMARK_SEGMENT_LENGTH 0.02
+#define COLLISION_BENCHMARK_RADIUS 0.002
+// Segments start anywhere in the model's bounding box, grown by this fraction of its size on each side
+#define COLLISION_BENCHMARK_MARGIN 0.1
+// Relative difference in hit distance allowed before a detector disagrees with brute force
+#define COLLISION_BENCHMARK_TOLERANCE 1e-9
+// Frames the model is deformed over for the refit test, and how far its vertices move (as a fraction of its size)
+#define COLLISION_BENCHMARK_DEFORM_FRAMES 20
+#define COLLISION_BENCHMARK_DEFORM_AMPLITUDE 0.05
+// Waves across the model's size
+#define COLLISION_BENCHMARK_DEFORM_WAVES 3
+// Distance the nearest point of the model is searched within, as a fraction of its size (the other search is unbounded)
+#define COLLISION_BENCHMARK_PROXIMITY_DISTANCE 0.05
+// The mixed-size model: a floor of 2 * cells * cells small triangles with this many large upright triangles on it
+#define COLLISION_BENCHMARK_MIXED_CELLS 40
+#define COLLISION_BENCHMARK_MIXED_WALLS 24
+// Segment-triangle tests timed for each way of testing triangles (spread over as many segments as that takes)
+#define COLLISION_BENCHMARK_TRIANGLE_TESTS 4000000
+
+// The neighbor benchmark builds neighbor lists on terrains of up to 2 * cells * cells triangles, halving the side this many times
+#define NEIGHBOR_BENCHMARK_DEFAULT_CELLS 708
+#define NEIGHBOR_BENCHMARK_SIZES 4
+
+// The example models tried when none are given, relative to $(CHAI_ROOT)/bin/resources/models
+#define COLLISION_BENCHMARK_DEFAULT_MODELS { "bunny/bunny.obj", "ducky/duck-full.obj", "tooth/tooth.3ds", "gear/gear.3ds", "face/face.3ds" }
+
+// The collision detectors a cMesh can be given
+enum CollisionDetectorType {
+	COLLISION_DETECTOR_BRUTE_FORCE,
+	COLLISION_DETECTOR_AABB,
+	COLLISION_DETECTOR_SPHERE_TREE,
+	COLLISION_DETECTOR_BVH,
+	COLLISION_DETECTOR_TYPE_COUNT
+};
+
+// A short segment near the model
+struct CollisionQuery {
+	cVector3d start;
+	cVector3d end;
+};
+
+// What one query found: whether it hit, and how far along
+struct CollisionAnswer {
+	bool hit;
+	double squareDistance;
+};
+
+// How a detector did on one model
+struct CollisionDetectorScore {
+	double buildSeconds;
+	double queriesPerSecond;
+	unsigned int hits;
+	// Queries (of those brute force answered) where the detector found a different nearest hit
+	unsigned int mismatches;
+};
+
+// The undeformed vertex positions of a mesh and its children, so it can be deformed again and again
+struct CollisionRestPose {
+	std::vector<cMesh*> meshes;
+	std::vector<std::vector<cVector3d> > positions;
+};
+
+// Gives 'mesh' (and its children) a collision detector of 'type', with 'radius' around the triangles
+void CreateCollisionDetector(cMesh* mesh, CollisionDetectorType type, double radius);
+// Makes 'count' random segments in and around 'mesh'
+void MakeCollisionQueries(cMesh* mesh, int count, std::vector<CollisionQuery>& queries);
+// Remembers the vertex positions of 'mesh' and its children
+void StoreRestPose(cMesh* mesh, CollisionRestPose& pose);
+// Moves every vertex from its rest position along a travelling wave ('amplitude' 0 restores the rest pose)
+void DeformMesh(CollisionRestPose& pose, double amplitude, double waveNumber, double phase);
+// Runs the first 'count' queries against 'mesh' for the nearest collision only, as the proxy does
+double RunCollisionQueries(cMesh* mesh, const std::vector<CollisionQuery>& queries, int count, double radius, std::vector<CollisionAnswer>& answers);
+
+// Times building each collision detector for the given models (or the example models if 'count' is 0) and a floor with walls,
+//  how many segments per second each can test, refitting the trees as the models deform, testing
+//  triangles in packets against testing them one at a time, and finding the nearest point of the model
+int collisionBenchmark(int count, char* fileNames[]);
+
+// Times building triangle neighbor lists on terrains of growing size, up to 2 * cells * cells triangles,
+//  checking them against lists found by sorting the triangles' corners by position
+int neighborBenchmark(int cells);
\ No newline at end of file
@@ -26,9 +26,12 @@ public:
 	~HapticsFluidTest();
 	void GetVelocityAt(cVector3d& velocity, const cVector3d& location);
 	void GetAllPoints(std::vector<IFluidParticle*>&) {}
+	void GetFrame(FluidFrame& frame) { frame.positions = 0; frame.velocities = 0; frame.count = 0; frame.version = 0; }
 	double GetMaxParticleSpeed(void);
+	void GetSpeedStats(FluidSpeedStats& stats) { stats.SetUniform(GetMaxParticleSpeed()); }
 	virtual void AdvanceFrame(void) {};
 	int GetCurrentPointCount(void) { return 0; };
+	int GetMaxSimulatedParticles() { return 0; };
 private:
 	HapticTestRunner * testRunner;
 };
\ No newline at end of file
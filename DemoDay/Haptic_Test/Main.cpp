@@ -1,19 +1,23 @@
 #include "chai3d.h"
 
 #include "FalconDevice.h"
+#include "HapticScheduler.h"
 #include "HapticsFluidTest.h"
+#include "RecordingHapticDevice.h"
+#include "ReplayHapticDevice.h"
 #include "IHapticMode.h"
 #include "UniformViscositySenseMode.h"
 #include "DirectionalViscositySenseMode.h"
 #include "VirtualHapticDevice.h"
+#include "VelocityBenchmark.h"
+#include "ProxyBenchmark.h"
+#include "CollisionBenchmark.h"
+#include "RenderBenchmark.h"
 
 cHapticDeviceHandler handler;
 
-// Global functions
-// TODO: See if you can wrap this in a class or namespace
-IFluid* fluid = 0;
-ITerrain* terrain = 0;
-IHapticDevice* hapticDevice = 0;
+// Where the modes' telemetry is written
+#define TELEMETRY_FILE_NAME "haptic_telemetry.csv"
 
 // function prototypes for main
 int uniformViscosity (void);
@@ -21,8 +25,75 @@ int directionalViscosity(void);
 int oscillating(void);
 int nathanMain(void);
 int virtualTest(void);
+int timingTest(double rate, double seconds);
+int tickBenchmark(double seconds);
+int recordSession(const char* fileName, double seconds);
+int replaySession(const char* fileName);
+int runHaptics(IHapticMode* mode);
+
+int	main(int argc, char* argv[]) {
+	// --timing [rate] [seconds] checks the haptic scheduler's timing against the virtual device, without any hardware
+	if (argc > 1 && strcmp(argv[1], "--timing") == 0) {
+		double rate = (argc > 2) ? atof(argv[2]) : HAPTIC_SCHEDULER_DEFAULT_RATE;
+		double seconds = (argc > 3) ? atof(argv[3]) : 10;
+		return timingTest(rate, seconds);
+	}
+
+	// --tick-benchmark [seconds] ticks the directional mode as fast as it will go with telemetry on
+	if (argc > 1 && strcmp(argv[1], "--tick-benchmark") == 0) {
+		return tickBenchmark((argc > 2) ? atof(argv[2]) : 5);
+	}
+
+	// --record <file> [seconds] runs the directional mode and logs every tick for --replay
+	if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+		return recordSession(argv[2], (argc > 3) ? atof(argv[3]) : 10);
+	}
+
+	// --replay <file> ticks the directional mode through a log as fast as it will go and checks its forces
+	if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+		return replaySession(argv[2]);
+	}
+
+	// --velocity-benchmark [file] scores the velocity estimators on a synthetic trajectory, or on a --record log
+	if (argc > 1 && strcmp(argv[1], "--velocity-benchmark") == 0) {
+		return velocityBenchmark((argc > 2) ? argv[2] : 0);
+	}
+
+	// --proxy-benchmark [objects] times the proxy algorithm's servo loop with and without the collision broad phase
+	if (argc > 1 && strcmp(argv[1], "--proxy-benchmark") == 0) {
+		return proxyBenchmark((argc > 2) ? atoi(argv[2]) : PROXY_BENCHMARK_DEFAULT_OBJECTS);
+	}
+
+	// --contact-benchmark [cells] times the proxy sliding over a large mesh with and without testing its recent contacts first
+	if (argc > 1 && strcmp(argv[1], "--contact-benchmark") == 0) {
+		return contactBenchmark((argc > 2) ? atoi(argv[2]) : PROXY_BENCHMARK_DEFAULT_TERRAIN_CELLS);
+	}
+
+	// --collision-benchmark [models...] times building and querying each mesh collision detector on the given models
+	if (argc > 1 && strcmp(argv[1], "--collision-benchmark") == 0) {
+		return collisionBenchmark(argc - 2, argv + 2);
+	}
+
+	// --neighbor-benchmark [cells] times building triangle neighbor lists on terrains of up to 2 * cells * cells triangles
+	if (argc > 1 && strcmp(argv[1], "--neighbor-benchmark") == 0) {
+		return neighborBenchmark((argc > 2) ? atoi(argv[2]) : NEIGHBOR_BENCHMARK_DEFAULT_CELLS);
+	}
+
+	// --render-benchmark [models...] times drawing the given models and a large terrain each way a cMesh can render
+	if (argc > 1 && strcmp(argv[1], "--render-benchmark") == 0) {
+		return renderBenchmark(argc - 2, argv + 2);
+	}
+
+	// --culling-benchmark [side] times drawing a grid of spheres between walls with and without frustum and occlusion culling
+	if (argc > 1 && strcmp(argv[1], "--culling-benchmark") == 0) {
+		return cullingBenchmark((argc > 2) ? atoi(argv[2]) : CULLING_BENCHMARK_DEFAULT_SIDE);
+	}
+
+	// --layout-benchmark [models...] times loading, drawing and querying the given models in file order and optimized for the vertex cache
+	if (argc > 1 && strcmp(argv[1], "--layout-benchmark") == 0) {
+		return layoutBenchmark(argc - 2, argv + 2);
+	}
 
-int	main(void) {
 	int fncToRun = 4;
 
 	switch (fncToRun) {
@@ -42,89 +113,210 @@ int	main(void) {
 int uniformViscosity (void) {
 	FalconDevice falcon;
 	falcon.Init();
-	hapticDevice = &falcon;
-
-	IHapticMode* mode = UniformViscositySenseMode::GetSingleton();
-	falcon.SetMode(mode);
 
-	while (true) {
-		mode->Tick();
-	}
+	HapticTelemetry telemetry(TELEMETRY_FILE_NAME);
+	UniformViscositySenseMode mode(&falcon, &telemetry);
+	falcon.SetMode(&mode);
 
-	return 0;
+	return runHaptics(&mode);
 }
 
 int directionalViscosity (void) {
 	FalconDevice falcon;
 	falcon.Init();
-	hapticDevice = &falcon;
-
-	IHapticMode* mode = DirectionalViscositySenseMode::GetSingleton();
-	falcon.SetMode(mode);
 
 	cVector3d initial(-0.025, 0, 0);
 	HapticsFluidTest oneDirecionFluid(HapticsFluidTest::CONSTANT_VELOCITY, initial);
-	fluid = &oneDirecionFluid;
 
-	while (true) {
-		mode->Tick();
-	}
+	HapticTelemetry telemetry(TELEMETRY_FILE_NAME);
+	DirectionalViscositySenseMode mode(&falcon, &oneDirecionFluid, &telemetry);
+	falcon.SetMode(&mode);
 
-	return 0;
+	return runHaptics(&mode);
 }
 
 int oscillating(void) {
 	FalconDevice falcon;
 	falcon.Init();
-	hapticDevice = &falcon;
-
-	IHapticMode* mode = DirectionalViscositySenseMode::GetSingleton();
-	falcon.SetMode(mode);
 
 	printf("osc fluid\n");
 	cVector3d initial(-1.0, 0, 0);
 	HapticsFluidTest oscFluid(HapticsFluidTest::X_AXIS_OSCILLATING, initial);
-	fluid = &oscFluid;
 
-	while (true) {
-		mode->Tick();
-	}
+	HapticTelemetry telemetry(TELEMETRY_FILE_NAME);
+	DirectionalViscositySenseMode mode(&falcon, &oscFluid, &telemetry);
+	falcon.SetMode(&mode);
 
-	return 0;
+	return runHaptics(&mode);
 }
 
 int nathanMain(void) {
 	FalconDevice falcon;
 	falcon.Init();
 
-	IHapticMode* mode = UniformViscositySenseMode::GetSingleton();
-	falcon.SetMode(mode);
+	HapticTelemetry telemetry(TELEMETRY_FILE_NAME);
+	UniformViscositySenseMode mode(&falcon, &telemetry);
+	falcon.SetMode(&mode);
+
+	return runHaptics(&mode);
+}
+
+int virtualTest(void) {
+	VirtualHapticDevice virtDevice;
+	virtDevice.Init();
+
+	cVector3d initial(1.0, 0, 0);
+	HapticsFluidTest oneDirecionFluid(HapticsFluidTest::CONSTANT_VELOCITY, initial);
+
+	HapticTelemetry telemetry(TELEMETRY_FILE_NAME);
+	DirectionalViscositySenseMode mode(&virtDevice, &oneDirecionFluid, &telemetry);
+	virtDevice.SetMode(&mode);
+
+	return runHaptics(&mode);
+}
+
+// Prints how well the scheduler has kept to its rate so far
+void printTiming(HapticScheduler& scheduler) {
+	HapticTimingStats stats;
+	scheduler.GetStats(stats);
 
-	cVector3d initial(0.5, 0.1, 0.2);
-	fluid = new HapticsFluidTest(HapticsFluidTest::CONSTANT_VELOCITY, initial);
-	
+	printf("%.0f Hz: %u ticks, %u overruns, %u skipped\n", stats.rate, stats.ticks, stats.overruns, stats.skipped);
+	printf("  late by (us):   p50 %7.1f  p99 %7.1f  p99.9 %7.1f  max %7.1f\n",
+		stats.GetJitterPercentile(0.5) * 1000000, stats.GetJitterPercentile(0.99) * 1000000,
+		stats.GetJitterPercentile(0.999) * 1000000, stats.maxJitter * 1000000);
+	printf("  tick took (us): p50 %7.1f  p99 %7.1f  p99.9 %7.1f  max %7.1f\n",
+		stats.GetDurationPercentile(0.5) * 1000000, stats.GetDurationPercentile(0.99) * 1000000,
+		stats.GetDurationPercentile(0.999) * 1000000, stats.maxDuration * 1000000);
+}
+
+// Waits on the main thread while the scheduler runs, printing its timing every 'interval' seconds
+void waitAndReport(HapticScheduler& scheduler, double seconds, double interval) {
+	cPrecisionClock clock;
+	clock.start(true);
+	double nextReport = interval;
 
-	while (true) {
-		mode->Tick();
+	while (seconds <= 0 || clock.getCurrentTimeSeconds() < seconds) {
+		cSleepMs(10);
+		if (clock.getCurrentTimeSeconds() >= nextReport) {
+			printTiming(scheduler);
+			nextReport += interval;
+		}
 	}
+}
+
+// Ticks 'mode' on the haptic scheduler until the program is closed
+int runHaptics(IHapticMode* mode) {
+	HapticScheduler scheduler(mode);
+	scheduler.Start();
+	waitAndReport(scheduler, 0, 5);
+
 	return 0;
 }
 
-int virtualTest(void) {
+int timingTest(double rate, double seconds) {
+	VirtualHapticDevice virtDevice;
+	virtDevice.Init();
+
+	cVector3d initial(1.0, 0, 0);
+	HapticsFluidTest oneDirecionFluid(HapticsFluidTest::CONSTANT_VELOCITY, initial);
+
+	HapticTelemetry telemetry(TELEMETRY_FILE_NAME);
+	DirectionalViscositySenseMode mode(&virtDevice, &oneDirecionFluid, &telemetry);
+	virtDevice.SetMode(&mode);
+
+	HapticScheduler scheduler(&mode, rate);
+	scheduler.Start();
+	waitAndReport(scheduler, seconds, 1);
+	scheduler.Stop();
+
+	printf("Final timing:\n");
+	printTiming(scheduler);
+	printf("Telemetry: %u records written, %u dropped\n", telemetry.GetWrittenCount(), telemetry.GetDroppedCount());
+
+	return 0;
+}
+
+int tickBenchmark(double seconds) {
+	VirtualHapticDevice virtDevice;
+	virtDevice.Init();
+
+	cVector3d initial(1.0, 0, 0);
+	HapticsFluidTest oneDirecionFluid(HapticsFluidTest::CONSTANT_VELOCITY, initial);
+
+	HapticTelemetry telemetry(TELEMETRY_FILE_NAME);
+	DirectionalViscositySenseMode mode(&virtDevice, &oneDirecionFluid, &telemetry);
+	virtDevice.SetMode(&mode);
+
+	// Tick back to back on this thread, the way the scheduler would if it never had to wait
+	cPrecisionClock clock;
+	clock.start(true);
+	unsigned int ticks = 0;
+	double slowest = 0;
+	double last = 0;
+	while (last < seconds) {
+		mode.Tick();
+		ticks++;
+
+		double now = clock.getCurrentTimeSeconds();
+		if (now - last > slowest) {
+			slowest = now - last;
+		}
+		last = now;
+	}
+
+	printf("%u ticks in %.2f s: %.0f ticks per second, slowest tick %.1f us\n", ticks, last, ticks / last, slowest * 1000000);
+	printf("Telemetry: %u records pushed, %u dropped\n", ticks - telemetry.GetDroppedCount(), telemetry.GetDroppedCount());
+
+	return 0;
+}
+
+int recordSession(const char* fileName, double seconds) {
+	// Swap in a FalconDevice to record a real session
 	VirtualHapticDevice virtDevice;
 	virtDevice.Init();
-	hapticDevice = &virtDevice;
-	
-	IHapticMode* mode = DirectionalViscositySenseMode::GetSingleton();
-	virtDevice.SetMode(mode);
 
+	RecordingHapticDevice recorder(&virtDevice, fileName);
+	if (!recorder.IsRecording()) {
+		printf("Couldn't open %s\n", fileName);
+		return 1;
+	}
+
+	// Replay has to use the same fluid to get the same forces
 	cVector3d initial(1.0, 0, 0);
 	HapticsFluidTest oneDirecionFluid(HapticsFluidTest::CONSTANT_VELOCITY, initial);
-	fluid = &oneDirecionFluid;
 
-	while (true) {
-		mode->Tick();
+	DirectionalViscositySenseMode mode(&recorder, &oneDirecionFluid);
+	recorder.SetMode(&mode);
+
+	HapticScheduler scheduler(&mode);
+	scheduler.Start();
+	waitAndReport(scheduler, seconds, 1);
+	scheduler.Stop();
+	recorder.Close();
+
+	printf("Recorded %u ticks to %s\n", recorder.GetSampleCount(), fileName);
+
+	return 0;
+}
+
+int replaySession(const char* fileName) {
+	ReplayHapticDevice replay;
+	if (!replay.Load(fileName)) {
+		printf("%s isn't a haptic log\n", fileName);
+		return 1;
 	}
 
+	cVector3d initial(1.0, 0, 0);
+	HapticsFluidTest oneDirecionFluid(HapticsFluidTest::CONSTANT_VELOCITY, initial);
+
+	DirectionalViscositySenseMode mode(&replay, &oneDirecionFluid);
+	replay.SetMode(&mode);
+
+	HapticReplayResult result = replay.Replay(&mode);
+
+	printf("Replayed %u ticks (%.2f s recorded) in %.3f s: %.0f ticks per second\n", result.ticks, result.recordedSeconds,
+		result.replaySeconds, (result.replaySeconds > 0) ? result.ticks / result.replaySeconds : 0);
+	printf("Force error (N): mean %g, max %g\n", result.meanForceError, result.maxForceError);
+
 	return 0;
 }
\ No newline at end of file
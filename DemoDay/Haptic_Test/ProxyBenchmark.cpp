@@ -0,0 +1,275 @@
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+
+#include "ProxyBenchmark.h"
+
+void AddSphereMesh(cMesh* mesh, double radius, int slices) {
+	int stacks = slices / 2;
+	unsigned int first = mesh->getNumVertices();
+
+	for (int stack = 0; stack <= stacks; stack++) {
+		double polar = CHAI_PI * stack / stacks;
+		for (int slice = 0; slice < slices; slice++) {
+			double azimuth = 2 * CHAI_PI * slice / slices;
+			mesh->newVertex(radius * sin(polar) * cos(azimuth), radius * sin(polar) * sin(azimuth), radius * cos(polar));
+		}
+	}
+
+	// Counter-clockwise from outside
+	for (int stack = 0; stack < stacks; stack++) {
+		for (int slice = 0; slice < slices; slice++) {
+			unsigned int a = first + stack * slices + slice;
+			unsigned int b = first + stack * slices + (slice + 1) % slices;
+			unsigned int c = a + slices;
+			unsigned int d = b + slices;
+			if (stack > 0) {
+				mesh->newTriangle(a, c, b);
+			}
+			if (stack < stacks - 1) {
+				mesh->newTriangle(b, c, d);
+			}
+		}
+	}
+}
+
+cWorld* BuildProxyScene(int objects) {
+	cWorld* world = new cWorld();
+
+	// As close to a cube as the count allows
+	int side = (int) ceil(pow((double) objects, 1.0 / 3.0));
+	double offset = 0.5 * (side - 1) * PROXY_BENCHMARK_SPACING;
+
+	for (int i = 0; i < objects; i++) {
+		cMesh* mesh = new cMesh(world);
+		AddSphereMesh(mesh, PROXY_BENCHMARK_SPHERE_RADIUS, PROXY_BENCHMARK_SPHERE_SLICES);
+		mesh->setPos((i % side) * PROXY_BENCHMARK_SPACING - offset,
+			((i / side) % side) * PROXY_BENCHMARK_SPACING - offset,
+			(i / (side * side)) * PROXY_BENCHMARK_SPACING - offset);
+		mesh->computeAllNormals();
+		mesh->createAABBCollisionDetector(PROXY_BENCHMARK_PROXY_RADIUS, true, false);
+		mesh->computeBoundaryBox(true);
+		world->addChild(mesh);
+	}
+
+	// Twice, so the previous frames match and the dynamic proxy sees the spheres standing still
+	world->computeGlobalPositions(true);
+	world->computeGlobalPositions(true);
+	return world;
+}
+
+double TerrainHeight(double x, double y) {
+	double k = 2 * CHAI_PI * PROXY_BENCHMARK_TERRAIN_WAVES / PROXY_BENCHMARK_TERRAIN_SIZE;
+	return PROXY_BENCHMARK_TERRAIN_BUMP * sin(k * x) * sin(k * y);
+}
+
+void AddTerrainMesh(cMesh* mesh, double size, int cells) {
+	unsigned int first = mesh->getNumVertices();
+
+	for (int row = 0; row <= cells; row++) {
+		double y = size * ((double) row / cells - 0.5);
+		for (int column = 0; column <= cells; column++) {
+			double x = size * ((double) column / cells - 0.5);
+			mesh->newVertex(x, y, TerrainHeight(x, y));
+		}
+	}
+
+	// Counter-clockwise from above
+	for (int row = 0; row < cells; row++) {
+		for (int column = 0; column < cells; column++) {
+			unsigned int a = first + row * (cells + 1) + column;
+			unsigned int b = a + 1;
+			unsigned int d = a + cells + 1;
+			unsigned int e = d + 1;
+			mesh->newTriangle(a, b, e);
+			mesh->newTriangle(a, e, d);
+		}
+	}
+}
+
+// Fills in the tick statistics from the time each tick took
+static void SummarizeTicks(std::vector<double>& ticks, ProxyRunResult& result) {
+	double total = 0;
+	for (unsigned int i = 0; i < ticks.size(); i++) {
+		total += ticks[i];
+	}
+	result.meanTick = total / ticks.size();
+
+	std::sort(ticks.begin(), ticks.end());
+	result.medianTick = ticks[ticks.size() / 2];
+	result.p99Tick = ticks[(ticks.size() * 99) / 100];
+	result.worstTick = ticks.back();
+}
+
+void RunProxy(cWorld* world, cProxyPointForceAlgo& proxy, ProxyRunResult& result) {
+	// Wander around the middle of the grid on a slow Lissajous path, so the proxy keeps running into the nearby spheres
+	double extent = PROXY_BENCHMARK_REACH;
+
+	cVector3d start(-extent, 0, 0);
+	proxy.initialize(world, start);
+	proxy.setProxyRadius(PROXY_BENCHMARK_PROXY_RADIUS);
+
+	result.contactTicks = 0;
+	result.forces.resize(PROXY_BENCHMARK_TICKS);
+	std::vector<double> ticks(PROXY_BENCHMARK_TICKS);
+
+	cPrecisionClock clock;
+	clock.start(true);
+	double last = 0;
+
+	for (int tick = 0; tick < PROXY_BENCHMARK_TICKS; tick++) {
+		double t = (double) tick / PROXY_BENCHMARK_TICKS;
+		cVector3d device(-extent * cos(2 * CHAI_PI * 3 * t), extent * sin(2 * CHAI_PI * 5 * t), extent * sin(2 * CHAI_PI * 7 * t));
+
+		result.forces[tick] = proxy.computeForces(device, cVector3d(0, 0, 0));
+		if (proxy.getNumContacts() > 0) {
+			result.contactTicks++;
+		}
+
+		double now = clock.getCurrentTimeSeconds();
+		ticks[tick] = now - last;
+		last = now;
+	}
+
+	SummarizeTicks(ticks, result);
+}
+
+void RunSlidingProxy(cWorld* world, cProxyPointForceAlgo& proxy, ProxyRunResult& result) {
+	// Lower the device onto the start of the circle, then go around it twice, pressing into the bumps as a user stroking the surface would
+	double radius = PROXY_BENCHMARK_SLIDE_RADIUS;
+	double above = 4 * PROXY_BENCHMARK_TERRAIN_PROXY_RADIUS;
+
+	cVector3d start(radius, 0, TerrainHeight(radius, 0) + above);
+	proxy.initialize(world, start);
+	proxy.setProxyRadius(PROXY_BENCHMARK_TERRAIN_PROXY_RADIUS);
+
+	result.contactTicks = 0;
+	result.forces.resize(PROXY_BENCHMARK_TICKS);
+	std::vector<double> ticks(PROXY_BENCHMARK_TICKS);
+
+	cPrecisionClock clock;
+	clock.start(true);
+	double last = 0;
+
+	for (int tick = 0; tick < PROXY_BENCHMARK_TICKS; tick++) {
+		cVector3d device;
+		if (tick < PROXY_BENCHMARK_APPROACH_TICKS) {
+			double t = (double) tick / PROXY_BENCHMARK_APPROACH_TICKS;
+			device.set(radius, 0, TerrainHeight(radius, 0) + above - t * (above + PROXY_BENCHMARK_PRESS_DEPTH));
+		} else {
+			double t = (double) (tick - PROXY_BENCHMARK_APPROACH_TICKS) / (PROXY_BENCHMARK_TICKS - PROXY_BENCHMARK_APPROACH_TICKS);
+			double x = radius * cos(2 * CHAI_PI * 2 * t);
+			double y = radius * sin(2 * CHAI_PI * 2 * t);
+			device.set(x, y, TerrainHeight(x, y) - PROXY_BENCHMARK_PRESS_DEPTH);
+		}
+
+		result.forces[tick] = proxy.computeForces(device, cVector3d(0, 0, 0));
+		if (proxy.getNumContacts() > 0) {
+			result.contactTicks++;
+		}
+
+		double now = clock.getCurrentTimeSeconds();
+		ticks[tick] = now - last;
+		last = now;
+	}
+
+	SummarizeTicks(ticks, result);
+}
+
+int proxyBenchmark(int objects) {
+	cWorld* world = BuildProxyScene(objects);
+	printf("%d spheres of %u triangles, %d ticks\n", objects, ((cMesh*) world->getChild(0))->getNumTriangles(), PROXY_BENCHMARK_TICKS);
+
+	cProxyPointForceAlgo sceneGraph;
+	ProxyRunResult walked;
+	RunProxy(world, sceneGraph, walked);
+
+	cProxyPointForceAlgo broadPhase;
+	broadPhase.m_useBroadPhase = true;
+	ProxyRunResult culled;
+	RunProxy(world, broadPhase, culled);
+
+	double maxDifference = 0;
+	for (int tick = 0; tick < PROXY_BENCHMARK_TICKS; tick++) {
+		double difference = cDistance(walked.forces[tick], culled.forces[tick]);
+		if (difference > maxDifference) {
+			maxDifference = difference;
+		}
+	}
+
+	printf("%-12s %12s %12s %12s %12s %10s\n", "", "mean (us)", "median (us)", "p99 (us)", "worst (us)", "contacts");
+	printf("%-12s %12.2f %12.2f %12.2f %12.2f %10u\n", "scene graph", walked.meanTick * 1000000, walked.medianTick * 1000000,
+		walked.p99Tick * 1000000, walked.worstTick * 1000000, walked.contactTicks);
+	printf("%-12s %12.2f %12.2f %12.2f %12.2f %10u\n", "broad phase", culled.meanTick * 1000000, culled.medianTick * 1000000,
+		culled.p99Tick * 1000000, culled.worstTick * 1000000, culled.contactTicks);
+	printf("Largest force difference: %g N\n", maxDifference);
+
+	delete world;
+	return 0;
+}
+
+// Slides the proxy over the terrain with its current detector, and prints how it went
+static void RunContactProxy(cWorld* world, cMesh* terrain, bool useContactCache, const char* name, double build,
+	const ProxyRunResult* reference, ProxyRunResult& result) {
+	cProxyPointForceAlgo proxy;
+	proxy.m_useContactCache = useContactCache;
+	RunSlidingProxy(world, proxy, result);
+
+	// How many of the queries the triangles around the last contact answered
+	double answered = 0;
+	const cCollisionContactCache* cache = 0;
+	if (cCollisionAABB* aabb = dynamic_cast<cCollisionAABB*>(terrain->getCollisionDetector())) {
+		cache = &aabb->getContactCache();
+	} else if (cCollisionBVH* bvh = dynamic_cast<cCollisionBVH*>(terrain->getCollisionDetector())) {
+		cache = &bvh->getContactCache();
+	}
+	if (useContactCache && cache && cache->getNumQueries() > 0) {
+		answered = 100.0 * cache->getNumAnswered() / cache->getNumQueries();
+	}
+
+	double maxDifference = 0;
+	if (reference) {
+		for (int tick = 0; tick < PROXY_BENCHMARK_TICKS; tick++) {
+			double difference = cDistance(reference->forces[tick], result.forces[tick]);
+			if (difference > maxDifference) {
+				maxDifference = difference;
+			}
+		}
+	}
+
+	printf("%-16s %10.0f %12.2f %12.2f %12.2f %10u %10.1f %12g\n", name, build * 1000, result.medianTick * 1000000, result.p99Tick * 1000000,
+		result.worstTick * 1000000, result.contactTicks, answered, maxDifference);
+}
+
+int contactBenchmark(int cells) {
+	cWorld* world = new cWorld();
+	cMesh* terrain = new cMesh(world);
+	AddTerrainMesh(terrain, PROXY_BENCHMARK_TERRAIN_SIZE, cells);
+	terrain->computeAllNormals();
+	terrain->computeBoundaryBox(true);
+	world->addChild(terrain);
+	world->computeGlobalPositions(true);
+	world->computeGlobalPositions(true);
+
+	printf("Terrain of %u triangles, %d ticks sliding in contact\n", terrain->getNumTriangles(), PROXY_BENCHMARK_TICKS);
+	printf("%-16s %10s %12s %12s %12s %10s %10s %12s\n", "", "build (ms)", "median (us)", "p99 (us)", "worst (us)", "contacts",
+		"cached (%)", "force diff");
+
+	ProxyRunResult aabb, aabbCached, bvh, bvhCached;
+	cPrecisionClock clock;
+
+	clock.start(true);
+	terrain->createAABBCollisionDetector(PROXY_BENCHMARK_TERRAIN_PROXY_RADIUS, false, false);
+	double build = clock.getCurrentTimeSeconds();
+	RunContactProxy(world, terrain, false, "AABB", build, 0, aabb);
+	RunContactProxy(world, terrain, true, "AABB + contacts", build, &aabb, aabbCached);
+
+	clock.start(true);
+	terrain->createBVHCollisionDetector(PROXY_BENCHMARK_TERRAIN_PROXY_RADIUS, false, false);
+	build = clock.getCurrentTimeSeconds();
+	RunContactProxy(world, terrain, false, "BVH", build, &aabb, bvh);
+	RunContactProxy(world, terrain, true, "BVH + contacts", build, &aabb, bvhCached);
+
+	delete world;
+	return 0;
+}
\ No newline at end of file
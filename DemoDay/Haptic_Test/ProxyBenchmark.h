@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "chai3d.h"
+
+// The scene is a grid of tessellated spheres, PROXY_BENCHMARK_SPACING apart
+#define PROXY_BENCHMARK_DEFAULT_OBJECTS 125
+#define PROXY_BENCHMARK_SPACING 0.1
+#define PROXY_BENCHMARK_SPHERE_RADIUS 0.03
+#define PROXY_BENCHMARK_SPHERE_SLICES 16
+#define PROXY_BENCHMARK_PROXY_RADIUS 0.005
+// The device explores this far around the middle of the grid, like a user feeling the few objects in reach
+#define PROXY_BENCHMARK_REACH 0.15
+// Servo ticks per run (the device path is the same every run)
+#define PROXY_BENCHMARK_TICKS 20000
+
+// The contact benchmark slides the proxy over a bumpy square of terrain, 2 * cells * cells triangles
+#define PROXY_BENCHMARK_DEFAULT_TERRAIN_CELLS 708
+#define PROXY_BENCHMARK_TERRAIN_SIZE 0.4
+#define PROXY_BENCHMARK_TERRAIN_BUMP 0.005
+#define PROXY_BENCHMARK_TERRAIN_WAVES 8
+// A proxy sized to the terrain's detail: only a few triangles lie under it
+#define PROXY_BENCHMARK_TERRAIN_PROXY_RADIUS 0.001
+// The device circles this far from the middle, held this far below the surface
+#define PROXY_BENCHMARK_SLIDE_RADIUS 0.1
+#define PROXY_BENCHMARK_PRESS_DEPTH 0.005
+// Ticks spent lowering the device onto the surface before it starts circling twice
+#define PROXY_BENCHMARK_APPROACH_TICKS 500
+
+// How a run of the proxy algorithm went
+struct ProxyRunResult {
+	double meanTick;
+	double medianTick;
+	double p99Tick;
+	double worstTick;
+	// Ticks where the proxy touched something
+	unsigned int contactTicks;
+	std::vector<cVector3d> forces;
+};
+
+// Adds a UV sphere of 'radius' around the mesh's origin, with 'slices' segments around and slices / 2 from pole to pole
+void AddSphereMesh(cMesh* mesh, double radius, int slices);
+// Builds a world holding 'objects' collidable spheres
+cWorld* BuildProxyScene(int objects);
+// Adds a square of 'cells' by 'cells' quads, 'size' across, with sine bumps
+void AddTerrainMesh(cMesh* mesh, double size, int cells);
+// Height of the terrain's surface above a point
+double TerrainHeight(double x, double y);
+// Drives a proxy through 'world' on the benchmark path, one computeForces per tick
+void RunProxy(cWorld* world, cProxyPointForceAlgo& proxy, ProxyRunResult& result);
+// Presses the proxy onto the terrain in 'world' and slides it around a circle, one computeForces per tick
+void RunSlidingProxy(cWorld* world, cProxyPointForceAlgo& proxy, ProxyRunResult& result);
+
+// Times the proxy's servo loop in a scene of 'objects' spheres, walking the scene graph and then through the broad phase
+int proxyBenchmark(int objects);
+// Times the proxy's servo loop sliding over a terrain of 2 * cells * cells triangles, with each tree collision detector,
+//  with and without the contact cache
+int contactBenchmark(int cells);
\ No newline at end of file
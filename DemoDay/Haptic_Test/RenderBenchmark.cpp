@@ -0,0 +1,573 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "RenderBenchmark.h"
+#include "CollisionBenchmark.h"
+#include "ProxyBenchmark.h"
+
+static const char* pathNames[MESH_RENDER_PATH_COUNT] = { "immediate", "vertex arrays", "display list", "vertex buffer" };
+static const char* cullingNames[CULLING_MODE_COUNT] = { "none", "frustum", "occlusion" };
+static const char* layoutNames[2] = { "file order", "optimized" };
+
+void SetMeshRenderPath(cMesh* mesh, MeshRenderPath path) {
+	mesh->useDisplayList(path == MESH_RENDER_DISPLAY_LIST, true);
+	mesh->useVertexArrays(path == MESH_RENDER_VERTEX_ARRAYS, true);
+	mesh->useVertexBuffer(path == MESH_RENDER_VERTEX_BUFFER, true);
+	mesh->invalidateDisplayList(true);
+}
+
+// Looks at the whole mesh from the front, lit from the viewer, with room for it to deform
+static void setUpView(cMesh* mesh) {
+	cVector3d center = cMul(0.5, cAdd(mesh->getBoundaryMin(), mesh->getBoundaryMax()));
+	double radius = 0.6 * cDistance(mesh->getBoundaryMin(), mesh->getBoundaryMax());
+
+	glViewport(0, 0, RENDER_BENCHMARK_WINDOW_SIZE, RENDER_BENCHMARK_WINDOW_SIZE);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(center.x - radius, center.x + radius, center.y - radius, center.y + radius, -center.z - radius, -center.z + radius);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	GLfloat lightPosition[] = { 0, 0, 1, 0 };
+	glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
+	glEnable(GL_LIGHT0);
+	glEnable(GL_LIGHTING);
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0, 0, 0, 1);
+}
+
+// Renders one frame and waits for OpenGL to finish it
+static void renderFrame(cMesh* mesh) {
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	mesh->renderSceneGraph();
+	glFinish();
+}
+
+static void readImage(std::vector<unsigned char>& pixels) {
+	pixels.resize(4 * RENDER_BENCHMARK_WINDOW_SIZE * RENDER_BENCHMARK_WINDOW_SIZE);
+	glReadPixels(0, 0, RENDER_BENCHMARK_WINDOW_SIZE, RENDER_BENCHMARK_WINDOW_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+}
+
+static unsigned int countDifferingPixels(const std::vector<unsigned char>& image, const std::vector<unsigned char>& reference) {
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < image.size(); i += 4) {
+		for (int channel = 0; channel < 4; channel++) {
+			if (abs((int) image[i + channel] - (int) reference[i + channel]) > RENDER_BENCHMARK_PIXEL_TOLERANCE) {
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+// Vertices sent to the vertex buffers of 'mesh' and its children so far
+static unsigned int countUploadedVertices(const CollisionRestPose& pose) {
+	unsigned int count = 0;
+	for (unsigned int m = 0; m < pose.meshes.size(); m++) {
+		count += pose.meshes[m]->getVertexBuffer().getNumUploadedVertices();
+	}
+	return count;
+}
+
+// Tells a mesh which of its vertices moved, the way the given path needs to hear it
+static void invalidateVertices(cMesh* mesh, MeshRenderPath path, unsigned int first, unsigned int count) {
+	if (path == MESH_RENDER_DISPLAY_LIST) {
+		mesh->invalidateDisplayList(false);
+	} else {
+		mesh->invalidateVertices(first, count);
+	}
+}
+
+// Pushes a span of vertices of 'mesh' in along their normals, 'depth' deep, from their rest positions
+static void dentMesh(cMesh* mesh, const std::vector<cVector3d>& rest, unsigned int first, unsigned int count, double depth) {
+	for (unsigned int i = first; i < first + count; i++) {
+		cVertex* vertex = mesh->getVertex(i);
+		vertex->setPos(cSub(rest[i], cMul(depth, vertex->getNormal())));
+	}
+}
+
+// Times each way of rendering 'mesh', printing a row for each
+static void benchmarkMesh(cMesh* mesh, const std::string& name) {
+	mesh->computeBoundaryBox(true);
+	setUpView(mesh);
+
+	double diagonal = cDistance(mesh->getBoundaryMin(), mesh->getBoundaryMax());
+	double amplitude = RENDER_BENCHMARK_DEFORM_AMPLITUDE * diagonal / sqrt(3.0);
+	double waveNumber = 2 * CHAI_PI * RENDER_BENCHMARK_DEFORM_WAVES / diagonal;
+
+	CollisionRestPose pose;
+	StoreRestPose(mesh, pose);
+
+	// The dent moves the middle of the mesh with the most vertices
+	unsigned int dented = 0;
+	for (unsigned int m = 1; m < pose.meshes.size(); m++) {
+		if (pose.positions[m].size() > pose.positions[dented].size()) {
+			dented = m;
+		}
+	}
+	unsigned int dentCount = cMin((unsigned int) RENDER_BENCHMARK_DENT_VERTICES, (unsigned int) pose.positions[dented].size());
+	unsigned int dentFirst = ((unsigned int) pose.positions[dented].size() - dentCount) / 2;
+
+	printf("\n%s: %u triangles, %u vertices\n", name.c_str(), mesh->getNumTriangles(true), mesh->getNumVertices(true));
+	printf("%-14s %12s %12s %12s %14s %14s %10s\n", "", "static (ms)", "deform (ms)", "dent (ms)",
+		"deform upload", "dent upload", "differing");
+
+	std::vector<unsigned char> reference;
+	std::vector<unsigned char> image;
+	cPrecisionClock clock;
+
+	for (int path = 0; path < MESH_RENDER_PATH_COUNT; path++) {
+		MeshRenderPath renderPath = (MeshRenderPath) path;
+		MeshRenderScore score;
+		SetMeshRenderPath(mesh, renderPath);
+		DeformMesh(pose, 0, 0, 0);
+
+		// The first frame builds the display list or fills the buffers
+		renderFrame(mesh);
+		readImage(image);
+		if (path == MESH_RENDER_IMMEDIATE) {
+			reference = image;
+		}
+		score.differingPixels = countDifferingPixels(image, reference);
+
+		clock.start(true);
+		for (int frame = 0; frame < RENDER_BENCHMARK_FRAMES; frame++) {
+			renderFrame(mesh);
+		}
+		score.staticMilliseconds = 1000 * clock.getCurrentTimeSeconds() / RENDER_BENCHMARK_FRAMES;
+
+		// Every vertex moves every frame, as a GEL deformable's do
+		unsigned int uploaded = countUploadedVertices(pose);
+		clock.start(true);
+		for (int frame = 0; frame < RENDER_BENCHMARK_FRAMES; frame++) {
+			DeformMesh(pose, amplitude, waveNumber, 2 * CHAI_PI * frame / RENDER_BENCHMARK_FRAMES);
+			for (unsigned int m = 0; m < pose.meshes.size(); m++) {
+				invalidateVertices(pose.meshes[m], renderPath, 0, pose.meshes[m]->getNumVertices(false));
+			}
+			renderFrame(mesh);
+		}
+		score.deformingMilliseconds = 1000 * clock.getCurrentTimeSeconds() / RENDER_BENCHMARK_FRAMES;
+		score.deformingUploads = (double) (countUploadedVertices(pose) - uploaded) / RENDER_BENCHMARK_FRAMES;
+
+		// Only a small span moves, as where a tool presses on the mesh
+		DeformMesh(pose, 0, 0, 0);
+		SetMeshRenderPath(mesh, renderPath);
+		renderFrame(mesh);
+		uploaded = countUploadedVertices(pose);
+		clock.start(true);
+		for (int frame = 0; frame < RENDER_BENCHMARK_FRAMES; frame++) {
+			double depth = amplitude * sin(2 * CHAI_PI * frame / RENDER_BENCHMARK_FRAMES);
+			dentMesh(pose.meshes[dented], pose.positions[dented], dentFirst, dentCount, depth);
+			invalidateVertices(pose.meshes[dented], renderPath, dentFirst, dentCount);
+			renderFrame(mesh);
+		}
+		score.dentedMilliseconds = 1000 * clock.getCurrentTimeSeconds() / RENDER_BENCHMARK_FRAMES;
+		score.dentedUploads = (double) (countUploadedVertices(pose) - uploaded) / RENDER_BENCHMARK_FRAMES;
+
+		printf("%-14s %12.2f %12.2f %12.2f %14.0f %14.0f %10u\n", pathNames[path], score.staticMilliseconds,
+			score.deformingMilliseconds, score.dentedMilliseconds, score.deformingUploads, score.dentedUploads, score.differingPixels);
+	}
+
+	DeformMesh(pose, 0, 0, 0);
+}
+
+int RunRenderBenchmark(const std::vector<std::string>& models) {
+	if (!cVertexBuffer::isSupported()) {
+		printf("This OpenGL has no vertex buffer objects; the vertex buffer falls back to vertex arrays\n");
+	}
+	printf("%d frames each, %dx%d pixels\n", RENDER_BENCHMARK_FRAMES, RENDER_BENCHMARK_WINDOW_SIZE, RENDER_BENCHMARK_WINDOW_SIZE);
+
+	int failures = 0;
+	for (unsigned int i = 0; i < models.size(); i++) {
+		cWorld* world = new cWorld();
+		cMesh* mesh = new cMesh(world);
+		world->addChild(mesh);
+
+		if (mesh->loadFromFile(models[i])) {
+			benchmarkMesh(mesh, models[i]);
+		} else {
+			printf("Could not load %s\n", models[i].c_str());
+			failures++;
+		}
+		delete world;
+	}
+
+	// A large mesh that never changes
+	cWorld* world = new cWorld();
+	cMesh* terrain = new cMesh(world);
+	world->addChild(terrain);
+	AddTerrainMesh(terrain, PROXY_BENCHMARK_TERRAIN_SIZE, RENDER_BENCHMARK_TERRAIN_CELLS);
+	terrain->computeAllNormals(true);
+	benchmarkMesh(terrain, "terrain");
+	delete world;
+
+	return (failures > 0) ? -1 : 0;
+}
+
+// Opens a window to render the benchmarks in, and makes its OpenGL context current
+static void openBenchmarkWindow(void) {
+	int argc = 1;
+	char* argv[] = { "Render Benchmark", NULL };
+	glutInit(&argc, argv);
+	glutInitWindowSize(RENDER_BENCHMARK_WINDOW_SIZE, RENDER_BENCHMARK_WINDOW_SIZE);
+	glutInitDisplayMode(GLUT_RGBA | GLUT_DEPTH | GLUT_SINGLE);
+	glutCreateWindow(argv[0]);
+}
+
+// The models named on the command line, or the example models if there are none
+static bool listModels(int count, char* fileNames[], std::vector<std::string>& models) {
+	if (count > 0) {
+		models.assign(fileNames, fileNames + count);
+	} else {
+		const char* root = getenv("CHAI_ROOT");
+		if (root == 0) {
+			printf("Set CHAI_ROOT or name the models to load\n");
+			return false;
+		}
+
+		const char* defaults[] = COLLISION_BENCHMARK_DEFAULT_MODELS;
+		for (unsigned int i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+			models.push_back(std::string(root) + "/bin/resources/models/" + defaults[i]);
+		}
+	}
+	return true;
+}
+
+int renderBenchmark(int count, char* fileNames[]) {
+	std::vector<std::string> models;
+	if (!listModels(count, fileNames, models)) {
+		return -1;
+	}
+
+	openBenchmarkWindow();
+	return RunRenderBenchmark(models);
+}
+
+// Adds a box from 'low' to 'high' to the mesh, its faces outwards
+static void addBoxMesh(cMesh* mesh, const cVector3d& low, const cVector3d& high) {
+	// Corner i is high on the axes whose bit is set in i
+	unsigned int first = mesh->getNumVertices();
+	for (int i = 0; i < 8; i++) {
+		mesh->newVertex((i & 1) ? high.x : low.x, (i & 2) ? high.y : low.y, (i & 4) ? high.z : low.z);
+	}
+
+	// Each face's corners, counter-clockwise from outside
+	const int faces[6][4] = { { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 2, 3, 1 }, { 4, 5, 7, 6 } };
+	for (int f = 0; f < 6; f++) {
+		mesh->newTriangle(first + faces[f][0], first + faces[f][1], first + faces[f][2]);
+		mesh->newTriangle(first + faces[f][0], first + faces[f][2], first + faces[f][3]);
+	}
+}
+
+cWorld* BuildCullingScene(int side, cCamera*& camera) {
+	cWorld* world = new cWorld();
+	world->setBackgroundColor(0, 0, 0);
+	double extent = 0.5 * CULLING_BENCHMARK_SPACING * side;
+
+	camera = new cCamera(world);
+	world->addChild(camera);
+	camera->setClippingPlanes(0.01, 10);
+
+	cLight* light = new cLight(world);
+	world->addChild(light);
+	light->setEnabled(true);
+	light->setDirectionalLight(true);
+	light->setDir(cVector3d(1, 0.5, -1));
+
+	// The walls come first, so they hide what is behind them
+	int blocks = (side + CULLING_BENCHMARK_WALL_COLUMNS - 1) / CULLING_BENCHMARK_WALL_COLUMNS;
+	for (int block = 1; block < blocks; block++) {
+		cMesh* wall = new cMesh(world);
+		world->addChild(wall);
+		double x = -extent + CULLING_BENCHMARK_SPACING * CULLING_BENCHMARK_WALL_COLUMNS * block;
+		addBoxMesh(wall, cVector3d(x - 0.005, -extent, -CULLING_BENCHMARK_WALL_HEIGHT / 2),
+			cVector3d(x + 0.005, extent, CULLING_BENCHMARK_WALL_HEIGHT / 2));
+		wall->computeAllNormals();
+	}
+
+	// Each block of columns between two walls is one branch of the scene graph
+	for (int block = 0; block < blocks; block++) {
+		cMesh* group = new cMesh(world);
+		world->addChild(group);
+
+		for (int column = block * CULLING_BENCHMARK_WALL_COLUMNS; column < cMin(side, (block + 1) * CULLING_BENCHMARK_WALL_COLUMNS); column++) {
+			for (int row = 0; row < side; row++) {
+				cMesh* sphere = new cMesh(world);
+				group->addChild(sphere);
+				AddSphereMesh(sphere, CULLING_BENCHMARK_SPHERE_RADIUS, CULLING_BENCHMARK_SPHERE_SLICES);
+				sphere->computeAllNormals();
+				sphere->setPos(-extent + CULLING_BENCHMARK_SPACING * (column + 0.5), -extent + CULLING_BENCHMARK_SPACING * (row + 0.5), 0);
+			}
+		}
+	}
+
+	world->computeBoundaryBox(true);
+	world->computeGlobalPositions(false);
+	return world;
+}
+
+// Points the camera from the edge of the grid, turned 'degrees' from looking across it
+static void aimCamera(cCamera* camera, int side, double degrees) {
+	double extent = 0.5 * CULLING_BENCHMARK_SPACING * side;
+	double angle = degrees * CHAI_PI / 180;
+	cVector3d position(-extent - CULLING_BENCHMARK_SPACING, 0, 0.02);
+	camera->set(position, cAdd(position, cVector3d(cos(angle), sin(angle), 0)), cVector3d(0, 0, 1));
+}
+
+static void setCullingMode(cWorld* world, CullingMode mode) {
+	world->setUseFrustumCulling(mode != CULLING_NONE, true);
+	world->setUseOcclusionCulling(mode == CULLING_FRUSTUM_AND_OCCLUSION, true);
+}
+
+// Renders one frame through the camera and waits for OpenGL to finish it
+static void renderCameraFrame(cCamera* camera) {
+	camera->renderView(RENDER_BENCHMARK_WINDOW_SIZE, RENDER_BENCHMARK_WINDOW_SIZE);
+	glFinish();
+}
+
+int RunCullingBenchmark(int side) {
+	cCamera* camera;
+	cWorld* world = BuildCullingScene(side, camera);
+	glViewport(0, 0, RENDER_BENCHMARK_WINDOW_SIZE, RENDER_BENCHMARK_WINDOW_SIZE);
+
+	if (!cOcclusionQuery::isSupported()) {
+		printf("This OpenGL has no occlusion queries; occlusion culling does nothing\n");
+	}
+
+	// The images every kind of culling should match
+	std::vector<std::vector<unsigned char> > reference(CULLING_BENCHMARK_CHECKED_VIEWS);
+	setCullingMode(world, CULLING_NONE);
+	for (int view = 0; view < CULLING_BENCHMARK_CHECKED_VIEWS; view++) {
+		aimCamera(camera, side, CULLING_BENCHMARK_TURN * ((double) view / (CULLING_BENCHMARK_CHECKED_VIEWS - 1) - 0.5));
+		renderCameraFrame(camera);
+		readImage(reference[view]);
+	}
+
+	// Without culling, everything is drawn
+	unsigned int total = cGenericObject::getRenderStatistics().m_numTrianglesDrawn;
+
+	printf("%d by %d spheres and walls (%u triangles), walls every %d columns, camera turning %d degrees over %d frames\n",
+		side, side, total, CULLING_BENCHMARK_WALL_COLUMNS, CULLING_BENCHMARK_TURN, CULLING_BENCHMARK_FRAMES);
+	printf("%-10s %10s %10s %10s %10s %14s %10s\n", "culling", "ms/frame", "drawn", "culled", "occluded", "triangles", "differing");
+
+	std::vector<unsigned char> image;
+	cPrecisionClock clock;
+	for (int mode = 0; mode < CULLING_MODE_COUNT; mode++) {
+		setCullingMode(world, (CullingMode) mode);
+
+		// Averages over the frames
+		double seconds = 0;
+		double drawn = 0;
+		double culled = 0;
+		double occluded = 0;
+		double triangles = 0;
+		for (int frame = 0; frame < CULLING_BENCHMARK_FRAMES; frame++) {
+			aimCamera(camera, side, CULLING_BENCHMARK_TURN * ((double) frame / (CULLING_BENCHMARK_FRAMES - 1) - 0.5));
+			clock.start(true);
+			renderCameraFrame(camera);
+			seconds += clock.getCurrentTimeSeconds();
+
+			const cRenderStatistics& statistics = cGenericObject::getRenderStatistics();
+			drawn += statistics.m_numObjectsDrawn;
+			culled += statistics.m_numObjectsCulled;
+			occluded += statistics.m_numObjectsOccluded;
+			triangles += statistics.m_numTrianglesDrawn;
+		}
+
+		// Occlusion culling answers a frame late, so each checked view is rendered twice
+		unsigned int differing = 0;
+		for (int view = 0; view < CULLING_BENCHMARK_CHECKED_VIEWS; view++) {
+			aimCamera(camera, side, CULLING_BENCHMARK_TURN * ((double) view / (CULLING_BENCHMARK_CHECKED_VIEWS - 1) - 0.5));
+			renderCameraFrame(camera);
+			renderCameraFrame(camera);
+			readImage(image);
+			differing += countDifferingPixels(image, reference[view]);
+		}
+
+		printf("%-10s %10.2f %10.1f %10.1f %10.1f %14.0f %10u\n", cullingNames[mode], 1000 * seconds / CULLING_BENCHMARK_FRAMES,
+			drawn / CULLING_BENCHMARK_FRAMES, culled / CULLING_BENCHMARK_FRAMES, occluded / CULLING_BENCHMARK_FRAMES,
+			triangles / CULLING_BENCHMARK_FRAMES, differing);
+	}
+
+	delete world;
+	return 0;
+}
+
+int cullingBenchmark(int side) {
+	openBenchmarkWindow();
+	return RunCullingBenchmark(side);
+}
+
+// Vertices a FIFO vertex cache of 'size' fetches per triangle, drawing the triangles of each mesh in order
+static double averageCacheMisses(const CollisionRestPose& pose, int size) {
+	unsigned int misses = 0;
+	unsigned int triangles = 0;
+	for (unsigned int m = 0; m < pose.meshes.size(); m++) {
+		cMesh* mesh = pose.meshes[m];
+
+		// A vertex is in the cache if fewer than 'size' vertices were fetched since it was
+		std::vector<int> fetched(mesh->getNumVertices(false), -size);
+		int time = 0;
+		for (unsigned int t = 0; t < mesh->getNumTriangles(false); t++) {
+			cTriangle* triangle = mesh->getTriangle(t);
+			if (!triangle->m_allocated) {
+				continue;
+			}
+
+			unsigned int vertices[3] = { triangle->getIndexVertex0(), triangle->getIndexVertex1(), triangle->getIndexVertex2() };
+			for (int k = 0; k < 3; k++) {
+				if (time - fetched[vertices[k]] >= size) {
+					fetched[vertices[k]] = time++;
+				}
+			}
+			triangles++;
+		}
+		misses += time;
+	}
+	return (triangles > 0) ? (double) misses / triangles : 0;
+}
+
+// Memory taken by the vertex and triangle arrays of each mesh
+static unsigned int countMeshBytes(const CollisionRestPose& pose) {
+	unsigned int bytes = 0;
+	for (unsigned int m = 0; m < pose.meshes.size(); m++) {
+		bytes += pose.meshes[m]->pVertices()->capacity() * sizeof(cVertex);
+		bytes += pose.meshes[m]->pTriangles()->capacity() * sizeof(cTriangle);
+	}
+	return bytes;
+}
+
+// Milliseconds it takes to load 'fileName', with or without welding and reordering it (-1 if it doesn't load)
+static double timeLoading(const std::string& fileName, bool optimize) {
+	cWorld* world = new cWorld();
+	cMesh* mesh = new cMesh(world);
+	world->addChild(mesh);
+
+	g_meshLoaderShouldOptimizeMeshes = optimize;
+	cPrecisionClock clock;
+	clock.start(true);
+	bool loaded = mesh->loadFromFile(fileName);
+	double milliseconds = 1000 * clock.getCurrentTimeSeconds();
+	g_meshLoaderShouldOptimizeMeshes = true;
+
+	delete world;
+	return loaded ? milliseconds : -1;
+}
+
+int RunLayoutBenchmark(const std::vector<std::string>& models) {
+	printf("%d frames and %d segments each, vertex cache of %d\n", LAYOUT_BENCHMARK_FRAMES, LAYOUT_BENCHMARK_QUERIES,
+		LAYOUT_BENCHMARK_CACHE_SIZE);
+
+	int failures = 0;
+	for (unsigned int i = 0; i < models.size(); i++) {
+		MeshLayoutScore scores[2];
+		scores[0].loadMilliseconds = timeLoading(models[i], false);
+		scores[1].loadMilliseconds = timeLoading(models[i], true);
+
+		// The mesh is loaded in file order and then optimized as the loader would, so both layouts are scored
+		//  on the same mesh
+		cWorld* world = new cWorld();
+		cMesh* mesh = new cMesh(world);
+		world->addChild(mesh);
+		g_meshLoaderShouldOptimizeMeshes = false;
+		bool loaded = mesh->loadFromFile(models[i]);
+		g_meshLoaderShouldOptimizeMeshes = true;
+
+		if (!loaded || scores[0].loadMilliseconds < 0) {
+			printf("Could not load %s\n", models[i].c_str());
+			failures++;
+			delete world;
+			continue;
+		}
+
+		printf("\n%s\n", models[i].c_str());
+		printf("%-11s %10s %9s %9s %9s %7s %11s %11s %11s %10s %10s\n", "", "load (ms)", "vertices", "triangles",
+			"KB", "misses", "render (ms)", "AABB q/s", "BVH q/s", "differing", "mismatches");
+
+		std::vector<unsigned char> reference;
+		std::vector<unsigned char> image;
+		std::vector<CollisionQuery> queries;
+		std::vector<CollisionAnswer> referenceAnswers[2];
+		std::vector<CollisionAnswer> answers;
+		cPrecisionClock clock;
+
+		// Textures are left off: a model's textures don't render the same from one frame to the next once
+		//  other models' textures were deleted, which would hide what the layout changes
+		mesh->setUseTexture(false, true);
+		mesh->computeBoundaryBox(true);
+		setUpView(mesh);
+		double diagonal = cDistance(mesh->getBoundaryMin(), mesh->getBoundaryMax());
+		double radius = COLLISION_BENCHMARK_RADIUS * diagonal;
+		MakeCollisionQueries(mesh, LAYOUT_BENCHMARK_QUERIES, queries);
+
+		for (int layout = 0; layout < 2; layout++) {
+			MeshLayoutScore& score = scores[layout];
+			if (layout == 1) {
+				mesh->weldVertices(true);
+				mesh->optimizeTriangleOrder(true);
+			}
+
+			CollisionRestPose pose;
+			StoreRestPose(mesh, pose);
+			score.vertices = mesh->getNumVertices(true);
+			score.triangles = mesh->getNumTriangles(true);
+			score.bytes = countMeshBytes(pose);
+			score.cacheMisses = averageCacheMisses(pose, LAYOUT_BENCHMARK_CACHE_SIZE);
+
+			// The first frame fills the buffers
+			SetMeshRenderPath(mesh, MESH_RENDER_VERTEX_BUFFER);
+			renderFrame(mesh);
+			readImage(image);
+			if (layout == 0) {
+				reference = image;
+			}
+			score.differingPixels = countDifferingPixels(image, reference);
+
+			clock.start(true);
+			for (int frame = 0; frame < LAYOUT_BENCHMARK_FRAMES; frame++) {
+				renderFrame(mesh);
+			}
+			score.renderMilliseconds = 1000 * clock.getCurrentTimeSeconds() / LAYOUT_BENCHMARK_FRAMES;
+
+			// Both layouts answer the same segments, which must find the same nearest hits
+			score.mismatches = 0;
+			CollisionDetectorType detectors[2] = { COLLISION_DETECTOR_AABB, COLLISION_DETECTOR_BVH };
+			double queriesPerSecond[2];
+			for (int d = 0; d < 2; d++) {
+				CreateCollisionDetector(mesh, detectors[d], radius);
+				queriesPerSecond[d] = LAYOUT_BENCHMARK_QUERIES / RunCollisionQueries(mesh, queries, LAYOUT_BENCHMARK_QUERIES, radius, answers);
+
+				if (layout == 0) {
+					referenceAnswers[d] = answers;
+				}
+				for (int q = 0; q < LAYOUT_BENCHMARK_QUERIES; q++) {
+					if (answers[q].hit != referenceAnswers[d][q].hit ||
+						fabs(answers[q].squareDistance - referenceAnswers[d][q].squareDistance) > COLLISION_BENCHMARK_TOLERANCE * diagonal * diagonal) {
+						score.mismatches++;
+					}
+				}
+			}
+			score.aabbQueriesPerSecond = queriesPerSecond[0];
+			score.bvhQueriesPerSecond = queriesPerSecond[1];
+
+			printf("%-11s %10.1f %9u %9u %9u %7.3f %11.2f %11.0f %11.0f %10u %10u\n", layoutNames[layout], score.loadMilliseconds,
+				score.vertices, score.triangles, score.bytes / 1024, score.cacheMisses, score.renderMilliseconds,
+				score.aabbQueriesPerSecond, score.bvhQueriesPerSecond, score.differingPixels, score.mismatches);
+		}
+		delete world;
+	}
+
+	return (failures > 0) ? -1 : 0;
+}
+
+int layoutBenchmark(int count, char* fileNames[]) {
+	std::vector<std::string> models;
+	if (!listModels(count, fileNames, models)) {
+		return -1;
+	}
+
+	openBenchmarkWindow();
+	return RunLayoutBenchmark(models);
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "chai3d.h"
+
+// Frames timed for each way of rendering, and the size of the image they are rendered to
+#define RENDER_BENCHMARK_FRAMES 20
+#define RENDER_BENCHMARK_WINDOW_SIZE 512
+// Cells along each side of the large static terrain rendered after the models
+#define RENDER_BENCHMARK_TERRAIN_CELLS 300
+// Vertices moved by the local dent each frame (one contiguous span, as a tool pressing on a mesh moves)
+#define RENDER_BENCHMARK_DENT_VERTICES 64
+// How far the model deforms (as a fraction of its size) when it moves as a whole, as GEL's deformables do
+#define RENDER_BENCHMARK_DEFORM_AMPLITUDE 0.02
+#define RENDER_BENCHMARK_DEFORM_WAVES 3
+// A pixel differs from immediate mode's if one of its channels is further off than this
+#define RENDER_BENCHMARK_PIXEL_TOLERANCE 2
+
+// The culling scene: a square grid of spheres, this many on a side by default, with walls across it every few columns
+#define CULLING_BENCHMARK_DEFAULT_SIDE 20
+#define CULLING_BENCHMARK_SPACING 0.1
+#define CULLING_BENCHMARK_SPHERE_RADIUS 0.03
+#define CULLING_BENCHMARK_SPHERE_SLICES 24
+#define CULLING_BENCHMARK_WALL_COLUMNS 5
+#define CULLING_BENCHMARK_WALL_HEIGHT 0.15
+// Frames the camera turns over, from one side to the other (in degrees) at the edge of the grid
+#define CULLING_BENCHMARK_FRAMES 90
+#define CULLING_BENCHMARK_TURN 120
+// Views whose images are compared with those rendered without culling
+#define CULLING_BENCHMARK_CHECKED_VIEWS 9
+
+// Frames timed and segments tested for each layout of a model, and the vertex cache (first in, first out) it is scored on
+#define LAYOUT_BENCHMARK_FRAMES 50
+#define LAYOUT_BENCHMARK_QUERIES 200000
+#define LAYOUT_BENCHMARK_CACHE_SIZE 16
+
+// What is skipped when the scene graph is rendered
+enum CullingMode {
+	CULLING_NONE,
+	CULLING_FRUSTUM,
+	CULLING_FRUSTUM_AND_OCCLUSION,
+	CULLING_MODE_COUNT
+};
+
+// The ways a cMesh can send its triangles to OpenGL
+enum MeshRenderPath {
+	MESH_RENDER_IMMEDIATE,
+	MESH_RENDER_VERTEX_ARRAYS,
+	MESH_RENDER_DISPLAY_LIST,
+	MESH_RENDER_VERTEX_BUFFER,
+	MESH_RENDER_PATH_COUNT
+};
+
+// How fast one way of rendering was on one mesh
+struct MeshRenderScore {
+	double staticMilliseconds;
+	double deformingMilliseconds;
+	double dentedMilliseconds;
+	// Vertices sent to the vertex buffer per frame while the mesh deforms and while it is dented (0 for the other ways)
+	double deformingUploads;
+	double dentedUploads;
+	// Pixels of the static mesh that differ from immediate mode's
+	unsigned int differingPixels;
+};
+
+// Sets 'mesh' (and its children) to render the way 'path' says
+void SetMeshRenderPath(cMesh* mesh, MeshRenderPath path);
+// Times rendering the given models (or the example models if there are none) and a large terrain each way,
+//  in the current OpenGL context (its default framebuffer at least RENDER_BENCHMARK_WINDOW_SIZE square)
+int RunRenderBenchmark(const std::vector<std::string>& models);
+// Builds a world of 'side' by 'side' spheres in blocks between walls, with a camera and a light
+cWorld* BuildCullingScene(int side, cCamera*& camera);
+// Times rendering the culling scene while the camera turns, with each kind of culling, in the current OpenGL context
+int RunCullingBenchmark(int side);
+
+// How a model did when loaded in the file's order or welded and reordered for the vertex cache
+struct MeshLayoutScore {
+	double loadMilliseconds;
+	unsigned int vertices;
+	unsigned int triangles;
+	// Memory taken by the vertex and triangle arrays
+	unsigned int bytes;
+	// Vertices a FIFO vertex cache of LAYOUT_BENCHMARK_CACHE_SIZE fetches per triangle
+	double cacheMisses;
+	double renderMilliseconds;
+	double aabbQueriesPerSecond;
+	double bvhQueriesPerSecond;
+	// Pixels that differ from the file order's image, and segments whose nearest hit differs from the file order's
+	unsigned int differingPixels;
+	unsigned int mismatches;
+};
+
+// Times loading the given models in the file's order and welded and reordered, then rendering them from a vertex
+//  buffer and testing segments against them, in the current OpenGL context
+int RunLayoutBenchmark(const std::vector<std::string>& models);
+
+// Opens a window and times rendering the given models (or the example models if 'count' is 0) each way:
+//  unchanged, deforming as a whole every frame, and with a small dent moving on them
+int renderBenchmark(int count, char* fileNames[]);
+// Opens a window and times rendering 'side' by 'side' spheres between walls with no culling, frustum culling,
+//  and frustum and occlusion culling
+int cullingBenchmark(int side);
+// Opens a window and times loading, rendering and testing segments against the given models (or the example
+//  models if 'count' is 0), as the files order them and welded and reordered for the vertex cache
+int layoutBenchmark(int count, char* fileNames[]);
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "VelocityBenchmark.h"
+#include "ReplayHapticDevice.h"
+#include "FiniteDifferenceEstimator.h"
+#include "LeastSquaresEstimator.h"
+#include "FOAWEstimator.h"
+#include "KalmanVelocityEstimator.h"
+
+// One sine making up part of the synthetic motion on an axis
+struct SyntheticWave {
+	int axis;
+	double amplitude;
+	double frequency;
+	double phase;
+};
+
+// Slow sweeps with some quicker wobble on top, in the range a hand stirs at
+static const SyntheticWave syntheticWaves[] = {
+	{ 0, 0.030, 0.8, 0.0 },
+	{ 0, 0.006, 4.0, 1.0 },
+	{ 1, 0.020, 1.3, 0.5 },
+	{ 1, 0.004, 6.5, 2.0 },
+	{ 2, 0.015, 2.1, 1.5 }
+};
+
+// A uniform random number from -1 to 1
+static double randomUnit(void) {
+	return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+void MakeSyntheticTrajectory(VelocityTrajectory& trajectory) {
+	int count = VELOCITY_BENCHMARK_RATE * VELOCITY_BENCHMARK_SECONDS;
+	int waveCount = sizeof(syntheticWaves) / sizeof(syntheticWaves[0]);
+	double period = 1.0 / VELOCITY_BENCHMARK_RATE;
+	double resolution = VELOCITY_BENCHMARK_RESOLUTION;
+
+	trajectory.times.resize(count);
+	trajectory.positions.resize(count);
+	trajectory.velocities.resize(count);
+	trajectory.margin = VELOCITY_MAX_WINDOW;
+
+	// The same noise every run, so runs can be compared
+	srand(1);
+
+	for (int i = 0; i < count; i++) {
+		// Ticks come up to a tenth of a period early or late
+		double t = (i + 0.1 * randomUnit()) * period;
+		cVector3d position(0, 0, 0);
+		cVector3d velocity(0, 0, 0);
+
+		for (int w = 0; w < waveCount; w++) {
+			const SyntheticWave& wave = syntheticWaves[w];
+			double angle = 2 * CHAI_PI * wave.frequency * t + wave.phase;
+			position[wave.axis] += wave.amplitude * sin(angle);
+			velocity[wave.axis] += wave.amplitude * 2 * CHAI_PI * wave.frequency * cos(angle);
+		}
+
+		for (int axis = 0; axis < 3; axis++) {
+			position[axis] = floor(position[axis] / resolution + 0.5) * resolution + 0.5 * resolution * randomUnit();
+		}
+
+		trajectory.times[i] = t;
+		trajectory.positions[i] = position;
+		trajectory.velocities[i] = velocity;
+	}
+}
+
+bool LoadRecordedTrajectory(VelocityTrajectory& trajectory, const char* fileName) {
+	ReplayHapticDevice replay;
+	if (!replay.Load(fileName)) {
+		return false;
+	}
+
+	int count = replay.GetSampleCount();
+	int half = VELOCITY_BENCHMARK_REFERENCE_HALF_WINDOW;
+	trajectory.times.resize(count);
+	trajectory.positions.resize(count);
+	trajectory.velocities.resize(count);
+	trajectory.margin = (half > VELOCITY_MAX_WINDOW) ? half : VELOCITY_MAX_WINDOW;
+
+	for (int i = 0; i < count; i++) {
+		const HapticLogSample& sample = replay.GetSample(i);
+		trajectory.times[i] = sample.time;
+		trajectory.positions[i].set(sample.position[0], sample.position[1], sample.position[2]);
+	}
+
+	// The reference sees the samples on both sides, which no estimator on the haptic thread can
+	for (int i = 0; i < count; i++) {
+		int first = (i - half < 0) ? 0 : i - half;
+		int last = (i + half >= count) ? count - 1 : i + half;
+		double meanT = 0;
+		cVector3d meanP(0, 0, 0);
+		for (int j = first; j <= last; j++) {
+			meanT += trajectory.times[j];
+			meanP += trajectory.positions[j];
+		}
+		meanT /= last - first + 1;
+		meanP.mul(1.0 / (last - first + 1));
+
+		double sumTT = 0;
+		cVector3d sumTP(0, 0, 0);
+		for (int j = first; j <= last; j++) {
+			double t = trajectory.times[j] - meanT;
+			sumTT += t * t;
+			sumTP += t * (trajectory.positions[j] - meanP);
+		}
+		trajectory.velocities[i] = (sumTT > 0) ? (1.0 / sumTT) * sumTP : cVector3d(0, 0, 0);
+	}
+
+	return true;
+}
+
+VelocityEstimatorScore ScoreVelocityEstimator(IVelocityEstimator* estimator, const VelocityTrajectory& trajectory) {
+	int count = trajectory.times.size();
+	std::vector<cVector3d> estimates(count);
+
+	// Time the estimator on its own, then score what it found
+	estimator->Reset();
+	cPrecisionClock clock;
+	clock.start(true);
+	for (int i = 0; i < count; i++) {
+		estimator->AddSample(trajectory.times[i], trajectory.positions[i]);
+		estimator->GetVelocity(estimates[i]);
+	}
+	double seconds = clock.stop();
+
+	VelocityEstimatorScore score;
+	score.rmsError = 0;
+	score.maxError = 0;
+	score.nanosecondsPerSample = (count > 0) ? seconds * 1000000000 / count : 0;
+
+	int scored = 0;
+	double sumSquares = 0;
+	for (int i = trajectory.margin; i + (int) trajectory.margin < count; i++) {
+		double error = (estimates[i] - trajectory.velocities[i]).length();
+		sumSquares += error * error;
+		if (error > score.maxError) {
+			score.maxError = error;
+		}
+		scored++;
+	}
+	if (scored > 0) {
+		score.rmsError = sqrt(sumSquares / scored);
+	}
+
+	return score;
+}
+
+int velocityBenchmark(const char* fileName) {
+	VelocityTrajectory trajectory;
+	if (fileName) {
+		if (!LoadRecordedTrajectory(trajectory, fileName)) {
+			printf("%s isn't a haptic log\n", fileName);
+			return 1;
+		}
+		printf("%u samples from %s (errors are against a centered fit over %d samples)\n", (unsigned int) trajectory.times.size(),
+			fileName, 2 * VELOCITY_BENCHMARK_REFERENCE_HALF_WINDOW + 1);
+	} else {
+		MakeSyntheticTrajectory(trajectory);
+		printf("%u synthetic samples at %d Hz, %.0f um resolution\n", (unsigned int) trajectory.times.size(),
+			VELOCITY_BENCHMARK_RATE, VELOCITY_BENCHMARK_RESOLUTION * 1000000);
+	}
+
+	FiniteDifferenceEstimator finiteDifference;
+	LeastSquaresEstimator leastSquares8(8);
+	LeastSquaresEstimator leastSquares16(16);
+	LeastSquaresEstimator leastSquares32(32);
+	FOAWEstimator foaw;
+	KalmanVelocityEstimator kalman;
+	IVelocityEstimator* estimators[] = { &finiteDifference, &leastSquares8, &leastSquares16, &leastSquares32, &foaw, &kalman };
+	const char* settings[] = { "", "8", "16", "32", "8", "" };
+	int estimatorCount = sizeof(estimators) / sizeof(estimators[0]);
+
+	printf("%-22s %12s %12s %10s\n", "estimator", "rms (mm/s)", "max (mm/s)", "ns/sample");
+	for (int i = 0; i < estimatorCount; i++) {
+		VelocityEstimatorScore score = ScoreVelocityEstimator(estimators[i], trajectory);
+		char name[64];
+		sprintf(name, "%s %s", estimators[i]->GetName(), settings[i]);
+		printf("%-22s %12.2f %12.2f %10.1f\n", name, score.rmsError * 1000, score.maxError * 1000, score.nanosecondsPerSample);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "chai3d.h"
+#include "IVelocityEstimator.h"
+
+// Samples per second in the synthetic trajectory
+#define VELOCITY_BENCHMARK_RATE 1000
+#define VELOCITY_BENCHMARK_SECONDS 20
+// The synthetic positions are quantized to this (roughly a Falcon encoder step, in meters) and then
+//  jittered by up to half of it again
+#define VELOCITY_BENCHMARK_RESOLUTION 0.00006
+// A recorded trajectory is compared against a centered least-squares fit over this many samples each side
+#define VELOCITY_BENCHMARK_REFERENCE_HALF_WINDOW 20
+
+// Positions sampled over time, and the velocities an estimator should find from them
+struct VelocityTrajectory {
+	std::vector<double> times;
+	std::vector<cVector3d> positions;
+	std::vector<cVector3d> velocities;
+	// Samples at the start (and end) that aren't scored, while the estimators fill their windows
+	unsigned int margin;
+};
+
+// How close an estimator came, and how long it took
+struct VelocityEstimatorScore {
+	double rmsError;
+	double maxError;
+	double nanosecondsPerSample;
+};
+
+// Builds a hand-like trajectory with a known velocity, sampled with timing jitter and position noise
+void MakeSyntheticTrajectory(VelocityTrajectory& trajectory);
+// Reads the positions from a haptic log, with a non-causal fit standing in for the real velocity
+bool LoadRecordedTrajectory(VelocityTrajectory& trajectory, const char* fileName);
+// Runs 'estimator' over 'trajectory' from a reset
+VelocityEstimatorScore ScoreVelocityEstimator(IVelocityEstimator* estimator, const VelocityTrajectory& trajectory);
+
+// Scores every velocity estimator on a synthetic trajectory, or on the log 'fileName' if it isn't 0
+int velocityBenchmark(const char* fileName);
\ No newline at end of file
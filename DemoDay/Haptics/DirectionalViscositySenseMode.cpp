@@ -2,64 +2,65 @@
 #include "FalconDevice.h"
 #include "DirectionalViscositySenseMode.h"
 
-IHapticMode* DirectionalViscositySenseMode::singleton = 0;
-
-DirectionalViscositySenseMode::DirectionalViscositySenseMode(void) : maxViscosity(1.0), minViscosity(0) {} 
+DirectionalViscositySenseMode::DirectionalViscositySenseMode(IHapticDevice* device, IFluid* fluid, HapticTelemetry* telemetry) :
+	device(device), fluid(fluid), telemetry(telemetry), maxViscosity(1.0), minViscosity(0), tickCount(0)
+{
+	clock.start(true);
+}
 
 DirectionalViscositySenseMode::~DirectionalViscositySenseMode(void) {}
 
 void DirectionalViscositySenseMode::Tick(void) {
-	extern IHapticDevice* hapticDevice;
-	extern IFluid* fluid;
-	cGenericHapticDevice* haptic = (dynamic_cast<GenericDevice*>(hapticDevice))->GetChaiDevice();
-
 	cVector3d cursorPosition;
-	hapticDevice->GetCursorPosition(cursorPosition);
+	device->GetCursorPosition(cursorPosition);
 
 	cVector3d linearVelocity;
-	hapticDevice->GetCursorVelocity(linearVelocity);
-	//
-	printf("Speed: %4.4f\n", linearVelocity.length());
-	//
+	device->GetCursorVelocity(linearVelocity);
 
-	// Don't do anything if cursor is moving too slowly
-	if (linearVelocity.length() < FALCON_MIN_CURSOR_SPEED) {
-		// The device continuously renders the last set force; this will clear that
-		cVector3d emptyForce(0, 0, 0);
-		haptic->setForce(emptyForce);
-		return;
-	}
+	cVector3d fluidVelocity(0, 0, 0);
+	cVector3d force(0, 0, 0);
 
-	cVector3d normLinVelocity(linearVelocity);
-	normLinVelocity.normalize();
-	
-	cVector3d fluidVelocity;
-	fluid->GetVelocityAt(fluidVelocity, cursorPosition);
-	cVector3d normFluidVelocity(fluidVelocity);
-	normFluidVelocity.normalize();
+	// Don't do anything if cursor is moving too slowly (the zero force still has to be sent,
+	//  since the device continuously renders the last set force)
+	if (linearVelocity.length() >= FALCON_MIN_CURSOR_SPEED) {
+		cVector3d normLinVelocity(linearVelocity);
+		normLinVelocity.normalize();
 
-	// If the direction of the cursor is perpendicular to or going with
-	//  the fluid flow, render no force
-	double dotProduct = normLinVelocity.dot(normFluidVelocity);
-	if (dotProduct < 0) {
-		dotProduct = 0;
-	}
+		fluid->GetVelocityAt(fluidVelocity, cursorPosition);
+		cVector3d normFluidVelocity(fluidVelocity);
+		normFluidVelocity.normalize();
 
-	double fluidForcePercent = fluidVelocity.length() / fluid->GetMaxParticleSpeed();
-	if (fluidForcePercent > 1.0) { fluidForcePercent = 1.0; }
-	double pushForcePercent = linearVelocity.length() / DIR_VISC_MAX_SPEED;
-	if (pushForcePercent > 1.0) { pushForcePercent = 1.0; }
+		// If the direction of the cursor is perpendicular to or going with
+		//  the fluid flow, render no force
+		double dotProduct = normLinVelocity.dot(normFluidVelocity);
+		if (dotProduct < 0) {
+			dotProduct = 0;
+		}
 
-	double hapticForcePercent = -1 * fluidForcePercent * pushForcePercent * dotProduct;
-	normLinVelocity.mul(hapticForcePercent * hapticDevice->GetMaxForce());
+		// Scale against this frame's speeds, so the curve covers the speeds actually in the fluid
+		fluid->GetSpeedStats(speedStats);
+		double referenceSpeed = response.GetReferenceSpeed(speedStats, cursorPosition);
+		double fluidForcePercent = response.Lookup(fluidVelocity.length(), referenceSpeed);
+		double pushForcePercent = linearVelocity.length() / DIR_VISC_MAX_SPEED;
+		if (pushForcePercent > 1.0) { pushForcePercent = 1.0; }
 
-	hapticDevice->ConvertToDeviceAxes(normLinVelocity);
-	haptic->setForce(normLinVelocity);
-}
+		double hapticForcePercent = -1 * fluidForcePercent * pushForcePercent * dotProduct;
+		force = normLinVelocity;
+		force.mul(hapticForcePercent * device->GetMaxForce());
+	}
+
+	force = response.Filter(force);
+	device->SetForce(force);
 
-IHapticMode* DirectionalViscositySenseMode::GetSingleton(void){
-	if (! singleton) {
-		singleton = new DirectionalViscositySenseMode();
+	if (telemetry) {
+		HapticTelemetryRecord record;
+		record.tick = tickCount;
+		record.time = clock.getCurrentTimeSeconds();
+		record.cursorPosition = cursorPosition;
+		record.cursorVelocity = linearVelocity;
+		record.fluidVelocity = fluidVelocity;
+		record.force = force;
+		telemetry->Push(record);
 	}
-	return singleton;
+	tickCount++;
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "chai3d.h"
+#include "IFluid.h"
+#include "IHapticDevice.h"
 #include "IHapticMode.h"
+#include "HapticTelemetry.h"
+#include "ViscosityResponse.h"
 
 #define DIR_VISC_MAX_SPEED 0.05
 
@@ -13,15 +18,25 @@
  */
 class DirectionalViscositySenseMode : public IHapticMode {
 private:
-	static IHapticMode* singleton;
+	IHapticDevice* device;
+	IFluid* fluid;
+	HapticTelemetry* telemetry;
+	ViscosityResponse response;
+	// The current frame's speeds, copied from the fluid each tick the cursor moves
+	FluidSpeedStats speedStats;
 
 	double maxViscosity;
 	double minViscosity;
-	
-	DirectionalViscositySenseMode(void);
-	~DirectionalViscositySenseMode(void);
+
+	cPrecisionClock clock;
+	unsigned int tickCount;
 public:
+	// Renders forces on 'device' against the flow of 'fluid', recording every tick to 'telemetry' if one is given
+	DirectionalViscositySenseMode(IHapticDevice* device, IFluid* fluid, HapticTelemetry* telemetry = 0);
+	~DirectionalViscositySenseMode(void);
+
 	virtual void Tick(void);
 
-	static IHapticMode* GetSingleton(void);
+	// The curve that maps the fluid's speed (scaled against the current frame's speeds) to force
+	ViscosityResponse& GetResponse(void) { return response; }
 };
\ No newline at end of file
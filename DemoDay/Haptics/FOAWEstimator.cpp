@@ -0,0 +1,62 @@
+#include <math.h>
+
+#include "FOAWEstimator.h"
+
+FOAWEstimator::FOAWEstimator(int maxWindow, double noiseBound) : noiseBound(noiseBound) {
+	if (maxWindow < 2) {
+		maxWindow = 2;
+	}
+	if (maxWindow > VELOCITY_MAX_WINDOW) {
+		maxWindow = VELOCITY_MAX_WINDOW;
+	}
+	this->maxWindow = maxWindow;
+
+	Reset();
+}
+
+void FOAWEstimator::Reset(void) {
+	count = 0;
+	next = 0;
+	velocity.zero();
+	lastWindow = 0;
+}
+
+void FOAWEstimator::AddSample(double time, const cVector3d& position) {
+	times[next] = time;
+	positions[next] = position;
+	int newest = next;
+	next = (next + 1) % maxWindow;
+	if (count < maxWindow) {
+		count++;
+	}
+
+	// Grow the window one sample at a time, stopping at the first line that misses a sample in between
+	for (int n = 1; n < count; n++) {
+		int start = (newest - n + maxWindow) % maxWindow;
+		double span = time - times[start];
+		if (span <= 0) {
+			break;
+		}
+
+		cVector3d slope = position - positions[start];
+		slope.mul(1.0 / span);
+
+		bool fits = true;
+		for (int i = 1; i < n && fits; i++) {
+			int slot = (newest - i + maxWindow) % maxWindow;
+			cVector3d onLine = position - (time - times[slot]) * slope;
+			cVector3d miss = onLine - positions[slot];
+			fits = fabs(miss.x) <= noiseBound && fabs(miss.y) <= noiseBound && fabs(miss.z) <= noiseBound;
+		}
+		if (!fits) {
+			break;
+		}
+
+		velocity = slope;
+		lastWindow = n + 1;
+	}
+}
+
+void FOAWEstimator::GetVelocity(cVector3d& velocity) {
+	velocity = this->velocity;
+}
\ No newline at end of file
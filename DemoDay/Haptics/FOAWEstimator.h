@@ -0,0 +1,37 @@
+#pragma once
+
+#include "IVelocityEstimator.h"
+
+// First-order adaptive windowing (end-fit FOAW, after Janabi-Sharifi et al.).
+// For each sample it looks for the longest window, up to 'maxWindow' samples, whose end-to-end line passes within
+//  'noiseBound' of every sample in between, and returns that line's slope. Slow, smooth motion gets a long window
+//  (little noise), while a sudden change shortens the window straight away (little lag).
+// Each sample checks at most maxWindow * (maxWindow - 1) / 2 points, and usually far fewer since the search
+//  stops at the first window that doesn't fit, so the cost per sample is bounded by the window cap.
+class FOAWEstimator : public IVelocityEstimator {
+protected:
+	int maxWindow;
+	double noiseBound;
+	int count;
+	int next;
+
+	double times[VELOCITY_MAX_WINDOW];
+	cVector3d positions[VELOCITY_MAX_WINDOW];
+
+	cVector3d velocity;
+	int lastWindow;
+
+public:
+	// 'maxWindow' is the most samples looked back over (2 to VELOCITY_MAX_WINDOW), and 'noiseBound' is
+	//  the most a measured position is expected to stray from the real one, in meters
+	FOAWEstimator(int maxWindow = 8, double noiseBound = 0.00012);
+
+	// Returns the number of samples the last estimate was taken over
+	int GetLastWindow(void) { return lastWindow; }
+
+	// Overridden from IVelocityEstimator
+	virtual void Reset(void);
+	virtual void AddSample(double time, const cVector3d& position);
+	virtual void GetVelocity(cVector3d& velocity);
+	virtual const char* GetName(void) { return "FOAW"; }
+};
\ No newline at end of file
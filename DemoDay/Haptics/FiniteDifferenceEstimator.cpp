@@ -0,0 +1,28 @@
+#include "FiniteDifferenceEstimator.h"
+
+FiniteDifferenceEstimator::FiniteDifferenceEstimator(void) {
+	Reset();
+}
+
+void FiniteDifferenceEstimator::Reset(void) {
+	lastPosition.zero();
+	lastTime = 0;
+	started = false;
+	velocity.zero();
+}
+
+void FiniteDifferenceEstimator::AddSample(double time, const cVector3d& position) {
+	// A repeated timestamp has no interval to divide by; keep the last estimate
+	if (started && time > lastTime) {
+		velocity = position - lastPosition;
+		velocity.mul(1.0 / (time - lastTime));
+	}
+
+	lastPosition = position;
+	lastTime = time;
+	started = true;
+}
+
+void FiniteDifferenceEstimator::GetVelocity(cVector3d& velocity) {
+	velocity = this->velocity;
+}
\ No newline at end of file
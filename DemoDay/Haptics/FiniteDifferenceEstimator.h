@@ -0,0 +1,22 @@
+#pragma once
+
+#include "IVelocityEstimator.h"
+
+// The velocity between the last two samples. Exact for clean positions, but every bit of position noise is
+//  divided by the tick length, so at kHz rates it is the noisiest estimator.
+class FiniteDifferenceEstimator : public IVelocityEstimator {
+protected:
+	cVector3d lastPosition;
+	double lastTime;
+	bool started;
+	cVector3d velocity;
+
+public:
+	FiniteDifferenceEstimator(void);
+
+	// Overridden from IVelocityEstimator
+	virtual void Reset(void);
+	virtual void AddSample(double time, const cVector3d& position);
+	virtual void GetVelocity(cVector3d& velocity);
+	virtual const char* GetName(void) { return "finite difference"; }
+};
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 extern cHapticDeviceHandler handler;
 
+GenericDevice::GenericDevice(void) : chaiDevice(0), velocityEstimator(0) {
+	clock.start(true);
+}
+
 void GenericDevice::Init(void) {
 	handler.getDevice(chaiDevice, 0);
 	chaiDevice->open();
@@ -13,9 +17,7 @@ void GenericDevice::Init(void) {
 
 	CenterHapticDevice();
 
-	//TODO: find out if this is working
-	//cThread* hapticsThread = new cThread();
-    //hapticsThread->set(UpdateHaptics, CHAI_THREAD_PRIORITY_HAPTICS);
+	// The mode is ticked by a HapticScheduler, on its own thread
 }
 
 void GenericDevice::CenterHapticDevice(void) {
@@ -57,6 +59,13 @@ double GenericDevice::GetHapticRadius(void) { return hapticRadius; }
 
 cGenericHapticDevice* GenericDevice::GetChaiDevice(void) { return chaiDevice; }
 
+void GenericDevice::SetVelocityEstimator(IVelocityEstimator* estimator) {
+	velocityEstimator = estimator;
+	if (velocityEstimator) {
+		velocityEstimator->Reset();
+	}
+}
+
 
 void GenericDevice::GetCursorPosition(cVector3d& destination) {
 	chaiDevice->getPosition(destination);
@@ -64,7 +73,21 @@ void GenericDevice::GetCursorPosition(cVector3d& destination) {
 }
 
 void GenericDevice::GetCursorVelocity(cVector3d& destination) {
+	if (velocityEstimator) {
+		cVector3d position;
+		GetCursorPosition(position);
+		velocityEstimator->AddSample(clock.getCurrentTimeSeconds(), position);
+		velocityEstimator->GetVelocity(destination);
+		return;
+	}
+
 	chaiDevice->getPosition(destination);		// This must be called to get a non-zero linear velocity
 	chaiDevice->getLinearVelocity(destination);
 	ConvertFromDeviceAxes(destination);
+}
+
+void GenericDevice::SetForce(const cVector3d& force) {
+	cVector3d deviceForce(force);
+	ConvertToDeviceAxes(deviceForce);
+	chaiDevice->setForce(deviceForce);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "IHapticDevice.h"
 #include "IHapticMode.h"
+#include "IVelocityEstimator.h"
 #include "chai3d.h"
 
 /*
@@ -10,15 +11,26 @@
 class GenericDevice : public IHapticDevice {
 protected:
 	cGenericHapticDevice* chaiDevice;
+	// Estimates the cursor velocity from its positions (0 to use the velocity chai reports)
+	IVelocityEstimator* velocityEstimator;
+	cPrecisionClock clock;
 
 	virtual void CenterHapticDevice(void);
 public:
+	GenericDevice(void);
+
 	virtual void Init(void);
 
 	virtual double GetMaxForce(void);
 	virtual double GetHapticRadius(void);
 	cGenericHapticDevice* GetChaiDevice(void);
 
+	// Estimates the cursor velocity with 'estimator' from now on (0 goes back to chai's velocity).
+	// The device doesn't take ownership, and the estimator is fed on every GetCursorVelocity.
+	virtual void SetVelocityEstimator(IVelocityEstimator* estimator);
+	IVelocityEstimator* GetVelocityEstimator(void) { return velocityEstimator; }
+
 	virtual void GetCursorPosition(cVector3d& destination);
 	virtual void GetCursorVelocity(cVector3d& destination);
+	virtual void SetForce(const cVector3d& force);
 };
\ No newline at end of file
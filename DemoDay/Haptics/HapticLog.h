@@ -0,0 +1,28 @@
+#pragma once
+
+// The binary log written by RecordingHapticDevice and read by ReplayHapticDevice:
+//  a HapticLogHeader followed by 'sampleCount' HapticLogSamples, little-endian, in the structs' own layout.
+// 'sampleCount' is only written when the log is closed, so readers count the samples from the file's size instead.
+
+// "HLOG"
+#define HAPTIC_LOG_MAGIC 0x474F4C48
+#define HAPTIC_LOG_VERSION 1
+
+struct HapticLogHeader {
+	unsigned int magic;
+	unsigned int version;
+	unsigned int sampleCount;
+	unsigned int sampleSize;
+	// The recorded device's limits, so a replay renders the same forces
+	double maxForce;
+	double hapticRadius;
+};
+
+// One tick: what the device reported and the force the mode answered with (all in the standard axes)
+struct HapticLogSample {
+	// Seconds since recording started
+	double time;
+	double position[3];
+	double velocity[3];
+	float force[3];
+};
\ No newline at end of file
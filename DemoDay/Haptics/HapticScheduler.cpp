@@ -0,0 +1,151 @@
+#include "HapticScheduler.h"
+
+HapticScheduler* HapticScheduler::scheduling = 0;
+
+// Finds the bin that 'fraction' of the counts fall at or under, and returns the time at its upper edge
+static double GetPercentile(const unsigned int* histogram, double binWidth, double fraction) {
+	unsigned int total = 0;
+	for (int i = 0; i < HAPTIC_TIMING_BINS; i++) {
+		total += histogram[i];
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	double wanted = fraction * total;
+	unsigned int seen = 0;
+	for (int i = 0; i < HAPTIC_TIMING_BINS; i++) {
+		seen += histogram[i];
+		if (seen >= wanted) {
+			return (i + 1) * binWidth;
+		}
+	}
+	return HAPTIC_TIMING_BINS * binWidth;
+}
+
+double HapticTimingStats::GetDurationPercentile(double fraction) const {
+	return GetPercentile(duration, binWidth, fraction);
+}
+
+double HapticTimingStats::GetJitterPercentile(double fraction) const {
+	return GetPercentile(jitter, binWidth, fraction);
+}
+
+HapticScheduler::HapticScheduler(IHapticMode* mode, double rate) :
+	mode(mode), thread(0), running(false), stopped(true),
+	tickCount(0), overrunCount(0), skippedCount(0), maxDurationUs(0), maxJitterUs(0)
+{
+	if (rate < HAPTIC_SCHEDULER_MIN_RATE) { rate = HAPTIC_SCHEDULER_MIN_RATE; }
+	if (rate > HAPTIC_SCHEDULER_MAX_RATE) { rate = HAPTIC_SCHEDULER_MAX_RATE; }
+	this->rate = rate;
+	period = 1.0 / rate;
+	binWidth = period / HAPTIC_TIMING_BINS_PER_TICK;
+
+	for (int i = 0; i < HAPTIC_TIMING_BINS; i++) {
+		durationHistogram[i] = 0;
+		jitterHistogram[i] = 0;
+	}
+}
+
+HapticScheduler::~HapticScheduler(void) {
+	Stop();
+}
+
+void HapticScheduler::Start(void) {
+	if (running) {
+		return;
+	}
+
+	running = true;
+	stopped = false;
+	scheduling = this;
+	thread = new cThread();
+	thread->set(HapticScheduler::SchedulerThread, CHAI_THREAD_PRIORITY_HAPTICS);
+}
+
+void HapticScheduler::Stop(void) {
+	if (!running) {
+		return;
+	}
+
+	// Let the current tick finish before the mode or device can go away
+	running = false;
+	while (!stopped) { cSleepMs(1); }
+	scheduling = 0;
+
+	delete thread;
+	thread = 0;
+}
+
+void HapticScheduler::SchedulerThread(void) {
+	scheduling->Run();
+}
+
+void HapticScheduler::Record(volatile unsigned int* histogram, volatile unsigned int& maxUs, double seconds) {
+	int bin = (int) (seconds / binWidth);
+	if (bin >= HAPTIC_TIMING_BINS) {
+		bin = HAPTIC_TIMING_BINS - 1;
+	}
+	histogram[bin]++;
+
+	unsigned int us = (unsigned int) (seconds * 1000000);
+	if (us > maxUs) {
+		maxUs = us;
+	}
+}
+
+void HapticScheduler::Run(void) {
+	cPrecisionClock clock;
+	clock.start(true);
+	double due = 0;
+
+	while (running) {
+		double now = clock.getCurrentTimeSeconds();
+
+		// Sleep through most of the wait, then spin so the tick starts on time
+		if (now < due) {
+			if (due - now > HAPTIC_SCHEDULER_SLEEP_MARGIN) {
+				cSleepMs(1);
+			}
+			continue;
+		}
+
+		IHapticMode* current = mode;
+		if (current) {
+			current->Tick();
+		}
+		double done = clock.getCurrentTimeSeconds();
+
+		Record(jitterHistogram, maxJitterUs, now - due);
+		Record(durationHistogram, maxDurationUs, done - now);
+		tickCount++;
+
+		due += period;
+		if (done > due) {
+			overrunCount++;
+		}
+
+		// Too far behind to catch up: skip the missed ticks rather than run them back to back
+		if (done - due > HAPTIC_SCHEDULER_MAX_BACKLOG * period) {
+			int missed = (int) ((done - due) / period);
+			skippedCount += missed;
+			due += missed * period;
+		}
+	}
+
+	stopped = true;
+}
+
+void HapticScheduler::GetStats(HapticTimingStats& stats) {
+	stats.rate = rate;
+	stats.ticks = tickCount;
+	stats.overruns = overrunCount;
+	stats.skipped = skippedCount;
+	stats.binWidth = binWidth;
+	for (int i = 0; i < HAPTIC_TIMING_BINS; i++) {
+		stats.duration[i] = durationHistogram[i];
+		stats.jitter[i] = jitterHistogram[i];
+	}
+	stats.maxDuration = maxDurationUs / 1000000.0;
+	stats.maxJitter = maxJitterUs / 1000000.0;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "chai3d.h"
+#include "IHapticMode.h"
+
+// The rates the scheduler can tick at (ticks per second)
+#define HAPTIC_SCHEDULER_MIN_RATE 1000
+#define HAPTIC_SCHEDULER_MAX_RATE 4000
+#define HAPTIC_SCHEDULER_DEFAULT_RATE 1000
+// The scheduler sleeps while the next tick is further away than this (seconds), and spins after
+#define HAPTIC_SCHEDULER_SLEEP_MARGIN 0.002
+// How far behind the scheduler may fall (in ticks) before it skips the missed ticks instead of catching up
+#define HAPTIC_SCHEDULER_MAX_BACKLOG 4
+// The timing histograms have this many bins, each 1/HAPTIC_TIMING_BINS_PER_TICK of a tick long (the last bin catches the rest)
+#define HAPTIC_TIMING_BINS 64
+#define HAPTIC_TIMING_BINS_PER_TICK 32
+
+// A copy of a HapticScheduler's timing counters
+struct HapticTimingStats {
+	// Ticks per second the scheduler was asked for
+	double rate;
+	unsigned int ticks;
+	// Ticks that were still running when the next tick was due
+	unsigned int overruns;
+	// Ticks dropped to catch up after falling too far behind
+	unsigned int skipped;
+	// How long each tick took, and how late each tick started, in bins of 'binWidth' seconds
+	double binWidth;
+	unsigned int duration[HAPTIC_TIMING_BINS];
+	unsigned int jitter[HAPTIC_TIMING_BINS];
+	double maxDuration;
+	double maxJitter;
+
+	// Returns the tick time that 'fraction' of the ticks came in under (in seconds, to within one bin)
+	double GetDurationPercentile(double fraction) const;
+	// Returns the lateness that 'fraction' of the ticks came in under (in seconds, to within one bin)
+	double GetJitterPercentile(double fraction) const;
+};
+
+// Runs a haptic mode's Tick on its own thread at a fixed rate, keeping track of how well it keeps to that rate.
+// Tick n is due at n / rate seconds after Start. A tick that is still running when the next is due is an overrun;
+//  if the scheduler falls more than HAPTIC_SCHEDULER_MAX_BACKLOG ticks behind, it skips ahead rather than bursting.
+// The counters are only written by the scheduler thread, so GetStats can read them at any time without a lock.
+// Only one HapticScheduler can be running at a time.
+class HapticScheduler {
+protected:
+	IHapticMode* volatile mode;
+	double rate;
+	double period;
+	double binWidth;
+
+	cThread* thread;
+	volatile bool running;
+	volatile bool stopped;
+
+	volatile unsigned int tickCount;
+	volatile unsigned int overrunCount;
+	volatile unsigned int skippedCount;
+	volatile unsigned int durationHistogram[HAPTIC_TIMING_BINS];
+	volatile unsigned int jitterHistogram[HAPTIC_TIMING_BINS];
+	// In microseconds, so they can't be read half written
+	volatile unsigned int maxDurationUs;
+	volatile unsigned int maxJitterUs;
+
+	static HapticScheduler* scheduling;
+	static void SchedulerThread(void);
+
+	void Run(void);
+	void Record(volatile unsigned int* histogram, volatile unsigned int& maxUs, double seconds);
+
+public:
+	// Creates a scheduler that will tick 'mode' 'rate' times a second (clamped to the supported rates)
+	HapticScheduler(IHapticMode* mode, double rate = HAPTIC_SCHEDULER_DEFAULT_RATE);
+	// Stops the scheduler if it is running
+	~HapticScheduler(void);
+
+	// Starts ticking on the scheduler thread (does nothing if it is already running)
+	void Start(void);
+	// Stops ticking, returning once the current tick is done
+	void Stop(void);
+	bool IsRunning(void) { return running; }
+
+	// Changes the mode that is ticked (takes effect on the next tick)
+	void SetMode(IHapticMode* newMode) { mode = newMode; }
+	double GetRate(void) { return rate; }
+
+	// Copies the timing counters into 'stats'
+	void GetStats(HapticTimingStats& stats);
+};
\ No newline at end of file
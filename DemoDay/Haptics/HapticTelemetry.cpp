@@ -0,0 +1,94 @@
+#include "HapticTelemetry.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+// Keeps a record's contents from being reordered past the index that publishes it
+#define TELEMETRY_BARRIER() MemoryBarrier()
+#else
+#define TELEMETRY_BARRIER() __sync_synchronize()
+#endif
+
+HapticTelemetry* HapticTelemetry::draining = 0;
+
+HapticTelemetry::HapticTelemetry(const char* fileName) :
+	head(0), tail(0), droppedCount(0), writtenCount(0), file(0),
+	running(true), stopped(false)
+{
+	ring = new HapticTelemetryRecord[HAPTIC_TELEMETRY_CAPACITY];
+
+	if (fileName) {
+		file = fopen(fileName, "w");
+	}
+	if (file) {
+		fprintf(file, "tick,time,x,y,z,vx,vy,vz,fluid vx,fluid vy,fluid vz,fx,fy,fz\n");
+	}
+
+	draining = this;
+	thread = new cThread();
+	thread->set(HapticTelemetry::DrainThread, CHAI_THREAD_PRIORITY_GRAPHICS);
+}
+
+HapticTelemetry::~HapticTelemetry(void) {
+	// The drain thread writes out what is left before it stops
+	running = false;
+	while (!stopped) { cSleepMs(1); }
+	draining = 0;
+
+	delete thread;
+	if (file) {
+		fclose(file);
+	}
+	delete[] ring;
+}
+
+bool HapticTelemetry::Push(const HapticTelemetryRecord& record) {
+	unsigned int at = head;
+	if (at - tail >= HAPTIC_TELEMETRY_CAPACITY) {
+		droppedCount++;
+		return false;
+	}
+
+	ring[at & (HAPTIC_TELEMETRY_CAPACITY - 1)] = record;
+	TELEMETRY_BARRIER();
+	head = at + 1;
+	return true;
+}
+
+void HapticTelemetry::DrainThread(void) {
+	draining->Drain();
+}
+
+int HapticTelemetry::Flush(void) {
+	unsigned int at = tail;
+	unsigned int end = head;
+	TELEMETRY_BARRIER();
+
+	for (; at != end; at++) {
+		const HapticTelemetryRecord& r = ring[at & (HAPTIC_TELEMETRY_CAPACITY - 1)];
+		if (file) {
+			fprintf(file, "%u,%.6f,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g\n", r.tick, r.time,
+				r.cursorPosition.x, r.cursorPosition.y, r.cursorPosition.z,
+				r.cursorVelocity.x, r.cursorVelocity.y, r.cursorVelocity.z,
+				r.fluidVelocity.x, r.fluidVelocity.y, r.fluidVelocity.z,
+				r.force.x, r.force.y, r.force.z);
+		}
+		writtenCount++;
+	}
+
+	// Only hand the slots back once they have been read
+	TELEMETRY_BARRIER();
+	int written = (int) (end - tail);
+	tail = end;
+	return written;
+}
+
+void HapticTelemetry::Drain(void) {
+	while (running) {
+		if (Flush() == 0) {
+			cSleepMs(1);
+		}
+	}
+	Flush();
+
+	stopped = true;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "chai3d.h"
+
+// How many records the ring holds (a power of two); records pushed while it is full are dropped
+#define HAPTIC_TELEMETRY_CAPACITY 8192
+
+// What a haptic mode did on one tick
+struct HapticTelemetryRecord {
+	unsigned int tick;
+	// Seconds since the mode started ticking
+	double time;
+	cVector3d cursorPosition;
+	cVector3d cursorVelocity;
+	// Zero for modes that don't read a fluid
+	cVector3d fluidVelocity;
+	// The force sent to the device, in standard axes
+	cVector3d force;
+};
+
+// Collects telemetry from the haptic thread without ever blocking it.
+// Push copies a record into a ring buffer (one writer, one reader, no locks), and a background thread
+//  drains the ring into a CSV file. If the drain falls behind, new records are dropped and counted.
+// Only one HapticTelemetry can be draining at a time.
+class HapticTelemetry {
+protected:
+	// HAPTIC_TELEMETRY_CAPACITY records, on the heap: the ring is too large to live on the stack with its owner
+	HapticTelemetryRecord* ring;
+	// head is only written by Push and tail only by the drain thread; both count up forever
+	volatile unsigned int head;
+	volatile unsigned int tail;
+	volatile unsigned int droppedCount;
+	volatile unsigned int writtenCount;
+
+	FILE* file;
+
+	cThread* thread;
+	volatile bool running;
+	volatile bool stopped;
+
+	static HapticTelemetry* draining;
+	static void DrainThread(void);
+
+	void Drain(void);
+	// Writes out everything in the ring, returning the number of records written
+	int Flush(void);
+
+public:
+	// Starts draining into the CSV file 'fileName' (with no file, records are drained and only counted)
+	HapticTelemetry(const char* fileName = 0);
+	// Writes out whatever is left in the ring and closes the file
+	~HapticTelemetry(void);
+
+	// Queues a record (call from the haptic thread only). Returns false if the ring was full and it was dropped.
+	bool Push(const HapticTelemetryRecord& record);
+
+	// Returns the number of records dropped because the ring was full
+	unsigned int GetDroppedCount(void) { return droppedCount; }
+	// Returns the number of records the drain thread has written out
+	unsigned int GetWrittenCount(void) { return writtenCount; }
+};
\ No newline at end of file
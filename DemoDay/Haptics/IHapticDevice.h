@@ -34,6 +34,9 @@ public:
 	// Returns the recommended workspace radius for this device
 	virtual double GetHapticRadius(void) = 0;
 
+	// Renders 'force' (in the standard axes) until the next call
+	virtual void SetForce(const cVector3d& force) = 0;
+
 	// Changes the haptic mode of the device
 	virtual void SetMode(IHapticMode* newMode) {
 		mode = newMode;
@@ -4,7 +4,7 @@
 
 class IHapticDevice;
 
-// All classes that implement this interface should be implemented as singletons.
+// Modes are given the device (and anything else they read) when they are created, so several can run at once.
 class IHapticMode {
 public:
 	// Called every time the haptic device needs to render a force or update variables.
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "chai3d.h"
+
+// The most samples a windowed estimator can look back over
+#define VELOCITY_MAX_WINDOW 64
+
+// Estimates the cursor's velocity from its positions, one sample per haptic tick.
+// A device feeds its estimator every time it is asked for the cursor velocity (see GenericDevice::SetVelocityEstimator).
+// AddSample and GetVelocity run on the haptic thread, so every estimator keeps them to a bounded amount of work.
+class IVelocityEstimator {
+public:
+	virtual ~IVelocityEstimator(void) {}
+
+	// Forgets every sample
+	virtual void Reset(void) = 0;
+	// Adds the position measured at 'time' (in seconds); samples must come in time order
+	virtual void AddSample(double time, const cVector3d& position) = 0;
+	// Copies the latest estimate into 'velocity' (zero until there are enough samples)
+	virtual void GetVelocity(cVector3d& velocity) = 0;
+	// Returns a short name for reports
+	virtual const char* GetName(void) = 0;
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "KalmanVelocityEstimator.h"
+
+// How unsure the filter starts out about the velocity (in (m/s)^2)
+#define KALMAN_INITIAL_VELOCITY_VARIANCE 1.0
+
+KalmanVelocityEstimator::KalmanVelocityEstimator(double processNoise, double measurementNoise) :
+	processNoise(processNoise), measurementNoise(measurementNoise)
+{
+	Reset();
+}
+
+void KalmanVelocityEstimator::Reset(void) {
+	started = false;
+	lastTime = 0;
+	position.zero();
+	velocity.zero();
+	p00 = p01 = p11 = 0;
+}
+
+void KalmanVelocityEstimator::AddSample(double time, const cVector3d& measured) {
+	if (!started) {
+		position = measured;
+		velocity.zero();
+		p00 = measurementNoise;
+		p01 = 0;
+		p11 = KALMAN_INITIAL_VELOCITY_VARIANCE;
+		lastTime = time;
+		started = true;
+		return;
+	}
+
+	double dt = time - lastTime;
+	if (dt < 0) {
+		dt = 0;
+	}
+	lastTime = time;
+
+	// Predict: carry the position along at the current velocity, and grow the covariance by the
+	//  acceleration the hand could have applied over dt
+	position += dt * velocity;
+	double dt2 = dt * dt;
+	double q = processNoise;
+	double n00 = p00 + 2 * dt * p01 + dt2 * p11 + q * dt2 * dt / 3;
+	double n01 = p01 + dt * p11 + q * dt2 / 2;
+	double n11 = p11 + q * dt;
+
+	// Correct with the measured position
+	double innovationVariance = n00 + measurementNoise;
+	double k0 = n00 / innovationVariance;
+	double k1 = n01 / innovationVariance;
+	cVector3d innovation = measured - position;
+	position += k0 * innovation;
+	velocity += k1 * innovation;
+
+	p00 = (1 - k0) * n00;
+	p01 = (1 - k0) * n01;
+	p11 = n11 - k1 * n01;
+}
+
+void KalmanVelocityEstimator::GetVelocity(cVector3d& velocity) {
+	velocity = this->velocity;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "IVelocityEstimator.h"
+
+// A constant-velocity Kalman filter on each axis, with the position as the only measurement.
+// The axes share their timing and noise, so they share one covariance and one gain; a sample is a 2x2 update.
+// 'processNoise' is how hard the hand is expected to accelerate (the spectral density of the acceleration,
+//  in m^2/s^3) and 'measurementNoise' is the variance of a position reading (in m^2): raising the first,
+//  or lowering the second, makes the filter follow the positions more closely and smooth them less.
+class KalmanVelocityEstimator : public IVelocityEstimator {
+protected:
+	double processNoise;
+	double measurementNoise;
+
+	bool started;
+	double lastTime;
+	cVector3d position;
+	cVector3d velocity;
+	// The covariance of (position, velocity), the same on every axis
+	double p00, p01, p11;
+
+public:
+	KalmanVelocityEstimator(double processNoise = 1.0, double measurementNoise = 0.00000001);
+
+	// Overridden from IVelocityEstimator
+	virtual void Reset(void);
+	virtual void AddSample(double time, const cVector3d& position);
+	virtual void GetVelocity(cVector3d& velocity);
+	virtual const char* GetName(void) { return "Kalman"; }
+};
\ No newline at end of file
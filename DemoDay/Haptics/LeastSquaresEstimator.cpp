@@ -0,0 +1,88 @@
+#include "LeastSquaresEstimator.h"
+
+LeastSquaresEstimator::LeastSquaresEstimator(int window) {
+	if (window < 2) {
+		window = 2;
+	}
+	if (window > VELOCITY_MAX_WINDOW) {
+		window = VELOCITY_MAX_WINDOW;
+	}
+	this->window = window;
+
+	Reset();
+}
+
+void LeastSquaresEstimator::Reset(void) {
+	count = 0;
+	next = 0;
+	sinceRebase = 0;
+	baseTime = 0;
+	sumT = sumTT = 0;
+	sumP.zero();
+	sumTP.zero();
+}
+
+// Moves the base time up to the oldest sample and recomputes the sums from the ring
+void LeastSquaresEstimator::Rebase(void) {
+	int oldest = (next - count + window) % window;
+	double newBase = baseTime + times[oldest];
+
+	sumT = sumTT = 0;
+	sumP.zero();
+	sumTP.zero();
+	for (int i = 0; i < count; i++) {
+		int slot = (oldest + i) % window;
+		times[slot] += baseTime - newBase;
+
+		double t = times[slot];
+		sumT += t;
+		sumTT += t * t;
+		sumP += positions[slot];
+		sumTP += t * positions[slot];
+	}
+
+	baseTime = newBase;
+	sinceRebase = 0;
+}
+
+void LeastSquaresEstimator::AddSample(double time, const cVector3d& position) {
+	if (count == 0) {
+		baseTime = time;
+	}
+
+	// Drop the oldest sample's terms
+	if (count == window) {
+		double t = times[next];
+		sumT -= t;
+		sumTT -= t * t;
+		sumP -= positions[next];
+		sumTP -= t * positions[next];
+		count--;
+	}
+
+	double t = time - baseTime;
+	times[next] = t;
+	positions[next] = position;
+	sumT += t;
+	sumTT += t * t;
+	sumP += position;
+	sumTP += t * position;
+	next = (next + 1) % window;
+	count++;
+
+	if (++sinceRebase >= window) {
+		Rebase();
+	}
+}
+
+void LeastSquaresEstimator::GetVelocity(cVector3d& velocity) {
+	double denominator = count * sumTT - sumT * sumT;
+	// Fewer than two distinct times don't make a line
+	if (count < 2 || denominator <= 0) {
+		velocity.zero();
+		return;
+	}
+
+	velocity = count * sumTP - sumT * sumP;
+	velocity.mul(1.0 / denominator);
+}
\ No newline at end of file
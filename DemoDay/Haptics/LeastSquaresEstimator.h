@@ -0,0 +1,38 @@
+#pragma once
+
+#include "IVelocityEstimator.h"
+
+// The slope of the least-squares line through the last 'window' samples.
+// The sums the fit needs are kept running, so a sample adds its terms and removes the oldest one's in O(1).
+// Times are stored relative to a base time that moves up every 'window' samples (the sums are rebuilt then,
+//  which also clears out rounding left behind by the subtractions), so long sessions don't lose precision.
+class LeastSquaresEstimator : public IVelocityEstimator {
+protected:
+	int window;
+	int count;
+	// Where the next sample goes in the ring
+	int next;
+	int sinceRebase;
+	double baseTime;
+
+	double times[VELOCITY_MAX_WINDOW];
+	cVector3d positions[VELOCITY_MAX_WINDOW];
+
+	// Sums of t, t^2, p and t*p over the samples in the ring (t relative to baseTime)
+	double sumT, sumTT;
+	cVector3d sumP, sumTP;
+
+	void Rebase(void);
+
+public:
+	// 'window' is the number of samples fitted, from 2 to VELOCITY_MAX_WINDOW
+	LeastSquaresEstimator(int window = 16);
+
+	int GetWindow(void) { return window; }
+
+	// Overridden from IVelocityEstimator
+	virtual void Reset(void);
+	virtual void AddSample(double time, const cVector3d& position);
+	virtual void GetVelocity(cVector3d& velocity);
+	virtual const char* GetName(void) { return "least squares"; }
+};
\ No newline at end of file
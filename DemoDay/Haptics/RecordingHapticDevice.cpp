@@ -0,0 +1,94 @@
+#include "RecordingHapticDevice.h"
+
+// Big enough for a few seconds of samples at 1 kHz
+#define RECORDING_BUFFER_SIZE (256 * 1024)
+
+RecordingHapticDevice::RecordingHapticDevice(IHapticDevice* device, const char* fileName) : device(device) {
+	mode = 0;
+	maxForce = 0;
+	hapticRadius = 0;
+
+	header.magic = HAPTIC_LOG_MAGIC;
+	header.version = HAPTIC_LOG_VERSION;
+	header.sampleCount = 0;
+	header.sampleSize = sizeof(HapticLogSample);
+	header.maxForce = device->GetMaxForce();
+	header.hapticRadius = device->GetHapticRadius();
+	memset(&sample, 0, sizeof(sample));
+
+	file = fopen(fileName, "wb");
+	if (file) {
+		setvbuf(file, 0, _IOFBF, RECORDING_BUFFER_SIZE);
+		// The limits go out now so a log cut short still replays with them; the count is only filled in by Close
+		fwrite(&header, sizeof(header), 1, file);
+	}
+
+	clock.start(true);
+}
+
+RecordingHapticDevice::~RecordingHapticDevice(void) {
+	Close();
+}
+
+void RecordingHapticDevice::Close(void) {
+	if (!file) {
+		return;
+	}
+
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+	fclose(file);
+	file = 0;
+}
+
+void RecordingHapticDevice::GetCursorPosition(cVector3d& destination) {
+	device->GetCursorPosition(destination);
+	sample.position[0] = destination.x;
+	sample.position[1] = destination.y;
+	sample.position[2] = destination.z;
+}
+
+void RecordingHapticDevice::GetCursorVelocity(cVector3d& destination) {
+	device->GetCursorVelocity(destination);
+	sample.velocity[0] = destination.x;
+	sample.velocity[1] = destination.y;
+	sample.velocity[2] = destination.z;
+}
+
+void RecordingHapticDevice::Init(void) {
+	device->Init();
+
+	// Initializing reads the device's limits, so the header is rewritten if nothing has been recorded yet
+	if (file && header.sampleCount == 0) {
+		header.maxForce = device->GetMaxForce();
+		header.hapticRadius = device->GetHapticRadius();
+		fseek(file, 0, SEEK_SET);
+		fwrite(&header, sizeof(header), 1, file);
+	}
+}
+
+double RecordingHapticDevice::GetMaxForce(void) {
+	return device->GetMaxForce();
+}
+
+double RecordingHapticDevice::GetHapticRadius(void) {
+	return device->GetHapticRadius();
+}
+
+void RecordingHapticDevice::SetForce(const cVector3d& force) {
+	device->SetForce(force);
+
+	if (file) {
+		sample.time = clock.getCurrentTimeSeconds();
+		sample.force[0] = (float) force.x;
+		sample.force[1] = (float) force.y;
+		sample.force[2] = (float) force.z;
+		fwrite(&sample, sizeof(sample), 1, file);
+		header.sampleCount++;
+	}
+}
+
+void RecordingHapticDevice::SetMode(IHapticMode* newMode) {
+	mode = newMode;
+	device->SetMode(newMode);
+}
\ No newline at end of file
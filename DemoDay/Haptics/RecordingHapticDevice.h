@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+
+#include "chai3d.h"
+#include "IHapticDevice.h"
+#include "HapticLog.h"
+
+// Wraps another device and records every tick of a session to a binary log that ReplayHapticDevice can play back.
+// The modes read the cursor and then send exactly one force per tick, so a sample is written on each SetForce.
+// Samples go through a large stdio buffer, so the haptic thread only touches the disk once every few thousand ticks.
+class RecordingHapticDevice : public IHapticDevice {
+protected:
+	IHapticDevice* device;
+	FILE* file;
+	HapticLogHeader header;
+	HapticLogSample sample;
+	cPrecisionClock clock;
+
+public:
+	// Records 'device' to the file 'fileName' (nothing is recorded if it can't be opened)
+	// The header takes the device's limits here, so 'device' should already be initialized
+	RecordingHapticDevice(IHapticDevice* device, const char* fileName);
+	// Finishes the log
+	virtual ~RecordingHapticDevice(void);
+
+	// Returns true if the log file is open
+	bool IsRecording(void) { return file != 0; }
+	// Returns the number of samples recorded so far
+	unsigned int GetSampleCount(void) { return header.sampleCount; }
+	// Writes the sample count and closes the file (further ticks aren't recorded)
+	void Close(void);
+
+	// Overridden from IHapticDevice; everything is passed on to the wrapped device
+	virtual void GetCursorPosition(cVector3d& destination);
+	virtual void GetCursorVelocity(cVector3d& destination);
+	virtual void Init(void);
+	virtual double GetMaxForce(void);
+	virtual double GetHapticRadius(void);
+	virtual void SetForce(const cVector3d& force);
+	virtual void SetMode(IHapticMode* newMode);
+};
\ No newline at end of file
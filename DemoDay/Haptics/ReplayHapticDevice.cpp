@@ -0,0 +1,111 @@
+#include <stdio.h>
+
+#include "ReplayHapticDevice.h"
+
+ReplayHapticDevice::ReplayHapticDevice(void) : current(0), lastForce(0, 0, 0) {
+	mode = 0;
+	maxForce = 0;
+	hapticRadius = 0;
+	header.sampleCount = 0;
+}
+
+ReplayHapticDevice::~ReplayHapticDevice(void) {}
+
+bool ReplayHapticDevice::Load(const char* fileName) {
+	samples.clear();
+	current = 0;
+
+	FILE* file = fopen(fileName, "rb");
+	if (!file) {
+		return false;
+	}
+
+	bool loaded = fread(&header, sizeof(header), 1, file) == 1 &&
+		header.magic == HAPTIC_LOG_MAGIC && header.version == HAPTIC_LOG_VERSION &&
+		header.sampleSize == sizeof(HapticLogSample);
+	if (loaded) {
+		// The header's count is still 0 if the recording was killed, so the samples are counted from the file's size
+		fseek(file, 0, SEEK_END);
+		long fileSize = ftell(file);
+		fseek(file, sizeof(header), SEEK_SET);
+		size_t count = fileSize > (long) sizeof(header) ? (fileSize - sizeof(header)) / sizeof(HapticLogSample) : 0;
+
+		samples.resize(count);
+		if (count > 0) {
+			size_t read = fread(&samples[0], sizeof(HapticLogSample), count, file);
+			samples.resize(read);
+		}
+		header.sampleCount = (unsigned int) samples.size();
+		maxForce = header.maxForce;
+		hapticRadius = header.hapticRadius;
+	}
+
+	fclose(file);
+	return loaded;
+}
+
+void ReplayHapticDevice::Seek(unsigned int sample) {
+	current = sample;
+}
+
+HapticReplayResult ReplayHapticDevice::Replay(IHapticMode* mode) {
+	HapticReplayResult result;
+	result.ticks = 0;
+	result.maxForceError = 0;
+	result.meanForceError = 0;
+	result.recordedSeconds = samples.empty() ? 0 : samples.back().time - samples.front().time;
+
+	cPrecisionClock clock;
+	clock.start(true);
+
+	double totalError = 0;
+	for (unsigned int i = 0; i < samples.size(); i++) {
+		Seek(i);
+		mode->Tick();
+
+		const float* recorded = samples[i].force;
+		cVector3d error = lastForce - cVector3d(recorded[0], recorded[1], recorded[2]);
+		double errorLength = error.length();
+		totalError += errorLength;
+		if (errorLength > result.maxForceError) {
+			result.maxForceError = errorLength;
+		}
+		result.ticks++;
+	}
+
+	result.replaySeconds = clock.stop();
+	if (result.ticks > 0) {
+		result.meanForceError = totalError / result.ticks;
+	}
+	return result;
+}
+
+void ReplayHapticDevice::GetCursorPosition(cVector3d& destination) {
+	if (current >= samples.size()) {
+		destination.zero();
+		return;
+	}
+	const double* position = samples[current].position;
+	destination.set(position[0], position[1], position[2]);
+}
+
+void ReplayHapticDevice::GetCursorVelocity(cVector3d& destination) {
+	if (current >= samples.size()) {
+		destination.zero();
+		return;
+	}
+	const double* velocity = samples[current].velocity;
+	destination.set(velocity[0], velocity[1], velocity[2]);
+}
+
+void ReplayHapticDevice::Init(void) {
+	// Nothing needs to happen; Load sets the device up
+}
+
+double ReplayHapticDevice::GetMaxForce(void) { return maxForce; }
+
+double ReplayHapticDevice::GetHapticRadius(void) { return hapticRadius; }
+
+void ReplayHapticDevice::SetForce(const cVector3d& force) {
+	lastForce = force;
+}
\ No newline at end of file
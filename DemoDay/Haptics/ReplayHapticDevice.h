@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "chai3d.h"
+#include "IHapticDevice.h"
+#include "HapticLog.h"
+
+// What a replay found
+struct HapticReplayResult {
+	unsigned int ticks;
+	// Seconds the replay took, and the seconds the recording covered
+	double replaySeconds;
+	double recordedSeconds;
+	// How far the replayed forces were from the recorded ones, in Newtons
+	double maxForceError;
+	double meanForceError;
+};
+
+// Plays back a log made by RecordingHapticDevice, as if its cursor were moving again.
+// Replay ticks a mode once per sample as fast as it will go, and compares each force the mode sends with
+//  the force that was recorded, so force computations can be timed and checked against real motion without hardware.
+// The results only match the recording if the mode's other inputs (like its fluid) do too.
+class ReplayHapticDevice : public IHapticDevice {
+protected:
+	HapticLogHeader header;
+	std::vector<HapticLogSample> samples;
+	unsigned int current;
+	cVector3d lastForce;
+
+public:
+	ReplayHapticDevice(void);
+	virtual ~ReplayHapticDevice(void);
+
+	// Reads the log 'fileName', returning false if it can't be read
+	bool Load(const char* fileName);
+	unsigned int GetSampleCount(void) { return samples.size(); }
+	// Returns the recorded sample 'sample' (less than GetSampleCount)
+	const HapticLogSample& GetSample(unsigned int sample) { return samples[sample]; }
+
+	// Moves to 'sample' (the cursor reports that sample until the next call)
+	void Seek(unsigned int sample);
+	// Ticks 'mode' once for every sample, comparing its forces with the recorded ones
+	HapticReplayResult Replay(IHapticMode* mode);
+
+	// Returns the force most recently sent to the device
+	void GetLastForce(cVector3d& force) { force = lastForce; }
+
+	// Overridden from IHapticDevice
+	virtual void GetCursorPosition(cVector3d& destination);
+	virtual void GetCursorVelocity(cVector3d& destination);
+	virtual void Init(void);
+	virtual double GetMaxForce(void);
+	virtual double GetHapticRadius(void);
+	virtual void SetForce(const cVector3d& force);
+};
\ No newline at end of file
@@ -2,30 +2,39 @@
 #include "FalconDevice.h"
 #include "UniformViscositySenseMode.h"
 
-IHapticMode* UniformViscositySenseMode::singleton = 0;
-
-UniformViscositySenseMode::UniformViscositySenseMode(void) : lastPosition(0, 0, 0) {}
+UniformViscositySenseMode::UniformViscositySenseMode(IHapticDevice* device, HapticTelemetry* telemetry) :
+	device(device), telemetry(telemetry), tickCount(0)
+{
+	clock.start(true);
+}
 
 UniformViscositySenseMode::~UniformViscositySenseMode(void) {}
 
 void UniformViscositySenseMode::Tick(void) {
-	extern IHapticDevice* hapticDevice;
-	GenericDevice* genDevice = dynamic_cast<GenericDevice*>(hapticDevice);
-	cGenericHapticDevice* haptic = genDevice->GetChaiDevice();
-
 	cVector3d linearVelocity;
-	hapticDevice->GetCursorVelocity(linearVelocity);
-
-	double forcePercent = linearVelocity.length() / UNIF_VISC_MAX_SPEED;
-	linearVelocity.mul(-forcePercent * hapticDevice->GetMaxForce());
-
-	hapticDevice->ConvertToDeviceAxes(linearVelocity);
-	haptic->setForce(linearVelocity);
-}
+	device->GetCursorVelocity(linearVelocity);
+
+	// Push back against the cursor's direction of travel
+	double speed = linearVelocity.length();
+	double forcePercent = response.Lookup(speed, UNIF_VISC_MAX_SPEED);
+	cVector3d force(0, 0, 0);
+	if (speed > 0) {
+		force = linearVelocity;
+		force.mul(-forcePercent * device->GetMaxForce() / speed);
+	}
 
-IHapticMode* UniformViscositySenseMode::GetSingleton(void){
-	if (! singleton) {
-		singleton = new UniformViscositySenseMode();
+	force = response.Filter(force);
+	device->SetForce(force);
+
+	if (telemetry) {
+		HapticTelemetryRecord record;
+		record.tick = tickCount;
+		record.time = clock.getCurrentTimeSeconds();
+		device->GetCursorPosition(record.cursorPosition);
+		record.cursorVelocity = linearVelocity;
+		record.fluidVelocity.zero();
+		record.force = force;
+		telemetry->Push(record);
 	}
-	return singleton;
+	tickCount++;
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "chai3d.h"
+#include "IHapticDevice.h"
 #include "IHapticMode.h"
+#include "HapticTelemetry.h"
+#include "ViscosityResponse.h"
 
 #define UNIF_VISC_MAX_SPEED 0.05
 
@@ -10,14 +14,19 @@
  */
 class UniformViscositySenseMode : public IHapticMode {
 private:
-	static IHapticMode* singleton;
+	IHapticDevice* device;
+	HapticTelemetry* telemetry;
+	ViscosityResponse response;
 
-	cVector3d lastPosition;
-
-	UniformViscositySenseMode(void);
-	~UniformViscositySenseMode(void);
+	cPrecisionClock clock;
+	unsigned int tickCount;
 public:
+	// Renders forces on 'device', recording every tick to 'telemetry' if one is given
+	UniformViscositySenseMode(IHapticDevice* device, HapticTelemetry* telemetry = 0);
+	~UniformViscositySenseMode(void);
+
 	virtual void Tick(void);
 
-	static IHapticMode* GetSingleton(void);
+	// The curve that maps the cursor's speed (scaled against UNIF_VISC_MAX_SPEED) to force
+	ViscosityResponse& GetResponse(void) { return response; }
 };
\ No newline at end of file
@@ -1,8 +1,7 @@
 #include "VirtualHapticDevice.h"
 
 VirtualHapticDevice::VirtualHapticDevice(void) {
-	clock.start(true);
-	lastClock = 0;
+	velocityEstimator = &finiteDifference;
 }
 
 VirtualHapticDevice::~VirtualHapticDevice(void) {
@@ -13,16 +12,8 @@ void VirtualHapticDevice::CenterHapticDevice(void) {
 	// Nothing needs to happen
 }
 
-void VirtualHapticDevice::GetCursorVelocity(cVector3d& velocity) {
-	double currentTime = clock.getCurrentTimeSeconds();
-	double ellapsedTime = currentTime - lastClock;
-	lastClock = currentTime;
-
-	cVector3d currentPos;
-	chaiDevice->getPosition(currentPos);
-	velocity = currentPos - lastPosition;
-	velocity.mul(1.0 / ellapsedTime );
-	lastPosition.copyfrom(currentPos);
+void VirtualHapticDevice::SetVelocityEstimator(IVelocityEstimator* estimator) {
+	GenericDevice::SetVelocityEstimator(estimator ? estimator : &finiteDifference);
 }
 
 // The Falcon's position components are mapped to the wrong fields; this
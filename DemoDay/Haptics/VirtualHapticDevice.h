@@ -2,12 +2,12 @@
 
 #include "chai3d.h"
 #include "GenericDevice.h"
+#include "FiniteDifferenceEstimator.h"
 
 class VirtualHapticDevice : public GenericDevice {
 protected:
-	cVector3d lastPosition;
-	cPrecisionClock clock;
-	double lastClock;
+	// The chai virtual device doesn't report a velocity, so there is always an estimator; this is the default one
+	FiniteDifferenceEstimator finiteDifference;
 
 	virtual void CenterHapticDevice(void);
 public:
@@ -15,9 +15,9 @@ public:
 	~VirtualHapticDevice(void);
 
 	// Overridden from GenericDevice; the chai virtual device doesn't implement
-	//  getLinearVelocity(cVector3d), so this is a software implementation of
-	//  linear velocity
-	virtual void GetCursorVelocity(cVector3d& velocity);
+	//  getLinearVelocity(cVector3d), so the velocity is always estimated from the positions
+	//  (0 goes back to the finite difference estimator)
+	virtual void SetVelocityEstimator(IVelocityEstimator* estimator);
 
 	// Overridden from IHapticDevice
 	virtual void ConvertToDeviceAxes(cVector3d& vector);
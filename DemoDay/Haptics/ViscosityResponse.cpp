@@ -0,0 +1,93 @@
+#include <math.h>
+
+#include "ViscosityResponse.h"
+
+ViscosityResponse::ViscosityResponse(ResponseCurve curve, ResponseReference reference) :
+	curve(curve), reference(reference), smoothing(0), maxForceStep(0), lastForce(0, 0, 0)
+{
+	BuildTable();
+}
+
+void ViscosityResponse::BuildTable(void) {
+	for (int i = 0; i <= VISCOSITY_RESPONSE_TABLE_SIZE; i++) {
+		double x = (double) i / VISCOSITY_RESPONSE_TABLE_SIZE;
+		double y;
+		switch (curve) {
+			case RESPONSE_SQUARE:
+				y = x * x;
+				break;
+			case RESPONSE_SQRT:
+				y = sqrt(x);
+				break;
+			case RESPONSE_SMOOTHSTEP:
+				y = x * x * (3 - 2 * x);
+				break;
+			case RESPONSE_LINEAR:
+			default:
+				y = x;
+		}
+		table[i] = (float) y;
+	}
+}
+
+void ViscosityResponse::SetCurve(ResponseCurve curve) {
+	this->curve = curve;
+	BuildTable();
+}
+
+void ViscosityResponse::SetSmoothing(double smoothing) {
+	if (smoothing < 0) { smoothing = 0; }
+	if (smoothing > 0.99) { smoothing = 0.99; }
+	this->smoothing = smoothing;
+}
+
+double ViscosityResponse::Lookup(double value, double fullScale) const {
+	if (fullScale <= 0 || value <= 0) {
+		return table[0];
+	}
+
+	double position = value / fullScale * VISCOSITY_RESPONSE_TABLE_SIZE;
+	if (position >= VISCOSITY_RESPONSE_TABLE_SIZE) {
+		return table[VISCOSITY_RESPONSE_TABLE_SIZE];
+	}
+
+	int index = (int) position;
+	double t = position - index;
+	return table[index] + t * (table[index + 1] - table[index]);
+}
+
+double ViscosityResponse::GetReferenceSpeed(const FluidSpeedStats& stats, const cVector3d& location) const {
+	double speed;
+	switch (reference) {
+		case REFERENCE_MAX_SPEED:
+			speed = stats.maxSpeed;
+			break;
+		case REFERENCE_LOCAL_SPEED:
+			speed = stats.GetFieldSpeedAt(location);
+			break;
+		case REFERENCE_P99_SPEED:
+		default:
+			speed = stats.p99Speed;
+	}
+	return (speed > FLUID_MIN_REFERENCE_SPEED) ? speed : FLUID_MIN_REFERENCE_SPEED;
+}
+
+cVector3d ViscosityResponse::Filter(const cVector3d& force) {
+	cVector3d filtered = force;
+
+	if (smoothing > 0) {
+		filtered = (1 - smoothing) * force + smoothing * lastForce;
+	}
+
+	if (maxForceStep > 0) {
+		cVector3d step = filtered - lastForce;
+		double length = step.length();
+		if (length > maxForceStep) {
+			step.mul(maxForceStep / length);
+			filtered = lastForce + step;
+		}
+	}
+
+	lastForce = filtered;
+	return filtered;
+}
\ No newline at end of file
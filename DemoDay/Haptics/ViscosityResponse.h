@@ -0,0 +1,62 @@
+#pragma once
+
+#include "chai3d.h"
+#include "FluidSpeedStats.h"
+
+// The response curve is looked up in a table of this many steps (plus one entry for the end)
+#define VISCOSITY_RESPONSE_TABLE_SIZE 256
+
+// How the input maps to a fraction of the device's force, once it is scaled to [0, 1]
+enum ResponseCurve {
+	RESPONSE_LINEAR,
+	RESPONSE_SQUARE,		// gentle near zero, steep near the top
+	RESPONSE_SQRT,			// steep near zero, gentle near the top
+	RESPONSE_SMOOTHSTEP		// gentle at both ends
+};
+
+// What a fluid speed is scaled against
+enum ResponseReference {
+	REFERENCE_MAX_SPEED,	// the fastest particle in the frame
+	REFERENCE_P99_SPEED,	// the 99th percentile speed in the frame (a few very fast particles don't flatten the rest)
+	REFERENCE_LOCAL_SPEED	// the fastest particle in the coarse cell around the cursor
+};
+
+// Turns speeds into force fractions for the viscosity modes through a precomputed curve.
+// The curve is built once, so a lookup is a scale, a clamp and one interpolated table read.
+// Filter then smooths the force and limits how fast it can change from one tick to the next.
+// Configure it before it is ticked; only Lookup and Filter are meant for the haptic thread.
+class ViscosityResponse {
+private:
+	float table[VISCOSITY_RESPONSE_TABLE_SIZE + 1];
+	ResponseCurve curve;
+	ResponseReference reference;
+
+	// The fraction of the last force kept each tick (0 is no smoothing)
+	double smoothing;
+	// The most the force may change in one tick, in Newtons (0 is no limit)
+	double maxForceStep;
+	cVector3d lastForce;
+
+	void BuildTable(void);
+
+public:
+	ViscosityResponse(ResponseCurve curve = RESPONSE_LINEAR, ResponseReference reference = REFERENCE_P99_SPEED);
+
+	void SetCurve(ResponseCurve curve);
+	ResponseCurve GetCurve(void) { return curve; }
+	void SetReference(ResponseReference reference) { this->reference = reference; }
+	ResponseReference GetReference(void) { return reference; }
+	// 'smoothing' is the fraction of the last force kept each tick, from 0 (none) to just under 1
+	void SetSmoothing(double smoothing);
+	// 'maxForceStep' is the most the force may change in one tick, in Newtons (0 for no limit)
+	void SetMaxForceStep(double maxForceStep) { this->maxForceStep = (maxForceStep > 0) ? maxForceStep : 0; }
+
+	// Returns the curve's response to 'value', where 'fullScale' (and anything above it) gets the full response
+	double Lookup(double value, double fullScale) const;
+	// Returns the speed 'stats' says a fluid speed at 'location' should be scaled against
+	double GetReferenceSpeed(const FluidSpeedStats& stats, const cVector3d& location) const;
+	// Smooths and rate limits 'force' against the last force this returned, and returns the result
+	cVector3d Filter(const cVector3d& force);
+	// Forgets the last force, so the next one isn't smoothed or limited
+	void Reset(void) { lastForce.zero(); }
+};
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "glm/glm.hpp"
 #include <vector>
 #include "IFluid.h"
-#include "capSimpleTetra.h"
+#include "ParticleCloud.h"
 
 using namespace glm;
 
@@ -16,15 +16,15 @@ public:
 	void InitFluids(cWorld*,IFluid*);
 	void UpdateFluid();
 
+	ParticleCloud* GetCloud() { return cloud; }
+
 private:
 	cWorld * world;
 	IFluid * fluidModel;
 
 	double diameter;
-	int activeParticles;
 	cMaterial fluidMaterial;
-	
-	void HandleParticleCountChange(int delta);
 
-	vector<capSimpleTetra*> particles;
+	//every particle is drawn by this one scene object
+	ParticleCloud* cloud;
 };
\ No newline at end of file
@@ -0,0 +1,560 @@
+#include "ParticleCloud.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER		0x8892
+#define GL_STREAM_DRAW		0x88E0
+#define GL_STATIC_DRAW		0x88E4
+#endif
+#ifndef GL_POINT_SPRITE
+#define GL_POINT_SPRITE		0x8861
+#define GL_COORD_REPLACE	0x8862
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER	0x8B31
+#define GL_COMPILE_STATUS	0x8B81
+#define GL_LINK_STATUS		0x8B82
+#endif
+
+//the generic attributes the glyph shader reads each particle from (clear of the ones some drivers alias to gl_Vertex and gl_Normal)
+#define GLYPH_CENTER_ATTRIBUTE	6
+#define GLYPH_COLOR_ATTRIBUTE	7
+//the fixed-function lights the glyph shader adds up
+#define GLYPH_LIGHTS			8
+//width and height of the texture that rounds off the point sprites
+#define DISC_TEXTURE_SIZE		32
+
+//Buffer, shader and instancing entry points; OpenGL 1.1 libraries don't export them
+typedef void (APIENTRY *GenBuffersProc)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRY *DeleteBuffersProc)(GLsizei n, const GLuint* buffers);
+typedef void (APIENTRY *BindBufferProc)(GLenum target, GLuint buffer);
+typedef void (APIENTRY *BufferDataProc)(GLenum target, ptrdiff_t size, const GLvoid* data, GLenum usage);
+typedef GLuint (APIENTRY *CreateShaderProc)(GLenum type);
+typedef void (APIENTRY *ShaderSourceProc)(GLuint shader, GLsizei count, const char** source, const GLint* length);
+typedef void (APIENTRY *CompileShaderProc)(GLuint shader);
+typedef void (APIENTRY *GetShaderivProc)(GLuint shader, GLenum name, GLint* value);
+typedef void (APIENTRY *DeleteShaderProc)(GLuint shader);
+typedef GLuint (APIENTRY *CreateProgramProc)(void);
+typedef void (APIENTRY *AttachShaderProc)(GLuint program, GLuint shader);
+typedef void (APIENTRY *BindAttribLocationProc)(GLuint program, GLuint index, const char* name);
+typedef void (APIENTRY *LinkProgramProc)(GLuint program);
+typedef void (APIENTRY *GetProgramivProc)(GLuint program, GLenum name, GLint* value);
+typedef void (APIENTRY *DeleteProgramProc)(GLuint program);
+typedef void (APIENTRY *UseProgramProc)(GLuint program);
+typedef GLint (APIENTRY *GetUniformLocationProc)(GLuint program, const char* name);
+typedef void (APIENTRY *Uniform1fProc)(GLint location, GLfloat value);
+typedef void (APIENTRY *Uniform1fvProc)(GLint location, GLsizei count, const GLfloat* values);
+typedef void (APIENTRY *VertexAttribArrayProc)(GLuint index);
+typedef void (APIENTRY *VertexAttribPointerProc)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+typedef void (APIENTRY *VertexAttribDivisorProc)(GLuint index, GLuint divisor);
+typedef void (APIENTRY *DrawArraysInstancedProc)(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+
+//What the current OpenGL context can do for a cloud, looked up on the first render
+struct CloudGL
+{
+	bool checked;
+	bool buffers;
+	bool pointSprites;
+	bool instancing;
+
+	GenBuffersProc GenBuffers;
+	DeleteBuffersProc DeleteBuffers;
+	BindBufferProc BindBuffer;
+	BufferDataProc BufferData;
+
+	CreateShaderProc CreateShader;
+	ShaderSourceProc ShaderSource;
+	CompileShaderProc CompileShader;
+	GetShaderivProc GetShaderiv;
+	DeleteShaderProc DeleteShader;
+	CreateProgramProc CreateProgram;
+	AttachShaderProc AttachShader;
+	BindAttribLocationProc BindAttribLocation;
+	LinkProgramProc LinkProgram;
+	GetProgramivProc GetProgramiv;
+	DeleteProgramProc DeleteProgram;
+	UseProgramProc UseProgram;
+	GetUniformLocationProc GetUniformLocation;
+	Uniform1fProc Uniform1f;
+	Uniform1fvProc Uniform1fv;
+	VertexAttribArrayProc EnableVertexAttribArray;
+	VertexAttribArrayProc DisableVertexAttribArray;
+	VertexAttribPointerProc VertexAttribPointer;
+	VertexAttribDivisorProc VertexAttribDivisor;
+	DrawArraysInstancedProc DrawArraysInstanced;
+};
+
+static CloudGL gl;
+
+//Moves each glyph vertex to its particle and lights it like the fixed-function pipeline would (ambient and diffuse only)
+static const char* glyphShaderSource =
+	"#version 120\n"
+	"attribute vec3 center;\n"
+	"attribute vec3 color;\n"
+	"uniform float lights[8];\n"
+	"uniform float useColor;\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 eye = gl_ModelViewMatrix * vec4(gl_Vertex.xyz + center, 1.0);\n"
+	"	gl_Position = gl_ProjectionMatrix * eye;\n"
+	"	vec3 normal = normalize(gl_NormalMatrix * gl_Normal);\n"
+	"	vec4 ambient = mix(gl_FrontMaterial.ambient, vec4(color, 1.0), useColor);\n"
+	"	vec4 diffuse = mix(gl_FrontMaterial.diffuse, vec4(color, 1.0), useColor);\n"
+	"	vec4 lit = gl_FrontMaterial.emission + gl_LightModel.ambient * ambient;\n"
+	"	for(int i = 0; i < 8; i++)\n"
+	"	{\n"
+	"		vec3 toLight = normalize(gl_LightSource[i].position.xyz - eye.xyz * gl_LightSource[i].position.w);\n"
+	"		lit += lights[i] * (gl_LightSource[i].ambient * ambient + gl_LightSource[i].diffuse * diffuse * max(dot(normal, toLight), 0.0));\n"
+	"	}\n"
+	"	gl_FrontColor = vec4(lit.rgb, diffuse.a);\n"
+	"}\n";
+
+//Returns true if the context's OpenGL version is at least major.minor
+static bool HasVersion(int major, int minor)
+{
+	const char* version = (const char*)glGetString(GL_VERSION);
+	if(version == 0)
+		return false;
+
+	int contextMajor = atoi(version);
+	const char* dot = strchr(version, '.');
+	int contextMinor = (dot != 0) ? atoi(dot + 1) : 0;
+	return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+static bool HasExtension(const char* name)
+{
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	return extensions != 0 && strstr(extensions, name) != 0;
+}
+
+//Looks up 'name' followed by 'suffix' ("" for the core function, "ARB" for the extension's)
+static void* LoadProc(const char* name, const char* suffix)
+{
+	char fullName[64];
+	sprintf(fullName, "%s%s", name, suffix);
+	return cGetGLProcAddress(fullName);
+}
+
+//Finds out what the current context supports; only looked at once, on the first render
+static void CheckGL()
+{
+	if(gl.checked || glGetString(GL_VERSION) == 0)
+		return;
+	gl.checked = true;
+
+	//the core functions have no suffix, those of the extensions end in ARB
+	const char* suffix = HasVersion(1, 5) ? "" : (HasExtension("GL_ARB_vertex_buffer_object") ? "ARB" : 0);
+	if(suffix != 0)
+	{
+		gl.GenBuffers = (GenBuffersProc)LoadProc("glGenBuffers", suffix);
+		gl.DeleteBuffers = (DeleteBuffersProc)LoadProc("glDeleteBuffers", suffix);
+		gl.BindBuffer = (BindBufferProc)LoadProc("glBindBuffer", suffix);
+		gl.BufferData = (BufferDataProc)LoadProc("glBufferData", suffix);
+		gl.buffers = gl.GenBuffers && gl.DeleteBuffers && gl.BindBuffer && gl.BufferData;
+	}
+
+	gl.pointSprites = HasVersion(2, 0) || HasExtension("GL_ARB_point_sprite");
+
+	//instancing needs the shader that reads the particles, so OpenGL 2.0 and a buffer for them
+	suffix = HasVersion(3, 3) ? "" :
+		(HasExtension("GL_ARB_instanced_arrays") && HasExtension("GL_ARB_draw_instanced") ? "ARB" : 0);
+	if(suffix != 0 && gl.buffers && HasVersion(2, 0))
+	{
+		gl.CreateShader = (CreateShaderProc)LoadProc("glCreateShader", "");
+		gl.ShaderSource = (ShaderSourceProc)LoadProc("glShaderSource", "");
+		gl.CompileShader = (CompileShaderProc)LoadProc("glCompileShader", "");
+		gl.GetShaderiv = (GetShaderivProc)LoadProc("glGetShaderiv", "");
+		gl.DeleteShader = (DeleteShaderProc)LoadProc("glDeleteShader", "");
+		gl.CreateProgram = (CreateProgramProc)LoadProc("glCreateProgram", "");
+		gl.AttachShader = (AttachShaderProc)LoadProc("glAttachShader", "");
+		gl.BindAttribLocation = (BindAttribLocationProc)LoadProc("glBindAttribLocation", "");
+		gl.LinkProgram = (LinkProgramProc)LoadProc("glLinkProgram", "");
+		gl.GetProgramiv = (GetProgramivProc)LoadProc("glGetProgramiv", "");
+		gl.DeleteProgram = (DeleteProgramProc)LoadProc("glDeleteProgram", "");
+		gl.UseProgram = (UseProgramProc)LoadProc("glUseProgram", "");
+		gl.GetUniformLocation = (GetUniformLocationProc)LoadProc("glGetUniformLocation", "");
+		gl.Uniform1f = (Uniform1fProc)LoadProc("glUniform1f", "");
+		gl.Uniform1fv = (Uniform1fvProc)LoadProc("glUniform1fv", "");
+		gl.EnableVertexAttribArray = (VertexAttribArrayProc)LoadProc("glEnableVertexAttribArray", "");
+		gl.DisableVertexAttribArray = (VertexAttribArrayProc)LoadProc("glDisableVertexAttribArray", "");
+		gl.VertexAttribPointer = (VertexAttribPointerProc)LoadProc("glVertexAttribPointer", "");
+		gl.VertexAttribDivisor = (VertexAttribDivisorProc)LoadProc("glVertexAttribDivisor", suffix);
+		gl.DrawArraysInstanced = (DrawArraysInstancedProc)LoadProc("glDrawArraysInstanced", suffix);
+
+		gl.instancing = gl.CreateShader && gl.ShaderSource && gl.CompileShader && gl.GetShaderiv &&
+			gl.DeleteShader && gl.CreateProgram && gl.AttachShader && gl.BindAttribLocation &&
+			gl.LinkProgram && gl.GetProgramiv && gl.DeleteProgram && gl.UseProgram &&
+			gl.GetUniformLocation && gl.Uniform1f && gl.Uniform1fv && gl.EnableVertexAttribArray &&
+			gl.DisableVertexAttribArray && gl.VertexAttribPointer && gl.VertexAttribDivisor &&
+			gl.DrawArraysInstanced;
+	}
+}
+
+//Compiles and links the glyph shader, returning 0 if the driver won't take it
+static GLuint BuildGlyphProgram()
+{
+	GLuint shader = gl.CreateShader(GL_VERTEX_SHADER);
+	gl.ShaderSource(shader, 1, &glyphShaderSource, 0);
+	gl.CompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	gl.GetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if(!compiled)
+	{
+		gl.DeleteShader(shader);
+		return 0;
+	}
+
+	GLuint program = gl.CreateProgram();
+	gl.AttachShader(program, shader);
+	gl.BindAttribLocation(program, GLYPH_CENTER_ATTRIBUTE, "center");
+	gl.BindAttribLocation(program, GLYPH_COLOR_ATTRIBUTE, "color");
+	gl.LinkProgram(program);
+	//the program keeps the shader until it's deleted itself
+	gl.DeleteShader(shader);
+
+	GLint linked = GL_FALSE;
+	gl.GetProgramiv(program, GL_LINK_STATUS, &linked);
+	if(!linked)
+	{
+		gl.DeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+ParticleCloud::ParticleCloud(double diameter, ParticleStyle style)
+{
+	this->diameter = diameter;
+	this->style = style;
+	pointSize = PARTICLE_POINT_SIZE;
+
+	colorBySpeed = false;
+	maxSpeed = 1.0;
+	slowColor.set(0.0, 0.635, 0.910);
+	fastColor.set(1.0, 1.0, 1.0);
+
+	count = 0;
+	upToDate = false;
+	frameVersion = 0;
+	uploaded = false;
+
+	glReady = false;
+	particleBuffer = 0;
+	glyphBuffer = 0;
+	glyphProgram = 0;
+	lightsUniform = -1;
+	useColorUniform = -1;
+	discTexture = 0;
+
+	BuildGlyph();
+}
+
+ParticleCloud::~ParticleCloud()
+{
+	if(particleBuffer != 0)
+		gl.DeleteBuffers(1, &particleBuffer);
+	if(glyphBuffer != 0)
+		gl.DeleteBuffers(1, &glyphBuffer);
+	if(glyphProgram != 0)
+		gl.DeleteProgram(glyphProgram);
+	if(discTexture != 0)
+		glDeleteTextures(1, &discTexture);
+}
+
+//Builds the same tetrahedron as capSimpleTetra, as a list of triangles with flat normals
+void ParticleCloud::BuildGlyph()
+{
+	double edge = diameter;
+	double faceHeight = (sqrt((float)3) / 2 ) * edge;
+
+	double corners[4][3] = {
+		{ 0, 0, 0 },
+		{ edge / 2.0, 0, 0 - faceHeight },
+		{ edge / -2.0, 0, 0 - faceHeight },
+		{ 0, sqrt((float)6) / 3.0 * edge, faceHeight * -2 / 3 }
+	};
+
+	int triangles[4][3] = { { 2, 1, 0 }, { 0, 1, 3 }, { 3, 2, 0 }, { 1, 2, 3 } };
+
+	for(int t = 0; t < 4; t++)
+	{
+		cVector3d a(corners[triangles[t][0]][0], corners[triangles[t][0]][1], corners[triangles[t][0]][2]);
+		cVector3d b(corners[triangles[t][1]][0], corners[triangles[t][1]][1], corners[triangles[t][1]][2]);
+		cVector3d c(corners[triangles[t][2]][0], corners[triangles[t][2]][1], corners[triangles[t][2]][2]);
+		cVector3d normal = cCross(b - a, c - a);
+		normal.normalize();
+
+		for(int v = 0; v < 3; v++)
+		{
+			int index = (t * 3 + v) * 3;
+			for(int axis = 0; axis < 3; axis++)
+			{
+				glyphOffsets[index + axis] = (float)corners[triangles[t][v]][axis];
+			}
+			glyphFaceNormals[index + 0] = (float)normal.x;
+			glyphFaceNormals[index + 1] = (float)normal.y;
+			glyphFaceNormals[index + 2] = (float)normal.z;
+		}
+	}
+}
+
+void ParticleCloud::SetColorBySpeed(bool enabled, double maxSpeed)
+{
+	colorBySpeed = enabled;
+	this->maxSpeed = (maxSpeed > 0) ? maxSpeed : 1.0;
+	upToDate = false;
+}
+
+void ParticleCloud::Update(IFluid* fluid)
+{
+	FluidFrame frame;
+	fluid->GetFrame(frame);
+
+	if(upToDate && frame.version == frameVersion && frame.count == count)
+		return;
+
+	count = frame.count;
+	vertices.resize(count * PARTICLE_VERTEX_FLOATS);
+
+	//every particle gets a color, so turning colors on never draws past the end of the vertices
+	for(int i = 0; i < count; i++)
+	{
+		float* v = &vertices[i * PARTICLE_VERTEX_FLOATS];
+		const cVector3d& pos = frame.positions[i];
+		v[0] = (float)pos.x;
+		v[1] = (float)pos.y;
+		v[2] = (float)pos.z;
+
+		float t = 0.0f;
+		if(colorBySpeed)
+		{
+			t = (float)(frame.velocities[i].length() / maxSpeed);
+			t = (t > 1.0f) ? 1.0f : t;
+		}
+		v[3] = slowColor[0] + (fastColor[0] - slowColor[0]) * t;
+		v[4] = slowColor[1] + (fastColor[1] - slowColor[1]) * t;
+		v[5] = slowColor[2] + (fastColor[2] - slowColor[2]) * t;
+	}
+
+	upToDate = true;
+	uploaded = false;
+	frameVersion = frame.version;
+	updateBoundaryBox();
+}
+
+//Creates the buffers, the glyph shader and the sprite texture, as far as the context supports them
+void ParticleCloud::CreateGLObjects()
+{
+	glReady = true;
+	CheckGL();
+
+	if(gl.buffers)
+	{
+		gl.GenBuffers(1, &particleBuffer);
+
+		//the glyph never changes, so it's uploaded once
+		float glyph[GLYPH_VERTICES * 6];
+		memcpy(glyph, glyphOffsets, sizeof(glyphOffsets));
+		memcpy(glyph + GLYPH_VERTICES * 3, glyphFaceNormals, sizeof(glyphFaceNormals));
+		gl.GenBuffers(1, &glyphBuffer);
+		gl.BindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
+		gl.BufferData(GL_ARRAY_BUFFER, sizeof(glyph), glyph, GL_STATIC_DRAW);
+		gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	if(gl.instancing)
+	{
+		glyphProgram = BuildGlyphProgram();
+		if(glyphProgram != 0)
+		{
+			lightsUniform = gl.GetUniformLocation(glyphProgram, "lights");
+			useColorUniform = gl.GetUniformLocation(glyphProgram, "useColor");
+		}
+	}
+
+	if(gl.pointSprites)
+	{
+		//opaque inside the circle that touches the edges, clear outside it
+		GLubyte disc[DISC_TEXTURE_SIZE * DISC_TEXTURE_SIZE];
+		for(int y = 0; y < DISC_TEXTURE_SIZE; y++)
+		{
+			for(int x = 0; x < DISC_TEXTURE_SIZE; x++)
+			{
+				float dx = (x + 0.5f) / DISC_TEXTURE_SIZE * 2.0f - 1.0f;
+				float dy = (y + 0.5f) / DISC_TEXTURE_SIZE * 2.0f - 1.0f;
+				disc[y * DISC_TEXTURE_SIZE + x] = (dx * dx + dy * dy <= 1.0f) ? 255 : 0;
+			}
+		}
+
+		glGenTextures(1, &discTexture);
+		glBindTexture(GL_TEXTURE_2D, discTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, DISC_TEXTURE_SIZE, DISC_TEXTURE_SIZE, 0, GL_ALPHA, GL_UNSIGNED_BYTE, disc);
+		glPopClientAttrib();
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+}
+
+//Sends the vertices to the particle buffer, once per frame
+void ParticleCloud::Upload()
+{
+	uploaded = true;
+	if(particleBuffer == 0)
+		return;
+
+	gl.BindBuffer(GL_ARRAY_BUFFER, particleBuffer);
+	gl.BufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STREAM_DRAW);
+	gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//Returns the array pointer for the vertices starting at 'firstFloat': an offset into particleBuffer, or client memory without one
+const GLvoid* ParticleCloud::VertexArray(int firstFloat)
+{
+	if(particleBuffer == 0)
+		return &vertices[firstFloat];
+	return (const GLvoid*)(firstFloat * sizeof(float));
+}
+
+void ParticleCloud::render(const int a_renderMode)
+{
+	//the cloud is opaque, so it only draws in the opaque pass
+	if(a_renderMode == CHAI_RENDER_MODE_TRANSPARENT_BACK_ONLY ||
+	   a_renderMode == CHAI_RENDER_MODE_TRANSPARENT_FRONT_ONLY)
+		return;
+
+	if(count == 0)
+		return;
+
+	if(!glReady)
+		CreateGLObjects();
+	if(!uploaded)
+		Upload();
+
+	if(style == POINT_SPRITES || glyphProgram == 0)
+		RenderPoints();
+	else
+		RenderGlyphs();
+}
+
+void ParticleCloud::RenderPoints()
+{
+	glPushAttrib(GL_ENABLE_BIT | GL_POINT_BIT | GL_CURRENT_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT);
+	glDisable(GL_LIGHTING);
+	glPointSize(pointSize);
+
+	if(discTexture != 0)
+	{
+		//each point is a screen-aligned square, and the disc's alpha cuts it round
+		glEnable(GL_POINT_SPRITE);
+		glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
+		glEnable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, discTexture);
+		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		glEnable(GL_ALPHA_TEST);
+		glAlphaFunc(GL_GREATER, 0.5f);
+	}
+	else
+	{
+		glEnable(GL_POINT_SMOOTH);
+	}
+
+	if(particleBuffer != 0)
+		gl.BindBuffer(GL_ARRAY_BUFFER, particleBuffer);
+
+	GLsizei stride = PARTICLE_VERTEX_FLOATS * sizeof(float);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, stride, VertexArray(0));
+	glEnableClientState(GL_COLOR_ARRAY);
+	glColorPointer(3, GL_FLOAT, stride, VertexArray(3));
+
+	glDrawArrays(GL_POINTS, 0, count);
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if(particleBuffer != 0)
+		gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+	glPopAttrib();
+}
+
+//Draws one instance of the glyph per particle; the shader moves it to the particle
+void ParticleCloud::RenderGlyphs()
+{
+	glPushAttrib(GL_ENABLE_BIT | GL_LIGHTING_BIT | GL_CURRENT_BIT);
+	glEnable(GL_LIGHTING);
+
+	if(m_useMaterialProperty)
+		m_material.render();
+
+	//the shader adds up the same lights the fixed-function pipeline would
+	GLfloat lights[GLYPH_LIGHTS];
+	for(int l = 0; l < GLYPH_LIGHTS; l++)
+		lights[l] = glIsEnabled(GL_LIGHT0 + l) ? 1.0f : 0.0f;
+
+	gl.UseProgram(glyphProgram);
+	gl.Uniform1fv(lightsUniform, GLYPH_LIGHTS, lights);
+	gl.Uniform1f(useColorUniform, colorBySpeed ? 1.0f : 0.0f);
+
+	gl.BindBuffer(GL_ARRAY_BUFFER, glyphBuffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, 0);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glNormalPointer(GL_FLOAT, 0, (const GLvoid*)(GLYPH_VERTICES * 3 * sizeof(float)));
+
+	//the center and color advance once per glyph instead of once per vertex
+	GLsizei stride = PARTICLE_VERTEX_FLOATS * sizeof(float);
+	gl.BindBuffer(GL_ARRAY_BUFFER, particleBuffer);
+	gl.EnableVertexAttribArray(GLYPH_CENTER_ATTRIBUTE);
+	gl.VertexAttribPointer(GLYPH_CENTER_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, stride, VertexArray(0));
+	gl.VertexAttribDivisor(GLYPH_CENTER_ATTRIBUTE, 1);
+	gl.EnableVertexAttribArray(GLYPH_COLOR_ATTRIBUTE);
+	gl.VertexAttribPointer(GLYPH_COLOR_ATTRIBUTE, 3, GL_FLOAT, GL_FALSE, stride, VertexArray(3));
+	gl.VertexAttribDivisor(GLYPH_COLOR_ATTRIBUTE, 1);
+
+	gl.DrawArraysInstanced(GL_TRIANGLES, 0, GLYPH_VERTICES, count);
+
+	gl.VertexAttribDivisor(GLYPH_COLOR_ATTRIBUTE, 0);
+	gl.DisableVertexAttribArray(GLYPH_COLOR_ATTRIBUTE);
+	gl.VertexAttribDivisor(GLYPH_CENTER_ATTRIBUTE, 0);
+	gl.DisableVertexAttribArray(GLYPH_CENTER_ATTRIBUTE);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+	gl.UseProgram(0);
+	glPopAttrib();
+}
+
+void ParticleCloud::updateBoundaryBox()
+{
+	if(count == 0)
+	{
+		m_boundaryBoxMin.zero();
+		m_boundaryBoxMax.zero();
+		return;
+	}
+
+	cVector3d lo(vertices[0], vertices[1], vertices[2]);
+	cVector3d hi = lo;
+
+	for(int i = 1; i < count; i++)
+	{
+		for(int axis = 0; axis < 3; axis++)
+		{
+			double value = vertices[i * PARTICLE_VERTEX_FLOATS + axis];
+			if(value < lo[axis]) lo[axis] = value;
+			if(value > hi[axis]) hi[axis] = value;
+		}
+	}
+
+	//leave room for the glyphs hanging off each position
+	m_boundaryBoxMin = lo - cVector3d(diameter, diameter, diameter);
+	m_boundaryBoxMax = hi + cVector3d(diameter, diameter, diameter);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "chai3d.h"
+#include <vector>
+#include "IFluid.h"
+
+#define PARTICLE_POINT_SIZE	4.0f
+#define GLYPH_VERTICES		12
+//xyz and rgb per particle
+#define PARTICLE_VERTEX_FLOATS	6
+
+using namespace std;
+
+enum ParticleStyle
+{
+	POINT_SPRITES,	//one round point per particle (fixed size on screen)
+	GLYPHS			//one small tetrahedron per particle (fixed size in the world)
+};
+
+//A single scene object that draws every particle of a fluid.
+//Each frame the particles are copied into one vertex buffer and drawn with a single call,
+//as point sprites or as instances of one glyph, instead of one cMesh per particle.
+//Without instancing the glyphs are drawn as point sprites, and without buffer objects
+//the same arrays are drawn from client memory.
+class ParticleCloud : public cGenericObject
+{
+private:
+	ParticleStyle style;
+	double diameter;
+	float pointSize;
+
+	bool colorBySpeed;
+	double maxSpeed;
+	cColorf slowColor;
+	cColorf fastColor;
+
+	int count;
+	bool upToDate;				//false until a frame has been copied with the current settings
+	unsigned int frameVersion;	//the version of the last frame copied
+	vector<float> vertices;		//PARTICLE_VERTEX_FLOATS per particle
+	bool uploaded;				//false until the current vertices are in particleBuffer
+
+	float glyphOffsets[GLYPH_VERTICES * 3];
+	float glyphFaceNormals[GLYPH_VERTICES * 3];
+
+	//OpenGL objects, created on the first render
+	bool glReady;
+	GLuint particleBuffer;		//the vertices (0 without buffer objects)
+	GLuint glyphBuffer;			//one glyph's offsets, then its normals
+	GLuint glyphProgram;		//places and lights a glyph per instance (0 without instancing)
+	GLint lightsUniform;
+	GLint useColorUniform;
+	GLuint discTexture;			//rounds off the point sprites (0 without point sprites)
+
+	void BuildGlyph(void);
+	void CreateGLObjects(void);
+	void Upload(void);
+	const GLvoid* VertexArray(int firstFloat);
+	void RenderPoints(void);
+	void RenderGlyphs(void);
+
+public:
+	ParticleCloud(double diameter, ParticleStyle style = GLYPHS);
+	// Deletes the OpenGL objects (the context the cloud was drawn in must be current)
+	virtual ~ParticleCloud(void);
+
+	void SetStyle(ParticleStyle s) { style = s; }
+	ParticleStyle GetStyle(void) const { return style; }
+	void SetPointSize(float pixels) { pointSize = pixels; }
+	void SetColorBySpeed(bool enabled, double maxSpeed);
+	int GetParticleCount(void) const { return count; }
+
+	// Copies the current frame of the fluid into the vertices (skipped if the frame hasn't changed);
+	// they're uploaded on the next render
+	void Update(IFluid* fluid);
+
+	virtual void render(const int a_renderMode = CHAI_RENDER_MODE_RENDER_ALL);
+	virtual void updateBoundaryBox(void);
+};
@@ -4,22 +4,221 @@
 #include "FalconDevice.h"
 #include "IFluid.h"
 #include "GEOFileFluid.h"
+#include "LiveSPHFluid.h"
+#include "BasicFluidParticle.h"
+#include "ParticleCloud.h"
+#include "capSimpleTetra.h"
 
 #include <iostream>
+#include <string.h>
+#include <stdlib.h>
+
+#define BENCHMARK_WARMUP_FRAMES	5
+#define BENCHMARK_FRAMES		50
 
 cHapticDeviceHandler handler;
 IHapticDevice* hapticDevice;
 IFluid * fluidModel;
 
+double RandomIn(double lo, double hi)
+{
+	return lo + (hi - lo) * rand() / (double)RAND_MAX;
+}
+
+//A fluid with a fixed number of particles scattered through a 10 unit cube, for timing the renderers
+class BenchmarkFluid : public IFluid
+{
+private:
+	vector<BasicFluidParticle> particles;
+	vector<cVector3d> positions;
+	vector<cVector3d> velocities;
+	double maxSpeed;
+	unsigned int version;
+	FluidSpeedStats speedStats;
+
+public:
+	BenchmarkFluid(int count)
+	{
+		maxSpeed = 2.0;
+		version = 0;
+		srand(count);
+		for(int i = 0; i < count; i++)
+		{
+			cVector3d pos(RandomIn(0, 10), RandomIn(0, 10), RandomIn(0, 10));
+			cVector3d vel(RandomIn(-1, 1), RandomIn(-1, 1), RandomIn(-1, 1));
+			particles.push_back(BasicFluidParticle(pos, vel));
+			positions.push_back(pos);
+			velocities.push_back(vel);
+		}
+		speedStats.Compute(&positions[0], &velocities[0], count);
+	}
+
+	void GetAllPoints(vector<IFluidParticle*>& allParticles)
+	{
+		allParticles.resize(particles.size());
+		for(unsigned int i = 0; i < particles.size(); i++)
+			allParticles[i] = &particles[i];
+	}
+	void GetFrame(FluidFrame& frame)
+	{
+		frame.positions = &positions[0];
+		frame.velocities = &velocities[0];
+		frame.count = positions.size();
+		frame.version = version;
+	}
+	int GetCurrentPointCount(void) { return particles.size(); }
+	void GetVelocityAt(cVector3d& velocity, const cVector3d& location) { velocity.zero(); }
+	double GetMaxParticleSpeed(void) { return maxSpeed; }
+	void GetSpeedStats(FluidSpeedStats& stats) { stats = speedStats; }
+	//the particles stand still, but every frame is treated as new so the renderers copy it again
+	void AdvanceFrame(void) { version++; }
+	int GetMaxSimulatedParticles() { return particles.size(); }
+};
+
+//Times one renderer: 'update' copies the frame into the scene, then the camera draws it
+template <class Update>
+double TimeFrames(cCamera* camera, Update& update)
+{
+	cPrecisionClock clock;
+
+	for(int i = 0; i < BENCHMARK_WARMUP_FRAMES; i++)
+	{
+		update();
+		camera->renderView(WINDOW_SIZE_W, WINDOW_SIZE_H);
+	}
+	glFinish();
+
+	clock.start(true);
+	for(int i = 0; i < BENCHMARK_FRAMES; i++)
+	{
+		update();
+		camera->renderView(WINDOW_SIZE_W, WINDOW_SIZE_H);
+		glFinish();
+	}
+	return clock.stop() * 1000.0 / BENCHMARK_FRAMES;
+}
+
+//The old FluidRenderer path: one capSimpleTetra per particle, moved with setPos every frame
+struct TetraUpdate
+{
+	IFluid* fluid;
+	vector<capSimpleTetra*> tetras;
+	vector<IFluidParticle*> points;
+
+	void operator()()
+	{
+		fluid->AdvanceFrame();
+		fluid->GetAllPoints(points);
+		cVector3d pos;
+		for(unsigned int i = 0; i < points.size(); i++)
+		{
+			points[i]->GetPosition(pos);
+			tetras[i]->setPos(pos);
+		}
+	}
+};
+
+struct CloudUpdate
+{
+	IFluid* fluid;
+	ParticleCloud* cloud;
+
+	void operator()()
+	{
+		fluid->AdvanceFrame();
+		cloud->Update(fluid);
+	}
+};
+
+cWorld* NewBenchmarkWorld(cCamera*& camera)
+{
+	cWorld* world = new cWorld();
+	world->setBackgroundColor(0, 0, 0);
+
+	camera = new cCamera(world);
+	world->addChild(camera);
+	camera->set(cVector3d(20, 20, 10), cVector3d(5, 5, 5), cVector3d(0, 0, 1));
+
+	cLight* light = new cLight(world);
+	world->addChild(light);
+	light->setEnabled(true);
+	light->setPos(cVector3d(5, 10, 5));
+	light->setDir(cVector3d(0, -10, 0));
+
+	return world;
+}
+
+//Prints the frame time of each particle renderer at 1k, 10k and 100k particles.
+//Headless machines can run this under xvfb-run (or with Mesa's software opengl32.dll on Windows).
+int RunRenderBenchmark(int argc, char* argv[])
+{
+	glutInit(&argc, argv);
+	glutInitWindowSize(WINDOW_SIZE_W, WINDOW_SIZE_H);
+	glutInitDisplayMode(GLUT_RGBA | GLUT_DEPTH | GLUT_DOUBLE);
+	glutCreateWindow("Particle Benchmark");
+
+	int counts[] = { 1000, 10000, 100000 };
+	cMaterial material;
+	material.m_ambient.set(.5, .5, .5);
+	material.m_diffuse.set(1, 1, 1);
+	material.m_specular.set(1.0, 1.0, 1.0);
+
+	printf("%10s %14s %14s %14s\n", "particles", "tetras (ms)", "points (ms)", "glyphs (ms)");
+
+	for(int c = 0; c < 3; c++)
+	{
+		BenchmarkFluid fluid(counts[c]);
+		double times[3];
+		cCamera* camera;
+
+		//one cMesh per particle
+		cWorld* world = NewBenchmarkWorld(camera);
+		TetraUpdate tetraUpdate;
+		tetraUpdate.fluid = &fluid;
+		for(int i = 0; i < counts[c]; i++)
+		{
+			capSimpleTetra* tetra = new capSimpleTetra(world, 0.03);
+			tetra->m_material = material;
+			world->addChild(tetra);
+			tetraUpdate.tetras.push_back(tetra);
+		}
+		times[0] = TimeFrames(camera, tetraUpdate);
+		delete world;
+
+		//one ParticleCloud, in each style
+		ParticleStyle styles[] = { POINT_SPRITES, GLYPHS };
+		for(int s = 0; s < 2; s++)
+		{
+			world = NewBenchmarkWorld(camera);
+			CloudUpdate cloudUpdate;
+			cloudUpdate.fluid = &fluid;
+			cloudUpdate.cloud = new ParticleCloud(0.03, styles[s]);
+			cloudUpdate.cloud->m_material = material;
+			cloudUpdate.cloud->SetColorBySpeed(true, fluid.GetMaxParticleSpeed());
+			world->addChild(cloudUpdate.cloud);
+			times[s + 1] = TimeFrames(camera, cloudUpdate);
+			delete world;
+		}
+
+		printf("%10d %14.3f %14.3f %14.3f\n", counts[c], times[0], times[1], times[2]);
+	}
+
+	return 0;
+}
 
-int main(void)
+int main(int argc, char* argv[])
 {
+	if(argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+		return RunRenderBenchmark(argc, argv);
 
 	VirtualHapticDevice device;
 	//FalconDevice device;
 
-	GEOFileFluid fluid("../Fluids/fluidBake/demo_day_geometry", 200, 220);
-	fluidModel = &fluid;
+	//--live simulates the fluid as it runs instead of replaying the baked frames
+	if(argc > 1 && strcmp(argv[1], "--live") == 0)
+		fluidModel = new LiveSPHFluid();
+	else
+		fluidModel = new GEOFileFluid("../Fluids/fluidBake/demo_day_geometry", 200, 220);
 
 	device.Init();
 	hapticDevice = &device;
@@ -374,6 +374,31 @@ void cGELMesh::connectVerticesToSkeleton(bool a_connectToNodesOnly)
 }
 
 
+//===========================================================================
+/*!
+    Mark all vertices of a mesh and of its child meshes as modified, so that
+    their vertex buffers (if used) send them again.
+
+    \fn       static void cInvalidateAllVertices(cMesh* a_mesh)
+    \param    a_mesh  Mesh whose vertices moved.
+*/
+//===========================================================================
+static void cInvalidateAllVertices(cMesh* a_mesh)
+{
+    a_mesh->invalidateVertices(0, a_mesh->getNumVertices(false));
+
+    unsigned int numChildren = a_mesh->getNumChildren();
+    for (unsigned int i=0; i<numChildren; i++)
+    {
+        cMesh* child = dynamic_cast<cMesh*>(a_mesh->getChild(i));
+        if (child != NULL)
+        {
+            cInvalidateAllVertices(child);
+        }
+    }
+}
+
+
 //===========================================================================
 /*!
     Update position of vertices connected to skeleton.
@@ -436,6 +461,19 @@ void cGELMesh::updateVertexPosition()
             }
         }
     }
+
+    // every vertex may have moved
+    if (m_useSkeletonModel || m_useMassParticleModel)
+    {
+        cInvalidateAllVertices(this);
+    }
+
+    // keep the collision tree (if there is one) around the deformed surface
+    if (m_collisionDetector != NULL)
+    {
+        refitCollisionDetector(CHAI_COLLISION_MAX_DEGRADATION, false);
+        updateBoundaryBox();
+    }
 }
 
 
@@ -65,12 +65,16 @@
 //---------------------------------------------------------------------------
 #include "graphics/CColor.h"
 #include "graphics/CDraw3D.h"
+#include "graphics/CFrustum.h"
 #include "graphics/CGenericTexture.h"
 #include "graphics/CMacrosGL.h"
 #include "graphics/CMaterial.h"
+#include "graphics/COcclusionQuery.h"
 #include "graphics/CTexture2D.h"
 #include "graphics/CTriangle.h"
+#include "graphics/CTrianglePacket.h"
 #include "graphics/CVertex.h"
+#include "graphics/CVertexBuffer.h"
 
 
 //---------------------------------------------------------------------------
@@ -139,7 +143,10 @@
 #include "collisions/CCollisionAABBBox.h"
 #include "collisions/CCollisionAABBTree.h"
 #include "collisions/CCollisionBasics.h"
+#include "collisions/CCollisionBroadPhase.h"
 #include "collisions/CCollisionBrute.h"
+#include "collisions/CCollisionBVH.h"
+#include "collisions/CCollisionContactCache.h"
 #include "collisions/CCollisionSpheres.h"
 #include "collisions/CCollisionSpheresGeometry.h"
 #include "collisions/CGenericCollision.h"
@@ -48,6 +48,8 @@ cCollisionAABB::cCollisionAABB(vector<cTriangle> *a_triangles, bool a_useNeighbo
     m_leaves        = NULL;
     m_numTriangles  = 0;
     m_useNeighbors  = a_useNeighbors;
+    m_radius        = 0;
+    m_buildCost     = 0;
 }
 
 
@@ -100,11 +102,20 @@ void cCollisionAABB::initialize(double a_radius)
 {
     unsigned int i;
     m_lastCollision = NULL;
+    m_contactCache.clear();
+    m_radius = a_radius;
 
-    // if a previous tree was created, delete it
+    // if a previous tree was created, delete it (with a single triangle,
+    // the root is the only leaf)
     if (m_root != NULL)
     {
-        delete[] m_root;
+        if (m_numTriangles > 1)
+        {
+            delete [] m_internalNodes;
+            m_internalNodes = NULL;
+        }
+        delete [] m_leaves;
+        m_leaves = NULL;
         m_root = NULL;
     }
 
@@ -159,6 +170,174 @@ void cCollisionAABB::initialize(double a_radius)
 
     // assign parent relationships in the tree
     m_root->setParent(0,1);
+
+    // remember how good the tree was, so that refit() can tell when it degrades
+    m_buildCost = computeCost();
+}
+
+
+//===========================================================================
+/*!
+    Update the bounding boxes of the tree to the current positions of the
+    vertices, without changing its structure. The leaves are refitted to
+    their triangles, then each internal node to its children. Internal nodes
+    are allocated before their children, so walking the array backwards
+    visits every child before its parent. 
+
+
+    As the vertices move away from where they were when the tree was built,
+    the boxes can grow to overlap each other and queries slow down. If
+    \e a_maxDegradation is positive and the cost of the refitted tree (see
+    computeCost()) has grown past \e a_maxDegradation times its cost when it
+    was built, the tree is rebuilt instead. 
+
+
+    The triangles of the mesh must not have been added, removed or
+    reallocated since the tree was built.
+
+    \fn       bool cCollisionAABB::refit(double a_maxDegradation)
+    \param    a_maxDegradation  Growth in cost past which the tree is rebuilt;
+                                0 never rebuilds.
+    \return   Return \b true if the tree was rebuilt.
+*/
+//===========================================================================
+bool cCollisionAABB::refit(double a_maxDegradation)
+{
+    if (m_root == NULL)
+    {
+        return (false);
+    }
+
+    // refit the leaves to their triangles
+    unsigned int i;
+    for (i = 0; i < m_numTriangles; ++i)
+    {
+        m_leaves[i].fitBBox(m_radius);
+    }
+
+    // refit the internal nodes, children first
+    if (m_numTriangles > 1)
+    {
+        for (i = m_numTriangles - 1; i > 0; --i)
+        {
+            m_internalNodes[i - 1].fitBBox();
+        }
+    }
+
+    // rebuild the tree if it has become much worse than when it was built
+    if ((a_maxDegradation > 0) && (computeCost() > a_maxDegradation * m_buildCost))
+    {
+        initialize(m_radius);
+        return (true);
+    }
+
+    // triangles may have moved into the cached region
+    m_contactCache.clear();
+
+    return (false);
+}
+
+
+//===========================================================================
+/*!
+    Compute the cost of the tree with the surface area heuristic: the sum of
+    the surface areas of the internal boxes, relative to that of the root.
+    This is the number of internal nodes that a random segment through the
+    root is expected to visit, so it grows as the boxes overlap more.
+
+    \fn       double cCollisionAABB::computeCost()
+    \return   Return the cost of the tree (0 for a single leaf).
+*/
+//===========================================================================
+double cCollisionAABB::computeCost()
+{
+    if (m_numTriangles < 2)
+    {
+        return (0.0);
+    }
+
+    // the root is the first internal node
+    double area = 0.0;
+    double rootArea = 0.0;
+    for (unsigned int i = 0; i < m_numTriangles - 1; ++i)
+    {
+        cVector3d size = m_internalNodes[i].m_bbox.getExtent();
+        double nodeArea = size.x * size.y + size.y * size.z + size.z * size.x;
+        area += nodeArea;
+        if (i == 0)
+        {
+            rootArea = nodeArea;
+        }
+    }
+
+    if (rootArea <= 0.0)
+    {
+        return (0.0);
+    }
+    return (area / rootArea);
+}
+
+
+//===========================================================================
+/*!
+    Collect the triangles whose boxes overlap a region, for the contact
+    cache. Gives up once more than CHAI_COLLISION_CACHE_MAX_TRIANGLES are
+    found, as testing them all would cost more than searching the tree.
+
+    \fn       bool cCollisionAABB::collectTriangles(const cCollisionAABBBox& a_region,
+              vector<unsigned int>& a_indices) const
+    \param    a_region  Region to collect the triangles of.
+    \param    a_indices  Returns the indices of the triangles in the mesh.
+    \return   Return \b false if there were too many triangles.
+*/
+//===========================================================================
+bool cCollisionAABB::collectTriangles(const cCollisionAABBBox& a_region,
+                                      vector<unsigned int>& a_indices) const
+{
+    a_indices.clear();
+    if (m_root == NULL)
+    {
+        return (true);
+    }
+
+    const cTriangle* first = &(*m_triangles)[0];
+    vector<const cCollisionAABBNode*> stack;
+    stack.push_back(m_root);
+
+    while (!stack.empty())
+    {
+        const cCollisionAABBNode* node = stack.back();
+        stack.pop_back();
+
+        const cCollisionAABBBox& box = node->m_bbox;
+        if ((box.getUpperX() < a_region.getLowerX()) || (box.getLowerX() > a_region.getUpperX()) ||
+            (box.getUpperY() < a_region.getLowerY()) || (box.getLowerY() > a_region.getUpperY()) ||
+            (box.getUpperZ() < a_region.getLowerZ()) || (box.getLowerZ() > a_region.getUpperZ()))
+        {
+            continue;
+        }
+
+        if (node->m_nodeType == AABB_NODE_LEAF)
+        {
+            const cTriangle* triangle = ((const cCollisionAABBLeaf*)node)->m_triangle;
+            if (cCollisionContactCache::overlaps(a_region, *triangle))
+            {
+                if (a_indices.size() == CHAI_COLLISION_CACHE_MAX_TRIANGLES)
+                {
+                    return (false);
+                }
+                a_indices.push_back((unsigned int)(triangle - first));
+            }
+        }
+        else
+        {
+            const cCollisionAABBInternal* internal = (const cCollisionAABBInternal*)node;
+            stack.push_back(internal->m_leftSubTree);
+            stack.push_back(internal->m_rightSubTree);
+        }
+    }
+
+    return (true);
 }
 
 
@@ -173,7 +352,10 @@ void cCollisionAABB::initialize(double a_radius)
     AABB boxes, starting at the root and recursing through the tree, breaking
     the recursion along any path in which the bounding box of the line segment
     does not intersect the bounding box of the node.  At the leafs,
-    triangle-segment intersection testing is called.
+    triangle-segment intersection testing is called.  With the contact cache
+    in use, the tree is only searched if the triangles around the last
+    contact do not answer the query, and the region around the contact is
+    cached again afterwards.
 
     \fn       bool cCollisionAABB::computeCollision(cVector3d& a_segmentPointA,
               cVector3d& a_segmentPointB, cCollisionRecorder& a_recorder,
@@ -194,6 +376,15 @@ bool cCollisionAABB::computeCollision(cVector3d& a_segmentPointA, cVector3d& a_s
         return (false);
     }
 
+    // the triangles around the last contact usually answer the query
+    bool cached = false;
+    bool coherent = a_settings.m_useContactCache && a_settings.m_checkForNearestCollisionOnly;
+    if (coherent && m_contactCache.computeCollision(m_triangles, a_segmentPointA, a_segmentPointB,
+                                                    a_recorder, a_settings, cached))
+    {
+        return (cached);
+    }
+
     // create an axis-aligned bounding box for the line
     cCollisionAABBBox lineBox;
     lineBox.setEmpty();
@@ -206,12 +397,97 @@ bool cCollisionAABB::computeCollision(cVector3d& a_segmentPointA, cVector3d& a_s
                                            a_segmentPointB, 
                                            lineBox,
                                            a_recorder, a_settings);
+    result = result || cached;
+
+    // cache the region around the new contact
+    cCollisionAABBBox region;
+    if (coherent && result && m_contactCache.computeRegion(m_triangles, a_segmentPointA, a_recorder,
+                                                           a_settings, region))
+    {
+        vector<unsigned int> indices;
+        if (collectTriangles(region, indices))
+        {
+            m_contactCache.set(m_triangles, region, indices);
+        }
+        else
+        {
+            m_contactCache.clear();
+        }
+    }
 
     // return whether there was an intersection
     return result;
 }
 
 
+//===========================================================================
+/*!
+    Find the point of the mesh nearest to the given point, within a maximum
+    distance of it. The tree is searched branch and bound: the child whose
+    box is nearer to the point is visited first, and nodes whose boxes are
+    farther than the nearest point found so far are skipped.
+
+    \fn       bool cCollisionAABB::computeClosestPoint(const cVector3d& a_point,
+              const double a_maxDistance, cProximityEvent& a_event)
+    \param    a_point  Point to search from.
+    \param    a_maxDistance  Largest distance to search to.
+    \param    a_event  Returns the nearest point, if it is nearer than the
+                       point already stored there.
+    \return   Return true if a nearer point was found.
+*/
+//===========================================================================
+bool cCollisionAABB::computeClosestPoint(const cVector3d& a_point,
+         const double a_maxDistance, cProximityEvent& a_event)
+{
+    if (m_root == NULL)
+    {
+        return (false);
+    }
+
+    bool found = false;
+    double maxSquareDistance = cSqr(a_maxDistance);
+    vector<const cCollisionAABBNode*> stack;
+    stack.push_back(m_root);
+
+    while (!stack.empty())
+    {
+        const cCollisionAABBNode* node = stack.back();
+        stack.pop_back();
+
+        // nothing in this node can be nearer than the nearest point so far
+        double bound = cMin(maxSquareDistance, a_event.m_squareDistance);
+        if (node->m_bbox.squareDistance(a_point) > bound)
+        {
+            continue;
+        }
+
+        if (node->m_nodeType == AABB_NODE_LEAF)
+        {
+            const cTriangle* triangle = ((const cCollisionAABBLeaf*)node)->m_triangle;
+            if (triangle->computeClosestPoint(a_point, maxSquareDistance, a_event))
+            {
+                found = true;
+            }
+        }
+        else
+        {
+            // push the far child first, so that the near child is popped first
+            const cCollisionAABBInternal* internal = (const cCollisionAABBInternal*)node;
+            const cCollisionAABBNode* nearChild = internal->m_leftSubTree;
+            const cCollisionAABBNode* farChild = internal->m_rightSubTree;
+            if (farChild->m_bbox.squareDistance(a_point) < nearChild->m_bbox.squareDistance(a_point))
+            {
+                cSwap(nearChild, farChild);
+            }
+            stack.push_back(farChild);
+            stack.push_back(nearChild);
+        }
+    }
+
+    return (found);
+}
+
+
 //===========================================================================
 /*!
     Render the bounding boxes of the collision tree in OpenGL.
@@ -29,6 +29,7 @@
 #include "collisions/CGenericCollision.h"
 #include "collisions/CCollisionAABBBox.h"
 #include "collisions/CCollisionAABBTree.h"
+#include "collisions/CCollisionContactCache.h"
 #include <vector>
 //---------------------------------------------------------------------------
 
@@ -50,7 +51,11 @@
     \brief    
     cCollisionAABB provides methods to create an Axis-Aligned Bounding Box 
     collision detection tree, and to use this tree to check for the 
-    intersection of a line segment with a mesh.
+    intersection of a line segment with a mesh. \n
+
+    Queries with \e m_useContactCache set in their settings first test the
+    triangles around the last contact, which usually answers them without
+    searching the tree (see cCollisionContactCache).
 */
 //===========================================================================
 class cCollisionAABB : public cGenericCollision
@@ -82,9 +87,19 @@ class cCollisionAABB : public cGenericCollision
     bool computeCollision(cVector3d& a_segmentPointA, cVector3d& a_segmentPointB,
          cCollisionRecorder& a_recorder, cCollisionSettings& a_settings);
 
+    //! Find the point of the mesh nearest to the given point, within a maximum distance of it.
+    bool computeClosestPoint(const cVector3d& a_point, const double a_maxDistance,
+         cProximityEvent& a_event);
+
+    //! Update the boxes to the current vertex positions, rebuilding the tree if it has degraded too much.
+    bool refit(double a_maxDegradation = 0);
+
     //! Return the root node of the collision tree.
     cCollisionAABBNode* getRoot() { return (m_root); }
 
+    //! Return the triangles cached around the last contact.
+    const cCollisionContactCache& getContactCache() const { return (m_contactCache); }
+
 
   protected:
 
@@ -112,6 +127,26 @@ class cCollisionAABB : public cGenericCollision
 
     //! Use list of triangles' neighbors to speed up collision detection?
     bool m_useNeighbors;
+
+    //! Radius added around the triangles when the tree was built.
+    double m_radius;
+
+    //! Cost of the tree when it was built (see computeCost()).
+    double m_buildCost;
+
+    //! Triangles around the last contact.
+    cCollisionContactCache m_contactCache;
+
+
+	//-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Return the total area of the internal boxes relative to the root's.
+    double computeCost();
+
+    //! Collect the triangles overlapping a region, unless there are too many.
+    bool collectTriangles(const cCollisionAABBBox& a_region, vector<unsigned int>& a_indices) const;
 };
 
 //---------------------------------------------------------------------------
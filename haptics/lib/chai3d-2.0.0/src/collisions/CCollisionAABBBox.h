@@ -113,6 +113,27 @@ class cCollisionAABBBox
     }
 
 
+    //-----------------------------------------------------------------------
+    /*!
+        Return the square of the distance from the given point to this box.
+
+        \fn       double cCollisionAABBBox::squareDistance(const cVector3d& a_p) const
+        \return   Returns the square distance, or 0 if the box contains the point.
+    */
+    //-----------------------------------------------------------------------
+    inline double squareDistance(const cVector3d& a_p) const
+    {
+        // add the distance beyond the box along each axis
+        double result = 0.0;
+        for (int axis=0; axis<3; axis++)
+        {
+            if (a_p[axis] < m_min[axis]) { result += cSqr(m_min[axis] - a_p[axis]); }
+            else if (a_p[axis] > m_max[axis]) { result += cSqr(a_p[axis] - m_max[axis]); }
+        }
+        return (result);
+    }
+
+
     //-----------------------------------------------------------------------
     /*!
         Set the bounding box to bound the two given bounding boxes.
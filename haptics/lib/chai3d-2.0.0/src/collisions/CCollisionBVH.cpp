@@ -0,0 +1,1207 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#include "collisions/CCollisionBVH.h"
+#include "graphics/CDraw3D.h"
+#include <algorithm>
+#include <float.h>
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    Bounds of a triangle while the tree is being built.
+*/
+//===========================================================================
+struct cCollisionBVHPrimitive
+{
+    //! Minimum corner of the box around the triangle.
+    cVector3d m_min;
+
+    //! Maximum corner of the box around the triangle.
+    cVector3d m_max;
+
+    //! Center of the box around the triangle, used to sort triangles into bins.
+    cVector3d m_centroid;
+};
+
+
+//===========================================================================
+/*!
+    A subtree built on its own thread, with its nodes indexed from zero.
+*/
+//===========================================================================
+struct cCollisionBVHTask
+{
+    //! First triangle index of the subtree.
+    unsigned int m_begin;
+
+    //! One past the last triangle index of the subtree.
+    unsigned int m_end;
+
+    //! Depth of the subtree's root in the whole tree.
+    unsigned int m_depth;
+
+    //! Nodes of the subtree, depth first.
+    vector<cCollisionBVHNode> m_nodes;
+};
+
+
+//===========================================================================
+/*!
+    A node above the subtrees that are built in parallel. Either it is split
+    in two (\e m_left and \e m_right) or it is the root of a subtree
+    (\e m_task).
+*/
+//===========================================================================
+struct cCollisionBVHTopNode
+{
+    //! Minimum corner of the box around the node's triangles.
+    cVector3d m_min;
+
+    //! Maximum corner of the box around the node's triangles.
+    cVector3d m_max;
+
+    //! Axis along which the node was split.
+    int m_axis;
+
+    //! First child, or -1 if the node is the root of a subtree.
+    int m_left;
+
+    //! Second child, or -1 if the node is the root of a subtree.
+    int m_right;
+
+    //! Subtree built from this node, or -1 if the node is split.
+    int m_task;
+};
+
+
+//===========================================================================
+/*!
+    Round a value down to the nearest float that is not greater than it.
+
+    \fn     static inline float cFloatBelow(const double a_value)
+    \param  a_value  Value to round.
+    \return Return the rounded value.
+*/
+//===========================================================================
+static inline float cFloatBelow(const double a_value)
+{
+    float result = (float)a_value;
+    if ((double)result > a_value) { result -= cAbs(result) * FLT_EPSILON + FLT_MIN; }
+    return (result);
+}
+
+
+//===========================================================================
+/*!
+    Round a value up to the nearest float that is not smaller than it.
+
+    \fn     static inline float cFloatAbove(const double a_value)
+    \param  a_value  Value to round.
+    \return Return the rounded value.
+*/
+//===========================================================================
+static inline float cFloatAbove(const double a_value)
+{
+    float result = (float)a_value;
+    if ((double)result < a_value) { result += cAbs(result) * FLT_EPSILON + FLT_MIN; }
+    return (result);
+}
+
+
+//===========================================================================
+/*!
+    Compute half of the surface area of a box, which is all the surface
+    area heuristic needs to compare boxes.
+
+    \fn     static inline double cHalfArea(const cVector3d& a_min, const cVector3d& a_max)
+    \param  a_min  Minimum corner of the box.
+    \param  a_max  Maximum corner of the box.
+    \return Return half of the surface area, or 0 for an empty box.
+*/
+//===========================================================================
+static inline double cHalfArea(const cVector3d& a_min, const cVector3d& a_max)
+{
+    cVector3d size = cSub(a_max, a_min);
+    if ((size.x < 0) || (size.y < 0) || (size.z < 0)) { return (0.0); }
+    return (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+
+//===========================================================================
+/*!
+    Compute the box around a range of triangles, and the box around their
+    centroids.
+
+    \fn     static void cComputeBVHBounds(const cCollisionBVHPrimitive* a_primitives,
+                                          const unsigned int* a_indices,
+                                          unsigned int a_begin, unsigned int a_end,
+                                          cVector3d& a_min, cVector3d& a_max,
+                                          cVector3d& a_centroidMin,
+                                          cVector3d& a_centroidMax)
+    \param  a_primitives  Bounds of all triangles.
+    \param  a_indices  Triangle indices.
+    \param  a_begin  First index of the range.
+    \param  a_end  One past the last index of the range.
+    \param  a_min  Returns the minimum corner of the box around the triangles.
+    \param  a_max  Returns the maximum corner of the box around the triangles.
+    \param  a_centroidMin  Returns the minimum corner of the box around the centroids.
+    \param  a_centroidMax  Returns the maximum corner of the box around the centroids.
+*/
+//===========================================================================
+static void cComputeBVHBounds(const cCollisionBVHPrimitive* a_primitives,
+                              const unsigned int* a_indices,
+                              unsigned int a_begin, unsigned int a_end,
+                              cVector3d& a_min, cVector3d& a_max,
+                              cVector3d& a_centroidMin, cVector3d& a_centroidMax)
+{
+    a_min.set(CHAI_LARGE, CHAI_LARGE, CHAI_LARGE);
+    a_max.set(-CHAI_LARGE, -CHAI_LARGE, -CHAI_LARGE);
+    a_centroidMin = a_min;
+    a_centroidMax = a_max;
+
+    for (unsigned int i=a_begin; i<a_end; i++)
+    {
+        const cCollisionBVHPrimitive& primitive = a_primitives[a_indices[i]];
+        for (int axis=0; axis<3; axis++)
+        {
+            a_min[axis] = cMin(a_min[axis], primitive.m_min[axis]);
+            a_max[axis] = cMax(a_max[axis], primitive.m_max[axis]);
+            a_centroidMin[axis] = cMin(a_centroidMin[axis], primitive.m_centroid[axis]);
+            a_centroidMax[axis] = cMax(a_centroidMax[axis], primitive.m_centroid[axis]);
+        }
+    }
+}
+
+
+//===========================================================================
+/*!
+    Function object that tells whether a triangle's centroid falls in the
+    bins at or below a split.
+*/
+//===========================================================================
+struct cCollisionBVHBinBelow
+{
+    const cCollisionBVHPrimitive* m_primitives;
+    int m_axis;
+    double m_origin;
+    double m_scale;
+    int m_numBins;
+    int m_split;
+
+    bool operator()(unsigned int a_index) const
+    {
+        int bin = (int)((m_primitives[a_index].m_centroid[m_axis] - m_origin) * m_scale);
+        if (bin > m_numBins - 1) { bin = m_numBins - 1; }
+        return (bin <= m_split);
+    }
+};
+
+
+//===========================================================================
+/*!
+    Function object that orders triangles by their centroid along an axis.
+*/
+//===========================================================================
+struct cCollisionBVHCentroidLess
+{
+    const cCollisionBVHPrimitive* m_primitives;
+    int m_axis;
+
+    bool operator()(unsigned int a_index0, unsigned int a_index1) const
+    {
+        return (m_primitives[a_index0].m_centroid[m_axis] < m_primitives[a_index1].m_centroid[m_axis]);
+    }
+};
+
+
+//===========================================================================
+/*!
+    Decide how to split a range of triangles, and reorder their indices so
+    that the triangles of the first child come first. The split is chosen
+    with the binned surface area heuristic. Deep in the tree, or when the
+    centroids cannot be told apart, the range is split at its median
+    instead, which bounds the depth of the tree.
+
+    \fn     static unsigned int cSplitBVHRange(const cCollisionBVHPrimitive* a_primitives,
+                                                unsigned int* a_indices,
+                                                unsigned int a_begin, unsigned int a_end,
+                                                unsigned int a_depth,
+                                                const cVector3d& a_min, const cVector3d& a_max,
+                                                const cVector3d& a_centroidMin,
+                                                const cVector3d& a_centroidMax,
+                                                int& a_axis)
+    \param  a_primitives  Bounds of all triangles.
+    \param  a_indices  Triangle indices.
+    \param  a_begin  First index of the range.
+    \param  a_end  One past the last index of the range.
+    \param  a_depth  Depth of the node in the tree.
+    \param  a_min  Minimum corner of the box around the triangles.
+    \param  a_max  Maximum corner of the box around the triangles.
+    \param  a_centroidMin  Minimum corner of the box around the centroids.
+    \param  a_centroidMax  Maximum corner of the box around the centroids.
+    \param  a_axis  Returns the axis of the split.
+    \return Return the first index of the second child, or \e a_end if the
+            range should become a leaf.
+*/
+//===========================================================================
+static unsigned int cSplitBVHRange(const cCollisionBVHPrimitive* a_primitives,
+                                   unsigned int* a_indices,
+                                   unsigned int a_begin, unsigned int a_end,
+                                   unsigned int a_depth,
+                                   const cVector3d& a_min, const cVector3d& a_max,
+                                   const cVector3d& a_centroidMin,
+                                   const cVector3d& a_centroidMax,
+                                   int& a_axis)
+{
+    unsigned int count = a_end - a_begin;
+    cVector3d extent = cSub(a_centroidMax, a_centroidMin);
+
+    a_axis = 0;
+    if (extent.y > extent[a_axis]) { a_axis = 1; }
+    if (extent.z > extent[a_axis]) { a_axis = 2; }
+
+    if ((count == 1) || (a_depth >= CHAI_BVH_MAX_DEPTH - 1))
+    {
+        return (a_end);
+    }
+
+    // the heuristic is only trusted in the upper half of the tree
+    if ((a_depth < CHAI_BVH_MAX_DEPTH / 2) && (extent[a_axis] > 0.0))
+    {
+        double parentArea = cHalfArea(a_min, a_max);
+
+        // small ranges need no more bins than they have triangles
+        int numBins = (count < CHAI_BVH_NUM_BINS) ? (int)count : CHAI_BVH_NUM_BINS;
+        double bestCost = CHAI_LARGE;
+        int bestAxis = -1;
+        int bestSplit = -1;
+
+        for (int axis=0; axis<3; axis++)
+        {
+            if (extent[axis] <= 0.0) { continue; }
+
+            // sort the triangles into bins by centroid
+            unsigned int binCount[CHAI_BVH_NUM_BINS];
+            cVector3d binMin[CHAI_BVH_NUM_BINS];
+            cVector3d binMax[CHAI_BVH_NUM_BINS];
+            for (int bin=0; bin<numBins; bin++)
+            {
+                binCount[bin] = 0;
+                binMin[bin].set(CHAI_LARGE, CHAI_LARGE, CHAI_LARGE);
+                binMax[bin].set(-CHAI_LARGE, -CHAI_LARGE, -CHAI_LARGE);
+            }
+
+            double scale = numBins / extent[axis];
+            for (unsigned int i=a_begin; i<a_end; i++)
+            {
+                const cCollisionBVHPrimitive& primitive = a_primitives[a_indices[i]];
+                int bin = (int)((primitive.m_centroid[axis] - a_centroidMin[axis]) * scale);
+                if (bin > numBins - 1) { bin = numBins - 1; }
+
+                binCount[bin]++;
+                for (int k=0; k<3; k++)
+                {
+                    binMin[bin][k] = cMin(binMin[bin][k], primitive.m_min[k]);
+                    binMax[bin][k] = cMax(binMax[bin][k], primitive.m_max[k]);
+                }
+            }
+
+            // sweep from the right to find the area and count on the right of each split
+            double rightArea[CHAI_BVH_NUM_BINS];
+            unsigned int rightCount[CHAI_BVH_NUM_BINS];
+            cVector3d boxMin(CHAI_LARGE, CHAI_LARGE, CHAI_LARGE);
+            cVector3d boxMax(-CHAI_LARGE, -CHAI_LARGE, -CHAI_LARGE);
+            unsigned int sum = 0;
+            for (int bin=numBins-1; bin>0; bin--)
+            {
+                sum += binCount[bin];
+                for (int k=0; k<3; k++)
+                {
+                    boxMin[k] = cMin(boxMin[k], binMin[bin][k]);
+                    boxMax[k] = cMax(boxMax[k], binMax[bin][k]);
+                }
+                rightArea[bin - 1] = cHalfArea(boxMin, boxMax);
+                rightCount[bin - 1] = sum;
+            }
+
+            // sweep from the left and evaluate each split between bins
+            boxMin.set(CHAI_LARGE, CHAI_LARGE, CHAI_LARGE);
+            boxMax.set(-CHAI_LARGE, -CHAI_LARGE, -CHAI_LARGE);
+            sum = 0;
+            for (int split=0; split<numBins-1; split++)
+            {
+                sum += binCount[split];
+                for (int k=0; k<3; k++)
+                {
+                    boxMin[k] = cMin(boxMin[k], binMin[split][k]);
+                    boxMax[k] = cMax(boxMax[k], binMax[split][k]);
+                }
+
+                if ((sum == 0) || (rightCount[split] == 0)) { continue; }
+
+                double cost = CHAI_BVH_TRAVERSAL_COST +
+                              (cHalfArea(boxMin, boxMax) * sum +
+                               rightArea[split] * rightCount[split]) / parentArea;
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        // a small range stays a leaf unless splitting it is cheaper
+        if ((count <= CHAI_BVH_MAX_LEAF_SIZE) && (bestCost >= (double)count))
+        {
+            return (a_end);
+        }
+
+        if (bestAxis >= 0)
+        {
+            cCollisionBVHBinBelow below;
+            below.m_primitives = a_primitives;
+            below.m_axis = bestAxis;
+            below.m_origin = a_centroidMin[bestAxis];
+            below.m_scale = numBins / extent[bestAxis];
+            below.m_numBins = numBins;
+            below.m_split = bestSplit;
+
+            unsigned int* middle = std::partition(a_indices + a_begin, a_indices + a_end, below);
+            unsigned int split = (unsigned int)(middle - a_indices);
+            if ((split > a_begin) && (split < a_end))
+            {
+                a_axis = bestAxis;
+                return (split);
+            }
+        }
+    }
+    else if (count <= CHAI_BVH_MAX_LEAF_SIZE)
+    {
+        return (a_end);
+    }
+
+    // split at the median along the longest axis of the centroids
+    cCollisionBVHCentroidLess less;
+    less.m_primitives = a_primitives;
+    less.m_axis = a_axis;
+
+    unsigned int middle = a_begin + count / 2;
+    std::nth_element(a_indices + a_begin, a_indices + middle, a_indices + a_end, less);
+    return (middle);
+}
+
+
+//===========================================================================
+/*!
+    Store a box in a node, rounded outwards to single precision.
+
+    \fn     static void cSetBVHNodeBox(cCollisionBVHNode& a_node,
+                                       const cVector3d& a_min,
+                                       const cVector3d& a_max)
+    \param  a_node  Node to set.
+    \param  a_min  Minimum corner of the box.
+    \param  a_max  Maximum corner of the box.
+*/
+//===========================================================================
+static void cSetBVHNodeBox(cCollisionBVHNode& a_node,
+                           const cVector3d& a_min,
+                           const cVector3d& a_max)
+{
+    for (int axis=0; axis<3; axis++)
+    {
+        a_node.m_min[axis] = cFloatBelow(a_min[axis]);
+        a_node.m_max[axis] = cFloatAbove(a_max[axis]);
+    }
+}
+
+
+//===========================================================================
+/*!
+    Build the subtree over a range of triangles, appending its nodes depth
+    first.
+
+    \fn     static void cBuildBVHSubtree(const cCollisionBVHPrimitive* a_primitives,
+                                         unsigned int* a_indices,
+                                         unsigned int a_begin, unsigned int a_end,
+                                         unsigned int a_depth,
+                                         vector<cCollisionBVHNode>& a_nodes)
+    \param  a_primitives  Bounds of all triangles.
+    \param  a_indices  Triangle indices.
+    \param  a_begin  First index of the range.
+    \param  a_end  One past the last index of the range.
+    \param  a_depth  Depth of the subtree's root in the whole tree.
+    \param  a_nodes  Nodes of the subtree.
+*/
+//===========================================================================
+static void cBuildBVHSubtree(const cCollisionBVHPrimitive* a_primitives,
+                             unsigned int* a_indices,
+                             unsigned int a_begin, unsigned int a_end,
+                             unsigned int a_depth,
+                             vector<cCollisionBVHNode>& a_nodes)
+{
+    cVector3d boxMin, boxMax, centroidMin, centroidMax;
+    cComputeBVHBounds(a_primitives, a_indices, a_begin, a_end,
+                      boxMin, boxMax, centroidMin, centroidMax);
+
+    unsigned int nodeIndex = (unsigned int)a_nodes.size();
+    cCollisionBVHNode node;
+    cSetBVHNodeBox(node, boxMin, boxMax);
+    node.m_unused = 0;
+
+    int axis;
+    unsigned int split = cSplitBVHRange(a_primitives, a_indices, a_begin, a_end, a_depth,
+                                        boxMin, boxMax, centroidMin, centroidMax, axis);
+    node.m_axis = (unsigned char)axis;
+
+    if (split == a_end)
+    {
+        node.m_index = a_begin;
+        node.m_numTriangles = (unsigned short)(a_end - a_begin);
+        a_nodes.push_back(node);
+        return;
+    }
+
+    node.m_numTriangles = 0;
+    a_nodes.push_back(node);
+
+    // the first child follows its parent; the second comes after the first's subtree
+    cBuildBVHSubtree(a_primitives, a_indices, a_begin, split, a_depth + 1, a_nodes);
+    a_nodes[nodeIndex].m_index = (unsigned int)a_nodes.size();
+    cBuildBVHSubtree(a_primitives, a_indices, split, a_end, a_depth + 1, a_nodes);
+}
+
+
+//===========================================================================
+/*!
+    Split the top of the tree until the remaining subtrees are small enough
+    to be built on one thread each.
+
+    \fn     static int cSplitBVHTop(const cCollisionBVHPrimitive* a_primitives,
+                                    unsigned int* a_indices,
+                                    unsigned int a_begin, unsigned int a_end,
+                                    unsigned int a_depth,
+                                    vector<cCollisionBVHTopNode>& a_topNodes,
+                                    vector<cCollisionBVHTask>& a_tasks)
+    \param  a_primitives  Bounds of all triangles.
+    \param  a_indices  Triangle indices.
+    \param  a_begin  First index of the range.
+    \param  a_end  One past the last index of the range.
+    \param  a_depth  Depth of the node in the tree.
+    \param  a_topNodes  Nodes above the subtrees.
+    \param  a_tasks  Subtrees left to build.
+    \return Return the index of the new node in \e a_topNodes.
+*/
+//===========================================================================
+static int cSplitBVHTop(const cCollisionBVHPrimitive* a_primitives,
+                        unsigned int* a_indices,
+                        unsigned int a_begin, unsigned int a_end,
+                        unsigned int a_depth,
+                        vector<cCollisionBVHTopNode>& a_topNodes,
+                        vector<cCollisionBVHTask>& a_tasks)
+{
+    int nodeIndex = (int)a_topNodes.size();
+    cCollisionBVHTopNode node;
+    node.m_axis = 0;
+    node.m_left = -1;
+    node.m_right = -1;
+    node.m_task = -1;
+
+    unsigned int split = a_end;
+    if (a_end - a_begin >= CHAI_BVH_PARALLEL_SIZE)
+    {
+        cVector3d centroidMin, centroidMax;
+        cComputeBVHBounds(a_primitives, a_indices, a_begin, a_end,
+                          node.m_min, node.m_max, centroidMin, centroidMax);
+        split = cSplitBVHRange(a_primitives, a_indices, a_begin, a_end, a_depth,
+                               node.m_min, node.m_max, centroidMin, centroidMax, node.m_axis);
+    }
+
+    if (split == a_end)
+    {
+        cCollisionBVHTask task;
+        task.m_begin = a_begin;
+        task.m_end = a_end;
+        task.m_depth = a_depth;
+        node.m_task = (int)a_tasks.size();
+        a_tasks.push_back(task);
+        a_topNodes.push_back(node);
+        return (nodeIndex);
+    }
+
+    a_topNodes.push_back(node);
+    int left = cSplitBVHTop(a_primitives, a_indices, a_begin, split, a_depth + 1, a_topNodes, a_tasks);
+    int right = cSplitBVHTop(a_primitives, a_indices, split, a_end, a_depth + 1, a_topNodes, a_tasks);
+    a_topNodes[nodeIndex].m_left = left;
+    a_topNodes[nodeIndex].m_right = right;
+    return (nodeIndex);
+}
+
+
+//===========================================================================
+/*!
+    Append the nodes above the subtrees and the subtrees themselves depth
+    first, offsetting the node indices of each subtree to its final place.
+
+    \fn     static void cAppendBVHTop(const vector<cCollisionBVHTopNode>& a_topNodes,
+                                      const vector<cCollisionBVHTask>& a_tasks,
+                                      int a_nodeIndex,
+                                      vector<cCollisionBVHNode>& a_nodes)
+    \param  a_topNodes  Nodes above the subtrees.
+    \param  a_tasks  Built subtrees.
+    \param  a_nodeIndex  Node of \e a_topNodes to append.
+    \param  a_nodes  Nodes of the whole tree.
+*/
+//===========================================================================
+static void cAppendBVHTop(const vector<cCollisionBVHTopNode>& a_topNodes,
+                          const vector<cCollisionBVHTask>& a_tasks,
+                          int a_nodeIndex,
+                          vector<cCollisionBVHNode>& a_nodes)
+{
+    const cCollisionBVHTopNode& topNode = a_topNodes[a_nodeIndex];
+
+    if (topNode.m_task >= 0)
+    {
+        const vector<cCollisionBVHNode>& subtree = a_tasks[topNode.m_task].m_nodes;
+        unsigned int offset = (unsigned int)a_nodes.size();
+        for (unsigned int i=0; i<subtree.size(); i++)
+        {
+            cCollisionBVHNode node = subtree[i];
+            if (node.m_numTriangles == 0) { node.m_index += offset; }
+            a_nodes.push_back(node);
+        }
+        return;
+    }
+
+    unsigned int nodeIndex = (unsigned int)a_nodes.size();
+    cCollisionBVHNode node;
+    cSetBVHNodeBox(node, topNode.m_min, topNode.m_max);
+    node.m_numTriangles = 0;
+    node.m_axis = (unsigned char)topNode.m_axis;
+    node.m_unused = 0;
+    a_nodes.push_back(node);
+
+    cAppendBVHTop(a_topNodes, a_tasks, topNode.m_left, a_nodes);
+    a_nodes[nodeIndex].m_index = (unsigned int)a_nodes.size();
+    cAppendBVHTop(a_topNodes, a_tasks, topNode.m_right, a_nodes);
+}
+
+
+//===========================================================================
+/*!
+    Compute the square of the distance from a point to the box of a node.
+
+    \fn     static inline double cSquareDistanceToNode(const cCollisionBVHNode& a_node,
+                                                      const cVector3d& a_point)
+    \param  a_node  Node whose box is measured.
+    \param  a_point  Point to measure from.
+    \return Return the square distance, or 0 if the box contains the point.
+*/
+//===========================================================================
+static inline double cSquareDistanceToNode(const cCollisionBVHNode& a_node,
+                                           const cVector3d& a_point)
+{
+    double result = 0.0;
+    for (int axis=0; axis<3; axis++)
+    {
+        double lower = (double)a_node.m_min[axis];
+        double upper = (double)a_node.m_max[axis];
+        if (a_point[axis] < lower) { result += cSqr(lower - a_point[axis]); }
+        else if (a_point[axis] > upper) { result += cSqr(a_point[axis] - upper); }
+    }
+    return (result);
+}
+
+
+//===========================================================================
+/*!
+    Constructor of cCollisionBVH.
+
+    \fn       cCollisionBVH::cCollisionBVH(vector<cTriangle>* a_triangles, bool a_useNeighbors)
+    \param    a_triangles     Pointer to array of triangles.
+    \param    a_useNeighbors  Use neighbor lists to speed up collision detection?
+*/
+//===========================================================================
+cCollisionBVH::cCollisionBVH(vector<cTriangle>* a_triangles, bool a_useNeighbors)
+{
+    // list of triangles used when building the tree
+    m_triangles = a_triangles;
+
+    // initialize members
+    m_radius = 0;
+    m_useNeighbors = a_useNeighbors;
+    m_buildCost = 0;
+}
+
+
+//===========================================================================
+/*!
+    Build the tree. The allocated triangles of the mesh are binned by the
+    centroids of their boxes, and each node is split where the surface area
+    heuristic expects queries to be cheapest. The top of the tree is split
+    on the calling thread until the remaining subtrees are smaller than
+    CHAI_BVH_PARALLEL_SIZE triangles; these are then built in parallel.
+
+    \fn       void cCollisionBVH::initialize(double a_radius)
+    \param    a_radius  Radius to add around the triangles.
+*/
+//===========================================================================
+void cCollisionBVH::initialize(double a_radius)
+{
+    m_nodes.clear();
+    m_triangleIndices.clear();
+    m_packets.clear();
+    m_firstPackets.clear();
+    m_contactCache.clear();
+    m_radius = a_radius;
+
+    // collect the allocated triangles
+    unsigned int numTriangles = (unsigned int)m_triangles->size();
+    for (unsigned int i=0; i<numTriangles; i++)
+    {
+        if ((*m_triangles)[i].allocated())
+        {
+            m_triangleIndices.push_back(i);
+        }
+    }
+
+    int numIndices = (int)m_triangleIndices.size();
+    if (numIndices == 0) { return; }
+
+    // compute the box around each triangle, grown by the radius
+    vector<cCollisionBVHPrimitive> primitives(numTriangles);
+    int i;
+    #pragma omp parallel for schedule(static)
+    for (i=0; i<numIndices; i++)
+    {
+        const cTriangle& triangle = (*m_triangles)[m_triangleIndices[i]];
+        cCollisionBVHPrimitive& primitive = primitives[m_triangleIndices[i]];
+        cVector3d vertex0 = triangle.getVertex0()->getPos();
+        cVector3d vertex1 = triangle.getVertex1()->getPos();
+        cVector3d vertex2 = triangle.getVertex2()->getPos();
+
+        for (int axis=0; axis<3; axis++)
+        {
+            primitive.m_min[axis] = cMin(vertex0[axis], cMin(vertex1[axis], vertex2[axis])) - a_radius;
+            primitive.m_max[axis] = cMax(vertex0[axis], cMax(vertex1[axis], vertex2[axis])) + a_radius;
+        }
+        primitive.m_centroid = cMul(0.5, cAdd(primitive.m_min, primitive.m_max));
+    }
+
+    // split the top of the tree, then build the subtrees below it in parallel
+    vector<cCollisionBVHTopNode> topNodes;
+    vector<cCollisionBVHTask> tasks;
+    cSplitBVHTop(&primitives[0], &m_triangleIndices[0], 0, numIndices, 0, topNodes, tasks);
+
+    int numTasks = (int)tasks.size();
+    #pragma omp parallel for schedule(dynamic)
+    for (i=0; i<numTasks; i++)
+    {
+        cBuildBVHSubtree(&primitives[0], &m_triangleIndices[0],
+                         tasks[i].m_begin, tasks[i].m_end, tasks[i].m_depth,
+                         tasks[i].m_nodes);
+    }
+
+    // lay the whole tree out depth first
+    m_nodes.reserve(2 * numIndices);
+    cAppendBVHTop(topNodes, tasks, 0, m_nodes);
+
+    // group the triangles of each leaf into packets
+    m_firstPackets.resize(m_nodes.size(), 0);
+    for (unsigned int j=0; j<m_nodes.size(); j++)
+    {
+        const cCollisionBVHNode& node = m_nodes[j];
+        if (node.m_numTriangles == 0) { continue; }
+
+        m_firstPackets[j] = (unsigned int)m_packets.size();
+        for (unsigned int k=0; k<node.m_numTriangles; k+=CHAI_TRIANGLE_PACKET_SIZE)
+        {
+            m_packets.push_back(cTrianglePacket());
+            m_packets.back().set(m_triangles, &m_triangleIndices[node.m_index + k],
+                                 node.m_numTriangles - k);
+        }
+    }
+
+    // remember how good the tree was, so that refit() can tell when it degrades
+    m_buildCost = computeCost();
+}
+
+
+//===========================================================================
+/*!
+    Update the boxes of the tree to the current positions of the vertices,
+    without changing its structure. Children are stored after their parent,
+    so walking the nodes backwards refits every child before its parent. \n
+
+    If \e a_maxDegradation is positive and the cost of the refitted tree (see
+    computeCost()) has grown past \e a_maxDegradation times its cost when it
+    was built, the tree is rebuilt instead. \n
+
+    The triangles of the mesh must not have been added or removed since the
+    tree was built.
+
+    \fn       bool cCollisionBVH::refit(double a_maxDegradation)
+    \param    a_maxDegradation  Growth in cost past which the tree is rebuilt;
+                                0 never rebuilds.
+    \return   Return \b true if the tree was rebuilt.
+*/
+//===========================================================================
+bool cCollisionBVH::refit(double a_maxDegradation)
+{
+    if (m_nodes.empty()) { return (false); }
+
+    for (unsigned int i=(unsigned int)m_nodes.size(); i>0; i--)
+    {
+        cCollisionBVHNode& node = m_nodes[i - 1];
+
+        // a leaf encloses its triangles, grown by the radius
+        if (node.m_numTriangles > 0)
+        {
+            cVector3d boxMin(CHAI_LARGE, CHAI_LARGE, CHAI_LARGE);
+            cVector3d boxMax(-CHAI_LARGE, -CHAI_LARGE, -CHAI_LARGE);
+            for (unsigned int j=0; j<node.m_numTriangles; j++)
+            {
+                const cTriangle& triangle = (*m_triangles)[m_triangleIndices[node.m_index + j]];
+                cVector3d vertex0 = triangle.getVertex0()->getPos();
+                cVector3d vertex1 = triangle.getVertex1()->getPos();
+                cVector3d vertex2 = triangle.getVertex2()->getPos();
+                for (int axis=0; axis<3; axis++)
+                {
+                    boxMin[axis] = cMin(boxMin[axis], cMin(vertex0[axis], cMin(vertex1[axis], vertex2[axis])));
+                    boxMax[axis] = cMax(boxMax[axis], cMax(vertex0[axis], cMax(vertex1[axis], vertex2[axis])));
+                }
+            }
+            boxMin.sub(m_radius, m_radius, m_radius);
+            boxMax.add(m_radius, m_radius, m_radius);
+            cSetBVHNodeBox(node, boxMin, boxMax);
+        }
+
+        // an internal node encloses its two children
+        else
+        {
+            const cCollisionBVHNode& first = m_nodes[i];
+            const cCollisionBVHNode& second = m_nodes[node.m_index];
+            for (int axis=0; axis<3; axis++)
+            {
+                node.m_min[axis] = cMin(first.m_min[axis], second.m_min[axis]);
+                node.m_max[axis] = cMax(first.m_max[axis], second.m_max[axis]);
+            }
+        }
+    }
+
+    // rebuild the tree if it has become much worse than when it was built
+    if ((a_maxDegradation > 0) && (computeCost() > a_maxDegradation * m_buildCost))
+    {
+        initialize(m_radius);
+        return (true);
+    }
+
+    for (unsigned int i=0; i<m_packets.size(); i++)
+    {
+        m_packets[i].update(m_triangles);
+    }
+
+    // triangles may have moved into the cached region
+    m_contactCache.clear();
+
+    return (false);
+}
+
+
+//===========================================================================
+/*!
+    Compute the cost of the tree with the surface area heuristic: the sum of
+    the surface areas of the internal boxes, relative to that of the root.
+
+    \fn       double cCollisionBVH::computeCost() const
+    \return   Return the cost of the tree (0 for a single leaf).
+*/
+//===========================================================================
+double cCollisionBVH::computeCost() const
+{
+    double area = 0.0;
+    for (unsigned int i=0; i<m_nodes.size(); i++)
+    {
+        const cCollisionBVHNode& node = m_nodes[i];
+        if (node.m_numTriangles == 0)
+        {
+            cVector3d boxMin(node.m_min[0], node.m_min[1], node.m_min[2]);
+            cVector3d boxMax(node.m_max[0], node.m_max[1], node.m_max[2]);
+            area += cHalfArea(boxMin, boxMax);
+        }
+    }
+
+    if ((m_nodes.empty()) || (m_nodes[0].m_numTriangles > 0)) { return (0.0); }
+
+    cVector3d rootMin(m_nodes[0].m_min[0], m_nodes[0].m_min[1], m_nodes[0].m_min[2]);
+    cVector3d rootMax(m_nodes[0].m_max[0], m_nodes[0].m_max[1], m_nodes[0].m_max[2]);
+    double rootArea = cHalfArea(rootMin, rootMax);
+    if (rootArea <= 0.0) { return (0.0); }
+    return (area / rootArea);
+}
+
+
+//===========================================================================
+/*!
+    Collect the packets of the leaves whose boxes overlap a region, with the
+    boxes, for the contact cache. Gives up once they hold more than
+    CHAI_COLLISION_CACHE_MAX_TRIANGLES triangles, as testing them all would
+    cost more than searching the tree.
+
+    \fn       bool cCollisionBVH::collectPackets(const cCollisionAABBBox& a_region,
+                                                  vector<cTrianglePacket>& a_packets,
+                                                  vector<cCollisionAABBBox>& a_boxes) const
+    \param    a_region  Region to collect the leaves of.
+    \param    a_packets  Returns the packets of the leaves.
+    \param    a_boxes  Returns the box of the leaf of each packet.
+    \return   Return \b false if the leaves held too many triangles.
+*/
+//===========================================================================
+bool cCollisionBVH::collectPackets(const cCollisionAABBBox& a_region,
+                                   vector<cTrianglePacket>& a_packets,
+                                   vector<cCollisionAABBBox>& a_boxes) const
+{
+    a_packets.clear();
+    a_boxes.clear();
+    if (m_nodes.empty()) { return (true); }
+
+    const cCollisionBVHNode* nodes = &m_nodes[0];
+    unsigned int stack[CHAI_BVH_MAX_DEPTH];
+    int size = 0;
+    stack[size++] = 0;
+    unsigned int numTriangles = 0;
+
+    while (size > 0)
+    {
+        unsigned int index = stack[--size];
+        const cCollisionBVHNode& node = nodes[index];
+        if ((node.m_max[0] < a_region.getLowerX()) || (node.m_min[0] > a_region.getUpperX()) ||
+            (node.m_max[1] < a_region.getLowerY()) || (node.m_min[1] > a_region.getUpperY()) ||
+            (node.m_max[2] < a_region.getLowerZ()) || (node.m_min[2] > a_region.getUpperZ()))
+        {
+            continue;
+        }
+
+        if (node.m_numTriangles > 0)
+        {
+            numTriangles += node.m_numTriangles;
+            if (numTriangles > CHAI_COLLISION_CACHE_MAX_TRIANGLES) { return (false); }
+
+            // the cache grows the boxes by the collision radius itself
+            cCollisionAABBBox box;
+            box.setValue(cVector3d(node.m_min[0] + m_radius, node.m_min[1] + m_radius, node.m_min[2] + m_radius),
+                         cVector3d(node.m_max[0] - m_radius, node.m_max[1] - m_radius, node.m_max[2] - m_radius));
+
+            unsigned int first = m_firstPackets[index];
+            unsigned int last = first + (node.m_numTriangles + CHAI_TRIANGLE_PACKET_SIZE - 1) / CHAI_TRIANGLE_PACKET_SIZE;
+            for (unsigned int i=first; i<last; i++)
+            {
+                a_packets.push_back(m_packets[i]);
+                a_boxes.push_back(box);
+            }
+        }
+        else
+        {
+            stack[size++] = node.m_index;
+            stack[size++] = index + 1;
+        }
+    }
+
+    return (true);
+}
+
+
+//===========================================================================
+/*!
+    Draw the boxes of the tree in OpenGL, down to (or only at) the display
+    depth.
+
+    \fn       void cCollisionBVH::render()
+*/
+//===========================================================================
+void cCollisionBVH::render()
+{
+    if (m_nodes.empty()) { return; }
+
+    // set rendering settings
+    glDisable(GL_LIGHTING);
+    glLineWidth(1.0);
+    glColor4fv(m_material.m_ambient.pColor());
+
+    unsigned int stack[CHAI_BVH_MAX_DEPTH];
+    int depths[CHAI_BVH_MAX_DEPTH];
+    int size = 0;
+    stack[size] = 0;
+    depths[size] = 0;
+    size++;
+
+    while (size > 0)
+    {
+        size--;
+        unsigned int index = stack[size];
+        int depth = depths[size];
+        const cCollisionBVHNode& node = m_nodes[index];
+
+        if (((m_displayDepth < 0) && (-m_displayDepth >= depth)) || (m_displayDepth == depth))
+        {
+            cDrawWireBox(node.m_min[0], node.m_max[0],
+                         node.m_min[1], node.m_max[1],
+                         node.m_min[2], node.m_max[2]);
+        }
+
+        if ((node.m_numTriangles == 0) && ((m_displayDepth < 0) || (depth < m_displayDepth)))
+        {
+            stack[size] = node.m_index;
+            depths[size] = depth + 1;
+            size++;
+            stack[size] = index + 1;
+            depths[size] = depth + 1;
+            size++;
+        }
+    }
+
+    // restore lighting settings
+    glEnable(GL_LIGHTING);
+}
+
+
+//===========================================================================
+/*!
+    Check if the given line segment intersects any triangle of the mesh.
+    The tree is walked with an explicit stack, testing the segment against
+    each node's box grown by the part of the collision radius that the boxes
+    were not already built with. At each internal node, the child on the
+    side the segment comes from is visited first. When only the nearest
+    collision is needed, nodes that the segment enters farther away than
+    the nearest collision found so far are skipped. With the contact cache
+    in use, the tree is only walked if the triangles around the last
+    contact do not answer the query, and the region around the contact is
+    cached again afterwards.
+
+    \fn       bool cCollisionBVH::computeCollision(cVector3d& a_segmentPointA,
+                                                    cVector3d& a_segmentPointB,
+                                                    cCollisionRecorder& a_recorder,
+                                                    cCollisionSettings& a_settings)
+    \param    a_segmentPointA  Initial point of segment.
+    \param    a_segmentPointB  End point of segment.
+    \param    a_recorder  Stores all collision events.
+    \param    a_settings  Contains collision settings information.
+    \return   Return \b true if a collision event has occurred.
+*/
+//===========================================================================
+bool cCollisionBVH::computeCollision(cVector3d& a_segmentPointA,
+                                     cVector3d& a_segmentPointB,
+                                     cCollisionRecorder& a_recorder,
+                                     cCollisionSettings& a_settings)
+{
+    if (m_nodes.empty()) { return (false); }
+
+    bool hit = false;
+
+    // the triangles around the last contact usually answer the query
+    bool coherent = a_settings.m_useContactCache && a_settings.m_checkForNearestCollisionOnly;
+    if (coherent && m_contactCache.computeCollision(m_triangles, a_segmentPointA, a_segmentPointB,
+                                                    a_recorder, a_settings, hit))
+    {
+        return (hit);
+    }
+
+    double margin = cMax(0.0, a_settings.m_collisionRadius - m_radius);
+
+    // precompute the slab test terms of the segment
+    cVector3d direction = cSub(a_segmentPointB, a_segmentPointA);
+    double length = direction.length();
+    double inverse[3];
+    bool parallel[3];
+    for (int axis=0; axis<3; axis++)
+    {
+        parallel[axis] = (cAbs(direction[axis]) < CHAI_TINY);
+        inverse[axis] = parallel[axis] ? 0.0 : 1.0 / direction[axis];
+    }
+
+    cTrianglePacketSegment segment;
+    segment.set(a_segmentPointA, a_segmentPointB, a_settings.m_collisionRadius);
+
+    const cCollisionBVHNode* nodes = &m_nodes[0];
+    unsigned int stack[CHAI_BVH_MAX_DEPTH];
+    int size = 0;
+    stack[size++] = 0;
+
+    while (size > 0)
+    {
+        unsigned int index = stack[--size];
+        const cCollisionBVHNode& node = nodes[index];
+
+        // clip the segment against the node's box
+        double enter = 0.0;
+        double leave = 1.0;
+        bool inside = true;
+        for (int axis=0; axis<3; axis++)
+        {
+            double lower = (double)node.m_min[axis] - margin;
+            double upper = (double)node.m_max[axis] + margin;
+            double start = a_segmentPointA[axis];
+
+            if (parallel[axis])
+            {
+                if ((start < lower) || (start > upper)) { inside = false; break; }
+                continue;
+            }
+
+            double t0 = (lower - start) * inverse[axis];
+            double t1 = (upper - start) * inverse[axis];
+            if (t0 > t1) { cSwap(t0, t1); }
+            if (t0 > enter) { enter = t0; }
+            if (t1 < leave) { leave = t1; }
+            if (enter > leave) { inside = false; break; }
+        }
+        if (!inside) { continue; }
+
+        // nothing in this node can be nearer than the nearest collision so far
+        if (a_settings.m_checkForNearestCollisionOnly)
+        {
+            double distance = enter * length - CHAI_SMALL;
+            if ((distance > 0.0) &&
+                (distance * distance > a_recorder.m_nearestCollision.m_squareDistance))
+            {
+                continue;
+            }
+        }
+
+        if (node.m_numTriangles > 0)
+        {
+            unsigned int first = m_firstPackets[index];
+            unsigned int last = first + (node.m_numTriangles + CHAI_TRIANGLE_PACKET_SIZE - 1) / CHAI_TRIANGLE_PACKET_SIZE;
+            for (unsigned int i=first; i<last; i++)
+            {
+                if (m_packets[i].computeCollision(m_triangles, a_segmentPointA, a_segmentPointB,
+                                                  segment, a_recorder, a_settings))
+                {
+                    hit = true;
+                }
+            }
+        }
+        else
+        {
+            // push the far child first, so that the near child is popped first
+            if (direction[node.m_axis] >= 0.0)
+            {
+                stack[size++] = node.m_index;
+                stack[size++] = index + 1;
+            }
+            else
+            {
+                stack[size++] = index + 1;
+                stack[size++] = node.m_index;
+            }
+        }
+    }
+
+    // cache the region around the new contact
+    cCollisionAABBBox region;
+    if (coherent && hit && m_contactCache.computeRegion(m_triangles, a_segmentPointA, a_recorder,
+                                                        a_settings, region))
+    {
+        vector<cTrianglePacket> packets;
+        vector<cCollisionAABBBox> boxes;
+        if (collectPackets(region, packets, boxes))
+        {
+            m_contactCache.set(m_triangles, region, packets, boxes);
+        }
+        else
+        {
+            m_contactCache.clear();
+        }
+    }
+
+    return (hit);
+}
+
+
+//===========================================================================
+/*!
+    Find the point of the mesh nearest to the given point, within a maximum
+    distance of it. The tree is searched branch and bound, with the same
+    explicit stack as computeCollision(): the child whose box is nearer to
+    the point is visited first, and nodes whose boxes are farther than the
+    nearest point found so far are skipped.
+
+    \fn       bool cCollisionBVH::computeClosestPoint(const cVector3d& a_point,
+                                                    const double a_maxDistance,
+                                                    cProximityEvent& a_event)
+    \param    a_point  Point to search from.
+    \param    a_maxDistance  Largest distance to search to.
+    \param    a_event  Returns the nearest point, if it is nearer than the
+                       point already stored there.
+    \return   Return \b true if a nearer point was found.
+*/
+//===========================================================================
+bool cCollisionBVH::computeClosestPoint(const cVector3d& a_point,
+                                        const double a_maxDistance,
+                                        cProximityEvent& a_event)
+{
+    if (m_nodes.empty()) { return (false); }
+
+    bool found = false;
+    double maxSquareDistance = cSqr(a_maxDistance);
+
+    const cCollisionBVHNode* nodes = &m_nodes[0];
+    unsigned int stack[CHAI_BVH_MAX_DEPTH];
+    int size = 0;
+    stack[size++] = 0;
+
+    while (size > 0)
+    {
+        unsigned int index = stack[--size];
+        const cCollisionBVHNode& node = nodes[index];
+
+        // nothing in this node can be nearer than the nearest point so far
+        double bound = cMin(maxSquareDistance, a_event.m_squareDistance);
+        if (cSquareDistanceToNode(node, a_point) > bound) { continue; }
+
+        if (node.m_numTriangles > 0)
+        {
+            for (unsigned int i=0; i<node.m_numTriangles; i++)
+            {
+                const cTriangle& triangle = (*m_triangles)[m_triangleIndices[node.m_index + i]];
+                if (triangle.computeClosestPoint(a_point, maxSquareDistance, a_event))
+                {
+                    found = true;
+                }
+            }
+        }
+        else
+        {
+            // push the far child first, so that the near child is popped first
+            unsigned int nearChild = index + 1;
+            unsigned int farChild = node.m_index;
+            if (cSquareDistanceToNode(nodes[farChild], a_point) <
+                cSquareDistanceToNode(nodes[nearChild], a_point))
+            {
+                cSwap(nearChild, farChild);
+            }
+            stack[size++] = farChild;
+            stack[size++] = nearChild;
+        }
+    }
+
+    return (found);
+}
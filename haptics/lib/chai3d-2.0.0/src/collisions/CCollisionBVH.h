@@ -0,0 +1,221 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#ifndef CCollisionBVHH
+#define CCollisionBVHH
+//---------------------------------------------------------------------------
+#include "math/CMaths.h"
+#include "graphics/CTriangle.h"
+#include "graphics/CVertex.h"
+#include "graphics/CTrianglePacket.h"
+#include "collisions/CGenericCollision.h"
+#include "collisions/CCollisionContactCache.h"
+#include <vector>
+//---------------------------------------------------------------------------
+using std::vector;
+//---------------------------------------------------------------------------
+//! Number of bins the surface area heuristic evaluates along each axis.
+#define CHAI_BVH_NUM_BINS           16
+
+//! Largest number of triangles stored in a leaf.
+#define CHAI_BVH_MAX_LEAF_SIZE      4
+
+//! Cost of visiting a node, relative to the cost of a triangle test.
+#define CHAI_BVH_TRAVERSAL_COST     0.5
+
+//! Deepest level of the tree (also the size of the traversal stack).
+#define CHAI_BVH_MAX_DEPTH          64
+
+//! Subtrees with fewer triangles than this are built on a single thread.
+#define CHAI_BVH_PARALLEL_SIZE      4096
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \file       CCollisionBVH.h
+
+    \brief
+    <b> Collision Detection </b> \n
+    Flattened Bounding Volume Hierarchy (BVH) built with the Surface Area
+    Heuristic.
+*/
+//===========================================================================
+
+//===========================================================================
+/*!
+    \struct     cCollisionBVHNode
+    \ingroup    collisions
+
+    \brief
+    A node of a cCollisionBVH tree, packed into 32 bytes. Nodes are stored
+    depth first, so the first child of an internal node always follows it
+    in the array. The box is stored in single precision, rounded outwards
+    so that it still encloses its triangles.
+*/
+//===========================================================================
+struct cCollisionBVHNode
+{
+    //! Minimum corner of the box around the node's triangles.
+    float m_min[3];
+
+    //! Maximum corner of the box around the node's triangles.
+    float m_max[3];
+
+    /*!
+        For a leaf, the position of its first triangle in the list of
+        triangle indices. For an internal node, the index of its second child.
+    */
+    unsigned int m_index;
+
+    //! Number of triangles in a leaf, or 0 for an internal node.
+    unsigned short m_numTriangles;
+
+    //! Axis along which an internal node was split (0, 1 or 2).
+    unsigned char m_axis;
+
+    //! Unused; pads the node to 32 bytes.
+    unsigned char m_unused;
+};
+
+
+//===========================================================================
+/*!
+    \class      cCollisionBVH
+    \ingroup    collisions
+
+    \brief
+    cCollisionBVH provides methods to create a bounding volume hierarchy of
+    axis-aligned boxes, and to use it to check for the intersection of a
+    line segment with a mesh. \n
+
+    Unlike cCollisionAABB, which splits each node at the middle of its
+    triangles, the tree is built with the binned Surface Area Heuristic,
+    which places splits where they minimize the expected cost of a query.
+    Large subtrees are built in parallel (with OpenMP). The tree is stored
+    as a flat array of 32-byte nodes and traversed iteratively, visiting the
+    child nearest to the segment origin first, so that queries for the
+    nearest collision can skip nodes that are farther away than the nearest
+    collision found so far. The triangles of each leaf are tested together,
+    as a cTrianglePacket. \n
+
+    Queries with \e m_useContactCache set in their settings first test the
+    triangles around the last contact, which usually answers them without
+    searching the tree (see cCollisionContactCache).
+*/
+//===========================================================================
+class cCollisionBVH : public cGenericCollision
+{
+  public:
+
+    //-----------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //-----------------------------------------------------------------------
+
+    //! Constructor of cCollisionBVH.
+    cCollisionBVH(vector<cTriangle>* a_triangles, bool a_useNeighbors);
+
+    //! Destructor of cCollisionBVH.
+    virtual ~cCollisionBVH() {}
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Build the tree.
+    void initialize(double a_radius = 0);
+
+    //! Draw the boxes of the tree in OpenGL.
+    void render();
+
+    //! Update the boxes to the current vertex positions, rebuilding the tree if it has degraded too much.
+    bool refit(double a_maxDegradation = 0);
+
+    //! Return the nearest triangle intersected by the given segment, if any.
+    bool computeCollision(cVector3d& a_segmentPointA,
+                          cVector3d& a_segmentPointB,
+                          cCollisionRecorder& a_recorder,
+                          cCollisionSettings& a_settings);
+
+    //! Find the point of the mesh nearest to the given point, within a maximum distance of it.
+    bool computeClosestPoint(const cVector3d& a_point,
+                             const double a_maxDistance,
+                             cProximityEvent& a_event);
+
+    //! Return the number of nodes in the tree.
+    unsigned int getNumNodes() const { return ((unsigned int)m_nodes.size()); }
+
+    //! Return the number of triangles in the tree.
+    unsigned int getNumTriangles() const { return ((unsigned int)m_triangleIndices.size()); }
+
+    //! Return the triangles cached around the last contact.
+    const cCollisionContactCache& getContactCache() const { return (m_contactCache); }
+
+
+  protected:
+
+    //-----------------------------------------------------------------------
+    // MEMBERS:
+    //-----------------------------------------------------------------------
+
+    //! Pointer to the list of triangles in the mesh.
+    vector<cTriangle>* m_triangles;
+
+    //! Nodes of the tree, depth first; the root is the first node.
+    vector<cCollisionBVHNode> m_nodes;
+
+    //! Indices of the triangles in the mesh, in the order the leaves refer to them.
+    vector<unsigned int> m_triangleIndices;
+
+    //! Triangles of the leaves, in packets; the packets of a leaf are consecutive.
+    vector<cTrianglePacket> m_packets;
+
+    //! For each leaf node, the index of its first packet (0 for internal nodes).
+    vector<unsigned int> m_firstPackets;
+
+    //! Radius added around the triangles when the boxes were built.
+    double m_radius;
+
+    //! Use list of triangles' neighbors to speed up collision detection?
+    bool m_useNeighbors;
+
+    //! Cost of the tree when it was built (see computeCost()).
+    double m_buildCost;
+
+    //! Triangles around the last contact.
+    cCollisionContactCache m_contactCache;
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Return the total area of the internal boxes relative to the root's.
+    double computeCost() const;
+
+    //! Collect the leaves overlapping a region, unless they hold too many triangles.
+    bool collectPackets(const cCollisionAABBBox& a_region,
+                        vector<cTrianglePacket>& a_packets,
+                        vector<cCollisionAABBBox>& a_boxes) const;
+};
+
+//---------------------------------------------------------------------------
+#endif
+//---------------------------------------------------------------------------
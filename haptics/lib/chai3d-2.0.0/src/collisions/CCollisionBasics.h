@@ -94,6 +94,52 @@ struct cCollisionEvent
 };
 
 
+//===========================================================================
+/*!
+    \struct     cProximityEvent
+    \ingroup    collisions
+
+    \brief
+    cProximityEvent stores the point of a mesh nearest to a given point,
+    as found by cGenericCollision::computeClosestPoint().
+*/
+//===========================================================================
+struct cProximityEvent
+{
+    //! Constructor of cProximityEvent.
+    cProximityEvent() { clear(); }
+
+    //! Pointer to the nearest triangle, or NULL if none was found.
+    cTriangle* m_triangle;
+
+    //! Position of the nearest point in reference to the mesh's coordinate frame (local coordinates).
+    cVector3d m_localPos;
+
+    //! Unit normal of the nearest triangle, following the order of its vertices (local coordinates).
+    cVector3d m_localNormal;
+
+    //! Barycentric coordinates of the nearest point: the weights of vertices 0, 1 and 2 of the triangle.
+    cVector3d m_barycentric;
+
+    //! Distance between the given point and the nearest point.
+    double m_distance;
+
+    //! Square of that distance.
+    double m_squareDistance;
+
+    //! initialize all data
+    void clear()
+    {
+        m_triangle  = NULL;
+        m_localPos.zero();
+        m_localNormal.zero();
+        m_barycentric.zero();
+        m_distance = CHAI_LARGE;
+        m_squareDistance = CHAI_LARGE;
+    }
+};
+
+
 //===========================================================================
 /*!
     \class      cCollisionRecorder
@@ -172,6 +218,9 @@ struct cCollisionSettings
     //! If \b true, then adjust for object motion. (dynamic proxy model).
     bool m_adjustObjectMotion;
 
+    //! If \b true, then test the triangles around the last contact first (see cCollisionContactCache).
+    bool m_useContactCache;
+
     //! Radius of the virtual tool or cursor.
     double m_collisionRadius;
 };
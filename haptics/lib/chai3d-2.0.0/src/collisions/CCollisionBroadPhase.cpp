@@ -0,0 +1,327 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#include "collisions/CCollisionBroadPhase.h"
+#include "collisions/CGenericCollision.h"
+#include "scenegraph/CGenericObject.h"
+//---------------------------------------------------------------------------
+//! Boundary boxes whose diagonal is shorter than this are treated as missing.
+#define CHAI_BROAD_PHASE_MIN_BOX 1e-15
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    Check whether a segment passes through an axis-aligned box, using the
+    slab test.
+
+    \fn     static bool cSegmentIntersectsBox(const cVector3d& a_segmentPointA,
+                                              const cVector3d& a_segmentPointB,
+                                              const cVector3d& a_boxMin,
+                                              const cVector3d& a_boxMax)
+    \param  a_segmentPointA  Start point of segment.
+    \param  a_segmentPointB  End point of segment.
+    \param  a_boxMin  Minimum corner of the box.
+    \param  a_boxMax  Maximum corner of the box.
+    \return Return \b true if any part of the segment is inside the box.
+*/
+//===========================================================================
+static bool cSegmentIntersectsBox(const cVector3d& a_segmentPointA,
+                                  const cVector3d& a_segmentPointB,
+                                  const cVector3d& a_boxMin,
+                                  const cVector3d& a_boxMax)
+{
+    double enter = 0.0;
+    double leave = 1.0;
+
+    for (int axis=0; axis<3; axis++)
+    {
+        double start = a_segmentPointA[axis];
+        double delta = a_segmentPointB[axis] - start;
+
+        // parallel to this slab: either always inside it or never
+        if (cAbs(delta) < CHAI_TINY)
+        {
+            if ((start < a_boxMin[axis]) || (start > a_boxMax[axis])) { return (false); }
+            continue;
+        }
+
+        double t0 = (a_boxMin[axis] - start) / delta;
+        double t1 = (a_boxMax[axis] - start) / delta;
+        if (t0 > t1) { cSwap(t0, t1); }
+
+        if (t0 > enter) { enter = t0; }
+        if (t1 < leave) { leave = t1; }
+        if (enter > leave) { return (false); }
+    }
+
+    return (true);
+}
+
+
+//===========================================================================
+/*!
+    Constructor of cCollisionBroadPhase.
+
+    \fn     cCollisionBroadPhase::cCollisionBroadPhase()
+*/
+//===========================================================================
+cCollisionBroadPhase::cCollisionBroadPhase()
+{
+    m_numUpdated = 0;
+    m_numRefitted = 0;
+    m_numCandidates = 0;
+}
+
+
+//===========================================================================
+/*!
+    Refresh the cached objects from the scene graph. The descendants of
+    \e a_root are cached; the collision detector of the root itself is
+    ignored, as in cWorld::computeCollisionDetection(). Ghost objects and
+    their descendants are left out.
+
+    \fn     void cCollisionBroadPhase::update(cGenericObject* a_root)
+    \param  a_root  Root of the scene graph (typically a cWorld).
+*/
+//===========================================================================
+void cCollisionBroadPhase::update(cGenericObject* a_root)
+{
+    m_numUpdated = 0;
+    m_numRefitted = 0;
+
+    unsigned int numChildren = a_root->getNumChildren();
+    for (unsigned int i=0; i<numChildren; i++)
+    {
+        updateObject(a_root->getChild(i));
+    }
+
+    // drop entries left over from objects that are no longer in the scene
+    m_entries.resize(m_numUpdated);
+}
+
+
+//===========================================================================
+/*!
+    Cache an object (if it has a collision detector) and its descendants.
+    An entry whose object, global frame and boundary box are unchanged since
+    the last update keeps its box.
+
+    \fn     void cCollisionBroadPhase::updateObject(cGenericObject* a_object)
+    \param  a_object  Object to cache.
+*/
+//===========================================================================
+void cCollisionBroadPhase::updateObject(cGenericObject* a_object)
+{
+    // ghosts hide their whole subtree from collision detection
+    if (a_object->getAsGhost()) { return; }
+
+    if (a_object->getCollisionDetector() != NULL)
+    {
+        if (m_numUpdated == m_entries.size())
+        {
+            cCollisionBroadPhaseEntry entry;
+            entry.m_object = NULL;
+            m_entries.push_back(entry);
+        }
+
+        cCollisionBroadPhaseEntry& entry = m_entries[m_numUpdated];
+        cVector3d pos = a_object->getGlobalPos();
+        cMatrix3d rot = a_object->getGlobalRot();
+        cVector3d localMin = a_object->getBoundaryMin();
+        cVector3d localMax = a_object->getBoundaryMax();
+
+        bool unchanged = (entry.m_object == a_object) &&
+                         entry.m_pos.equals(pos) &&
+                         entry.m_rot.equals(rot) &&
+                         entry.m_localMin.equals(localMin) &&
+                         entry.m_localMax.equals(localMax);
+
+        if (!unchanged)
+        {
+            entry.m_object = a_object;
+            entry.m_pos = pos;
+            entry.m_rot = rot;
+            entry.m_localMin = localMin;
+            entry.m_localMax = localMax;
+            refit(entry);
+            m_numRefitted++;
+        }
+
+        // moving objects need their segments adjusted by the dynamic proxy
+        cMatrix3d prevRot = a_object->getPrevGlobalRot();
+        entry.m_moving = !a_object->getPrevGlobalPos().equals(pos) || !prevRot.equals(rot);
+
+        m_numUpdated++;
+    }
+
+    unsigned int numChildren = a_object->getNumChildren();
+    for (unsigned int i=0; i<numChildren; i++)
+    {
+        updateObject(a_object->getChild(i));
+    }
+}
+
+
+//===========================================================================
+/*!
+    Compute the world box of an entry by transforming the eight corners of
+    its boundary box.
+
+    \fn     void cCollisionBroadPhase::refit(cCollisionBroadPhaseEntry& a_entry)
+    \param  a_entry  Entry to update.
+*/
+//===========================================================================
+void cCollisionBroadPhase::refit(cCollisionBroadPhaseEntry& a_entry)
+{
+    const cVector3d& localMin = a_entry.m_localMin;
+    const cVector3d& localMax = a_entry.m_localMax;
+
+    a_entry.m_bounded = (localMin.x <= localMax.x) &&
+                        (localMin.y <= localMax.y) &&
+                        (localMin.z <= localMax.z) &&
+                        (cDistance(localMin, localMax) > CHAI_BROAD_PHASE_MIN_BOX);
+    if (!a_entry.m_bounded) { return; }
+
+    a_entry.m_globalMin.set( CHAI_LARGE,  CHAI_LARGE,  CHAI_LARGE);
+    a_entry.m_globalMax.set(-CHAI_LARGE, -CHAI_LARGE, -CHAI_LARGE);
+
+    for (int corner=0; corner<8; corner++)
+    {
+        cVector3d local((corner & 1) ? localMax.x : localMin.x,
+                        (corner & 2) ? localMax.y : localMin.y,
+                        (corner & 4) ? localMax.z : localMin.z);
+        cVector3d global = cAdd(a_entry.m_pos, cMul(a_entry.m_rot, local));
+
+        for (int axis=0; axis<3; axis++)
+        {
+            if (global[axis] < a_entry.m_globalMin[axis]) { a_entry.m_globalMin[axis] = global[axis]; }
+            if (global[axis] > a_entry.m_globalMax[axis]) { a_entry.m_globalMax[axis] = global[axis]; }
+        }
+    }
+}
+
+
+//===========================================================================
+/*!
+    Determine whether the given segment intersects a triangle of the cached
+    objects, with the same results as cWorld::computeCollisionDetection().
+    Objects whose box (grown by the collision radius) the segment misses
+    are skipped without being transformed or tested. With
+    \e m_adjustObjectMotion set, the segment start of an object that moved
+    at the last computeGlobalPositions() is adjusted as in
+    cGenericObject::adjustCollisionSegment(), and that object is culled
+    against its box in its own frame instead. The results match the scene
+    graph walk as long as the global frames are current.
+
+    \fn     bool cCollisionBroadPhase::computeCollision(cVector3d& a_segmentPointA,
+                                                         cVector3d& a_segmentPointB,
+                                                         cCollisionRecorder& a_recorder,
+                                                         cCollisionSettings& a_settings)
+    \param  a_segmentPointA  Start point of segment (world coordinates).
+    \param  a_segmentPointB  End point of segment (world coordinates).
+    \param  a_recorder  Stores all collision events.
+    \param  a_settings  Contains collision settings information.
+    \return Return \b true if the segment intersects a triangle.
+*/
+//===========================================================================
+bool cCollisionBroadPhase::computeCollision(cVector3d& a_segmentPointA,
+                                            cVector3d& a_segmentPointB,
+                                            cCollisionRecorder& a_recorder,
+                                            cCollisionSettings& a_settings)
+{
+    bool hit = false;
+    m_numCandidates = 0;
+
+    // the triangles are hit within the collision radius of the segment
+    double margin = a_settings.m_collisionRadius + CHAI_SMALL;
+    cVector3d grow(margin, margin, margin);
+
+    // box around the segment, for a quick rejection before the slab test
+    cVector3d segmentMin, segmentMax;
+    for (int axis=0; axis<3; axis++)
+    {
+        segmentMin[axis] = cMin(a_segmentPointA[axis], a_segmentPointB[axis]) - margin;
+        segmentMax[axis] = cMax(a_segmentPointA[axis], a_segmentPointB[axis]) + margin;
+    }
+
+    unsigned int numEntries = (unsigned int)m_entries.size();
+    for (unsigned int i=0; i<numEntries; i++)
+    {
+        cCollisionBroadPhaseEntry& entry = m_entries[i];
+        bool adjust = a_settings.m_adjustObjectMotion && entry.m_moving;
+
+        // static objects are culled in world coordinates before any transform
+        if (entry.m_bounded && !adjust)
+        {
+            if ((segmentMax.x < entry.m_globalMin.x - margin) || (segmentMin.x > entry.m_globalMax.x + margin) ||
+                (segmentMax.y < entry.m_globalMin.y - margin) || (segmentMin.y > entry.m_globalMax.y + margin) ||
+                (segmentMax.z < entry.m_globalMin.z - margin) || (segmentMin.z > entry.m_globalMax.z + margin))
+            {
+                continue;
+            }
+
+            if (!cSegmentIntersectsBox(a_segmentPointA, a_segmentPointB,
+                                       cSub(entry.m_globalMin, grow),
+                                       cAdd(entry.m_globalMax, grow)))
+            {
+                continue;
+            }
+        }
+
+        cGenericObject* object = entry.m_object;
+        if ((a_settings.m_checkVisibleObjectsOnly && !object->getShowEnabled()) ||
+            (a_settings.m_checkHapticObjectsOnly && !object->getHapticEnabled()))
+        {
+            continue;
+        }
+
+        // convert the segment into the local coordinate frame of the object
+        cMatrix3d transRot;
+        entry.m_rot.transr(transRot);
+        cVector3d localSegmentPointA = cMul(transRot, cSub(a_segmentPointA, entry.m_pos));
+        cVector3d localSegmentPointB = cMul(transRot, cSub(a_segmentPointB, entry.m_pos));
+
+        cVector3d localSegmentPointAadjusted = localSegmentPointA;
+        if (adjust)
+        {
+            object->adjustCollisionSegment(localSegmentPointA, localSegmentPointAadjusted);
+
+            // a moving object is culled against its boundary box in its own frame
+            if (entry.m_bounded &&
+                !cSegmentIntersectsBox(localSegmentPointAadjusted, localSegmentPointB,
+                                       cSub(entry.m_localMin, grow),
+                                       cAdd(entry.m_localMax, grow)))
+            {
+                continue;
+            }
+        }
+
+        m_numCandidates++;
+        if (object->getCollisionDetector()->computeCollision(localSegmentPointAadjusted,
+                                                             localSegmentPointB,
+                                                             a_recorder,
+                                                             a_settings))
+        {
+            hit = true;
+        }
+    }
+
+    return (hit);
+}
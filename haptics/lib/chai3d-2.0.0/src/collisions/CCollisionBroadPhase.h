@@ -0,0 +1,178 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#ifndef CCollisionBroadPhaseH
+#define CCollisionBroadPhaseH
+//---------------------------------------------------------------------------
+#include "math/CVector3d.h"
+#include "math/CMatrix3d.h"
+#include "collisions/CCollisionBasics.h"
+#include <vector>
+//---------------------------------------------------------------------------
+using std::vector;
+class cGenericObject;
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \file       CCollisionBroadPhase.h
+
+    \brief
+    <b> Collision Detection </b> \n
+    World-Level Broad Phase.
+*/
+//===========================================================================
+
+//===========================================================================
+/*!
+    \struct     cCollisionBroadPhaseEntry
+    \ingroup    collisions
+
+    \brief
+    An object with a collision detector, as cached by cCollisionBroadPhase.
+*/
+//===========================================================================
+struct cCollisionBroadPhaseEntry
+{
+    //! The object.
+    cGenericObject* m_object;
+
+    //! Global position of the object when its box was computed.
+    cVector3d m_pos;
+
+    //! Global rotation of the object when its box was computed.
+    cMatrix3d m_rot;
+
+    //! Boundary box (in local coordinates) that the world box was computed from.
+    cVector3d m_localMin;
+
+    //! Boundary box (in local coordinates) that the world box was computed from.
+    cVector3d m_localMax;
+
+    //! Axis-aligned box around the object in world coordinates.
+    cVector3d m_globalMin;
+
+    //! Axis-aligned box around the object in world coordinates.
+    cVector3d m_globalMax;
+
+    //! If \b false, the object has no valid boundary box and is never culled.
+    bool m_bounded;
+
+    //! If \b true, the object moved at the last computeGlobalPositions().
+    bool m_moving;
+};
+
+
+//===========================================================================
+/*!
+    \class      cCollisionBroadPhase
+    \ingroup    collisions
+
+    \brief
+    cCollisionBroadPhase keeps a flat list of the objects in a scene graph
+    that have a collision detector, with a world-space axis-aligned box
+    around each one. A segment query then only transforms the segment into
+    the objects whose box it passes through, instead of walking the whole
+    scene graph and calling every collision detector, as
+    cWorld::computeCollisionDetection does. \n
+
+    The boxes come from the objects' boundary boxes and global frames, so
+    these must be kept up to date (see cGenericObject::computeBoundaryBox
+    and cGenericObject::computeGlobalPositions, which the haptic loop
+    already calls for the global positions of collision events). Objects
+    without a valid boundary box are always tested. Call update() once per
+    haptic iteration, after computeGlobalPositions(); it walks the scene
+    graph to pick up new, removed and moved objects, but only recomputes
+    the boxes of objects that have moved or whose boundary box has changed.
+*/
+//===========================================================================
+class cCollisionBroadPhase
+{
+  public:
+
+    //-----------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //-----------------------------------------------------------------------
+
+    //! Constructor of cCollisionBroadPhase.
+    cCollisionBroadPhase();
+
+    //! Destructor of cCollisionBroadPhase.
+    virtual ~cCollisionBroadPhase() {}
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Refresh the cached objects and boxes from the descendants of a root object (typically a world).
+    void update(cGenericObject* a_root);
+
+    //! Remove all cached objects.
+    void clear() { m_entries.clear(); }
+
+    //! Compute collision detection between a segment (in world coordinates) and the cached objects.
+    bool computeCollision(cVector3d& a_segmentPointA,
+                          cVector3d& a_segmentPointB,
+                          cCollisionRecorder& a_recorder,
+                          cCollisionSettings& a_settings);
+
+    //! Return the number of cached objects.
+    unsigned int getNumObjects() const { return ((unsigned int)m_entries.size()); }
+
+    //! Return the number of objects whose boxes were recomputed by the last update.
+    unsigned int getNumRefitted() const { return (m_numRefitted); }
+
+    //! Return the number of objects whose collision detector was called by the last query.
+    unsigned int getNumCandidates() const { return (m_numCandidates); }
+
+  protected:
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Cache an object and its descendants.
+    void updateObject(cGenericObject* a_object);
+
+    //! Compute the world box of an entry from its frame and boundary box.
+    void refit(cCollisionBroadPhaseEntry& a_entry);
+
+
+    //-----------------------------------------------------------------------
+    // MEMBERS:
+    //-----------------------------------------------------------------------
+
+    //! Cached objects, in scene graph order.
+    vector<cCollisionBroadPhaseEntry> m_entries;
+
+    //! Number of entries filled so far by the current update.
+    unsigned int m_numUpdated;
+
+    //! Number of boxes recomputed by the last update.
+    unsigned int m_numRefitted;
+
+    //! Number of collision detectors called by the last query.
+    unsigned int m_numCandidates;
+};
+
+//---------------------------------------------------------------------------
+#endif
+//---------------------------------------------------------------------------
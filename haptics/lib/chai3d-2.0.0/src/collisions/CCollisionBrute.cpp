@@ -23,6 +23,57 @@
 #include "collisions/CCollisionBrute.h"
 //---------------------------------------------------------------------------
 
+//===========================================================================
+/*!
+    Group the triangles of the mesh into packets of
+    CHAI_TRIANGLE_PACKET_SIZE, in order.
+
+    \fn       void cCollisionBrute::initialize(double a_radius)
+    \param    a_radius  Unused; the radius is taken from the collision
+                        settings of each query.
+*/
+//===========================================================================
+void cCollisionBrute::initialize(double a_radius)
+{
+    m_packets.clear();
+    m_numPacketTriangles = m_triangles->size();
+
+    unsigned int indices[CHAI_TRIANGLE_PACKET_SIZE];
+    for (unsigned int i=0; i<m_numPacketTriangles; i+=CHAI_TRIANGLE_PACKET_SIZE)
+    {
+        unsigned int count = cMin(m_numPacketTriangles - i, (unsigned int)CHAI_TRIANGLE_PACKET_SIZE);
+        for (unsigned int j=0; j<count; j++)
+        {
+            indices[j] = i + j;
+        }
+
+        m_packets.push_back(cTrianglePacket());
+        m_packets.back().set(m_triangles, indices, count);
+    }
+}
+
+
+//===========================================================================
+/*!
+    Update the packets to the current positions of the vertices. There is
+    no tree to degrade, so nothing is ever rebuilt.
+
+    \fn       bool cCollisionBrute::refit(double a_maxDegradation)
+    \param    a_maxDegradation  Unused.
+    \return   Return \b false.
+*/
+//===========================================================================
+bool cCollisionBrute::refit(double a_maxDegradation)
+{
+    for (unsigned int i=0; i<m_packets.size(); i++)
+    {
+        m_packets[i].update(m_triangles);
+    }
+
+    return (false);
+}
+
+
 //===========================================================================
 /*!
     Check if the given line segment intersects any triangle of the mesh. This
@@ -49,9 +100,28 @@ bool cCollisionBrute::computeCollision(cVector3d& a_segmentPointA,
 {
     // temp variables
     bool hit = false;
+    unsigned int numTriangles = m_triangles->size();
+
+    // check the triangles in packets, unless triangles were added since they were built
+    if ((m_numPacketTriangles > 0) && (m_numPacketTriangles == numTriangles))
+    {
+        cTrianglePacketSegment segment;
+        segment.set(a_segmentPointA, a_segmentPointB, a_settings.m_collisionRadius);
+
+        unsigned int numPackets = m_packets.size();
+        for (unsigned int i=0; i<numPackets; i++)
+        {
+            if (m_packets[i].computeCollision(m_triangles, a_segmentPointA, a_segmentPointB,
+                                              segment, a_recorder, a_settings))
+            {
+                hit = true;
+            }
+        }
+
+        return (hit);
+    }
 
     // check all triangles for collision
-    unsigned int numTriangles = m_triangles->size();
     for (unsigned int i=0; i<numTriangles; i++)
     {
 
@@ -69,4 +139,38 @@ bool cCollisionBrute::computeCollision(cVector3d& a_segmentPointA,
 }
 
 
+//===========================================================================
+/*!
+    Find the point of the mesh nearest to the given point, within a maximum
+    distance of it, by checking all triangles in the mesh.
 
+    \fn       bool cCollisionBrute::computeClosestPoint(const cVector3d& a_point,
+                                                      const double a_maxDistance,
+                                                      cProximityEvent& a_event)
+    \param    a_point  Point to search from.
+    \param    a_maxDistance  Largest distance to search to.
+    \param    a_event  Returns the nearest point, if it is nearer than the
+                       point already stored there.
+    \return   Return true if a nearer point was found.
+*/
+//===========================================================================
+bool cCollisionBrute::computeClosestPoint(const cVector3d& a_point,
+                                          const double a_maxDistance,
+                                          cProximityEvent& a_event)
+{
+    bool found = false;
+    double maxSquareDistance = cSqr(a_maxDistance);
+    unsigned int numTriangles = m_triangles->size();
+
+    for (unsigned int i=0; i<numTriangles; i++)
+    {
+        const cTriangle& triangle = (*m_triangles)[i];
+        if (triangle.allocated() &&
+            triangle.computeClosestPoint(a_point, maxSquareDistance, a_event))
+        {
+            found = true;
+        }
+    }
+
+    return (found);
+}
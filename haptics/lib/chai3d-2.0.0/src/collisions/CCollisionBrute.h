@@ -26,6 +26,7 @@
 #include "math/CMaths.h"
 #include "graphics/CTriangle.h"
 #include "graphics/CVertex.h"
+#include "graphics/CTrianglePacket.h"
 #include "collisions/CGenericCollision.h"
 #include <vector>
 //---------------------------------------------------------------------------
@@ -49,7 +50,14 @@ using std::vector;
     
     \brief    
     cCollisionBrute provides methods to check for the intersection
-    of a line segment with a mesh by checking all triangles in the mesh.
+    of a line segment with a mesh by checking all triangles in the mesh. \n
+
+    Once initialize() has been called, the triangles are checked in packets
+    of CHAI_TRIANGLE_PACKET_SIZE (see cTrianglePacket), which report the
+    same collisions faster. The packets hold the positions of the vertices
+    at that time, so refit() must be called after the vertices move. If
+    triangles are added to the mesh afterwards, the triangles are checked
+    one at a time again until the next call to initialize().
 */
 //===========================================================================
 class cCollisionBrute : public cGenericCollision
@@ -61,7 +69,7 @@ class cCollisionBrute : public cGenericCollision
     //-----------------------------------------------------------------------
 
     //! Constructor of cCollisionBrute.
-    cCollisionBrute(vector<cTriangle> *a_triangles) : m_triangles(a_triangles) {}
+    cCollisionBrute(vector<cTriangle> *a_triangles) : m_triangles(a_triangles), m_numPacketTriangles(0) {}
 
     //! Destructor of cCollisionBrute.
     virtual ~cCollisionBrute() { }
@@ -71,18 +79,26 @@ class cCollisionBrute : public cGenericCollision
     // METHODS:
     //-----------------------------------------------------------------------
 
-    //! No initialization is necessary for the brute force method.
-    virtual void initialize(double a_radius = 0) {};
+    //! Group the triangles into packets.
+    virtual void initialize(double a_radius = 0);
 
     //! There isn't really a useful "visualization" of "check all triangles".
     virtual void render() {};
 
+    //! Update the packets to the current vertex positions.
+    bool refit(double a_maxDegradation = 0);
+
     //! Return the triangles intersected by the given segment, if any.
     bool computeCollision(cVector3d& a_segmentPointA,
                           cVector3d& a_segmentPointB,
                           cCollisionRecorder& a_recorder,
                           cCollisionSettings& a_settings);
 
+    //! Find the point of the mesh nearest to the given point by checking all triangles.
+    bool computeClosestPoint(const cVector3d& a_point,
+                             const double a_maxDistance,
+                             cProximityEvent& a_event);
+
   protected:
 
 	//-----------------------------------------------------------------------
@@ -91,6 +107,12 @@ class cCollisionBrute : public cGenericCollision
 
     //! Pointer to the list of triangles in the mesh.
     vector<cTriangle> *m_triangles;
+
+    //! Triangles of the mesh in packets, in order (empty until initialize() is called).
+    vector<cTrianglePacket> m_packets;
+
+    //! Number of triangles in the mesh when the packets were built.
+    unsigned int m_numPacketTriangles;
 };
 
 //---------------------------------------------------------------------------
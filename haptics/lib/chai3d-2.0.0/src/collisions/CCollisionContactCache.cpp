@@ -0,0 +1,395 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#include "collisions/CCollisionContactCache.h"
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    Return whether a box holds the box around two points, grown by a margin.
+
+    \fn     static inline bool cBoxContains(const cCollisionAABBBox& a_box,
+                                            const cVector3d& a_pointA,
+                                            const cVector3d& a_pointB,
+                                            const double a_margin)
+    \param  a_box  Box to test.
+    \param  a_pointA  First point.
+    \param  a_pointB  Second point.
+    \param  a_margin  Margin added around the points.
+    \return Return \b true if the grown box lies inside \e a_box.
+*/
+//===========================================================================
+static inline bool cBoxContains(const cCollisionAABBBox& a_box,
+                                const cVector3d& a_pointA,
+                                const cVector3d& a_pointB,
+                                const double a_margin)
+{
+    return ((cMin(a_pointA.x, a_pointB.x) - a_margin >= a_box.getLowerX()) &&
+            (cMax(a_pointA.x, a_pointB.x) + a_margin <= a_box.getUpperX()) &&
+            (cMin(a_pointA.y, a_pointB.y) - a_margin >= a_box.getLowerY()) &&
+            (cMax(a_pointA.y, a_pointB.y) + a_margin <= a_box.getUpperY()) &&
+            (cMin(a_pointA.z, a_pointB.z) - a_margin >= a_box.getLowerZ()) &&
+            (cMax(a_pointA.z, a_pointB.z) + a_margin <= a_box.getUpperZ()));
+}
+
+
+//===========================================================================
+/*!
+    Clip a segment against a box grown by a margin, as cCollisionBVH does.
+
+    \fn     static inline bool cClipSegment(const cCollisionAABBBox& a_box,
+                                            const double a_margin,
+                                            const cVector3d& a_segmentPointA,
+                                            const double* a_inverse,
+                                            const bool* a_parallel,
+                                            double& a_enter)
+    \param  a_box  Box to clip against.
+    \param  a_margin  Margin added around the box.
+    \param  a_segmentPointA  Initial point of segment.
+    \param  a_inverse  Inverse of the segment's direction along each axis.
+    \param  a_parallel  Whether the segment is parallel to each axis.
+    \param  a_enter  Returns where the segment enters the box (0 to 1).
+    \return Return \b true if the segment passes through the box.
+*/
+//===========================================================================
+static inline bool cClipSegment(const cCollisionAABBBox& a_box,
+                                const double a_margin,
+                                const cVector3d& a_segmentPointA,
+                                const double* a_inverse,
+                                const bool* a_parallel,
+                                double& a_enter)
+{
+    double lower[3] = { a_box.getLowerX(), a_box.getLowerY(), a_box.getLowerZ() };
+    double upper[3] = { a_box.getUpperX(), a_box.getUpperY(), a_box.getUpperZ() };
+
+    a_enter = 0.0;
+    double leave = 1.0;
+    for (int axis=0; axis<3; axis++)
+    {
+        double start = a_segmentPointA[axis];
+        if (a_parallel[axis])
+        {
+            if ((start < lower[axis] - a_margin) || (start > upper[axis] + a_margin)) { return (false); }
+            continue;
+        }
+
+        double t0 = (lower[axis] - a_margin - start) * a_inverse[axis];
+        double t1 = (upper[axis] + a_margin - start) * a_inverse[axis];
+        if (t0 > t1) { cSwap(t0, t1); }
+        if (t0 > a_enter) { a_enter = t0; }
+        if (t1 < leave) { leave = t1; }
+        if (a_enter > leave) { return (false); }
+    }
+
+    return (true);
+}
+
+
+//===========================================================================
+/*!
+    Constructor of cCollisionContactCache.
+
+    \fn     cCollisionContactCache::cCollisionContactCache()
+*/
+//===========================================================================
+cCollisionContactCache::cCollisionContactCache()
+{
+    m_numQueries = 0;
+    m_numAnswered = 0;
+    clear();
+}
+
+
+//===========================================================================
+/*!
+    Forget the cached triangles, for example when the tree is rebuilt or
+    the vertices move.
+
+    \fn     void cCollisionContactCache::clear()
+*/
+//===========================================================================
+void cCollisionContactCache::clear()
+{
+    m_region.setEmpty();
+    m_packets.clear();
+    m_boxes.clear();
+    m_lastPacket = 0;
+    m_numMeshTriangles = 0;
+}
+
+
+//===========================================================================
+/*!
+    Test the segment against the cached triangles, recording any collision
+    as cTriangle::computeCollision() does. The query is answered if no
+    other triangle of the mesh can be hit nearer than the nearest collision
+    recorded (see the class description); if it is not, the collisions
+    recorded are still valid, and the tree must be searched for nearer ones.
+
+    \fn     bool cCollisionContactCache::computeCollision(vector<cTriangle>* a_triangles,
+                                                          cVector3d& a_segmentPointA,
+                                                          cVector3d& a_segmentPointB,
+                                                          cCollisionRecorder& a_recorder,
+                                                          cCollisionSettings& a_settings,
+                                                          bool& a_hit)
+    \param  a_triangles  Triangles of the mesh.
+    \param  a_segmentPointA  Initial point of segment.
+    \param  a_segmentPointB  End point of segment.
+    \param  a_recorder  Stores all collision events.
+    \param  a_settings  Contains collision settings information.
+    \param  a_hit  Set to \b true if a cached triangle was hit.
+    \return Return \b true if the query is answered.
+*/
+//===========================================================================
+bool cCollisionContactCache::computeCollision(vector<cTriangle>* a_triangles,
+                                              cVector3d& a_segmentPointA,
+                                              cVector3d& a_segmentPointB,
+                                              cCollisionRecorder& a_recorder,
+                                              cCollisionSettings& a_settings,
+                                              bool& a_hit)
+{
+    a_hit = false;
+
+    // triangles added or removed since the region was cached may lie in it
+    if (m_numMeshTriangles != a_triangles->size())
+    {
+        clear();
+        return (false);
+    }
+
+    // the segment must at least start in the region
+    double margin = a_settings.m_collisionRadius + CHAI_SMALL;
+    if (!cBoxContains(m_region, a_segmentPointA, a_segmentPointA, margin)) { return (false); }
+
+    m_numQueries++;
+
+    cTrianglePacketSegment segment;
+    segment.set(a_segmentPointA, a_segmentPointB, a_settings.m_collisionRadius);
+
+    // precompute the slab test terms of the segment
+    cVector3d direction = cSub(a_segmentPointB, a_segmentPointA);
+    double length = direction.length();
+    double inverse[3];
+    bool parallel[3];
+    for (int axis=0; axis<3; axis++)
+    {
+        parallel[axis] = (cAbs(direction[axis]) < CHAI_TINY);
+        inverse[axis] = parallel[axis] ? 0.0 : 1.0 / direction[axis];
+    }
+
+    // the packet hit last time most likely holds the nearest collision, and
+    // then bounds how far along the segment the others need to be tested
+    unsigned int numPackets = (unsigned int)m_packets.size();
+    unsigned int nearestPacket = m_lastPacket;
+    for (unsigned int i=0; i<numPackets; i++)
+    {
+        unsigned int packet = (i == 0) ? m_lastPacket : ((i == m_lastPacket) ? 0 : i);
+
+        // a collision lies within the collision radius of the packet's box
+        double enter;
+        if (!cClipSegment(m_boxes[packet], a_settings.m_collisionRadius, a_segmentPointA,
+                          inverse, parallel, enter))
+        {
+            continue;
+        }
+        double distance = enter * length - CHAI_SMALL;
+        double squareDistance = a_recorder.m_nearestCollision.m_squareDistance;
+        if ((distance > 0.0) && (distance * distance > squareDistance)) { continue; }
+
+        if (m_packets[packet].computeCollision(a_triangles, a_segmentPointA, a_segmentPointB,
+                                               segment, a_recorder, a_settings))
+        {
+            a_hit = true;
+            if (a_recorder.m_nearestCollision.m_squareDistance < squareDistance) { nearestPacket = packet; }
+        }
+    }
+    m_lastPacket = nearestPacket;
+
+    // only the part of the segment up to the nearest collision needs to lie in the region
+    cVector3d segmentEnd = a_segmentPointB;
+    double squareLength = cDistanceSq(a_segmentPointA, a_segmentPointB);
+    if (a_recorder.m_nearestCollision.m_squareDistance < squareLength)
+    {
+        double length = sqrt(squareLength);
+        double distance = sqrt(a_recorder.m_nearestCollision.m_squareDistance) + CHAI_SMALL;
+        segmentEnd = cAdd(a_segmentPointA, cMul(cMin(1.0, distance / length),
+                                                cSub(a_segmentPointB, a_segmentPointA)));
+    }
+
+    if (!cBoxContains(m_region, a_segmentPointA, segmentEnd, margin)) { return (false); }
+
+    m_numAnswered++;
+    return (true);
+}
+
+
+//===========================================================================
+/*!
+    Compute the region to cache around the nearest collision of a query:
+    the box around the start of the segment and the collision point, grown
+    by the collision radius and by CHAI_COLLISION_CACHE_REACH times the size
+    of the triangle hit.
+
+    \fn     bool cCollisionContactCache::computeRegion(vector<cTriangle>* a_triangles,
+                                                       const cVector3d& a_segmentPointA,
+                                                       const cCollisionRecorder& a_recorder,
+                                                       const cCollisionSettings& a_settings,
+                                                       cCollisionAABBBox& a_region) const
+    \param  a_triangles  Triangles of the mesh.
+    \param  a_segmentPointA  Initial point of the segment of the query.
+    \param  a_recorder  Recorder of the query.
+    \param  a_settings  Collision settings of the query.
+    \param  a_region  Returns the region.
+    \return Return \b false if the nearest collision is not with a triangle
+            of this mesh.
+*/
+//===========================================================================
+bool cCollisionContactCache::computeRegion(vector<cTriangle>* a_triangles,
+                                           const cVector3d& a_segmentPointA,
+                                           const cCollisionRecorder& a_recorder,
+                                           const cCollisionSettings& a_settings,
+                                           cCollisionAABBBox& a_region) const
+{
+    const cTriangle* triangle = a_recorder.m_nearestCollision.m_triangle;
+    unsigned int numTriangles = (unsigned int)a_triangles->size();
+    if ((triangle == NULL) || (numTriangles == 0)) { return (false); }
+
+    // the nearest collision may be with another mesh
+    const cTriangle* first = &(*a_triangles)[0];
+    if ((triangle < first) || (triangle >= first + numTriangles)) { return (false); }
+
+    cCollisionAABBBox box;
+    box.setEmpty();
+    box.enclose(triangle->getVertex0()->getPos());
+    box.enclose(triangle->getVertex1()->getPos());
+    box.enclose(triangle->getVertex2()->getPos());
+    cVector3d extent = box.getExtent();
+    double size = 2.0 * cMax(extent.x, cMax(extent.y, extent.z));
+
+    double margin = a_settings.m_collisionRadius + CHAI_COLLISION_CACHE_REACH * size;
+    cVector3d grow(margin, margin, margin);
+    a_region.setEmpty();
+    a_region.enclose(cSub(a_segmentPointA, grow));
+    a_region.enclose(cAdd(a_segmentPointA, grow));
+    a_region.enclose(cSub(a_recorder.m_nearestCollision.m_localPos, grow));
+    a_region.enclose(cAdd(a_recorder.m_nearestCollision.m_localPos, grow));
+
+    return (true);
+}
+
+
+//===========================================================================
+/*!
+    Cache the triangles of a region. \e a_indices must hold every triangle
+    of the mesh for which overlaps() is \b true.
+
+    \fn     void cCollisionContactCache::set(vector<cTriangle>* a_triangles,
+                                             const cCollisionAABBBox& a_region,
+                                             const vector<unsigned int>& a_indices)
+    \param  a_triangles  Triangles of the mesh.
+    \param  a_region  The region.
+    \param  a_indices  Indices of the triangles overlapping the region.
+*/
+//===========================================================================
+void cCollisionContactCache::set(vector<cTriangle>* a_triangles,
+                                 const cCollisionAABBBox& a_region,
+                                 const vector<unsigned int>& a_indices)
+{
+    m_region = a_region;
+    m_numMeshTriangles = (unsigned int)a_triangles->size();
+    m_lastPacket = 0;
+
+    unsigned int numPackets = ((unsigned int)a_indices.size() + CHAI_TRIANGLE_PACKET_SIZE - 1) / CHAI_TRIANGLE_PACKET_SIZE;
+    m_packets.resize(numPackets);
+    m_boxes.resize(numPackets);
+    for (unsigned int i=0; i<numPackets; i++)
+    {
+        unsigned int firstIndex = i * CHAI_TRIANGLE_PACKET_SIZE;
+        unsigned int numTriangles = cMin((unsigned int)a_indices.size() - firstIndex, (unsigned int)CHAI_TRIANGLE_PACKET_SIZE);
+        m_packets[i].set(a_triangles, &a_indices[firstIndex], numTriangles);
+
+        m_boxes[i].setEmpty();
+        for (unsigned int j=0; j<numTriangles; j++)
+        {
+            const cTriangle& triangle = (*a_triangles)[a_indices[firstIndex + j]];
+            m_boxes[i].enclose(triangle.getVertex0()->getPos());
+            m_boxes[i].enclose(triangle.getVertex1()->getPos());
+            m_boxes[i].enclose(triangle.getVertex2()->getPos());
+        }
+    }
+}
+
+
+//===========================================================================
+/*!
+    Cache the triangles of a region, already in packets (such as the leaves
+    of a tree), with a box around each packet. The packets must hold every
+    triangle of the mesh for which overlaps() is \b true.
+
+    \fn     void cCollisionContactCache::set(vector<cTriangle>* a_triangles,
+                                             const cCollisionAABBBox& a_region,
+                                             const vector<cTrianglePacket>& a_packets,
+                                             const vector<cCollisionAABBBox>& a_boxes)
+    \param  a_triangles  Triangles of the mesh.
+    \param  a_region  The region.
+    \param  a_packets  Packets holding the triangles overlapping the region.
+    \param  a_boxes  Box around the triangles of each packet.
+*/
+//===========================================================================
+void cCollisionContactCache::set(vector<cTriangle>* a_triangles,
+                                 const cCollisionAABBBox& a_region,
+                                 const vector<cTrianglePacket>& a_packets,
+                                 const vector<cCollisionAABBBox>& a_boxes)
+{
+    m_region = a_region;
+    m_numMeshTriangles = (unsigned int)a_triangles->size();
+    m_lastPacket = 0;
+    m_packets = a_packets;
+    m_boxes = a_boxes;
+}
+
+
+//===========================================================================
+/*!
+    Return whether the box around a triangle overlaps the region. The
+    triangles a detector collects for set() are those for which this is
+    \b true.
+
+    \fn     bool cCollisionContactCache::overlaps(const cCollisionAABBBox& a_region,
+                                                  const cTriangle& a_triangle)
+    \param  a_region  The region.
+    \param  a_triangle  Triangle to test.
+    \return Return \b true if the triangle may lie in the region.
+*/
+//===========================================================================
+bool cCollisionContactCache::overlaps(const cCollisionAABBBox& a_region,
+                                      const cTriangle& a_triangle)
+{
+    cVector3d vertex0 = a_triangle.getVertex0()->getPos();
+    cVector3d vertex1 = a_triangle.getVertex1()->getPos();
+    cVector3d vertex2 = a_triangle.getVertex2()->getPos();
+
+    return ((cMax(vertex0.x, cMax(vertex1.x, vertex2.x)) >= a_region.getLowerX()) &&
+            (cMin(vertex0.x, cMin(vertex1.x, vertex2.x)) <= a_region.getUpperX()) &&
+            (cMax(vertex0.y, cMax(vertex1.y, vertex2.y)) >= a_region.getLowerY()) &&
+            (cMin(vertex0.y, cMin(vertex1.y, vertex2.y)) <= a_region.getUpperY()) &&
+            (cMax(vertex0.z, cMax(vertex1.z, vertex2.z)) >= a_region.getLowerZ()) &&
+            (cMin(vertex0.z, cMin(vertex1.z, vertex2.z)) <= a_region.getUpperZ()));
+}
@@ -0,0 +1,167 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#ifndef CCollisionContactCacheH
+#define CCollisionContactCacheH
+//---------------------------------------------------------------------------
+#include "math/CMaths.h"
+#include "graphics/CTriangle.h"
+#include "graphics/CTrianglePacket.h"
+#include "collisions/CCollisionBasics.h"
+#include "collisions/CCollisionAABBBox.h"
+#include <vector>
+//---------------------------------------------------------------------------
+using std::vector;
+//---------------------------------------------------------------------------
+//! Margin kept around a contact, in sizes of the contact triangle.
+#define CHAI_COLLISION_CACHE_REACH          2.0
+
+//! Largest number of triangles cached around a contact.
+#define CHAI_COLLISION_CACHE_MAX_TRIANGLES  4096
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \file       CCollisionContactCache.h
+
+    \brief
+    <b> Collision Detection </b> \n
+    Triangles Around the Last Contact of a Collision Detector.
+*/
+//===========================================================================
+
+//===========================================================================
+/*!
+    \class      cCollisionContactCache
+    \ingroup    collisions
+
+    \brief
+    cCollisionContactCache keeps the triangles of a mesh that lie in a box
+    (the region) around the last contact its collision detector reported,
+    so that the next queries of a proxy sliding on the surface can be
+    answered without searching the tree. \n
+
+    A triangle can only be hit at some point of the segment if it lies
+    within the collision radius of that point. Once the cached triangles are
+    tested, if the part of the segment up to the nearest collision (or the
+    whole segment, if there is none), grown by the collision radius, lies
+    inside the region, every triangle that could be hit nearer is among the
+    cached ones, and the query is answered exactly. Otherwise the detector
+    searches its tree as usual, starting from the collision found in the
+    cache, and caches the region around the new contact. Within the cache,
+    the packet hit by the last query is tested first, and packets that the
+    segment misses, or reaches only beyond the nearest collision, are
+    skipped. \n
+
+    Only queries for the nearest collision with \e m_useContactCache set in
+    their cCollisionSettings use the cache. The triangles are collected by
+    the detector's tree (see cCollisionAABB and cCollisionBVH); the cache is
+    cleared whenever the tree is rebuilt or refit.
+*/
+//===========================================================================
+class cCollisionContactCache
+{
+  public:
+
+    //-----------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //-----------------------------------------------------------------------
+
+    //! Constructor of cCollisionContactCache.
+    cCollisionContactCache();
+
+    //! Destructor of cCollisionContactCache.
+    virtual ~cCollisionContactCache() {}
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Forget the cached triangles.
+    void clear();
+
+    //! Test the segment against the cached triangles, and return \b true if that answers the query.
+    bool computeCollision(vector<cTriangle>* a_triangles,
+                          cVector3d& a_segmentPointA,
+                          cVector3d& a_segmentPointB,
+                          cCollisionRecorder& a_recorder,
+                          cCollisionSettings& a_settings,
+                          bool& a_hit);
+
+    //! Compute the region to cache around the nearest collision of a query, if it is with the mesh.
+    bool computeRegion(vector<cTriangle>* a_triangles,
+                       const cVector3d& a_segmentPointA,
+                       const cCollisionRecorder& a_recorder,
+                       const cCollisionSettings& a_settings,
+                       cCollisionAABBBox& a_region) const;
+
+    //! Cache the triangles of a region.
+    void set(vector<cTriangle>* a_triangles,
+             const cCollisionAABBBox& a_region,
+             const vector<unsigned int>& a_indices);
+
+    //! Cache the triangles of a region, already in packets.
+    void set(vector<cTriangle>* a_triangles,
+             const cCollisionAABBBox& a_region,
+             const vector<cTrianglePacket>& a_packets,
+             const vector<cCollisionAABBBox>& a_boxes);
+
+    //! Return \b true if the box around a triangle overlaps the region.
+    static bool overlaps(const cCollisionAABBBox& a_region, const cTriangle& a_triangle);
+
+    //! Return the number of queries that tested the cached triangles.
+    unsigned int getNumQueries() const { return (m_numQueries); }
+
+    //! Return the number of those queries answered without searching the tree.
+    unsigned int getNumAnswered() const { return (m_numAnswered); }
+
+
+  protected:
+
+    //-----------------------------------------------------------------------
+    // MEMBERS:
+    //-----------------------------------------------------------------------
+
+    //! Region around the last contact, in the mesh's coordinates.
+    cCollisionAABBBox m_region;
+
+    //! The triangles overlapping the region.
+    vector<cTrianglePacket> m_packets;
+
+    //! Box around the triangles of each packet.
+    vector<cCollisionAABBBox> m_boxes;
+
+    //! Packet holding the nearest collision of the last query, which is tested first.
+    unsigned int m_lastPacket;
+
+    //! Number of triangles in the mesh when the region was cached, or 0 if none is.
+    unsigned int m_numMeshTriangles;
+
+    //! Number of queries that tested the cached triangles.
+    unsigned int m_numQueries;
+
+    //! Number of those queries answered without searching the tree.
+    unsigned int m_numAnswered;
+};
+
+//---------------------------------------------------------------------------
+#endif
+//---------------------------------------------------------------------------
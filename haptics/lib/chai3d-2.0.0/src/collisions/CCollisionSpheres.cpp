@@ -23,12 +23,6 @@
 #include "collisions/CCollisionSpheres.h"
 #include <algorithm>
 //---------------------------------------------------------------------------
-//! Pointer to first free location in array of sphere tree internal nodes.
-cCollisionSpheresNode* g_nextInternalNode;
-
-//! Pointer to first free location in array of sphere tree leaf nodes.
-cCollisionSpheresLeaf* g_nextLeafNode;
-
 //! A "sufficiently small" number; zero within tolerated precision.
 const double LITTLE = 1e-10;
 
@@ -36,9 +30,316 @@ const double LITTLE = 1e-10;
 const double LARGE = 1e10;
 
 //cTriangle* secret2;
+
+//! Internal use: a range of the triangles whose subtree is left to build.
+struct cCollisionSpheresTask
+{
+    //! Root of the subtree, already constructed.
+    cCollisionSpheresNode* m_node;
+
+    //! Parent of the root.
+    cCollisionSpheresSphere* m_parent;
+
+    //! Position of the root among the internal nodes.
+    unsigned int m_nodeIndex;
+
+    //! First triangle of the range.
+    unsigned int m_first;
+
+    //! One past the last triangle of the range.
+    unsigned int m_last;
+};
+
+//! Internal use: orders triangle primitives by the position of their centers along an axis.
+struct cCollisionSpheresCenterLess
+{
+    //! Axis to compare along.
+    int m_axis;
+
+    //! Return \b true if the center of \e a_a is below that of \e a_b.
+    bool operator()(const cCollisionSpheresTri* a_a, const cCollisionSpheresTri* a_b) const
+    {
+        return (a_a->getCenter()[m_axis] < a_b->getCenter()[m_axis]);
+    }
+};
 //---------------------------------------------------------------------------
 
 
+//===========================================================================
+/*!
+    Split a range of triangles at the median of their centers, along the
+    axis where the centers spread most. The range is reordered so that the
+    first half lies below the second along that axis.
+
+    \fn     static unsigned int cSplitSpheresRange(cCollisionSpheresTri** a_primitives,
+                                                  const unsigned int a_first,
+                                                  const unsigned int a_last)
+    \param  a_primitives  Triangle primitives of the tree.
+    \param  a_first  First triangle of the range.
+    \param  a_last  One past the last triangle of the range.
+    \return Return the first triangle of the second half.
+*/
+//===========================================================================
+static unsigned int cSplitSpheresRange(cCollisionSpheresTri** a_primitives,
+                                       const unsigned int a_first,
+                                       const unsigned int a_last)
+{
+    // find minimum and maximum values for each coordinate of primitives' centers
+    double min[3] = {LARGE, LARGE, LARGE};
+    double max[3] = {-LARGE, -LARGE, -LARGE};
+    for (unsigned int i=a_first; i<a_last; i++)
+    {
+        const cVector3d& center = a_primitives[i]->getCenter();
+        for (int axis=0; axis<3; axis++)
+        {
+            if (center[axis] < min[axis]) min[axis] = center[axis];
+            if (center[axis] > max[axis]) max[axis] = center[axis];
+        }
+    }
+
+    // find the coordinate index with the largest range (max to min)
+    cCollisionSpheresCenterLess less;
+    less.m_axis = 0;
+    if ((max[1] - min[1]) > (max[less.m_axis] - min[less.m_axis])) less.m_axis = 1;
+    if ((max[2] - min[2]) > (max[less.m_axis] - min[less.m_axis])) less.m_axis = 2;
+
+    // put the first half along that axis in the left subtree
+    unsigned int middle = a_first + (a_last - a_first) / 2;
+    std::nth_element(a_primitives + a_first, a_primitives + middle, a_primitives + a_last, less);
+    return (middle);
+}
+
+
+//===========================================================================
+/*!
+    Build the subtree over a range of triangles. The internal nodes of a
+    subtree over \e n triangles take the \e n - 1 positions from its root's,
+    its left subtree coming first, and its leaves take the positions of its
+    triangles, so subtrees can be built independently. Subtrees smaller
+    than CHAI_SPHERES_PARALLEL_SIZE are left for later if \e a_tasks is
+    given, and so is fitting the spheres of the nodes above them.
+
+    \fn     static cCollisionSpheresSphere* cBuildSpheresSubtree(cCollisionSpheresTri** a_primitives,
+                                           const unsigned int a_first,
+                                           const unsigned int a_last,
+                                           cCollisionSpheresNode* a_internalNodes,
+                                           const unsigned int a_nodeIndex,
+                                           cCollisionSpheresLeaf* a_leaves,
+                                           cCollisionSpheresSphere* a_parent,
+                                           vector<cCollisionSpheresTask>* a_tasks,
+                                           vector<cCollisionSpheresTask>* a_topNodes)
+    \param  a_primitives  Triangle primitives of the tree.
+    \param  a_first  First triangle of the range.
+    \param  a_last  One past the last triangle of the range.
+    \param  a_internalNodes  Internal nodes of the tree.
+    \param  a_nodeIndex  Position of the subtree's root among the internal nodes.
+    \param  a_leaves  Leaf nodes of the tree.
+    \param  a_parent  Parent of the subtree's root.
+    \param  a_tasks  Returns the subtrees left to build, or NULL to build them all.
+    \param  a_topNodes  Returns the nodes above them, whose spheres are left to fit.
+    \return Return the root of the subtree.
+*/
+//===========================================================================
+static cCollisionSpheresSphere* cBuildSpheresSubtree(cCollisionSpheresTri** a_primitives,
+                                                     const unsigned int a_first,
+                                                     const unsigned int a_last,
+                                                     cCollisionSpheresNode* a_internalNodes,
+                                                     const unsigned int a_nodeIndex,
+                                                     cCollisionSpheresLeaf* a_leaves,
+                                                     cCollisionSpheresSphere* a_parent,
+                                                     vector<cCollisionSpheresTask>* a_tasks,
+                                                     vector<cCollisionSpheresTask>* a_topNodes)
+{
+    // a single triangle is a leaf
+    if (a_last - a_first == 1)
+    {
+        return (new(&a_leaves[a_first]) cCollisionSpheresLeaf(a_primitives[a_first], a_parent));
+    }
+
+    cCollisionSpheresNode* node = new(&a_internalNodes[a_nodeIndex]) cCollisionSpheresNode(a_parent);
+
+    cCollisionSpheresTask range;
+    range.m_node = node;
+    range.m_parent = a_parent;
+    range.m_nodeIndex = a_nodeIndex;
+    range.m_first = a_first;
+    range.m_last = a_last;
+
+    // leave small subtrees to be built in parallel
+    if ((a_tasks != NULL) && (a_last - a_first < CHAI_SPHERES_PARALLEL_SIZE))
+    {
+        a_tasks->push_back(range);
+        return (node);
+    }
+    if (a_topNodes != NULL)
+    {
+        a_topNodes->push_back(range);
+    }
+
+    unsigned int middle = cSplitSpheresRange(a_primitives, a_first, a_last);
+    node->m_left = cBuildSpheresSubtree(a_primitives, a_first, middle,
+                                        a_internalNodes, a_nodeIndex + 1, a_leaves,
+                                        node, a_tasks, a_topNodes);
+    node->m_right = cBuildSpheresSubtree(a_primitives, middle, a_last,
+                                         a_internalNodes, a_nodeIndex + (middle - a_first), a_leaves,
+                                         node, a_tasks, a_topNodes);
+
+    // the children of the nodes above the tasks are not built yet
+    if (a_tasks == NULL)
+    {
+        node->fitSphere(a_primitives + a_first, a_last - a_first);
+    }
+    return (node);
+}
+
+
+//===========================================================================
+/*!
+    Fit a sphere around the spheres of two nodes.
+
+    \fn     static void cFitSpheresChildren(cCollisionSpheresSphere* a_left,
+                                           cCollisionSpheresSphere* a_right,
+                                           cVector3d& a_center,
+                                           double& a_radius)
+    \param  a_left  Left child.
+    \param  a_right  Right child.
+    \param  a_center  Returns the center of the sphere.
+    \param  a_radius  Returns the radius of the sphere.
+*/
+//===========================================================================
+static void cFitSpheresChildren(cCollisionSpheresSphere* a_left,
+                                cCollisionSpheresSphere* a_right,
+                                cVector3d& a_center,
+                                double& a_radius)
+{
+    // get centers and radii of left and right children
+    const cVector3d &lc = a_left->getCenter();
+    const cVector3d &rc = a_right->getCenter();
+    double lr = a_left->getRadius();
+    double rr = a_right->getRadius();
+
+    // compute new radius as one-half the sum of the distance between the two
+    // childrens' centers and the two childrens' radii
+    double dist = lc.distance(rc);
+    a_radius = (dist + lr + rr) / 2.0;
+
+    // compute new center along line between childrens' centers
+    if (dist != 0)
+    {
+        double lambda = (a_radius - lr) / dist;
+        a_center.x = lc.x + lambda*(rc.x - lc.x);
+        a_center.y = lc.y + lambda*(rc.y - lc.y);
+        a_center.z = lc.z + lambda*(rc.z - lc.z);
+    }
+
+    // if the left and right children have the same center, use this as the
+    // new center
+    else
+    {
+        a_center = lc;
+    }
+
+    // if one sphere is entirely contained within the other, set this sphere's
+    // new center and radius equal to those of the larger one
+    if (lr > dist + rr)
+    {
+        a_center = lc;
+        a_radius = lr;
+    }
+    if (rr > dist + lr)
+    {
+        a_center = rc;
+        a_radius = rr;
+    }
+
+    a_radius *= 1.001;
+}
+
+
+//===========================================================================
+/*!
+    Fit a sphere around the spheres of a range of triangles with Ritter's
+    algorithm: start from the sphere around the pair of triangles whose
+    centers lie farthest apart along an axis, then grow it just enough to
+    enclose each triangle's sphere left outside.
+
+    \fn     static void cFitSpheresRitter(cCollisionSpheresTri* const* a_primitives,
+                                         const unsigned int a_numPrimitives,
+                                         cVector3d& a_center,
+                                         double& a_radius)
+    \param  a_primitives  Triangles to enclose.
+    \param  a_numPrimitives  Number of triangles.
+    \param  a_center  Returns the center of the sphere.
+    \param  a_radius  Returns the radius of the sphere.
+*/
+//===========================================================================
+static void cFitSpheresRitter(cCollisionSpheresTri* const* a_primitives,
+                              const unsigned int a_numPrimitives,
+                              cVector3d& a_center,
+                              double& a_radius)
+{
+    // find the triangles with the extreme centers along each axis
+    unsigned int lowest[3] = {0, 0, 0};
+    unsigned int highest[3] = {0, 0, 0};
+    unsigned int i;
+    for (i=1; i<a_numPrimitives; i++)
+    {
+        const cVector3d& center = a_primitives[i]->getCenter();
+        for (int axis=0; axis<3; axis++)
+        {
+            if (center[axis] < a_primitives[lowest[axis]]->getCenter()[axis]) lowest[axis] = i;
+            if (center[axis] > a_primitives[highest[axis]]->getCenter()[axis]) highest[axis] = i;
+        }
+    }
+
+    // start from the pair farthest apart
+    int widest = 0;
+    double widestSq = -1.0;
+    for (int axis=0; axis<3; axis++)
+    {
+        double distanceSq = cDistanceSq(a_primitives[lowest[axis]]->getCenter(),
+                                        a_primitives[highest[axis]]->getCenter());
+        if (distanceSq > widestSq)
+        {
+            widest = axis;
+            widestSq = distanceSq;
+        }
+    }
+    const cCollisionSpheresTri* low = a_primitives[lowest[widest]];
+    const cCollisionSpheresTri* high = a_primitives[highest[widest]];
+    a_center = cMul(0.5, cAdd(low->getCenter(), high->getCenter()));
+    a_radius = 0.5 * sqrt(widestSq) + cMax(low->getRadius(), high->getRadius());
+
+    // grow the sphere towards each triangle left outside
+    for (i=0; i<a_numPrimitives; i++)
+    {
+        const cVector3d& center = a_primitives[i]->getCenter();
+        double radius = a_primitives[i]->getRadius();
+        double distanceSq = cDistanceSq(center, a_center);
+        double reach = a_radius - radius;
+        if ((reach < 0.0) || (distanceSq > reach * reach))
+        {
+            double distance = sqrt(distanceSq);
+
+            // a triangle whose sphere holds the whole sphere replaces it
+            if (radius >= a_radius + distance)
+            {
+                a_center = center;
+                a_radius = radius;
+                continue;
+            }
+
+            double grown = 0.5 * (a_radius + distance + radius);
+            if (distance > 0.0)
+            {
+                a_center.add(cMul((grown - a_radius) / distance, cSub(center, a_center)));
+            }
+            a_radius = grown;
+        }
+    }
+}
+
+
 //===========================================================================
 /*!
     Constructor of cCollisionSpheres.
@@ -56,6 +357,10 @@ cCollisionSpheres::cCollisionSpheres(vector<cTriangle> *a_triangles,
     m_useNeighbors = a_useNeighbors;
     m_root = NULL;
     m_firstLeaf = 0;
+    m_primitives = NULL;
+    m_numTriangles = 0;
+    m_radius = 0;
+    m_buildCost = 0;
 
     // set material properties
     m_material.m_ambient.set(0.1, 0.3, 0.1, 0.3);
@@ -74,17 +379,42 @@ cCollisionSpheres::cCollisionSpheres(vector<cTriangle> *a_triangles,
 //===========================================================================
 cCollisionSpheres::~cCollisionSpheres()
 {
-    // delete array of internal nodes
-    if (m_root != NULL)
-        delete [] m_root;
+    deleteTree();
+}
+
+
+//===========================================================================
+/*!
+    Delete the arrays of internal nodes, leaf nodes and triangle primitives.
+
+    \fn       void cCollisionSpheres::deleteTree()
+*/
+//===========================================================================
+void cCollisionSpheres::deleteTree()
+{
+    // delete array of internal nodes (with a single triangle, the root is
+    // the leaf, which is deleted below)
+    if ((m_root != NULL) && (m_root != m_firstLeaf))
+        delete [] (cCollisionSpheresNode*)m_root;
+    m_root = NULL;
 
-    // delete array of leaf nodes
-    // if ((m_trigs) && (m_trigs->size() > 1) && (m_firstLeaf))
+    // delete array of leaf nodes; their primitives belong to the array below
     if (m_firstLeaf)
     {
+        for (unsigned int i=0; i<m_numTriangles; i++)
+        {
+            m_firstLeaf[i].m_prim = 0;
+        }
         delete [] m_firstLeaf;
         m_firstLeaf = 0;
     }
+
+    // delete array of triangle primitives
+    if (m_primitives)
+    {
+        delete [] m_primitives;
+        m_primitives = NULL;
+    }
 }
 
 
@@ -92,9 +422,10 @@ cCollisionSpheres::~cCollisionSpheres()
 /*!
     Build the Sphere Tree collision-detection tree.  Each leaf is associated
     with one triangle and with a bounding sphere of minimal radius such that
-    it fully encloses the triangle.  Each internal node is associated
-    with a bounding sphere of minimal radius such that it fully encloses
-    the bounding spheres of its two children.
+    it fully encloses the triangle.  Each internal node splits its triangles
+    at their median along the axis where they spread most, and is associated
+    with a bounding sphere that fully encloses the bounding spheres of its
+    triangles.  Subtrees are built in parallel.
 
     \fn       void cCollisionSpheres::initialize(double a_radius)
     \param    a_radius radius to add around the triangles.
@@ -104,42 +435,161 @@ void cCollisionSpheres::initialize(double a_radius)
 {
 	secret = NULL;
 
+    // if a previous tree was created, delete it
+    deleteTree();
+
     // initialize number of triangles, root pointer, and last intersected triangle
-    int numTriangles = m_trigs->size();
+    int numTriangles = (int)m_trigs->size();
 
     m_root = NULL;
     m_lastCollision = NULL;
+    m_numTriangles = numTriangles;
+    m_radius = a_radius;
 
     // if there are triangles, build the tree
     if (numTriangles > 0)
     {
+        // create a cCollisionSpheresTri primitive for each cTriangle
+        m_primitives = new cCollisionSpheresTri[numTriangles];
+        int i;
+        #pragma omp parallel for
+        for (i=0; i<numTriangles; i++)
+        {
+            m_primitives[i].setOriginal(&(*m_trigs)[i]);
+            m_primitives[i].update(a_radius);
+        }
 
         // allocate array for leaf nodes
-        g_nextLeafNode = new cCollisionSpheresLeaf[numTriangles];
-        m_firstLeaf = g_nextLeafNode;
+        m_firstLeaf = new cCollisionSpheresLeaf[numTriangles];
 
-        // if there is more than one triangle, allocate internal nodes
-        if (numTriangles > 1)
+        // if there is only one triangle, the root is its leaf
+        if (numTriangles == 1)
         {
-            g_nextInternalNode = new cCollisionSpheresNode[numTriangles-1];
-            m_root = g_nextInternalNode;
-            new(g_nextInternalNode++) cCollisionSpheresNode(m_trigs, NULL, a_radius);
+            m_root = new(&m_firstLeaf[0]) cCollisionSpheresLeaf(&m_primitives[0], NULL);
         }
 
-        // if there is only one triangle, just allocate one leaf node and
-        // set the root to point to it
+        // otherwise build the internal nodes
         else
         {
-            new(&m_firstLeaf[0]) cCollisionSpheresLeaf(&((*m_trigs)[0]));
-            m_root = g_nextLeafNode;
+            vector<cCollisionSpheresTri*> primitives(numTriangles);
+            for (i=0; i<numTriangles; i++)
+            {
+                primitives[i] = &m_primitives[i];
+            }
+
+            cCollisionSpheresNode* internalNodes = new cCollisionSpheresNode[numTriangles-1];
+
+            // split the top of the tree, leaving its smaller subtrees as tasks
+            vector<cCollisionSpheresTask> tasks;
+            vector<cCollisionSpheresTask> topNodes;
+            m_root = cBuildSpheresSubtree(&primitives[0], 0, numTriangles,
+                                          internalNodes, 0, m_firstLeaf,
+                                          NULL, &tasks, &topNodes);
+
+            // build the subtrees; each writes only its own nodes and leaves
+            int numTasks = (int)tasks.size();
+            int t;
+            #pragma omp parallel for schedule(dynamic)
+            for (t=0; t<numTasks; t++)
+            {
+                const cCollisionSpheresTask& task = tasks[t];
+                cBuildSpheresSubtree(&primitives[0], task.m_first, task.m_last,
+                                     internalNodes, task.m_nodeIndex, m_firstLeaf,
+                                     task.m_parent, NULL, NULL);
+            }
+
+            // fit the spheres of the nodes above the subtrees, children first
+            for (t=(int)topNodes.size()-1; t>=0; t--)
+            {
+                const cCollisionSpheresTask& node = topNodes[t];
+                node.m_node->fitSphere(&primitives[node.m_first], node.m_last - node.m_first);
+            }
         }
     }
 
-    // if there are no triangles, just set the root to null
-    else
+    // remember how good the tree was, so that refit() can tell when it degrades
+    m_buildCost = computeCost();
+}
+
+
+//===========================================================================
+/*!
+    Update the spheres of the tree to the current positions of the vertices,
+    without changing its structure. The leaves are refitted to their
+    triangles, then each internal node to its children. Internal nodes are
+    allocated before their children, so walking the array backwards visits
+    every child before its parent. \n
+
+    If \e a_maxDegradation is positive and the cost of the refitted tree (see
+    computeCost()) has grown past \e a_maxDegradation times its cost when it
+    was built, the tree is rebuilt instead. \n
+
+    The triangles of the mesh must not have been added, removed or
+    reallocated since the tree was built.
+
+    \fn       bool cCollisionSpheres::refit(double a_maxDegradation)
+    \param    a_maxDegradation  Growth in cost past which the tree is rebuilt;
+                                0 never rebuilds.
+    \return   Return \b true if the tree was rebuilt.
+*/
+//===========================================================================
+bool cCollisionSpheres::refit(double a_maxDegradation)
+{
+    if (m_root == NULL) return (false);
+
+    // refit the leaves to their triangles
+    unsigned int i;
+    for (i=0; i<m_numTriangles; i++)
+    {
+        m_firstLeaf[i].fitSphere(m_radius);
+    }
+
+    // refit the internal nodes, children first
+    if (m_numTriangles > 1)
     {
-        m_root = 0;
+        cCollisionSpheresNode* internalNodes = (cCollisionSpheresNode*)m_root;
+        for (i=m_numTriangles-1; i>0; i--)
+        {
+            internalNodes[i-1].fitSphere();
+        }
     }
+
+    // rebuild the tree if it has become much worse than when it was built
+    if ((a_maxDegradation > 0) && (computeCost() > a_maxDegradation * m_buildCost))
+    {
+        initialize(m_radius);
+        return (true);
+    }
+
+    return (false);
+}
+
+
+//===========================================================================
+/*!
+    Compute the cost of the tree: the sum of the surface areas of the
+    internal spheres, relative to that of the root. It grows as the spheres
+    overlap more.
+
+    \fn       double cCollisionSpheres::computeCost()
+    \return   Return the cost of the tree (0 for a single leaf).
+*/
+//===========================================================================
+double cCollisionSpheres::computeCost()
+{
+    if ((m_root == NULL) || (m_numTriangles < 2)) return (0.0);
+
+    cCollisionSpheresNode* internalNodes = (cCollisionSpheresNode*)m_root;
+    double area = 0.0;
+    for (unsigned int i=0; i<m_numTriangles-1; i++)
+    {
+        double radius = internalNodes[i].getRadius();
+        area += radius * radius;
+    }
+
+    double rootRadius = m_root->getRadius();
+    if (rootRadius <= 0.0) return (0.0);
+    return (area / (rootRadius * rootRadius));
 }
 
 
@@ -327,185 +777,45 @@ bool cCollisionSpheresSphere::computeCollision(cCollisionSpheresSphere *a_sa,
 
 //===========================================================================
 /*!
-    Constructor of cCollisionSpheresNode.
+    Fit the sphere of this node around the spheres of its two children.
 
-    \fn         cCollisionSpheresNode::cCollisionSpheresNode(Plist &a_primList,
-                cCollisionSpheresSphere *a_parent)
-    \param      a_primList  List of shape primitives to be enclosed in the
-                            subtree rooted at this internal node.
-    \param      a_parent  Pointer to the parent of this node in the tree.
+    \fn       void cCollisionSpheresNode::fitSphere()
 */
 //===========================================================================
-cCollisionSpheresNode::cCollisionSpheresNode(Plist &a_primList,
-                                             cCollisionSpheresSphere *a_parent) :
-                                             cCollisionSpheresSphere(a_parent)
+void cCollisionSpheresNode::fitSphere()
 {
-    // set this node's parent pointer
-    m_parent = a_parent;
-
-    // create the left and right subtrees of this node
-    ConstructChildren(a_primList);
+    cFitSpheresChildren(m_left, m_right, m_center, m_radius);
 }
 
 
 //===========================================================================
 /*!
-    Constructor of cCollisionSpheresNode.
-
-    \fn       cCollisionSpheresNode::cCollisionSpheresNode(std::vector<cTriangle>* a_tris,
-                 cCollisionSpheresSphere *a_parent,
-                 double a_extendedRadius) :
-                 cCollisionSpheresSphere(a_parent)
-    \param    a_tris  Pointer to vector of triangles to use for collision detection.
-    \param    a_parent  Pointer to the parent of this node in sphere tree.
-    \param    a_extendedRadius  Bounding radius.
+    Fit the sphere of this node around the triangles of its subtree. Both
+    the sphere around the spheres of its two children and the sphere around
+    the spheres of the triangles themselves (found with Ritter's algorithm)
+    enclose the subtree; the smaller one is kept.
+
+    \fn       void cCollisionSpheresNode::fitSphere(cCollisionSpheresTri* const* a_primitives,
+                                                   const unsigned int a_numPrimitives)
+    \param    a_primitives  Triangles of the subtree rooted at this node.
+    \param    a_numPrimitives  Number of triangles.
 */
 //===========================================================================
-cCollisionSpheresNode::cCollisionSpheresNode(std::vector<cTriangle>* a_tris,
-                                             cCollisionSpheresSphere *a_parent,
-                                             double a_extendedRadius) :
-                                             cCollisionSpheresSphere(a_parent)
+void cCollisionSpheresNode::fitSphere(cCollisionSpheresTri* const* a_primitives,
+                                      const unsigned int a_numPrimitives)
 {
-    // create cCollisionSpheresTri primitive object for each cTriangle object
-    Plist primList;
-    for (unsigned int i=0; i<a_tris->size(); i++)
-    {
-        // create cCollisionSpheresPoint primitive object for first point
-        cVector3d vpos1 =  (*a_tris)[i].getVertex0()->getPos();
-        cVector3d vpos2 =  (*a_tris)[i].getVertex1()->getPos();
-        cVector3d vpos3 =  (*a_tris)[i].getVertex2()->getPos();
-
-        cCollisionSpheresTri* t = new cCollisionSpheresTri(vpos1,
-                                                           vpos2,
-                                                           vpos3,
-                                                           a_extendedRadius);
-
-        t->setOriginal(&(*a_tris)[i]);
-
-        // insert new object in primitives list
-        primList.insert(primList.end(), t);
-    }
-
-    // set parent pointer
-    m_parent = a_parent;
-
-    // create left and right subtrees of this node
-    ConstructChildren(primList);
-}
+    cFitSpheresChildren(m_left, m_right, m_center, m_radius);
 
+    cVector3d center;
+    double radius;
+    cFitSpheresRitter(a_primitives, a_numPrimitives, center, radius);
+    radius *= 1.001;
 
-//===========================================================================
-/*!
-    Create subtrees by splitting primitives into left and right lists.
-
-    \fn       void cCollisionSpheresNode::ConstructChildren(Plist &a_primList)
-    \param    a_primList  List of shape primitives to be split into left
-                          and right subtrees.
-*/
-//===========================================================================
-void cCollisionSpheresNode::ConstructChildren(Plist &a_primList)
-{
-    // ensure that there are at least two primitives so that it makes sense
-    // to split them into left and right subtrees
-    Plist::iterator primIter;
-    assert(a_primList.size() >= 2);
-
-    // declare and initialize local variables for splitting primitives
-    Plist leftList, rightList;
-    double min[3] = {LARGE, LARGE, LARGE};
-    double max[3] = {-LARGE, -LARGE, -LARGE};
-
-    // find minimum and maximum values for each coordinate of primitves' centers
-    for (primIter = a_primList.begin(); primIter != a_primList.end(); primIter++)
-    {
-        cCollisionSpheresGenericShape *cur = *primIter;
-        const cVector3d &center = cur->getCenter();
-        for (int i = 0; i < 3; i++)
-        {
-          if (center.get(i) < min[i])
-              min[i] = center.get(i);
-          if (center.get(i) > max[i])
-              max[i] = center.get(i);
-        }
-    }
-
-    // find the coordinate index with the largest range (max to min)
-    int split = 0;
-    if ((max[1] - min[1]) > (max[split] - min[split]))
-        split = 1;
-    if ((max[2] - min[2]) > (max[split] - min[split]))
-        split = 2;
-
-    // sort the primitives according to the coordinate with largest range
-    cCollisionSpheresGenericShape::m_split = split;
-    std::sort(a_primList.begin(), a_primList.end());
-
-    // put first half in left subtree and second half in right subtree
-    unsigned int s;
-    for (s=0; s<a_primList.size()/2; s++)
-        leftList.insert(leftList.end(), a_primList[s]);
-    for (s=a_primList.size()/2; s<a_primList.size(); s++)
-        rightList.insert(rightList.end(), a_primList[s]);
-
-    // if the left subtree is empty, transfer one from the right list
-    if (leftList.size() == 0)
-    {
-        leftList.insert(leftList.begin(), *rightList.begin());
-        rightList.erase(rightList.begin());
-    }
-
-    // create new internal nodes as roots for left and right subtree lists, or
-    // a leaf node if the subtree list has only one primitive
-    if (leftList.size() == 1)
-        m_left = new(g_nextLeafNode++) cCollisionSpheresLeaf(*(leftList.begin()), this);
-    else
-        m_left = new(g_nextInternalNode++) cCollisionSpheresNode(leftList, this);
-    if (rightList.size() == 1)
-        m_right = new(g_nextLeafNode++) cCollisionSpheresLeaf(*(rightList.begin()), this);
-    else
-        m_right = new(g_nextInternalNode++) cCollisionSpheresNode(rightList, this);
-
-    // get centers and radii of left and right children
-    const cVector3d &lc = m_left->m_center;
-    const cVector3d &rc = m_right->m_center;
-    double lr = m_left->getRadius();
-    double rr = m_right->getRadius();
-
-    // compute new radius as one-half the sum of the distance between the two
-    // childrens' centers and the two childrens' radii
-    double dist = lc.distance(rc);
-    m_radius = (dist + lr + rr) / 2.0;
-
-    // compute new center along line between childrens' centers
-    if (dist != 0)
-    {
-        double lambda = (m_radius - lr) / dist;
-        m_center.x = lc.x + lambda*(rc.x - lc.x);
-        m_center.y = lc.y + lambda*(rc.y - lc.y);
-        m_center.z = lc.z + lambda*(rc.z - lc.z);
-    }
-
-    // if the left and right children have the same center, use this as the
-    // new center
-    else
+    if (radius < m_radius)
     {
-        m_center = lc;
+        m_center = center;
+        m_radius = radius;
     }
-
-    // if one sphere is entirely contained within the other, set this sphere's
-    // new center and radius equal to those of the larger one
-    if (lr > dist + rr)
-    {
-        m_center = lc;
-        m_radius = lr;
-    }
-    if (rr > dist + lr)
-    {
-        m_center = rc;
-        m_radius = rr;
-    }
-
-	m_radius*=1.001;
 }
 
 
@@ -631,6 +941,22 @@ cCollisionSpheresLeaf::cCollisionSpheresLeaf(cCollisionSpheresGenericShape *a_pr
 }
 
 
+//===========================================================================
+/*!
+    Refit the sphere of this leaf to the current position of its primitive.
+
+    \fn       void cCollisionSpheresLeaf::fitSphere(double a_extendedRadius)
+    \param    a_extendedRadius  Bounding radius.
+*/
+//===========================================================================
+void cCollisionSpheresLeaf::fitSphere(double a_extendedRadius)
+{
+    m_prim->update(a_extendedRadius);
+    m_radius = m_prim->getRadius();
+    m_center = m_prim->getCenter();
+}
+
+
 //===========================================================================
 /*!
     Constructor of cCollisionSpheresLeaf.
@@ -35,6 +35,10 @@
 #include <list>
 #include <queue>
 #include <vector>
+//---------------------------------------------------------------------------
+//! Subtrees with fewer triangles than this are built on a single thread.
+#define CHAI_SPHERES_PARALLEL_SIZE  4096
+//---------------------------------------------------------------------------
 
 //===========================================================================
 /*!
@@ -65,7 +69,16 @@ class cCollisionSpheresLeaf;
     \brief    
     cCollisionSpheres provides methods to create a sphere tree for
     collision detection, and to use this tree to check for the
-    intersection of a line with a mesh.
+    intersection of a line with a mesh. \n
+
+    The tree is built by splitting the triangles at their median along the
+    axis where their centers spread most. The nodes and the triangle
+    primitives are allocated in three arrays, and each subtree's nodes
+    are at positions that follow from the triangles it holds, so subtrees
+    smaller than CHAI_SPHERES_PARALLEL_SIZE triangles are built in
+    parallel (with OpenMP). Each internal node gets the smaller of the
+    sphere around its two children and the sphere that Ritter's algorithm
+    fits around the spheres of its triangles.
 */
 //===========================================================================
 class cCollisionSpheres : public cGenericCollision
@@ -93,6 +106,12 @@ class cCollisionSpheres : public cGenericCollision
     //! Draw the collision spheres in OpenGL.
     void render();
 
+    //! Update the spheres to the current vertex positions, rebuilding the tree if it has degraded too much.
+    bool refit(double a_maxDegradation = 0);
+
+    //! Return the total area of the internal spheres relative to the root's.
+    double computeCost();
+
     //! Return the nearest triangle intersected by the given segment, if any.
     bool computeCollision(cVector3d& a_segmentPointA,
                           cVector3d& a_segmentPointB,
@@ -119,8 +138,30 @@ class cCollisionSpheres : public cGenericCollision
     //! Pointer to the beginning of list of leaf nodes.
     cCollisionSpheresLeaf *m_firstLeaf;
 
+    //! Triangle primitives of the leaves, in the order of the triangles.
+    cCollisionSpheresTri *m_primitives;
+
+    //! Number of leaf nodes (one per triangle).
+    unsigned int m_numTriangles;
+
+    //! Radius added around the triangles when the tree was built.
+    double m_radius;
+
+    //! Cost of the tree when it was built (see computeCost()).
+    double m_buildCost;
+
     //! For internal and debug usage.
 	cTriangle* secret;
+
+
+  protected:
+
+	//-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Delete the nodes and primitives of the tree.
+    void deleteTree();
 };
 
 
@@ -227,14 +268,9 @@ class cCollisionSpheresNode : public cCollisionSpheresSphere
     // CONSTRUCTORS AND DESTRUCTOR:
     //-----------------------------------------------------------------------
 
-    //! Constructor of cCollisionSpheresNode.
-    cCollisionSpheresNode(Plist &a_primList,
-            cCollisionSpheresSphere *a_parent = NULL);
-
-    //! Constructor of cCollisionSpheresNode.
-    cCollisionSpheresNode(std::vector<cTriangle> *a_tris,
-            cCollisionSpheresSphere *a_parent = NULL,
-            double a_extendedRadius = 0);
+    //! Constructor of cCollisionSpheresNode; its children are set by the tree.
+    cCollisionSpheresNode(cCollisionSpheresSphere *a_parent) :
+        cCollisionSpheresSphere(a_parent), m_left(0), m_right(0) { };
 
     //! Default constructor of cCollisionSpheresNode.
     cCollisionSpheresNode() : cCollisionSpheresSphere(), m_left(0), m_right(0) { };
@@ -247,8 +283,12 @@ class cCollisionSpheresNode : public cCollisionSpheresSphere
     // METHODS:
     //-----------------------------------------------------------------------
 
-    //! Create subtrees by splitting primitives into left and right lists.
-    void ConstructChildren(Plist &a_primList);
+    //! Fit the sphere around the spheres of the two children.
+    void fitSphere();
+
+    //! Fit the smaller of the sphere around the children and the sphere around the given triangles.
+    void fitSphere(cCollisionSpheresTri* const* a_primitives,
+                   const unsigned int a_numPrimitives);
 
     //! Return whether the node is a leaf node. (In this class, it is not.)
     int isLeaf()  { return 0; }
@@ -320,6 +360,9 @@ class cCollisionSpheresLeaf : public cCollisionSpheresSphere
     //! Return whether the node is a leaf node. (In this class, it is.)
     int isLeaf()  { return 1; }
 
+    //! Refit the sphere to the current position of the primitive.
+    void fitSphere(double a_extendedRadius);
+
     //! Draw the collision sphere if at the given depth.
     void draw(int a_depth);
 
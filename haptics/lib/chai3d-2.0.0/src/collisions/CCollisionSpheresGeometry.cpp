@@ -80,6 +80,52 @@ cCollisionSpheresTri::cCollisionSpheresTri(cVector3d a,
                                            cVector3d b,
                                            cVector3d c,
                                            double a_extendedRadius)
+{
+    m_original = NULL;
+    fitSphere(a, b, c, a_extendedRadius);
+}
+
+
+//===========================================================================
+/*!
+    Refit the bounding sphere to the current positions of the vertices of
+    the cTriangle object, after they have moved.
+
+    \fn       void cCollisionSpheresTri::update(double a_extendedRadius)
+    \param    a_extendedRadius  Additional radius to add to sphere.
+*/
+//===========================================================================
+void cCollisionSpheresTri::update(double a_extendedRadius)
+{
+    if (m_original == NULL) return;
+
+    fitSphere(m_original->getVertex0()->getPos(),
+              m_original->getVertex1()->getPos(),
+              m_original->getVertex2()->getPos(),
+              a_extendedRadius);
+}
+
+
+//===========================================================================
+/*!
+    Fit the bounding sphere to the given vertices: the smallest of the
+    circumscribing sphere and the spheres around each edge that enclose the
+    third vertex.
+
+    \fn       void cCollisionSpheresTri::fitSphere(cVector3d a,
+                                             cVector3d b,
+                                             cVector3d c,
+                                             double a_extendedRadius)
+    \param    a     First vertex of the triangle.
+    \param    b     Second vertex of the triangle.
+    \param    c     Third vertex of the triangle.
+    \param    a_extendedRadius  Additional radius to add to sphere.
+*/
+//===========================================================================
+void cCollisionSpheresTri::fitSphere(cVector3d a,
+                                     cVector3d b,
+                                     cVector3d c,
+                                     double a_extendedRadius)
 {
     // Calculate the center of the circumscribing sphere for this triangle:
     // First compute the normal to the plane of this triangle
@@ -189,6 +189,9 @@ class cCollisionSpheresGenericShape
     //! Return radius.
     virtual double getRadius() const = 0;
 
+    //! Refit the bounding sphere to the current position of the shape.
+    virtual void update(double a_extendedRadius) {}
+
     //! Determine whether this primitive intersects the given primitive.
     virtual bool computeCollision(cCollisionSpheresGenericShape *a_other,
                                   cCollisionRecorder& a_recorder,
@@ -245,6 +248,9 @@ class cCollisionSpheresTri : public cCollisionSpheresGenericShape
     // CONSTRUCTOR & DESTRUCTOR:
     //-----------------------------------------------------------------------
 
+    //! Default constructor of cCollisionSpheresTri; update() fits it once setOriginal() is called.
+    cCollisionSpheresTri() : m_radius(0), m_original(NULL) { }
+
     //! Constructor of cCollisionSpheresTri.
     cCollisionSpheresTri(cVector3d a,
                          cVector3d b,
@@ -276,6 +282,9 @@ class cCollisionSpheresTri : public cCollisionSpheresGenericShape
     //! Sets the cTriangle object in the mesh associated with this triangle.
     void setOriginal(cTriangle* a_original) { m_original = a_original; }
 
+    //! Refit the bounding sphere to the current vertices of the cTriangle object.
+    void update(double a_extendedRadius);
+
 
   protected:
 	
@@ -297,6 +306,14 @@ class cCollisionSpheresTri : public cCollisionSpheresGenericShape
 
     //! The cTriangle object in the mesh associated with this triangle.
     cTriangle* m_original;
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Fit the bounding sphere to the given vertices.
+    void fitSphere(cVector3d a, cVector3d b, cVector3d c, double a_extendedRadius);
 };
 
 
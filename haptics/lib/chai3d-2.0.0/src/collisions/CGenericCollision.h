@@ -26,6 +26,9 @@
 //---------------------------------------------------------------------------
 using std::vector;
 //---------------------------------------------------------------------------
+//! Growth in the cost of a collision tree past which refitting rebuilds it.
+#define CHAI_COLLISION_MAX_DEGRADATION  2.0
+//---------------------------------------------------------------------------
 
 //===========================================================================
 /*!
@@ -44,7 +47,12 @@ using std::vector;
     
     \brief    
     cGenericCollision is an abstract class for collision-detection
-    algorithms for meshes with line segments.
+    algorithms for meshes with line segments. \n
+
+    Detectors may also answer proximity queries with computeClosestPoint(),
+    which finds the point of the mesh nearest to a given point. A point
+    already stored in the cProximityEvent is kept unless a nearer one is
+    found, so that several meshes can be searched with the same event.
 */
 //===========================================================================
 class cGenericCollision
@@ -72,6 +80,9 @@ class cGenericCollision
     //! Provide a visual representation of the method.
     virtual void render() {};
 
+    //! Update the method to the current positions of the vertices, rebuilding if it has degraded too much.
+    virtual bool refit(double a_maxDegradation = 0) { return (false); }
+
     //! Return the triangles intersected by the given segment, if any.
     virtual bool computeCollision(cVector3d& a_segmentPointA,
                                   cVector3d& a_segmentPointB,
@@ -79,6 +90,12 @@ class cGenericCollision
                                   cCollisionSettings& a_settings)
                                   { return (false); }
 
+    //! Find the point of the mesh nearest to the given point, within a maximum distance of it.
+    virtual bool computeClosestPoint(const cVector3d& a_point,
+                                     const double a_maxDistance,
+                                     cProximityEvent& a_event)
+                                     { return (false); }
+
     //! Set level of collision tree to display.
     void setDisplayDepth(int a_depth) { m_displayDepth = a_depth; }
 
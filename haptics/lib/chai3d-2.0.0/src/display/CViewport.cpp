@@ -509,6 +509,7 @@ bool cViewport::select(const unsigned int a_windowPosX,
     {
         collisionSettings.m_checkVisibleObjectsOnly = true;
         collisionSettings.m_checkBothSidesOfTriangles = true;
+        collisionSettings.m_useContactCache = false;
         collisionSettings.m_collisionRadius = 0.0;
     }
     else
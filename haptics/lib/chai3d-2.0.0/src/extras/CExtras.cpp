@@ -39,15 +39,15 @@ void cSleepMs(unsigned int a_interval)
 
 #if defined(_LINUX)
     struct timespec t;
-    t.tv_sec  = a_interval/1000000;
-    t.tv_nsec = a_interval%1000000;
+    t.tv_sec  = a_interval/1000;
+    t.tv_nsec = (a_interval%1000)*1000000;
     nanosleep (&t, NULL);
 #endif
 
 #if defined(_MACOSX)
     struct timespec t;
-    t.tv_sec  = a_interval/1000000;
-    t.tv_nsec = a_interval%1000000;
+    t.tv_sec  = a_interval/1000;
+    t.tv_nsec = (a_interval%1000)*1000000;
     nanosleep (&t, NULL);
 #endif
 }
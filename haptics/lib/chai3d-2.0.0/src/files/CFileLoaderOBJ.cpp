@@ -971,8 +971,8 @@ void cOBJModel::getTokenParameter(char a_str[],
     char* first_non_whitespace_character = a_str;
     while( *first_non_whitespace_character == ' ' ) first_non_whitespace_character++;
 
-    // Remove space before the token
-    strcpy(a_str, first_non_whitespace_character);
+    // Remove space before the token (the strings overlap, so strcpy() can't be used)
+    memmove(a_str, first_non_whitespace_character, strlen(first_non_whitespace_character) + 1);
 
     // Remove newline character after the token
     if (a_str[strlen(a_str) - 1] == '\r' || a_str[strlen(a_str) - 1] == '\n')
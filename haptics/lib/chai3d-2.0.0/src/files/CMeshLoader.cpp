@@ -21,6 +21,8 @@
 //---------------------------------------------------------------------------
 #include "files/CMeshLoader.h"
 //--------------------------------------------------------------------------
+bool g_meshLoaderShouldOptimizeMeshes = true;
+//---------------------------------------------------------------------------
 
 //===========================================================================
 /*!
@@ -58,16 +60,29 @@ bool cLoadMeshFromFile(cMesh* a_mesh, const string& a_fileName)
     // return value
     bool result = false;
 
+    // should vertices be welded after loading?
+    bool weld = true;
+
     // Load an .obj file
     if (strcmp(lower_extension,"obj")==0) 
     {
         result = cLoadFileOBJ(a_mesh, a_fileName);
+        weld = !g_objLoaderShouldGenerateExtraVertices;
     }
 
     // Load a .3ds file
     else if (strcmp(lower_extension,"3ds")==0) 
     {
         result = cLoadFile3DS(a_mesh, a_fileName);
+        weld = !g_3dsLoaderShouldGenerateExtraVertices;
+    }
+
+    // merge the vertices the file repeats, and order the triangles and
+    // vertices for the vertex cache
+    if (result && g_meshLoaderShouldOptimizeMeshes)
+    {
+        if (weld) { a_mesh->weldVertices(true); }
+        a_mesh->optimizeTriangleOrder(true);
     }
 
     // if file has loaded, set the super parent to all child nodes.
@@ -58,6 +58,17 @@
 */
 bool cLoadMeshFromFile(cMesh* a_mesh, const string& a_fileName);
 
+/*!
+    Clients can use this to tell the mesh loader whether to optimize the
+    meshes it loads. \n
+
+    If \b true (default), identical vertices are welded (unless the file
+    loader was asked to generate extra vertices), and triangles and
+    vertices are reordered for the vertex cache (see
+    cMesh::weldVertices() and cMesh::optimizeTriangleOrder()).
+*/
+extern bool g_meshLoaderShouldOptimizeMeshes;
+
 //---------------------------------------------------------------------------
 #endif
 //---------------------------------------------------------------------------
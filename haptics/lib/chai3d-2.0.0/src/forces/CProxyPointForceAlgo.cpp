@@ -73,6 +73,10 @@ cProxyPointForceAlgo::cProxyPointForceAlgo()
     // use force shading
     m_useForceShading = false;
 
+    // by default, every query walks the scene graph, and searches each tree from its root
+    m_useBroadPhase = false;
+    m_useContactCache = false;
+
     // setup collision detector seetings
     m_collisionSettings.m_checkForNearestCollisionOnly  = true;
     m_collisionSettings.m_returnMinimalCollisionData    = false;
@@ -80,6 +84,7 @@ cProxyPointForceAlgo::cProxyPointForceAlgo()
     m_collisionSettings.m_checkHapticObjectsOnly        = true;
     m_collisionSettings.m_checkBothSidesOfTriangles     = true;
     m_collisionSettings.m_adjustObjectMotion            = m_useDynamicProxy;
+    m_collisionSettings.m_useContactCache               = m_useContactCache;
 
     // setup pointers to collision recoders so that user can access
     // collision information about each contact point.
@@ -186,6 +191,13 @@ cVector3d cProxyPointForceAlgo::computeForces(const cVector3d& a_toolPos,
     // check if world has been defined; if so, compute forces
     if (m_world != NULL)
     {
+        // pick up objects that were added, removed or moved since the last call
+        if (m_useBroadPhase)
+        {
+            m_broadPhase.update(m_world);
+        }
+        m_collisionSettings.m_useContactCache = m_useContactCache;
+
         // compute next best position of proxy
         computeNextBestProxyPosition(m_deviceGlobalPos);
 
@@ -262,6 +274,40 @@ void cProxyPointForceAlgo::computeNextBestProxyPosition(const cVector3d& a_goal)
     }
 }
 
+//===========================================================================
+/*!
+    Compute collision detection between a segment and the world with the
+    current collision settings. With \e m_useBroadPhase set, the query goes
+    through the broad phase (updated at the start of computeForces());
+    otherwise it walks the whole scene graph.
+
+    \fn       bool cProxyPointForceAlgo::computeCollision(cVector3d& a_segmentPointA,
+                                                         cVector3d& a_segmentPointB,
+                                                         cCollisionRecorder& a_recorder)
+    \param    a_segmentPointA  Start point of segment.
+    \param    a_segmentPointB  End point of segment.
+    \param    a_recorder  Stores all collision events.
+    \return   Return \b true if the segment intersects a triangle.
+*/
+//===========================================================================
+bool cProxyPointForceAlgo::computeCollision(cVector3d& a_segmentPointA,
+                                            cVector3d& a_segmentPointB,
+                                            cCollisionRecorder& a_recorder)
+{
+    if (m_useBroadPhase)
+    {
+        return (m_broadPhase.computeCollision(a_segmentPointA,
+                                              a_segmentPointB,
+                                              a_recorder,
+                                              m_collisionSettings));
+    }
+
+    return (m_world->computeCollisionDetection(a_segmentPointA,
+                                               a_segmentPointB,
+                                               a_recorder,
+                                               m_collisionSettings));
+}
+
 //---------------------------------------------------------------------------
 
 bool cProxyPointForceAlgo::computeNextProxyPositionWithContraints0(const cVector3d& a_goalGlobalPos)
@@ -344,10 +390,9 @@ bool cProxyPointForceAlgo::computeNextProxyPositionWithContraints0(const cVector
     // and the environment.
     m_collisionSettings.m_adjustObjectMotion = m_useDynamicProxy;
     m_collisionRecorderConstraint0.clear();
-    bool hit = m_world->computeCollisionDetection(m_proxyGlobalPos,
-                                                  targetPos,
-                                                  m_collisionRecorderConstraint0,
-                                                  m_collisionSettings);
+    bool hit = computeCollision(m_proxyGlobalPos,
+                                targetPos,
+                                m_collisionRecorderConstraint0);
 
 
     // check if collision occurred between proxy and goal positions.
@@ -506,10 +551,9 @@ bool cProxyPointForceAlgo::computeNextProxyPositionWithContraints1(const cVector
     // search for collision
     m_collisionSettings.m_adjustObjectMotion = false;
     m_collisionRecorderConstraint1.clear();
-    bool hit = m_world->computeCollisionDetection( m_proxyGlobalPos,
-                                                   targetPos,
-                                                   m_collisionRecorderConstraint1,
-                                                   m_collisionSettings);
+    bool hit = computeCollision(m_proxyGlobalPos,
+                                targetPos,
+                                m_collisionRecorderConstraint1);
 
     // check if collision occurred between proxy and goal positions.
     double collisionDistance;
@@ -672,10 +716,9 @@ bool cProxyPointForceAlgo::computeNextProxyPositionWithContraints2(const cVector
     // search for collision
     m_collisionSettings.m_adjustObjectMotion = false;
     m_collisionRecorderConstraint2.clear();
-    bool hit = m_world->computeCollisionDetection( m_proxyGlobalPos,
-                                                   targetPos,
-                                                   m_collisionRecorderConstraint2,
-                                                   m_collisionSettings);
+    bool hit = computeCollision(m_proxyGlobalPos,
+                                targetPos,
+                                m_collisionRecorderConstraint2);
 
     // check if collision occurred between proxy and goal positions.
     double collisionDistance;
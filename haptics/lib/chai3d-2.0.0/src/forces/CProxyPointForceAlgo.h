@@ -25,6 +25,7 @@
 #include "math/CVector3d.h"
 #include "math/CMatrix3d.h"
 #include "collisions/CGenericCollision.h"
+#include "collisions/CCollisionBroadPhase.h"
 #include "forces/CGenericPointForceAlgo.h"
 #include <map>
 //---------------------------------------------------------------------------
@@ -137,6 +138,28 @@ class cProxyPointForceAlgo : public cGenericPointForceAlgo
     //! Use force shading.
     bool m_useForceShading;
 
+    /*!
+        Use a world-level broad phase for the proxy's collision queries.
+        The objects' world boxes are cached once per call to computeForces(),
+        and each query only tests the objects whose box the proxy path
+        passes through, instead of the whole scene graph. This pays off in
+        scenes with many objects, but relies on their boundary boxes and
+        global positions being up to date (see cCollisionBroadPhase).
+    */
+    bool m_useBroadPhase;
+
+    //! Return the broad phase used when \e m_useBroadPhase is set.
+    cCollisionBroadPhase* getBroadPhase() { return (&m_broadPhase); }
+
+    /*!
+        Test the triangles around the proxy's last contact before searching
+        a mesh's collision tree. While the proxy slides over a surface, most
+        queries are then answered without searching the tree at all. The
+        answers are the same either way; only meshes with a cCollisionAABB
+        or cCollisionBVH detector keep a cCollisionContactCache.
+    */
+    bool m_useContactCache;
+
     /*!
         Dynamic friction hysteresis multiplier
         In CHAI's proxy, the angle computed from the coefficient is multiplied
@@ -176,6 +199,11 @@ class cProxyPointForceAlgo : public cGenericPointForceAlgo
     //! Compute force to apply to device.
     virtual void updateForce();
 
+    //! Compute collision detection between a segment and the world, through the broad phase if enabled.
+    bool computeCollision(cVector3d& a_segmentPointA,
+                          cVector3d& a_segmentPointB,
+                          cCollisionRecorder& a_recorder);
+
 
     //----------------------------------------------------------------------
     // MEMBERS - PROXY, DEVICE AND FORCE INFORMATION:
@@ -222,6 +250,9 @@ class cProxyPointForceAlgo : public cGenericPointForceAlgo
     //! Collision detection recorder for searching third constraint.
     cCollisionRecorder m_collisionRecorderConstraint2;
 
+    //! Cached world boxes of the objects, used when \e m_useBroadPhase is set.
+    cCollisionBroadPhase m_broadPhase;
+
     /*!
         To address numerical errors during geometric computation,
         several epsilon values are computed and used.
@@ -0,0 +1,138 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#include "graphics/CFrustum.h"
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    Extract the planes of the frustum from the current OpenGL projection
+    and modelview matrices.
+
+    \fn     void cFrustum::setFromGL()
+*/
+//===========================================================================
+void cFrustum::setFromGL()
+{
+    double projection[16];
+    double modelview[16];
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    set(projection, modelview);
+}
+
+
+//===========================================================================
+/*!
+    Extract the planes of the frustum from a projection and a modelview
+    matrix. Each plane is the sum or the difference of the last row of
+    their product and one of its other rows (Gribb and Hartmann).
+
+    \fn     void cFrustum::set(const double* a_projection,
+                               const double* a_modelview)
+    \param  a_projection  Projection matrix, column major.
+    \param  a_modelview  Modelview matrix, column major.
+*/
+//===========================================================================
+void cFrustum::set(const double* a_projection, const double* a_modelview)
+{
+    // rows of the product of the projection and modelview matrices
+    double rows[4][4];
+    int i, j, k;
+    for (i=0; i<4; i++)
+    {
+        for (j=0; j<4; j++)
+        {
+            double sum = 0.0;
+            for (k=0; k<4; k++)
+            {
+                sum += a_projection[4*k + i] * a_modelview[4*j + k];
+            }
+            rows[i][j] = sum;
+        }
+    }
+
+    for (j=0; j<4; j++)
+    {
+        m_planes[CHAI_FRUSTUM_LEFT][j]   = rows[3][j] + rows[0][j];
+        m_planes[CHAI_FRUSTUM_RIGHT][j]  = rows[3][j] - rows[0][j];
+        m_planes[CHAI_FRUSTUM_BOTTOM][j] = rows[3][j] + rows[1][j];
+        m_planes[CHAI_FRUSTUM_TOP][j]    = rows[3][j] - rows[1][j];
+        m_planes[CHAI_FRUSTUM_NEAR][j]   = rows[3][j] + rows[2][j];
+        m_planes[CHAI_FRUSTUM_FAR][j]    = rows[3][j] - rows[2][j];
+    }
+}
+
+
+//===========================================================================
+/*!
+    Check whether a box lies entirely outside the frustum: that is, whether
+    the corner of the box furthest along the inward normal of some plane is
+    still behind it. A few boxes near the edges of the frustum are reported
+    as inside although they are not.
+
+    \fn     bool cFrustum::isBoxOutside(const cVector3d& a_boxMin,
+                                        const cVector3d& a_boxMax) const
+    \param  a_boxMin  Lower corner of the box.
+    \param  a_boxMax  Upper corner of the box.
+    \return Return \b true if no part of the box can be seen.
+*/
+//===========================================================================
+bool cFrustum::isBoxOutside(const cVector3d& a_boxMin, const cVector3d& a_boxMax) const
+{
+    for (int i=0; i<CHAI_FRUSTUM_NUM_PLANES; i++)
+    {
+        const double* plane = m_planes[i];
+        double x = (plane[0] > 0) ? a_boxMax.x : a_boxMin.x;
+        double y = (plane[1] > 0) ? a_boxMax.y : a_boxMin.y;
+        double z = (plane[2] > 0) ? a_boxMax.z : a_boxMin.z;
+        if (plane[0]*x + plane[1]*y + plane[2]*z + plane[3] < 0)
+        {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+
+//===========================================================================
+/*!
+    Check whether part of a box lies behind one of the planes: that is,
+    whether the corner of the box furthest against its inward normal is
+    behind it.
+
+    \fn     bool cFrustum::isBoxCrossing(const cVector3d& a_boxMin,
+                                         const cVector3d& a_boxMax,
+                                         const int a_plane) const
+    \param  a_boxMin  Lower corner of the box.
+    \param  a_boxMax  Upper corner of the box.
+    \param  a_plane  Index of the plane (CHAI_FRUSTUM_LEFT ... CHAI_FRUSTUM_FAR).
+    \return Return \b true if some of the box is behind the plane.
+*/
+//===========================================================================
+bool cFrustum::isBoxCrossing(const cVector3d& a_boxMin, const cVector3d& a_boxMax,
+                             const int a_plane) const
+{
+    const double* plane = m_planes[a_plane];
+    double x = (plane[0] > 0) ? a_boxMin.x : a_boxMax.x;
+    double y = (plane[1] > 0) ? a_boxMin.y : a_boxMax.y;
+    double z = (plane[2] > 0) ? a_boxMin.z : a_boxMax.z;
+    return (plane[0]*x + plane[1]*y + plane[2]*z + plane[3] < 0);
+}
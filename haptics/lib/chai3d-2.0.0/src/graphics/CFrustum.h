@@ -0,0 +1,109 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#ifndef CFrustumH
+#define CFrustumH
+//---------------------------------------------------------------------------
+#include "math/CVector3d.h"
+#include "extras/CGlobals.h"
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \file       CFrustum.h
+
+    \brief
+    <b> Graphics </b> \n
+    View Frustum.
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+//! Indices of the planes of a cFrustum.
+const int CHAI_FRUSTUM_LEFT         = 0;
+const int CHAI_FRUSTUM_RIGHT        = 1;
+const int CHAI_FRUSTUM_BOTTOM       = 2;
+const int CHAI_FRUSTUM_TOP          = 3;
+const int CHAI_FRUSTUM_NEAR         = 4;
+const int CHAI_FRUSTUM_FAR          = 5;
+const int CHAI_FRUSTUM_NUM_PLANES   = 6;
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \class      cFrustum
+    \ingroup    graphics
+
+    \brief
+    cFrustum holds the six planes of the volume that the current OpenGL
+    projection and modelview matrices map inside the viewport, expressed in
+    the coordinates of the current modelview frame. While the scene graph
+    is rendered, these are the local coordinates of the object being
+    rendered, so its boundary box can be tested as it is.
+*/
+//===========================================================================
+class cFrustum
+{
+  public:
+
+    //-----------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //-----------------------------------------------------------------------
+
+    //! Constructor of cFrustum.
+    cFrustum() {};
+
+    //! Destructor of cFrustum.
+    virtual ~cFrustum() {};
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Extract the planes from the current OpenGL projection and modelview matrices.
+    void setFromGL();
+
+    //! Extract the planes from a projection and a modelview matrix (column major, as in OpenGL).
+    void set(const double* a_projection, const double* a_modelview);
+
+    //! Return \b true if the box lies entirely outside the frustum.
+    bool isBoxOutside(const cVector3d& a_boxMin, const cVector3d& a_boxMax) const;
+
+    //! Return \b true if part of the box lies behind the given plane.
+    bool isBoxCrossing(const cVector3d& a_boxMin, const cVector3d& a_boxMax,
+                       const int a_plane) const;
+
+
+    //-----------------------------------------------------------------------
+    // MEMBERS:
+    //-----------------------------------------------------------------------
+
+    /*!
+        The planes (a, b, c, d), facing inwards: a point (x, y, z) is on the
+        inner side of a plane if ax + by + cz + d >= 0. They are not
+        normalized.
+    */
+    double m_planes[CHAI_FRUSTUM_NUM_PLANES][4];
+};
+
+//---------------------------------------------------------------------------
+#endif
+//---------------------------------------------------------------------------
@@ -22,6 +22,10 @@
 //---------------------------------------------------------------------------
 #include "graphics/CMacrosGL.h"
 //---------------------------------------------------------------------------
+#if defined(_LINUX)
+#include <GL/glx.h>
+#endif
+//---------------------------------------------------------------------------
 
 //===========================================================================
 /*!
@@ -73,3 +77,26 @@ void cLookAt(const cVector3d& a_eye, const cVector3d& a_at, const cVector3d& a_u
     // Push it onto the matrix stack
     glMultMatrixd(dm);
 }
+
+
+//===========================================================================
+/*!
+    Look up an OpenGL entry point in the current context. Libraries that
+    only export OpenGL 1.1 (such as opengl32.dll) reach newer functions and
+    extensions this way.
+
+    \fn     void* cGetGLProcAddress(const char* a_name)
+    \param  a_name  Name of the function.
+    \return Return the address of the function, or NULL if it is missing.
+*/
+//===========================================================================
+void* cGetGLProcAddress(const char* a_name)
+{
+#if defined(_WIN32)
+    return ((void*)wglGetProcAddress(a_name));
+#elif defined(_LINUX)
+    return ((void*)glXGetProcAddressARB((const GLubyte*)a_name));
+#else
+    return (NULL);
+#endif
+}
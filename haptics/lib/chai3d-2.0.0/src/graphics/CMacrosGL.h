@@ -44,6 +44,9 @@
 //! Align the current -z axis with a reference frame;  la gluLookAt.
 void cLookAt(const cVector3d& a_eye, const cVector3d& a_at, const cVector3d& a_up);
 
+//! Look up an OpenGL entry point (of an extension, or of OpenGL above 1.1) in the current context.
+void* cGetGLProcAddress(const char* a_name);
+
 
 //===========================================================================
 /*!
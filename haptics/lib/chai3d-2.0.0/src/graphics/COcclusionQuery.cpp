@@ -0,0 +1,249 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#include "graphics/COcclusionQuery.h"
+#include "graphics/CMacrosGL.h"
+//---------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+//---------------------------------------------------------------------------
+#ifndef GL_SAMPLES_PASSED
+#define GL_SAMPLES_PASSED           0x8914
+#define GL_QUERY_RESULT             0x8866
+#define GL_QUERY_RESULT_AVAILABLE   0x8867
+#endif
+//---------------------------------------------------------------------------
+// Occlusion query entry points; OpenGL 1.1 libraries do not export them
+typedef void (APIENTRY *cGLGenQueries)(GLsizei a_n, GLuint* a_ids);
+typedef void (APIENTRY *cGLDeleteQueries)(GLsizei a_n, const GLuint* a_ids);
+typedef void (APIENTRY *cGLBeginQuery)(GLenum a_target, GLuint a_id);
+typedef void (APIENTRY *cGLEndQuery)(GLenum a_target);
+typedef void (APIENTRY *cGLGetQueryObjectuiv)(GLuint a_id, GLenum a_name, GLuint* a_params);
+
+static cGLGenQueries        cglGenQueries        = NULL;
+static cGLDeleteQueries     cglDeleteQueries     = NULL;
+static cGLBeginQuery        cglBeginQuery        = NULL;
+static cGLEndQuery          cglEndQuery          = NULL;
+static cGLGetQueryObjectuiv cglGetQueryObjectuiv = NULL;
+
+//! 1 if occlusion queries are supported, 0 if not, -1 if not checked yet.
+static int g_occlusionQuerySupport = -1;
+//---------------------------------------------------------------------------
+
+
+//===========================================================================
+/*!
+    Constructor of cOcclusionQuery.
+
+    \fn     cOcclusionQuery::cOcclusionQuery()
+*/
+//===========================================================================
+cOcclusionQuery::cOcclusionQuery()
+{
+    m_query = 0;
+    m_pending = false;
+}
+
+
+//===========================================================================
+/*!
+    Destructor of cOcclusionQuery.
+
+    \fn     cOcclusionQuery::~cOcclusionQuery()
+*/
+//===========================================================================
+cOcclusionQuery::~cOcclusionQuery()
+{
+    deleteQuery();
+}
+
+
+//===========================================================================
+/*!
+    Check whether the current OpenGL context supports occlusion queries,
+    either as part of OpenGL 1.5 or through GL_ARB_occlusion_query, and look
+    up their entry points. The check is done once, on the first call, which
+    must be made with a context current.
+
+    \fn     bool cOcclusionQuery::isSupported()
+    \return Return \b true if occlusion queries can be used.
+*/
+//===========================================================================
+bool cOcclusionQuery::isSupported()
+{
+    if (g_occlusionQuerySupport != -1) return (g_occlusionQuerySupport == 1);
+
+    const char* version = (const char*)glGetString(GL_VERSION);
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (version == NULL) return (false);
+
+    // the core functions have no suffix, those of the extension end in ARB
+    const char* suffix = NULL;
+    int major = atoi(version);
+    const char* dot = strchr(version, '.');
+    int minor = (dot != NULL) ? atoi(dot + 1) : 0;
+    if ((major > 1) || ((major == 1) && (minor >= 5)))
+    {
+        suffix = "";
+    }
+    else if ((extensions != NULL) && (strstr(extensions, "GL_ARB_occlusion_query") != NULL))
+    {
+        suffix = "ARB";
+    }
+
+    if (suffix != NULL)
+    {
+        char name[64];
+        sprintf(name, "glGenQueries%s", suffix);
+        cglGenQueries = (cGLGenQueries)cGetGLProcAddress(name);
+        sprintf(name, "glDeleteQueries%s", suffix);
+        cglDeleteQueries = (cGLDeleteQueries)cGetGLProcAddress(name);
+        sprintf(name, "glBeginQuery%s", suffix);
+        cglBeginQuery = (cGLBeginQuery)cGetGLProcAddress(name);
+        sprintf(name, "glEndQuery%s", suffix);
+        cglEndQuery = (cGLEndQuery)cGetGLProcAddress(name);
+        sprintf(name, "glGetQueryObjectuiv%s", suffix);
+        cglGetQueryObjectuiv = (cGLGetQueryObjectuiv)cGetGLProcAddress(name);
+    }
+
+    g_occlusionQuerySupport = ((cglGenQueries != NULL) && (cglDeleteQueries != NULL) &&
+                               (cglBeginQuery != NULL) && (cglEndQuery != NULL) &&
+                               (cglGetQueryObjectuiv != NULL)) ? 1 : 0;
+
+    return (g_occlusionQuerySupport == 1);
+}
+
+
+//===========================================================================
+/*!
+    Start counting the samples that pass the depth test. Only one query can
+    count at a time.
+
+    \fn     void cOcclusionQuery::begin()
+*/
+//===========================================================================
+void cOcclusionQuery::begin()
+{
+    if (m_query == 0)
+    {
+        cglGenQueries(1, &m_query);
+    }
+    cglBeginQuery(GL_SAMPLES_PASSED, m_query);
+}
+
+
+//===========================================================================
+/*!
+    Stop counting samples. The count can be read with getResult() once the
+    graphics card has rendered everything up to here.
+
+    \fn     void cOcclusionQuery::end()
+*/
+//===========================================================================
+void cOcclusionQuery::end()
+{
+    cglEndQuery(GL_SAMPLES_PASSED);
+    m_pending = true;
+}
+
+
+//===========================================================================
+/*!
+    Count the samples of a solid box that pass the depth test. Nothing is
+    written to the color or depth buffers.
+
+    \fn     void cOcclusionQuery::renderBox(const cVector3d& a_boxMin,
+                                            const cVector3d& a_boxMax)
+    \param  a_boxMin  Lower corner of the box.
+    \param  a_boxMax  Upper corner of the box.
+*/
+//===========================================================================
+void cOcclusionQuery::renderBox(const cVector3d& a_boxMin, const cVector3d& a_boxMax)
+{
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+
+    const double x0 = a_boxMin.x, y0 = a_boxMin.y, z0 = a_boxMin.z;
+    const double x1 = a_boxMax.x, y1 = a_boxMax.y, z1 = a_boxMax.z;
+
+    begin();
+    glBegin(GL_QUADS);
+        glVertex3d(x0, y0, z0); glVertex3d(x0, y1, z0); glVertex3d(x1, y1, z0); glVertex3d(x1, y0, z0);
+        glVertex3d(x0, y0, z1); glVertex3d(x1, y0, z1); glVertex3d(x1, y1, z1); glVertex3d(x0, y1, z1);
+        glVertex3d(x0, y0, z0); glVertex3d(x1, y0, z0); glVertex3d(x1, y0, z1); glVertex3d(x0, y0, z1);
+        glVertex3d(x0, y1, z0); glVertex3d(x0, y1, z1); glVertex3d(x1, y1, z1); glVertex3d(x1, y1, z0);
+        glVertex3d(x0, y0, z0); glVertex3d(x0, y0, z1); glVertex3d(x0, y1, z1); glVertex3d(x0, y1, z0);
+        glVertex3d(x1, y0, z0); glVertex3d(x1, y1, z0); glVertex3d(x1, y1, z1); glVertex3d(x1, y0, z1);
+    glEnd();
+    end();
+
+    glPopAttrib();
+}
+
+
+//===========================================================================
+/*!
+    Read the number of samples counted since the last begin(), if the
+    graphics card has finished counting them. This does not wait.
+
+    \fn     bool cOcclusionQuery::getResult(unsigned int& a_numSamples)
+    \param  a_numSamples  Receives the number of samples that passed the depth test.
+    \return Return \b true if the count was available (it is then read only once).
+*/
+//===========================================================================
+bool cOcclusionQuery::getResult(unsigned int& a_numSamples)
+{
+    if (!m_pending) return (false);
+
+    GLuint available = 0;
+    cglGetQueryObjectuiv(m_query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return (false);
+
+    GLuint samples = 0;
+    cglGetQueryObjectuiv(m_query, GL_QUERY_RESULT, &samples);
+    a_numSamples = samples;
+    m_pending = false;
+    return (true);
+}
+
+
+//===========================================================================
+/*!
+    Delete the OpenGL query, for instance when the OpenGL context is about
+    to be destroyed. Any count not read yet is lost.
+
+    \fn     void cOcclusionQuery::deleteQuery()
+*/
+//===========================================================================
+void cOcclusionQuery::deleteQuery()
+{
+    if (m_query != 0)
+    {
+        cglDeleteQueries(1, &m_query);
+        m_query = 0;
+    }
+    m_pending = false;
+}
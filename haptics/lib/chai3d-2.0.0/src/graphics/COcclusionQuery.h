@@ -0,0 +1,108 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#ifndef COcclusionQueryH
+#define COcclusionQueryH
+//---------------------------------------------------------------------------
+#include "math/CVector3d.h"
+#include "extras/CGlobals.h"
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \file       COcclusionQuery.h
+
+    \brief
+    <b> Graphics </b> \n
+    OpenGL Occlusion Query.
+*/
+//===========================================================================
+
+//===========================================================================
+/*!
+    \class      cOcclusionQuery
+    \ingroup    graphics
+
+    \brief
+    cOcclusionQuery counts the samples of what is rendered between begin()
+    and end() that pass the depth test, with an OpenGL occlusion query
+    (OpenGL 1.5 or GL_ARB_occlusion_query). \n
+
+    The count arrives some time after end(); getResult() does not wait for
+    it, so the answer is normally used one frame later.
+*/
+//===========================================================================
+class cOcclusionQuery
+{
+  public:
+
+    //-----------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //-----------------------------------------------------------------------
+
+    //! Constructor of cOcclusionQuery.
+    cOcclusionQuery();
+
+    //! Destructor of cOcclusionQuery.
+    virtual ~cOcclusionQuery();
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Return \b true if the current OpenGL context supports occlusion queries.
+    static bool isSupported();
+
+    //! Start counting samples.
+    void begin();
+
+    //! Stop counting samples.
+    void end();
+
+    //! Count the samples of a box that pass the depth test, without drawing it.
+    void renderBox(const cVector3d& a_boxMin, const cVector3d& a_boxMax);
+
+    //! Return \b true if a count was started and has not been read yet.
+    bool isPending() const { return (m_pending); }
+
+    //! Read the count if it has arrived, without waiting for it.
+    bool getResult(unsigned int& a_numSamples);
+
+    //! Delete the OpenGL query; it is created again by the next begin().
+    void deleteQuery();
+
+
+  protected:
+
+    //-----------------------------------------------------------------------
+    // MEMBERS:
+    //-----------------------------------------------------------------------
+
+    //! OpenGL query object (0 if not created).
+    GLuint m_query;
+
+    //! If \b true, a count was started and has not been read yet.
+    bool m_pending;
+};
+
+//---------------------------------------------------------------------------
+#endif
+//---------------------------------------------------------------------------
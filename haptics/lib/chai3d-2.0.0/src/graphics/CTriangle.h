@@ -650,6 +650,53 @@ class cTriangle
     }
 
 
+    //-----------------------------------------------------------------------
+    /*!
+        Find the point of this triangle nearest to a given point. If it lies
+        within the maximum distance, and nearer than the point stored in
+        \e a_event, it is stored there instead.
+
+        \param   a_point  Point to search from (in local frame).
+        \param   a_maxSquareDistance  Square of the maximum distance.
+        \param   a_event  Nearest point found so far.
+        \return  Returns \b true if \e a_event was updated, otherwise \b false.
+    */
+    //-----------------------------------------------------------------------
+    inline bool computeClosestPoint(const cVector3d& a_point,
+                                    const double a_maxSquareDistance,
+                                    cProximityEvent& a_event) const
+    {
+        // Get the position of the triangle's vertices
+        vector<cVertex>* vertex_vector = m_parent->pVertices();
+        cVertex* vertex_array = (cVertex*) &((*vertex_vector)[0]);
+        const cVector3d& vertex0 = vertex_array[m_indexVertex0].m_localPos;
+        const cVector3d& vertex1 = vertex_array[m_indexVertex1].m_localPos;
+        const cVector3d& vertex2 = vertex_array[m_indexVertex2].m_localPos;
+
+        double u, v;
+        cVector3d point = cProjectPointOnTriangle(a_point, vertex0, vertex1, vertex2, u, v);
+        double squareDistance = cDistanceSq(a_point, point);
+        if ((squareDistance > a_maxSquareDistance) || (squareDistance >= a_event.m_squareDistance))
+        {
+            return (false);
+        }
+
+        a_event.m_triangle = (cTriangle*)this;
+        a_event.m_localPos = point;
+        a_event.m_barycentric.set(1.0 - u - v, u, v);
+        a_event.m_squareDistance = squareDistance;
+        a_event.m_distance = sqrt(squareDistance);
+
+        // the normal of a degenerate triangle is left zero
+        cVector3d normal = cCross(cSub(vertex1, vertex0), cSub(vertex2, vertex0));
+        double length = normal.length();
+        if (length > 0.0) { normal.div(length); }
+        a_event.m_localNormal = normal;
+
+        return (true);
+    }
+
+
     //-----------------------------------------------------------------------
     /*!
         Compute and return the area of this triangle.
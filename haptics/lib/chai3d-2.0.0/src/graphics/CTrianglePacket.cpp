@@ -0,0 +1,292 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#include "graphics/CTrianglePacket.h"
+//---------------------------------------------------------------------------
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define CHAI_USE_SSE
+#include <xmmintrin.h>
+#endif
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    Return the largest absolute value of the coordinates of a point.
+
+    \fn     static inline double cLargestCoordinate(const cVector3d& a_point)
+    \param  a_point  Point to measure.
+    \return Return the largest of |x|, |y| and |z|.
+*/
+//===========================================================================
+static inline double cLargestCoordinate(const cVector3d& a_point)
+{
+    return (cMax(cAbs(a_point.x), cMax(cAbs(a_point.y), cAbs(a_point.z))));
+}
+
+
+//===========================================================================
+/*!
+    Set the segment and the collision radius it is tested with. The margin
+    grows with the size of the coordinates, to cover their rounding to
+    single precision.
+
+    \fn     void cTrianglePacketSegment::set(const cVector3d& a_segmentPointA,
+                                             const cVector3d& a_segmentPointB,
+                                             const double a_collisionRadius)
+    \param  a_segmentPointA  Initial point of segment.
+    \param  a_segmentPointB  End point of segment.
+    \param  a_collisionRadius  Collision radius of the query.
+*/
+//===========================================================================
+void cTrianglePacketSegment::set(const cVector3d& a_segmentPointA,
+                                 const cVector3d& a_segmentPointB,
+                                 const double a_collisionRadius)
+{
+    for (int axis=0; axis<3; axis++)
+    {
+        m_pointA[axis] = (float)a_segmentPointA[axis];
+        m_pointB[axis] = (float)a_segmentPointB[axis];
+    }
+
+    double size = cMax(cLargestCoordinate(a_segmentPointA), cLargestCoordinate(a_segmentPointB));
+    m_margin = (float)((1.0 + CHAI_TRIANGLE_PACKET_TOLERANCE) * a_collisionRadius +
+                       CHAI_TRIANGLE_PACKET_TOLERANCE * size);
+}
+
+
+//===========================================================================
+/*!
+    Store the given triangles of a mesh in the packet, and compute their
+    planes.
+
+    \fn     void cTrianglePacket::set(const vector<cTriangle>* a_triangles,
+                                      const unsigned int* a_indices,
+                                      const unsigned int a_numTriangles)
+    \param  a_triangles  Triangles of the mesh.
+    \param  a_indices  Indices in \e a_triangles of the triangles to store.
+    \param  a_numTriangles  Number of triangles to store, at most
+                            CHAI_TRIANGLE_PACKET_SIZE.
+*/
+//===========================================================================
+void cTrianglePacket::set(const vector<cTriangle>* a_triangles,
+                          const unsigned int* a_indices,
+                          const unsigned int a_numTriangles)
+{
+    m_numTriangles = cMin(a_numTriangles, (unsigned int)CHAI_TRIANGLE_PACKET_SIZE);
+    for (unsigned int i=0; i<m_numTriangles; i++)
+    {
+        m_indices[i] = a_indices[i];
+    }
+
+    update(a_triangles);
+}
+
+
+//===========================================================================
+/*!
+    Recompute the planes of the triangles from the current positions of
+    their vertices.
+
+    \fn     void cTrianglePacket::update(const vector<cTriangle>* a_triangles)
+    \param  a_triangles  Triangles of the mesh the packet was set from.
+*/
+//===========================================================================
+void cTrianglePacket::update(const vector<cTriangle>* a_triangles)
+{
+    for (unsigned int i=0; i<CHAI_TRIANGLE_PACKET_SIZE; i++)
+    {
+        for (int row=0; row<16; row++)
+        {
+            m_planes[row][i] = 0.0f;
+        }
+        m_tolerances[i] = 0.0f;
+
+        if (i >= m_numTriangles) { continue; }
+
+        const cTriangle& triangle = (*a_triangles)[m_indices[i]];
+        cVector3d vertex[3];
+        vertex[0] = triangle.getVertex0()->getPos();
+        vertex[1] = triangle.getVertex1()->getPos();
+        vertex[2] = triangle.getVertex2()->getPos();
+
+        // degenerate triangles are never rejected; their planes would be inaccurate
+        cVector3d edge0 = cSub(vertex[1], vertex[0]);
+        cVector3d edge1 = cSub(vertex[2], vertex[0]);
+        cVector3d normal = cCross(edge0, edge1);
+        double length = normal.length();
+        if ((length == 0.0) || (length < 1e-6 * edge0.length() * edge1.length())) { continue; }
+        normal.div(length);
+
+        cVector3d planeNormal[4];
+        planeNormal[0] = normal;
+        for (int edge=0; edge<3; edge++)
+        {
+            const cVector3d& start = vertex[edge];
+            const cVector3d& end = vertex[(edge + 1) % 3];
+            const cVector3d& opposite = vertex[(edge + 2) % 3];
+
+            // the normal of the edge plane points away from the opposite vertex
+            cVector3d edgeNormal = cCross(normal, cSub(end, start));
+            edgeNormal.normalize();
+            if (cDot(edgeNormal, cSub(opposite, start)) > 0.0) { edgeNormal.negate(); }
+            planeNormal[edge + 1] = edgeNormal;
+        }
+
+        for (int plane=0; plane<4; plane++)
+        {
+            const cVector3d& start = vertex[(plane == 0) ? 0 : plane - 1];
+            m_planes[4 * plane + 0][i] = (float)planeNormal[plane].x;
+            m_planes[4 * plane + 1][i] = (float)planeNormal[plane].y;
+            m_planes[4 * plane + 2][i] = (float)planeNormal[plane].z;
+            m_planes[4 * plane + 3][i] = (float)cDot(planeNormal[plane], start);
+        }
+
+        double size = cMax(cLargestCoordinate(vertex[0]),
+                           cMax(cLargestCoordinate(vertex[1]), cLargestCoordinate(vertex[2])));
+        m_tolerances[i] = (float)(CHAI_TRIANGLE_PACKET_TOLERANCE * size);
+    }
+}
+
+
+//===========================================================================
+/*!
+    Find the triangles of the packet that the segment may collide with. A
+    triangle is rejected when both ends of the segment lie farther than the
+    collision radius (plus the rounding margin) beyond its plane, on the
+    same side, or beyond one of its edge planes.
+
+    \fn     unsigned int cTrianglePacket::computeCandidates(const cTrianglePacketSegment& a_segment) const
+    \param  a_segment  Segment to test.
+    \return Return a mask with bit \e i set if triangle \e i may collide.
+*/
+//===========================================================================
+unsigned int cTrianglePacket::computeCandidates(const cTrianglePacketSegment& a_segment) const
+{
+    unsigned int rejected = 0;
+
+#ifdef CHAI_USE_SSE
+    __m128 ax = _mm_set1_ps(a_segment.m_pointA[0]);
+    __m128 ay = _mm_set1_ps(a_segment.m_pointA[1]);
+    __m128 az = _mm_set1_ps(a_segment.m_pointA[2]);
+    __m128 bx = _mm_set1_ps(a_segment.m_pointB[0]);
+    __m128 by = _mm_set1_ps(a_segment.m_pointB[1]);
+    __m128 bz = _mm_set1_ps(a_segment.m_pointB[2]);
+    __m128 margin = _mm_add_ps(_mm_set1_ps(a_segment.m_margin), _mm_loadu_ps(m_tolerances));
+    __m128 rejectedLanes = _mm_setzero_ps();
+
+    for (int plane=0; plane<4; plane++)
+    {
+        __m128 nx = _mm_loadu_ps(m_planes[4 * plane + 0]);
+        __m128 ny = _mm_loadu_ps(m_planes[4 * plane + 1]);
+        __m128 nz = _mm_loadu_ps(m_planes[4 * plane + 2]);
+        __m128 offset = _mm_loadu_ps(m_planes[4 * plane + 3]);
+
+        __m128 distanceA = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ax), _mm_mul_ps(ny, ay)),
+                                                 _mm_mul_ps(nz, az)), offset);
+        __m128 distanceB = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, bx), _mm_mul_ps(ny, by)),
+                                                 _mm_mul_ps(nz, bz)), offset);
+
+        rejectedLanes = _mm_or_ps(rejectedLanes, _mm_and_ps(_mm_cmpgt_ps(distanceA, margin),
+                                                            _mm_cmpgt_ps(distanceB, margin)));
+
+        // both sides of the triangle's own plane can be hit
+        if (plane == 0)
+        {
+            __m128 negativeMargin = _mm_sub_ps(_mm_setzero_ps(), margin);
+            rejectedLanes = _mm_or_ps(rejectedLanes, _mm_and_ps(_mm_cmplt_ps(distanceA, negativeMargin),
+                                                                _mm_cmplt_ps(distanceB, negativeMargin)));
+        }
+    }
+
+    rejected = (unsigned int)_mm_movemask_ps(rejectedLanes);
+#else
+    for (unsigned int i=0; i<m_numTriangles; i++)
+    {
+        float margin = a_segment.m_margin + m_tolerances[i];
+        for (int plane=0; plane<4; plane++)
+        {
+            float distanceA = m_planes[4 * plane + 0][i] * a_segment.m_pointA[0] +
+                              m_planes[4 * plane + 1][i] * a_segment.m_pointA[1] +
+                              m_planes[4 * plane + 2][i] * a_segment.m_pointA[2] -
+                              m_planes[4 * plane + 3][i];
+            float distanceB = m_planes[4 * plane + 0][i] * a_segment.m_pointB[0] +
+                              m_planes[4 * plane + 1][i] * a_segment.m_pointB[1] +
+                              m_planes[4 * plane + 2][i] * a_segment.m_pointB[2] -
+                              m_planes[4 * plane + 3][i];
+
+            if (((distanceA > margin) && (distanceB > margin)) ||
+                ((plane == 0) && (distanceA < -margin) && (distanceB < -margin)))
+            {
+                rejected |= (1 << i);
+                break;
+            }
+        }
+    }
+#endif
+
+    return (~rejected & ((1 << m_numTriangles) - 1));
+}
+
+
+//===========================================================================
+/*!
+    Test the segment against the triangles of the packet. The triangles that
+    computeCandidates() keeps are tested with cTriangle::computeCollision(),
+    in order, so the collisions recorded are the same as those of calling it
+    for every triangle of the packet.
+
+    \fn     bool cTrianglePacket::computeCollision(vector<cTriangle>* a_triangles,
+                                                   cVector3d& a_segmentPointA,
+                                                   cVector3d& a_segmentPointB,
+                                                   const cTrianglePacketSegment& a_segment,
+                                                   cCollisionRecorder& a_recorder,
+                                                   cCollisionSettings& a_settings) const
+    \param  a_triangles  Triangles of the mesh the packet was set from.
+    \param  a_segmentPointA  Initial point of segment.
+    \param  a_segmentPointB  End point of segment.
+    \param  a_segment  The same segment, set with the collision radius of
+                       \e a_settings.
+    \param  a_recorder  Stores all collision events.
+    \param  a_settings  Contains collision settings information.
+    \return Return \b true if a collision event has occurred.
+*/
+//===========================================================================
+bool cTrianglePacket::computeCollision(vector<cTriangle>* a_triangles,
+                                       cVector3d& a_segmentPointA,
+                                       cVector3d& a_segmentPointB,
+                                       const cTrianglePacketSegment& a_segment,
+                                       cCollisionRecorder& a_recorder,
+                                       cCollisionSettings& a_settings) const
+{
+    bool hit = false;
+    unsigned int candidates = computeCandidates(a_segment);
+
+    for (unsigned int i=0; candidates != 0; i++, candidates >>= 1)
+    {
+        if ((candidates & 1) &&
+            (*a_triangles)[m_indices[i]].computeCollision(a_segmentPointA, a_segmentPointB,
+                                                          a_recorder, a_settings))
+        {
+            hit = true;
+        }
+    }
+
+    return (hit);
+}
@@ -0,0 +1,170 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#ifndef CTrianglePacketH
+#define CTrianglePacketH
+//---------------------------------------------------------------------------
+#include "math/CMaths.h"
+#include "graphics/CTriangle.h"
+#include "collisions/CCollisionBasics.h"
+#include <vector>
+//---------------------------------------------------------------------------
+using std::vector;
+//---------------------------------------------------------------------------
+//! Number of triangles tested together by a cTrianglePacket.
+#define CHAI_TRIANGLE_PACKET_SIZE       4
+
+//! Margin added to the single precision tests, relative to the size of the coordinates.
+#define CHAI_TRIANGLE_PACKET_TOLERANCE  1e-5
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \file       CTrianglePacket.h
+
+    \brief
+    <b> Graphics </b> \n
+    Groups of triangles tested against a segment together.
+*/
+//===========================================================================
+
+//===========================================================================
+/*!
+    \struct     cTrianglePacketSegment
+    \ingroup    graphics
+
+    \brief
+    A segment converted once for testing against many cTrianglePacket
+    objects.
+*/
+//===========================================================================
+struct cTrianglePacketSegment
+{
+    //! Initial point of the segment, in single precision.
+    float m_pointA[3];
+
+    //! End point of the segment, in single precision.
+    float m_pointB[3];
+
+    //! Collision radius, plus the rounding margin of the segment's coordinates.
+    float m_margin;
+
+    //! Set the segment and the collision radius it is tested with.
+    void set(const cVector3d& a_segmentPointA,
+             const cVector3d& a_segmentPointB,
+             const double a_collisionRadius);
+};
+
+
+//===========================================================================
+/*!
+    \class      cTrianglePacket
+    \ingroup    graphics
+
+    \brief
+    cTrianglePacket stores up to CHAI_TRIANGLE_PACKET_SIZE triangles of a
+    mesh as planes laid out structure-of-arrays, so that one segment can be
+    tested against all of them at once (with SSE where it is available). \n
+
+    For each triangle the packet keeps the plane of the triangle and the
+    three planes through its edges, perpendicular to it. A triangle can only
+    be hit by a segment (or by a segment within the collision radius of it)
+    if the segment does not lie entirely beyond one of these planes. This
+    test is done in single precision with a margin covering the rounding, so
+    it never rejects a triangle that cTriangle::computeCollision() would
+    report. The triangles it keeps are then tested with
+    cTriangle::computeCollision(), so the collisions reported are exactly
+    those of testing every triangle in turn. \n
+
+    The planes are computed from the vertex positions when the packet is
+    set; update() must be called after the vertices move.
+*/
+//===========================================================================
+class cTrianglePacket
+{
+  public:
+
+    //-----------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //-----------------------------------------------------------------------
+
+    //! Constructor of cTrianglePacket.
+    cTrianglePacket() : m_numTriangles(0) {}
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Store the given triangles of a mesh in the packet.
+    void set(const vector<cTriangle>* a_triangles,
+             const unsigned int* a_indices,
+             const unsigned int a_numTriangles);
+
+    //! Recompute the planes from the current positions of the vertices.
+    void update(const vector<cTriangle>* a_triangles);
+
+    //! Return a bit mask of the triangles the segment may collide with.
+    unsigned int computeCandidates(const cTrianglePacketSegment& a_segment) const;
+
+    //! Test the segment against the triangles of the packet, as cTriangle::computeCollision() does.
+    bool computeCollision(vector<cTriangle>* a_triangles,
+                          cVector3d& a_segmentPointA,
+                          cVector3d& a_segmentPointB,
+                          const cTrianglePacketSegment& a_segment,
+                          cCollisionRecorder& a_recorder,
+                          cCollisionSettings& a_settings) const;
+
+    //! Return the number of triangles in the packet.
+    unsigned int getNumTriangles() const { return (m_numTriangles); }
+
+    //! Return the index in the mesh of a triangle of the packet.
+    unsigned int getTriangleIndex(const unsigned int a_index) const { return (m_indices[a_index]); }
+
+
+  protected:
+
+    //-----------------------------------------------------------------------
+    // MEMBERS:
+    //-----------------------------------------------------------------------
+
+    /*!
+        Planes of the triangles: for the plane of the triangle (0) and the
+        planes through its three edges (1 to 3), the x, y and z components
+        of the unit normal and the offset along it, one column per triangle.
+        Edge normals point away from the triangle. Unused columns, and
+        degenerate triangles, have all coefficients zero so that they are
+        never rejected.
+    */
+    float m_planes[16][CHAI_TRIANGLE_PACKET_SIZE];
+
+    //! Rounding margin of each triangle's planes.
+    float m_tolerances[CHAI_TRIANGLE_PACKET_SIZE];
+
+    //! Indices of the triangles in the mesh.
+    unsigned int m_indices[CHAI_TRIANGLE_PACKET_SIZE];
+
+    //! Number of triangles in the packet.
+    unsigned int m_numTriangles;
+};
+
+//---------------------------------------------------------------------------
+#endif
+//---------------------------------------------------------------------------
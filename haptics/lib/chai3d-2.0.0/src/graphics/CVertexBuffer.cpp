@@ -0,0 +1,400 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#include "graphics/CVertexBuffer.h"
+#include "graphics/CTriangle.h"
+#include "graphics/CMacrosGL.h"
+//---------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+//---------------------------------------------------------------------------
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER             0x8892
+#define GL_ELEMENT_ARRAY_BUFFER     0x8893
+#define GL_STATIC_DRAW              0x88E4
+#endif
+//---------------------------------------------------------------------------
+// Buffer object entry points; OpenGL 1.1 libraries do not export them
+typedef void (APIENTRY *cGLGenBuffers)(GLsizei a_n, GLuint* a_buffers);
+typedef void (APIENTRY *cGLDeleteBuffers)(GLsizei a_n, const GLuint* a_buffers);
+typedef void (APIENTRY *cGLBindBuffer)(GLenum a_target, GLuint a_buffer);
+typedef void (APIENTRY *cGLBufferData)(GLenum a_target, ptrdiff_t a_size,
+                                       const GLvoid* a_data, GLenum a_usage);
+typedef void (APIENTRY *cGLBufferSubData)(GLenum a_target, ptrdiff_t a_offset,
+                                          ptrdiff_t a_size, const GLvoid* a_data);
+
+static cGLGenBuffers    cglGenBuffers    = NULL;
+static cGLDeleteBuffers cglDeleteBuffers = NULL;
+static cGLBindBuffer    cglBindBuffer    = NULL;
+static cGLBufferData    cglBufferData    = NULL;
+static cGLBufferSubData cglBufferSubData = NULL;
+
+//! 1 if buffer objects are supported, 0 if not, -1 if not checked yet.
+static int g_vertexBufferSupport = -1;
+//---------------------------------------------------------------------------
+
+
+//===========================================================================
+/*!
+    Constructor of cVertexBuffer.
+
+    \fn     cVertexBuffer::cVertexBuffer()
+*/
+//===========================================================================
+cVertexBuffer::cVertexBuffer()
+{
+    m_vertexBuffer = 0;
+    m_indexBuffer = 0;
+    m_numVertices = 0;
+    m_numIndices = 0;
+    m_verticesModified = true;
+    m_indicesModified = true;
+    m_numUploadedVertices = 0;
+}
+
+
+//===========================================================================
+/*!
+    Destructor of cVertexBuffer.
+
+    \fn     cVertexBuffer::~cVertexBuffer()
+*/
+//===========================================================================
+cVertexBuffer::~cVertexBuffer()
+{
+    deleteBuffers();
+}
+
+
+//===========================================================================
+/*!
+    Check whether the current OpenGL context supports buffer objects, either
+    as part of OpenGL 1.5 or through GL_ARB_vertex_buffer_object, and look
+    up their entry points. The check is done once, on the first call, which
+    must be made with a context current.
+
+    \fn     bool cVertexBuffer::isSupported()
+    \return Return \b true if buffer objects can be used.
+*/
+//===========================================================================
+bool cVertexBuffer::isSupported()
+{
+    if (g_vertexBufferSupport != -1) return (g_vertexBufferSupport == 1);
+
+    const char* version = (const char*)glGetString(GL_VERSION);
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (version == NULL) return (false);
+
+    // the core functions have no suffix, those of the extension end in ARB
+    const char* suffix = NULL;
+    int major = atoi(version);
+    const char* dot = strchr(version, '.');
+    int minor = (dot != NULL) ? atoi(dot + 1) : 0;
+    if ((major > 1) || ((major == 1) && (minor >= 5)))
+    {
+        suffix = "";
+    }
+    else if ((extensions != NULL) && (strstr(extensions, "GL_ARB_vertex_buffer_object") != NULL))
+    {
+        suffix = "ARB";
+    }
+
+    if (suffix != NULL)
+    {
+        char name[64];
+        sprintf(name, "glGenBuffers%s", suffix);
+        cglGenBuffers = (cGLGenBuffers)cGetGLProcAddress(name);
+        sprintf(name, "glDeleteBuffers%s", suffix);
+        cglDeleteBuffers = (cGLDeleteBuffers)cGetGLProcAddress(name);
+        sprintf(name, "glBindBuffer%s", suffix);
+        cglBindBuffer = (cGLBindBuffer)cGetGLProcAddress(name);
+        sprintf(name, "glBufferData%s", suffix);
+        cglBufferData = (cGLBufferData)cGetGLProcAddress(name);
+        sprintf(name, "glBufferSubData%s", suffix);
+        cglBufferSubData = (cGLBufferSubData)cGetGLProcAddress(name);
+    }
+
+    g_vertexBufferSupport = ((cglGenBuffers != NULL) && (cglDeleteBuffers != NULL) &&
+                             (cglBindBuffer != NULL) && (cglBufferData != NULL) &&
+                             (cglBufferSubData != NULL)) ? 1 : 0;
+
+    return (g_vertexBufferSupport == 1);
+}
+
+
+//===========================================================================
+/*!
+    Mark all vertices and triangles as modified, so that the next render
+    uploads them all.
+
+    \fn     void cVertexBuffer::invalidate()
+*/
+//===========================================================================
+void cVertexBuffer::invalidate()
+{
+    m_verticesModified = true;
+    m_indicesModified = true;
+    m_modifiedRanges.clear();
+}
+
+
+//===========================================================================
+/*!
+    Mark a span of vertices as modified, so that the next render uploads
+    them. Spans that overlap or touch are merged.
+
+    \fn     void cVertexBuffer::invalidateVertices(const unsigned int a_firstIndex,
+                                                   const unsigned int a_numVertices)
+    \param  a_firstIndex  Index of the first modified vertex.
+    \param  a_numVertices  Number of modified vertices.
+*/
+//===========================================================================
+void cVertexBuffer::invalidateVertices(const unsigned int a_firstIndex,
+                                       const unsigned int a_numVertices)
+{
+    // nothing to add if every vertex is uploaded anyway
+    if ((a_numVertices == 0) || (m_verticesModified)) return;
+
+    cVertexBufferRange range;
+    range.m_first = a_firstIndex;
+    range.m_last = a_firstIndex + a_numVertices;
+
+    // skip the spans that end before this one, then absorb those it touches
+    vector<cVertexBufferRange>::iterator it = m_modifiedRanges.begin();
+    while ((it != m_modifiedRanges.end()) && (it->m_last < range.m_first))
+    {
+        it++;
+    }
+    while ((it != m_modifiedRanges.end()) && (it->m_first <= range.m_last))
+    {
+        range.m_first = cMin(range.m_first, it->m_first);
+        range.m_last = cMax(range.m_last, it->m_last);
+        it = m_modifiedRanges.erase(it);
+    }
+    m_modifiedRanges.insert(it, range);
+
+    // past the limit, merge the two spans closest to each other
+    if (m_modifiedRanges.size() > CHAI_VERTEX_BUFFER_MAX_RANGES)
+    {
+        unsigned int closest = 0;
+        unsigned int i;
+        for (i=1; i+1<m_modifiedRanges.size(); i++)
+        {
+            if (m_modifiedRanges[i+1].m_first - m_modifiedRanges[i].m_last <
+                m_modifiedRanges[closest+1].m_first - m_modifiedRanges[closest].m_last)
+            {
+                closest = i;
+            }
+        }
+        m_modifiedRanges[closest].m_last = m_modifiedRanges[closest+1].m_last;
+        m_modifiedRanges.erase(m_modifiedRanges.begin() + closest + 1);
+    }
+}
+
+
+//===========================================================================
+/*!
+    Delete the OpenGL buffers, for instance when the OpenGL context is about
+    to be destroyed. They are created and filled again on the next render.
+
+    \fn     void cVertexBuffer::deleteBuffers()
+*/
+//===========================================================================
+void cVertexBuffer::deleteBuffers()
+{
+    if (m_vertexBuffer != 0)
+    {
+        cglDeleteBuffers(1, &m_vertexBuffer);
+        cglDeleteBuffers(1, &m_indexBuffer);
+        m_vertexBuffer = 0;
+        m_indexBuffer = 0;
+    }
+    m_numVertices = 0;
+    m_numIndices = 0;
+    invalidate();
+}
+
+
+//===========================================================================
+/*!
+    Convert a span of vertices to single precision and upload it into the
+    vertex buffer, which must be bound.
+
+    \fn     void cVertexBuffer::uploadVertices(const vector<cVertex>& a_vertices,
+                                               const unsigned int a_first,
+                                               const unsigned int a_last)
+    \param  a_vertices  Vertices of the mesh.
+    \param  a_first  First vertex of the span.
+    \param  a_last  One past the last vertex of the span.
+*/
+//===========================================================================
+void cVertexBuffer::uploadVertices(const vector<cVertex>& a_vertices,
+                                   const unsigned int a_first,
+                                   const unsigned int a_last)
+{
+    if (a_first >= a_last) return;
+
+    unsigned int numVertices = a_last - a_first;
+    m_staging.resize(numVertices);
+    for (unsigned int i=0; i<numVertices; i++)
+    {
+        const cVertex& vertex = a_vertices[a_first + i];
+        cVertexBufferVertex& staged = m_staging[i];
+        staged.m_pos[0] = (float)vertex.m_localPos.x;
+        staged.m_pos[1] = (float)vertex.m_localPos.y;
+        staged.m_pos[2] = (float)vertex.m_localPos.z;
+        staged.m_normal[0] = (float)vertex.m_normal.x;
+        staged.m_normal[1] = (float)vertex.m_normal.y;
+        staged.m_normal[2] = (float)vertex.m_normal.z;
+        memcpy(staged.m_color, vertex.m_color.pColor(), 4 * sizeof(float));
+        staged.m_texCoord[0] = (float)vertex.m_texCoord.x;
+        staged.m_texCoord[1] = (float)vertex.m_texCoord.y;
+    }
+
+    cglBufferSubData(GL_ARRAY_BUFFER,
+                     a_first * sizeof(cVertexBufferVertex),
+                     numVertices * sizeof(cVertexBufferVertex),
+                     &m_staging[0]);
+    m_numUploadedVertices += numVertices;
+}
+
+
+//===========================================================================
+/*!
+    Upload the vertices and triangles modified since the last render, then
+    render the allocated triangles. The material, texture and lighting state
+    is left to the caller; the vertex, normal, and optionally color and
+    texture coordinate arrays are enabled here and disabled afterwards.
+
+    \fn     bool cVertexBuffer::render(const vector<cVertex>& a_vertices,
+                                       const vector<cTriangle>& a_triangles,
+                                       const bool a_useColors,
+                                       const bool a_useTexCoords)
+    \param  a_vertices  Vertices of the mesh.
+    \param  a_triangles  Triangles of the mesh.
+    \param  a_useColors  If \b true, the vertex colors are used.
+    \param  a_useTexCoords  If \b true, the texture coordinates are used.
+    \return Return \b false if buffer objects are not supported, in which
+            case nothing was rendered.
+*/
+//===========================================================================
+bool cVertexBuffer::render(const vector<cVertex>& a_vertices,
+                           const vector<cTriangle>& a_triangles,
+                           const bool a_useColors,
+                           const bool a_useTexCoords)
+{
+    if (!isSupported()) return (false);
+
+    // create the buffers on the first render
+    if (m_vertexBuffer == 0)
+    {
+        cglGenBuffers(1, &m_vertexBuffer);
+        cglGenBuffers(1, &m_indexBuffer);
+        invalidate();
+    }
+
+    //-----------------------------------------------------------------------
+    // VERTICES
+    //-----------------------------------------------------------------------
+    cglBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    unsigned int numVertices = (unsigned int)a_vertices.size();
+
+    // a different number of vertices needs a new buffer, filled entirely
+    if (numVertices != m_numVertices)
+    {
+        cglBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(cVertexBufferVertex),
+                      NULL, GL_STATIC_DRAW);
+        m_numVertices = numVertices;
+        m_verticesModified = true;
+    }
+
+    if (m_verticesModified)
+    {
+        uploadVertices(a_vertices, 0, numVertices);
+    }
+    else
+    {
+        for (unsigned int i=0; i<m_modifiedRanges.size(); i++)
+        {
+            uploadVertices(a_vertices, m_modifiedRanges[i].m_first,
+                           cMin(m_modifiedRanges[i].m_last, numVertices));
+        }
+    }
+    m_modifiedRanges.clear();
+    m_verticesModified = false;
+
+    //-----------------------------------------------------------------------
+    // TRIANGLES
+    //-----------------------------------------------------------------------
+    cglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    if (m_indicesModified)
+    {
+        m_indices.clear();
+        unsigned int numTriangles = (unsigned int)a_triangles.size();
+        for (unsigned int i=0; i<numTriangles; i++)
+        {
+            const cTriangle& triangle = a_triangles[i];
+            if (triangle.m_allocated)
+            {
+                m_indices.push_back(triangle.m_indexVertex0);
+                m_indices.push_back(triangle.m_indexVertex1);
+                m_indices.push_back(triangle.m_indexVertex2);
+            }
+        }
+        m_numIndices = (unsigned int)m_indices.size();
+        cglBufferData(GL_ELEMENT_ARRAY_BUFFER, m_numIndices * sizeof(GLuint),
+                      (m_numIndices > 0) ? &m_indices[0] : NULL, GL_STATIC_DRAW);
+        m_indicesModified = false;
+    }
+
+    //-----------------------------------------------------------------------
+    // RENDERING
+    //-----------------------------------------------------------------------
+    GLsizei stride = sizeof(cVertexBufferVertex);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, stride, (const GLvoid*)offsetof(cVertexBufferVertex, m_pos));
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glNormalPointer(GL_FLOAT, stride, (const GLvoid*)offsetof(cVertexBufferVertex, m_normal));
+    if (a_useColors)
+    {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_FLOAT, stride, (const GLvoid*)offsetof(cVertexBufferVertex, m_color));
+    }
+    if (a_useTexCoords)
+    {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, stride, (const GLvoid*)offsetof(cVertexBufferVertex, m_texCoord));
+    }
+
+    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, 0);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    // leave client-side arrays usable by the rest of the scene
+    cglBindBuffer(GL_ARRAY_BUFFER, 0);
+    cglBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return (true);
+}
@@ -0,0 +1,206 @@
+//===========================================================================
+/*
+    This file is part of the CHAI 3D visualization and haptics libraries.
+    Copyright (C) 2003-2009 by CHAI 3D. All rights reserved.
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License("GPL") version 2
+    as published by the Free Software Foundation.
+
+    For using the CHAI 3D libraries with software that can not be combined
+    with the GNU GPL, and for taking advantage of the additional benefits
+    of our support services, please contact CHAI 3D about acquiring a
+    Professional Edition License.
+
+    \author    <http://www.chai3d.org>
+    \version   2.0.0 $Rev: 251 $
+*/
+//===========================================================================
+
+//---------------------------------------------------------------------------
+#ifndef CVertexBufferH
+#define CVertexBufferH
+//---------------------------------------------------------------------------
+#include "extras/CGlobals.h"
+#include "graphics/CVertex.h"
+#include <vector>
+//---------------------------------------------------------------------------
+using std::vector;
+class cTriangle;
+//---------------------------------------------------------------------------
+//! Largest number of separate spans of modified vertices kept until the next upload.
+#define CHAI_VERTEX_BUFFER_MAX_RANGES   8
+//---------------------------------------------------------------------------
+
+//===========================================================================
+/*!
+    \file       CVertexBuffer.h
+
+    \brief
+    <b> Graphics </b> \n
+    OpenGL Vertex and Index Buffers of a Mesh.
+*/
+//===========================================================================
+
+//===========================================================================
+/*!
+    \struct     cVertexBufferVertex
+    \ingroup    graphics
+
+    \brief
+    A vertex as it is stored in a cVertexBuffer: position, normal, color
+    and texture coordinates, interleaved in single precision.
+*/
+//===========================================================================
+struct cVertexBufferVertex
+{
+    //! Position of the vertex, in the mesh's coordinates.
+    float m_pos[3];
+
+    //! Normal of the vertex.
+    float m_normal[3];
+
+    //! Color of the vertex.
+    float m_color[4];
+
+    //! Texture coordinates of the vertex.
+    float m_texCoord[2];
+};
+
+
+//===========================================================================
+/*!
+    \struct     cVertexBufferRange
+    \ingroup    graphics
+
+    \brief
+    A span of vertices to upload to a cVertexBuffer.
+*/
+//===========================================================================
+struct cVertexBufferRange
+{
+    //! First vertex of the span.
+    unsigned int m_first;
+
+    //! One past the last vertex of the span.
+    unsigned int m_last;
+};
+
+
+//===========================================================================
+/*!
+    \class      cVertexBuffer
+    \ingroup    graphics
+
+    \brief
+    cVertexBuffer keeps the vertices and triangles of a mesh in OpenGL
+    buffer objects (vertex buffer objects, OpenGL 1.5 or
+    GL_ARB_vertex_buffer_object), and renders them with a single call to
+    glDrawElements(). \n
+
+    The vertices are uploaded once, and then only the spans of vertices
+    marked as modified with invalidateVertices() are uploaded again, with
+    glBufferSubData(). Up to CHAI_VERTEX_BUFFER_MAX_RANGES separate spans
+    are kept; past that, the two spans closest to each other are merged.
+    The triangles are uploaded again after invalidateIndices(). A change in
+    the number of vertices uploads them all. \n
+
+    Changes made directly to the vertices are not noticed: the owner must
+    report them, as cMesh does for its own operations.
+*/
+//===========================================================================
+class cVertexBuffer
+{
+  public:
+
+    //-----------------------------------------------------------------------
+    // CONSTRUCTOR & DESTRUCTOR:
+    //-----------------------------------------------------------------------
+
+    //! Constructor of cVertexBuffer.
+    cVertexBuffer();
+
+    //! Destructor of cVertexBuffer.
+    virtual ~cVertexBuffer();
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Return \b true if the current OpenGL context supports buffer objects.
+    static bool isSupported();
+
+    //! Mark all vertices and triangles as modified.
+    void invalidate();
+
+    //! Mark a span of vertices as modified.
+    void invalidateVertices(const unsigned int a_firstIndex,
+                            const unsigned int a_numVertices);
+
+    //! Mark the triangles as modified.
+    void invalidateIndices() { m_indicesModified = true; }
+
+    //! Delete the OpenGL buffers; they are created again on the next render.
+    void deleteBuffers();
+
+    //! Upload what was modified, then render the triangles.
+    bool render(const vector<cVertex>& a_vertices,
+                const vector<cTriangle>& a_triangles,
+                const bool a_useColors,
+                const bool a_useTexCoords);
+
+    //! Return the number of vertices uploaded since the buffer was created.
+    unsigned int getNumUploadedVertices() const { return (m_numUploadedVertices); }
+
+
+  protected:
+
+    //-----------------------------------------------------------------------
+    // MEMBERS:
+    //-----------------------------------------------------------------------
+
+    //! OpenGL buffer holding the vertices (0 if not created).
+    GLuint m_vertexBuffer;
+
+    //! OpenGL buffer holding the vertex indices of the triangles (0 if not created).
+    GLuint m_indexBuffer;
+
+    //! Number of vertices in the vertex buffer.
+    unsigned int m_numVertices;
+
+    //! Number of indices in the index buffer.
+    unsigned int m_numIndices;
+
+    //! Spans of modified vertices, in order and disjoint.
+    vector<cVertexBufferRange> m_modifiedRanges;
+
+    //! If \b true, every vertex must be uploaded.
+    bool m_verticesModified;
+
+    //! If \b true, the triangles must be uploaded.
+    bool m_indicesModified;
+
+    //! Vertices being converted for upload.
+    vector<cVertexBufferVertex> m_staging;
+
+    //! Vertex indices being collected for upload.
+    vector<GLuint> m_indices;
+
+    //! Number of vertices uploaded since the buffer was created.
+    unsigned int m_numUploadedVertices;
+
+
+    //-----------------------------------------------------------------------
+    // METHODS:
+    //-----------------------------------------------------------------------
+
+    //! Convert a span of vertices and upload it.
+    void uploadVertices(const vector<cVertex>& a_vertices,
+                        const unsigned int a_first,
+                        const unsigned int a_last);
+};
+
+//---------------------------------------------------------------------------
+#endif
+//---------------------------------------------------------------------------
@@ -1034,6 +1034,124 @@ inline cVector3d cProjectPointOnSegment(const cVector3d& a_point,
 
 
 
+//===========================================================================
+/*!
+    Compute the projection of a point on a triangle, that is the point of
+    the triangle nearest to it. The projection is returned along with its
+    barycentric coordinates: it equals
+    \e V0 + \e u (\e V1 - \e V0) + \e v (\e V2 - \e V0).
+
+    \param    a_point  Point that is projected.
+    \param    a_triangleVertex0  Vertex 0 of triangle.
+    \param    a_triangleVertex1  Vertex 1 of triangle.
+    \param    a_triangleVertex2  Vertex 2 of triangle.
+    \param    a_u  Returns the weight \e u of vertex 1.
+    \param    a_v  Returns the weight \e v of vertex 2.
+    \return   Returns the projection of \e a_point on the triangle.
+*/
+//===========================================================================
+inline cVector3d cProjectPointOnTriangle(const cVector3d& a_point,
+                                         const cVector3d& a_triangleVertex0,
+                                         const cVector3d& a_triangleVertex1,
+                                         const cVector3d& a_triangleVertex2,
+                                         double& a_u,
+                                         double& a_v)
+{
+    cVector3d edge01 = cSub(a_triangleVertex1, a_triangleVertex0);
+    cVector3d edge02 = cSub(a_triangleVertex2, a_triangleVertex0);
+
+    // nearest to vertex 0
+    cVector3d point0 = cSub(a_point, a_triangleVertex0);
+    double d1 = cDot(edge01, point0);
+    double d2 = cDot(edge02, point0);
+    if ((d1 <= 0.0) && (d2 <= 0.0))
+    {
+        a_u = 0.0; a_v = 0.0;
+        return (a_triangleVertex0);
+    }
+
+    // nearest to vertex 1
+    cVector3d point1 = cSub(a_point, a_triangleVertex1);
+    double d3 = cDot(edge01, point1);
+    double d4 = cDot(edge02, point1);
+    if ((d3 >= 0.0) && (d4 <= d3))
+    {
+        a_u = 1.0; a_v = 0.0;
+        return (a_triangleVertex1);
+    }
+
+    // nearest to edge 0-1
+    double c = d1 * d4 - d3 * d2;
+    if ((c <= 0.0) && (d1 >= 0.0) && (d3 <= 0.0))
+    {
+        a_u = d1 / (d1 - d3); a_v = 0.0;
+        return (cAdd(a_triangleVertex0, cMul(a_u, edge01)));
+    }
+
+    // nearest to vertex 2
+    cVector3d point2 = cSub(a_point, a_triangleVertex2);
+    double d5 = cDot(edge01, point2);
+    double d6 = cDot(edge02, point2);
+    if ((d6 >= 0.0) && (d5 <= d6))
+    {
+        a_u = 0.0; a_v = 1.0;
+        return (a_triangleVertex2);
+    }
+
+    // nearest to edge 0-2
+    double b = d5 * d2 - d1 * d6;
+    if ((b <= 0.0) && (d2 >= 0.0) && (d6 <= 0.0))
+    {
+        a_u = 0.0; a_v = d2 / (d2 - d6);
+        return (cAdd(a_triangleVertex0, cMul(a_v, edge02)));
+    }
+
+    // nearest to edge 1-2
+    double a = d3 * d6 - d5 * d4;
+    if ((a <= 0.0) && (d4 >= d3) && (d5 >= d6))
+    {
+        double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        a_u = 1.0 - w; a_v = w;
+        return (cAdd(a_triangleVertex1, cMul(w, cSub(a_triangleVertex2, a_triangleVertex1))));
+    }
+
+    // nearest to the inside of the triangle; the sum is the squared norm of its normal
+    double sum = a + b + c;
+    if (sum <= 1e-12 * cDot(edge01, edge01) * cDot(edge02, edge02))
+    {
+        // a degenerate triangle is a segment, nearest to the point along one of its edges
+        cVector3d edge12 = cSub(a_triangleVertex2, a_triangleVertex1);
+        double s01 = (d1 > 0.0) ? cMin(1.0, d1 / cDot(edge01, edge01)) : 0.0;
+        double s02 = (d2 > 0.0) ? cMin(1.0, d2 / cDot(edge02, edge02)) : 0.0;
+        double s12 = cDot(edge12, point1);
+        s12 = (s12 > 0.0) ? cMin(1.0, s12 / cDot(edge12, edge12)) : 0.0;
+
+        cVector3d projection01 = cAdd(a_triangleVertex0, cMul(s01, edge01));
+        cVector3d projection02 = cAdd(a_triangleVertex0, cMul(s02, edge02));
+        cVector3d projection12 = cAdd(a_triangleVertex1, cMul(s12, edge12));
+        double distance01 = cDistanceSq(a_point, projection01);
+        double distance02 = cDistanceSq(a_point, projection02);
+        double distance12 = cDistanceSq(a_point, projection12);
+
+        if ((distance01 <= distance02) && (distance01 <= distance12))
+        {
+            a_u = s01; a_v = 0.0;
+            return (projection01);
+        }
+        if (distance02 <= distance12)
+        {
+            a_u = 0.0; a_v = s02;
+            return (projection02);
+        }
+        a_u = 1.0 - s12; a_v = s12;
+        return (projection12);
+    }
+    a_u = b / sum;
+    a_v = c / sum;
+    return (cAdd(a_triangleVertex0, cMul(a_u, edge01), cMul(a_v, edge02)));
+}
+
+
 //===========================================================================
 /*!
     Project a vector \e V0 onto a second vector \e V1.
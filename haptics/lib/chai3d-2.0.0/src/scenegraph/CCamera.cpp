@@ -424,6 +424,9 @@ void cCamera::renderView(const int a_windowWidth, const int a_windowHeight,
     glDepthMask(GL_TRUE);
     glEnable(GL_DEPTH_TEST);
 
+    // count what this view draws and culls
+    cGenericObject::clearRenderStatistics();
+
     // optionally perform multiple rendering passes for transparency
     if (m_useMultipassTransparency) {
       m_parentWorld->renderSceneGraph(CHAI_RENDER_MODE_NON_TRANSPARENT_ONLY);
@@ -22,10 +22,14 @@
 //---------------------------------------------------------------------------
 #include "scenegraph/CGenericObject.h"
 #include "collisions/CGenericCollision.h"
+#include "scenegraph/CMesh.h"
+#include "graphics/CFrustum.h"
 #include <float.h>
 //---------------------------------------------------------------------------
 #include <vector>
 //---------------------------------------------------------------------------
+cRenderStatistics cGenericObject::m_renderStatistics;
+//---------------------------------------------------------------------------
 
 //===========================================================================
 /*!
@@ -77,6 +81,11 @@ m_tag(-1), m_userData(0)
     // turn culling on by default
     m_cullingEnabled = true;
 
+    // render whether in view or not by default
+    m_useFrustumCulling = false;
+    m_useOcclusionCulling = false;
+    m_occluded = false;
+
     // by default, if transparency is enabled, use the multi-pass approach
     m_useMultipassTransparency = true;
 
@@ -853,7 +862,9 @@ void cGenericObject::setUserData(void* a_data, const bool a_affectChildren)
 //===========================================================================
 void cGenericObject::onDisplayReset(const bool a_affectChildren)
 {
-    // Since I don't have any display context to update, I don't do anything here...
+    // The occlusion query belongs to the old context
+    m_occlusionQuery.deleteQuery();
+    m_occluded = false;
 
     // We _don't_ call this method on the current object, which allows subclasses
     // to do their business in this method, then call the cGenericObject version
@@ -1229,6 +1240,82 @@ void cGenericObject::setUseCulling(const bool a_useCulling, const bool a_affectC
 }
 
 
+//===========================================================================
+/*!
+     Enables or disables view frustum culling: when the boundary box of
+     this object lies outside the view, the object and its children are
+     not rendered. The boundary box must include the children and be kept
+     up to date (see computeBoundaryBox()); objects without a boundary box
+     are always rendered.
+
+     \fn       void cGenericObject::setUseFrustumCulling(const bool a_useFrustumCulling,
+                                                         const bool a_affectChildren)
+     \param    a_useFrustumCulling  If \b true, objects outside the view are skipped.
+     \param    a_affectChildren  If \b true, this operation is propagated
+                                 to my children.
+*/
+//===========================================================================
+void cGenericObject::setUseFrustumCulling(const bool a_useFrustumCulling, const bool a_affectChildren)
+{
+    // apply changes to this object
+    m_useFrustumCulling = a_useFrustumCulling;
+
+    // propagate changes to children
+    if (a_affectChildren)
+    {
+        unsigned int i, numItems;
+        numItems = m_children.size();
+        for (i=0; i<numItems; i++)
+        {
+            cGenericObject *nextObject = m_children[i];
+            nextObject->setUseFrustumCulling(a_useFrustumCulling, a_affectChildren);
+        }
+    }
+}
+
+
+//===========================================================================
+/*!
+     Enables or disables occlusion culling: before this object is rendered,
+     its boundary box is tested against the depth buffer with an OpenGL
+     occlusion query, and if no part of it was visible, the object and its
+     children are not rendered in the following frames, until the box shows
+     again. \n
+
+     The answer is used one frame late, so an object coming out from
+     behind another appears one frame after it should. Only what was
+     rendered before the object hides it, so large occluders should come
+     first in the scene graph. The boundary box must be kept up to date, as
+     for frustum culling. Without occlusion queries (OpenGL 1.5 or
+     GL_ARB_occlusion_query), this option has no effect.
+
+     \fn       void cGenericObject::setUseOcclusionCulling(const bool a_useOcclusionCulling,
+                                                           const bool a_affectChildren)
+     \param    a_useOcclusionCulling  If \b true, hidden objects are skipped.
+     \param    a_affectChildren  If \b true, this operation is propagated
+                                 to my children.
+*/
+//===========================================================================
+void cGenericObject::setUseOcclusionCulling(const bool a_useOcclusionCulling, const bool a_affectChildren)
+{
+    // apply changes to this object
+    m_useOcclusionCulling = a_useOcclusionCulling;
+    m_occluded = false;
+
+    // propagate changes to children
+    if (a_affectChildren)
+    {
+        unsigned int i, numItems;
+        numItems = m_children.size();
+        for (i=0; i<numItems; i++)
+        {
+            cGenericObject *nextObject = m_children[i];
+            nextObject->setUseOcclusionCulling(a_useOcclusionCulling, a_affectChildren);
+        }
+    }
+}
+
+
 //===========================================================================
 /*!
      Enable or disable wireframe rendering, optionally propagating the
@@ -1635,6 +1722,43 @@ void cGenericObject::deleteCollisionDetector(const bool a_affectChildren)
 }
 
 
+//===========================================================================
+/*!
+    Update the collision detector to the current positions of the vertices
+    after they have been moved (for instance by a deformable model), without
+    building it again from scratch. If the detector has degraded by more
+    than \e a_maxDegradation since it was built, it is rebuilt instead
+    (see cCollisionAABB::refit()). \n
+
+    The broad phase culls objects with their boundary boxes, so call
+    computeBoundaryBox() too once the vertices have moved.
+
+    \fn     void cGenericObject::refitCollisionDetector(double a_maxDegradation,
+                                                       const bool a_affectChildren)
+    \param  a_maxDegradation  Growth in the cost of the collision tree past
+                              which it is rebuilt; 0 never rebuilds.
+    \param  a_affectChildren  If true, all my children's cd's are also updated.
+*/
+//===========================================================================
+void cGenericObject::refitCollisionDetector(double a_maxDegradation,
+                                            const bool a_affectChildren)
+{
+    if (m_collisionDetector)
+    {
+        m_collisionDetector->refit(a_maxDegradation);
+    }
+
+    // update children
+    if (a_affectChildren)
+    {
+        for (unsigned int i=0; i<m_children.size(); i++)
+        {
+            m_children[i]->refitCollisionDetector(a_maxDegradation, true);
+        }
+    }
+}
+
+
 //===========================================================================
 /*!
     Set the rendering properties for the graphic representation of collision 
@@ -1930,6 +2054,53 @@ void cGenericObject::adjustCollisionSegment(cVector3d& a_segmentPointA,
 }
 
 
+//===========================================================================
+/*!
+    Return the number of triangles an object renders itself, for the
+    rendering statistics.
+
+    \fn     static unsigned int cCountRenderedTriangles(cGenericObject* a_object)
+    \param  a_object  The object.
+    \return Return the number of triangles of a mesh, 0 for other objects.
+*/
+//===========================================================================
+static unsigned int cCountRenderedTriangles(cGenericObject* a_object)
+{
+    cMesh* mesh = dynamic_cast<cMesh*>(a_object);
+    return ((mesh != NULL) ? mesh->getNumTriangles(false) : 0);
+}
+
+
+//===========================================================================
+/*!
+    Add up the objects shown in a subtree of the scene graph, and their
+    triangles, for the rendering statistics.
+
+    \fn     static void cCountRenderedSubtree(cGenericObject* a_object,
+                                              unsigned int& a_numObjects,
+                                              unsigned int& a_numTriangles)
+    \param  a_object  Root of the subtree.
+    \param  a_numObjects  Incremented by the number of objects shown.
+    \param  a_numTriangles  Incremented by the number of their triangles.
+*/
+//===========================================================================
+static void cCountRenderedSubtree(cGenericObject* a_object,
+                                  unsigned int& a_numObjects,
+                                  unsigned int& a_numTriangles)
+{
+    if (a_object->getShowEnabled())
+    {
+        a_numObjects++;
+        a_numTriangles += cCountRenderedTriangles(a_object);
+    }
+
+    for (unsigned int i=0; i<a_object->getNumChildren(); i++)
+    {
+        cCountRenderedSubtree(a_object->getChild(i), a_numObjects, a_numTriangles);
+    }
+}
+
+
 //===========================================================================
 /*!
     Render the scene graph starting at this object. This method is called
@@ -1951,7 +2122,12 @@ void cGenericObject::adjustCollisionSegment(cVector3d& a_segmentPointA,
     If you have multipass transparency disabled (see cCamera), your objects will
     only be rendered once per frame, with a_renderMode set to CHAI_RENDER_MODE_RENDER_ALL.
     This is the default, and unless you enable multipass transparency, you don't
-    ever need to care about a_renderMode.
+    ever need to care about a_renderMode. \n
+
+    Objects with frustum or occlusion culling enabled (see
+    setUseFrustumCulling() and setUseOcclusionCulling()) are skipped, along
+    with their children, when their boundary box cannot be seen. What was
+    drawn and skipped is counted in getRenderStatistics().
 
     \fn     void cGenericObject::renderSceneGraph(const int a_renderMode)
     \param  a_renderMode  Rendering mode.
@@ -1968,6 +2144,73 @@ void cGenericObject::renderSceneGraph(const int a_renderMode)
     m_frameGL.set(m_localPos, m_localRot);
     m_frameGL.glMatrixPushMultiply();
 
+    // the first (or only) rendering pass tests for occlusion and counts
+    // objects for the statistics
+    bool first_pass = (a_renderMode == CHAI_RENDER_MODE_NON_TRANSPARENT_ONLY ||
+                       a_renderMode == CHAI_RENDER_MODE_RENDER_ALL);
+
+    //-----------------------------------------------------------------------
+    // Skip this object and its children if they cannot be seen
+    //-----------------------------------------------------------------------
+
+    // objects without a boundary box are always rendered
+    bool valid_box = (cDistance(m_boundaryBoxMax, m_boundaryBoxMin) > BOUNDARY_BOX_EPSILON);
+
+    if ((m_useFrustumCulling || m_useOcclusionCulling) && valid_box)
+    {
+        // the frustum in my reference frame, where my boundary box is
+        cFrustum frustum;
+        frustum.setFromGL();
+
+        if (m_useFrustumCulling && frustum.isBoxOutside(m_boundaryBoxMin, m_boundaryBoxMax))
+        {
+            if (first_pass)
+            {
+                cCountRenderedSubtree(this, m_renderStatistics.m_numObjectsCulled,
+                                      m_renderStatistics.m_numTrianglesCulled);
+            }
+            m_frameGL.glMatrixPop();
+            return;
+        }
+
+        if (m_useOcclusionCulling && cOcclusionQuery::isSupported())
+        {
+            if (first_pass)
+            {
+                // use the answer to the last query of my boundary box, once it arrives
+                unsigned int samples;
+                if (m_occlusionQuery.getResult(samples))
+                {
+                    m_occluded = (samples == 0);
+                }
+
+                // a box reaching past the near plane is clipped, and may seem hidden
+                // when it is in front of the viewer
+                if (frustum.isBoxCrossing(m_boundaryBoxMin, m_boundaryBoxMax, CHAI_FRUSTUM_NEAR))
+                {
+                    m_occluded = false;
+                }
+
+                // test the box against what has been rendered so far
+                else if (!m_occlusionQuery.isPending())
+                {
+                    m_occlusionQuery.renderBox(m_boundaryBoxMin, m_boundaryBoxMax);
+                }
+            }
+
+            if (m_occluded)
+            {
+                if (first_pass)
+                {
+                    cCountRenderedSubtree(this, m_renderStatistics.m_numObjectsOccluded,
+                                          m_renderStatistics.m_numTrianglesOccluded);
+                }
+                m_frameGL.glMatrixPop();
+                return;
+            }
+        }
+    }
+
     // Handle rendering meta-object components, e.g. collision trees,
     // bounding boxes, scenegraph tree, etc.
     // set up useful rendering state
@@ -2049,6 +2292,12 @@ void cGenericObject::renderSceneGraph(const int a_renderMode)
     //-----------------------------------------------------------------------
     if (m_show)
     {
+        if (first_pass)
+        {
+            m_renderStatistics.m_numObjectsDrawn++;
+            m_renderStatistics.m_numTrianglesDrawn += cCountRenderedTriangles(this);
+        }
+
         // set polygon and face mode
         glPolygonMode(GL_FRONT_AND_BACK, m_triangleMode);
 
@@ -29,6 +29,7 @@
 #include "graphics/CMacrosGL.h"
 #include "graphics/CMaterial.h"
 #include "graphics/CTexture2D.h"
+#include "graphics/COcclusionQuery.h"
 #include "collisions/CCollisionBasics.h"
 #include "forces/CInteractionBasics.h"
 #include "effects/CGenericEffect.h"
@@ -56,6 +57,50 @@ typedef enum {
 } chai_render_modes;
 //---------------------------------------------------------------------------
 
+//===========================================================================
+/*!
+    \struct     cRenderStatistics
+    \ingroup    scenegraph
+
+    \brief
+    Counts of what was drawn and what was culled while rendering the scene
+    graph (see cGenericObject::getRenderStatistics()). Objects are counted
+    once per frame, in the first rendering pass.
+*/
+//===========================================================================
+struct cRenderStatistics
+{
+    //! Set all counts to zero.
+    void clear()
+    {
+        m_numObjectsDrawn = 0;
+        m_numObjectsCulled = 0;
+        m_numObjectsOccluded = 0;
+        m_numTrianglesDrawn = 0;
+        m_numTrianglesCulled = 0;
+        m_numTrianglesOccluded = 0;
+    }
+
+    //! Number of objects drawn.
+    unsigned int m_numObjectsDrawn;
+
+    //! Number of objects skipped because they were outside the view frustum.
+    unsigned int m_numObjectsCulled;
+
+    //! Number of objects skipped because they were hidden behind others.
+    unsigned int m_numObjectsOccluded;
+
+    //! Number of mesh triangles drawn.
+    unsigned int m_numTrianglesDrawn;
+
+    //! Number of mesh triangles skipped because they were outside the view frustum.
+    unsigned int m_numTrianglesCulled;
+
+    //! Number of mesh triangles skipped because they were hidden behind others.
+    unsigned int m_numTrianglesOccluded;
+};
+//---------------------------------------------------------------------------
+
 //===========================================================================
 /*!
     \file       CGenericObject.h
@@ -140,6 +185,12 @@ class cGenericObject : public cGenericType
     //! Get the global rotation matrix of this object.
     inline cMatrix3d getGlobalRot() const { return (m_globalRot); }
 
+    //! Get the global position of this object before the last call to computeGlobalPositions().
+    inline cVector3d getPrevGlobalPos() const { return (m_prevGlobalPos); }
+
+    //! Get the global rotation matrix of this object before the last call to computeGlobalPositions().
+    inline cMatrix3d getPrevGlobalRot() const { return (m_prevGlobalRot); }
+
     //! Translate this object by a specified offset.
     void translate(const cVector3d& a_translation);
 
@@ -312,6 +363,24 @@ class cGenericObject : public cGenericType
     //! Is face-culling currently enabled?
     bool getUseCulling() const { return m_cullingEnabled; }
 
+    //! Skip this object and its children when their boundary box is outside the view, optionally propagating the operation to my children.
+    void setUseFrustumCulling(const bool a_useFrustumCulling, const bool a_affectChildren=true);
+
+    //! Is view frustum culling enabled?
+    bool getUseFrustumCulling() const { return m_useFrustumCulling; }
+
+    //! Skip this object and its children when their boundary box was hidden in the previous frame, optionally propagating the operation to my children.
+    void setUseOcclusionCulling(const bool a_useOcclusionCulling, const bool a_affectChildren=true);
+
+    //! Is occlusion culling enabled?
+    bool getUseOcclusionCulling() const { return m_useOcclusionCulling; }
+
+    //! Read what was drawn and culled since the statistics were last cleared.
+    static const cRenderStatistics& getRenderStatistics() { return (m_renderStatistics); }
+
+    //! Clear the rendering statistics (cCamera does so before rendering each view).
+    static void clearRenderStatistics() { m_renderStatistics.clear(); }
+
     //! Enable or disable the use of per-vertex colors, optionally propagating the operation to my children.
     void setUseVertexColors(const bool a_useColors, const bool a_affectChildren=true);
 
@@ -382,6 +451,9 @@ class cGenericObject : public cGenericType
     //! Delete any existing collision detector and set the current cd to null (no collisions).
     void deleteCollisionDetector(const bool a_affectChildren = false);
 
+    //! Update the collision detector to the current vertex positions, rebuilding it if it has degraded too much.
+    void refitCollisionDetector(double a_maxDegradation = 0, const bool a_affectChildren = false);
+
     //! Compute collision detection using collision trees
     bool computeCollisionDetection(cVector3d& a_segmentPointA,
                                    cVector3d& a_segmentPointB,
@@ -661,6 +733,30 @@ class cGenericObject : public cGenericType
     */
     bool m_cullingEnabled;
 
+    /*!
+        If \b true, this object and its children are not rendered when their
+        boundary box lies outside the view frustum. The boundary box must
+        be kept up to date with computeBoundaryBox(), including children.
+    */
+    bool m_useFrustumCulling;
+
+    /*!
+        If \b true, the boundary box of this object is tested against the
+        depth buffer with an occlusion query before the object is rendered.
+        If no part of it was visible, the object and its children are not
+        rendered in the next frame.
+    */
+    bool m_useOcclusionCulling;
+
+    //! Occlusion query of the boundary box.
+    cOcclusionQuery m_occlusionQuery;
+
+    //! If \b true, the boundary box was hidden when last tested.
+    bool m_occluded;
+
+    //! What was drawn and culled since the statistics were last cleared.
+    static cRenderStatistics m_renderStatistics;
+
 
 	//-----------------------------------------------------------------------
     // MEMBERS - COLLISION DETECTION:
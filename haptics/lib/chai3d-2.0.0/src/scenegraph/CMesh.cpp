@@ -27,9 +27,10 @@
 #include "collisions/CCollisionBrute.h"
 #include "collisions/CCollisionAABB.h"
 #include "collisions/CCollisionSpheres.h"
+#include "collisions/CCollisionBVH.h"
 #include "files/CMeshLoader.h"
 #include <algorithm>
-#include <set>
+#include <string.h>
 //---------------------------------------------------------------------------
 
 //===========================================================================
@@ -75,6 +76,9 @@ cMesh::cMesh(cWorld* a_world)
 
     // Vertex array disabled by default
     m_useVertexArrays = false;
+
+    // Vertex buffer disabled by default
+    m_useVertexBuffer = false;
 }
 
 
@@ -456,6 +460,68 @@ void cMesh::useVertexArrays(const bool a_useVertexArrays, const bool a_affectChi
 }
 
 
+//===========================================================================
+/*!
+     This enables the use of vertex buffer objects for mesh rendering. The
+     vertices and triangles are kept in OpenGL buffers (see cVertexBuffer),
+     so that static meshes are not sent to the graphics card again on every
+     frame, and meshes that change only have their modified vertices sent
+     again. This takes precedence over display lists and vertex arrays; if
+     the graphics card does not support vertex buffer objects, vertex arrays
+     are used instead.
+
+     Changes made by cMesh itself (to colors, normals, positions or
+     triangles) are tracked automatically. If you modify vertices directly,
+     call invalidateVertices() for the modified span, or
+     invalidateDisplayList() to send the whole mesh again.
+
+     \fn       void cMesh::useVertexBuffer(const bool a_useVertexBuffer,
+                                           const bool a_affectChildren)
+     \param    a_useVertexBuffer  If \b true, this mesh will be rendered from vertex buffer objects
+     \param    a_affectChildren  If \b true, then children also modified.
+*/
+//===========================================================================
+void cMesh::useVertexBuffer(const bool a_useVertexBuffer, const bool a_affectChildren)
+{
+    // update changes to object
+    m_useVertexBuffer = a_useVertexBuffer;
+
+    // propagate changes to children
+    if (a_affectChildren)
+    {
+        unsigned int i, numItems;
+        numItems = m_children.size();
+        for (i=0; i<numItems; i++)
+        {
+            cGenericObject *nextObject = m_children[i];
+
+            cMesh *nextMesh = dynamic_cast<cMesh*>(nextObject);
+            if (nextMesh)
+            {
+                nextMesh->useVertexBuffer(a_useVertexBuffer, a_affectChildren);
+            }
+        }
+    }
+}
+
+
+//===========================================================================
+/*!
+     Mark a span of my vertices as modified, so that the next rendering
+     from the vertex buffer sends them to the graphics card again.
+
+     \fn       void cMesh::invalidateVertices(const unsigned int a_firstIndex,
+                                              const unsigned int a_numVertices)
+     \param    a_firstIndex  Index of the first modified vertex.
+     \param    a_numVertices  Number of modified vertices.
+*/
+//===========================================================================
+void cMesh::invalidateVertices(const unsigned int a_firstIndex, const unsigned int a_numVertices)
+{
+    m_vertexBuffer.invalidateVertices(a_firstIndex, a_numVertices);
+}
+
+
 //===========================================================================
 /*!
      Returns the number of triangles contained in this mesh, optionally
@@ -628,6 +694,9 @@ unsigned int cMesh::newTriangle(const unsigned int a_indexVertex0, const unsigne
     (*vertex_vector)[a_indexVertex2].m_allocated = true;
     (*vertex_vector)[a_indexVertex2].m_nTriangles++;
 
+    // the vertex buffer must render the new triangle
+    m_vertexBuffer.invalidateIndices();
+
     /*
     m_vertices[a_indexVertex0].m_allocated = true;
     m_vertices[a_indexVertex0].m_nTriangles++;
@@ -697,6 +766,9 @@ bool cMesh::removeTriangle(const unsigned int a_index)
     // add triangle to free list
     m_freeTriangles.push_back(a_index);
 
+    // the vertex buffer must stop rendering it
+    m_vertexBuffer.invalidateIndices();
+
     // return success
     return (true);
 }
@@ -720,6 +792,9 @@ void cMesh::clear()
     // clear free lists
     m_freeTriangles.clear();
     m_freeVertices.clear();
+
+    // empty the vertex buffer
+    m_vertexBuffer.invalidate();
 }
 
 
@@ -806,6 +881,9 @@ void cMesh::computeAllNormals(const bool a_affectChildren)
 
             curtri++;
         }
+
+        // send the new normals to the vertex buffer
+        invalidateVertices(0, nvertices);
     }
 
     // optionally propagate changes to children
@@ -919,6 +997,7 @@ void cMesh::setTransparencyLevel(const float a_level, const bool a_applyToTextur
     {
         m_vertices[i].m_color.setA(level);
     }
+    invalidateVertices(0, numItems);
 
     // apply changes to texture if required
     if (a_applyToTextures && (m_texture != NULL))
@@ -958,6 +1037,7 @@ void cMesh::setVertexColor(const cColorf& a_color, const bool a_affectChildren)
     {
         m_vertices[i].m_color = a_color;
     }
+    invalidateVertices(0, numItems);
 
     // update changes to children
     if (a_affectChildren)
@@ -1001,6 +1081,7 @@ void cMesh::offsetVertices(const cVector3d& a_offset, const bool a_affectChildre
     {
         m_vertices[i].m_localPos.add(a_offset);
     }
+    invalidateVertices(0, vertexcount);
 
     m_boundaryBoxMin+=a_offset;
     m_boundaryBoxMax+=a_offset;
@@ -1046,6 +1127,7 @@ void cMesh::extrude(const double a_extrudeDistance, const bool a_affectChildren,
     {
         m_vertices[i].m_localPos.add(cMul(a_extrudeDistance,m_vertices[i].m_normal));
     }
+    invalidateVertices(0, vertexcount);
 
     // This is an O(N) operation, as is the extrusion, so it seems okay to call
     // this by default...
@@ -1093,6 +1175,7 @@ void cMesh::reverseAllNormals(const bool a_affectChildren)
 		{
 			vertex_array[i].m_normal.mul(-1.0);
 		}
+		invalidateVertices(0, vertexcount);
 	}
 
 	// propagate changes to my children
@@ -1112,60 +1195,138 @@ void cMesh::reverseAllNormals(const bool a_affectChildren)
 }
 
 
+//---------------------------------------------------------------------------
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+//---------------------------------------------------------------------------
+//! Number of values compared by weldVertices() for each vertex.
+#define CHAI_MESH_WELD_KEY_SIZE     13
+//---------------------------------------------------------------------------
+
 //---------------------------------------------------------------------------
 /*!
-	A function to put a triangle in vertex-sorted order, used for removing
-	redundant triangles.
+    Return the size of an open addressing hash table holding up to
+    a_numItems items: a power of two, at least twice as large.
 */
 //---------------------------------------------------------------------------
-inline void sort_triangle(cTriangle& t)
+static unsigned int cHashTableSize(const unsigned int a_numItems)
 {
-  register unsigned int tmp;
-  if (t.m_indexVertex0 > t.m_indexVertex1)
-    { tmp = t.m_indexVertex1; t.m_indexVertex1 = t.m_indexVertex0; t.m_indexVertex0 = tmp; }
-  if (t.m_indexVertex1 > t.m_indexVertex2)
-    { tmp = t.m_indexVertex2; t.m_indexVertex2 = t.m_indexVertex1; t.m_indexVertex1 = tmp; }
-  else return;
-  if (t.m_indexVertex0 > t.m_indexVertex1)
-    { tmp = t.m_indexVertex1; t.m_indexVertex1 = t.m_indexVertex0; t.m_indexVertex0 = tmp; }
+    unsigned int size = 16;
+    while (size < 2 * a_numItems) { size *= 2; }
+    return (size);
 }
 
 
-#ifndef DOXYGEN_SHOULD_SKIP_THIS
 //---------------------------------------------------------------------------
 /*!
-	A comparator for sorting triangles, used for removing redundant
-	triangles.
+    Mix a 32-bit word into a hash value.
 */
 //---------------------------------------------------------------------------
-struct lt_ctriangle
+static inline unsigned int cHashWord(unsigned int a_hash, const unsigned int a_word)
 {
-	inline bool operator()(const cTriangle& in_t1, const cTriangle& in_t2)
-	{
-		// Sort both triangles so we're comparing them in vertex-sorted order
-		cTriangle t1 = in_t1;
-		sort_triangle(t1);
-
-		cTriangle t2 = in_t2;
-		sort_triangle(t2);
-
-		// Do the comparison
-		if      (t1.m_indexVertex0 < t2.m_indexVertex0) return true;
-		else if (t1.m_indexVertex0 > t2.m_indexVertex0) return false;
-		else if (t1.m_indexVertex1 < t2.m_indexVertex1) return true;
-		else if (t1.m_indexVertex1 > t2.m_indexVertex1) return false;
-		else if (t1.m_indexVertex2 < t2.m_indexVertex2) return true;
-		return false;
-	}
-};
+    a_hash = (a_hash ^ a_word) * 0x9E3779B1u;
+    return (a_hash ^ (a_hash >> 15));
+}
+
+
+//---------------------------------------------------------------------------
+/*!
+    Fill a_key with the values that must match for two vertices to be
+    welded, and return their hash.
+*/
+//---------------------------------------------------------------------------
+static unsigned int cVertexWeldKey(const cVertex& a_vertex, double* a_key)
+{
+    a_key[0]  = a_vertex.m_localPos.x;
+    a_key[1]  = a_vertex.m_localPos.y;
+    a_key[2]  = a_vertex.m_localPos.z;
+    a_key[3]  = a_vertex.m_normal.x;
+    a_key[4]  = a_vertex.m_normal.y;
+    a_key[5]  = a_vertex.m_normal.z;
+    a_key[6]  = a_vertex.m_texCoord.x;
+    a_key[7]  = a_vertex.m_texCoord.y;
+    a_key[8]  = a_vertex.m_texCoord.z;
+    a_key[9]  = a_vertex.m_color.getR();
+    a_key[10] = a_vertex.m_color.getG();
+    a_key[11] = a_vertex.m_color.getB();
+    a_key[12] = a_vertex.m_color.getA();
+
+    unsigned int hash = 0;
+    for (int i=0; i<CHAI_MESH_WELD_KEY_SIZE; i++)
+    {
+        // adding zero turns -0 into +0, which compares equal to it
+        a_key[i] += 0.0;
+
+        unsigned int words[2];
+        memcpy(words, &a_key[i], sizeof(words));
+        hash = cHashWord(cHashWord(hash, words[0]), words[1]);
+    }
+    return (hash);
+}
+
+
+//---------------------------------------------------------------------------
+/*!
+    Return the index of the vertex a_index was welded to (0 for a vertex
+    that was dropped, which only unallocated triangles can refer to).
+*/
+//---------------------------------------------------------------------------
+static inline unsigned int cWeldedIndex(const vector<int>& a_newIndex,
+                                        const unsigned int a_index)
+{
+    if ((a_index >= a_newIndex.size()) || (a_newIndex[a_index] < 0)) { return (0); }
+    return (a_newIndex[a_index]);
+}
+
+
+//---------------------------------------------------------------------------
+/*!
+    Point the neighbor lists of a_triangles, which pointed into an array of
+    a_numOldTriangles triangles starting at a_oldFirst, to the new positions
+    of these triangles in a_triangles. Neighbors that were removed
+    (new index < 0) are dropped from the lists.
+*/
+//---------------------------------------------------------------------------
+static void cRemapNeighbors(vector<cTriangle>& a_triangles,
+                            const cTriangle* a_oldFirst,
+                            const unsigned int a_numOldTriangles,
+                            const vector<int>& a_newIndex)
+{
+    const cTriangle* oldLast = a_oldFirst + a_numOldTriangles;
+    for (unsigned int i=0; i<a_triangles.size(); i++)
+    {
+        std::vector<cTriangle*>* neighbors = a_triangles[i].m_neighbors;
+        if (neighbors == NULL) { continue; }
+
+        unsigned int numKept = 0;
+        for (unsigned int j=0; j<neighbors->size(); j++)
+        {
+            cTriangle* neighbor = (*neighbors)[j];
+            if ((neighbor >= a_oldFirst) && (neighbor < oldLast))
+            {
+                int index = a_newIndex[neighbor - a_oldFirst];
+                if (index < 0) { continue; }
+                neighbor = &a_triangles[index];
+            }
+            (*neighbors)[numKept++] = neighbor;
+        }
+        neighbors->resize(numKept);
+    }
+}
+//---------------------------------------------------------------------------
 #endif // DOXYGEN_SHOULD_SKIP_THIS
+//---------------------------------------------------------------------------
 
 
 //===========================================================================
 /*!
 	Remove redundant triangles from this model.  Does not use vertex positions
 	at all, just removed triangles with redundant indices and obviously-
-	degenerate triangles.
+	degenerate triangles. \n
+
+    The first of each set of triangles with the same three vertices is
+    kept (whatever their winding), and the remaining triangles keep their
+    order. Unallocated triangles are removed too, so the free list of
+    triangles is empty afterwards.
 
 	\fn        void cMesh::removeRedundantTriangles(bool a_affectChildren=0);
 	\param     a_affectChildren  If \b true, children are also modified.
@@ -1174,43 +1335,427 @@ struct lt_ctriangle
 void cMesh::removeRedundantTriangles(const bool a_affectChildren)
 {
     // remove redundant triangles from this mesh
-
-    // move everything from a vector into a set, sorted by triangles,
-    // and remove degenerate triangles.
-    std::set<cTriangle,lt_ctriangle> sorted_tris;
     unsigned int ntris = m_triangles.size();
-        unsigned int i;
-    for(i=0; i<ntris; i++) 
+    unsigned int i;
+    if (ntris > 0)
     {
-        cTriangle t = m_triangles[i];
+        // hash table of the triangles kept so far, by their sorted vertices
+        unsigned int tableSize = cHashTableSize(ntris);
+        vector<int> table(tableSize, -1);
+        vector<int> newIndex(ntris, -1);
+        unsigned int numKept = 0;
+
+        for(i=0; i<ntris; i++) 
+        {
+            cTriangle& t = m_triangles[i];
+            if (t.m_allocated == false)
+            {
+                // a kept triangle may be moved over this one, so its neighbor list goes now
+                delete t.m_neighbors;
+                t.m_neighbors = NULL;
+                continue;
+            }
+
+            // put the vertices in sorted order
+            unsigned int v0 = t.m_indexVertex0;
+            unsigned int v1 = t.m_indexVertex1;
+            unsigned int v2 = t.m_indexVertex2;
+            unsigned int tmp;
+            if (v0 > v1) { tmp = v0; v0 = v1; v1 = tmp; }
+            if (v1 > v2) { tmp = v1; v1 = v2; v2 = tmp; }
+            if (v0 > v1) { tmp = v0; v0 = v1; v1 = tmp; }
+
+            // look for a triangle with the same vertices
+            bool redundant = ((v0 == v1) || (v1 == v2));
+            unsigned int slot = cHashWord(cHashWord(cHashWord(0, v0), v1), v2) & (tableSize-1);
+            while (!redundant && (table[slot] >= 0))
+            {
+                const cTriangle& k = m_triangles[table[slot]];
+                unsigned int k0 = k.m_indexVertex0;
+                unsigned int k1 = k.m_indexVertex1;
+                unsigned int k2 = k.m_indexVertex2;
+                if (k0 > k1) { tmp = k0; k0 = k1; k1 = tmp; }
+                if (k1 > k2) { tmp = k1; k1 = k2; k2 = tmp; }
+                if (k0 > k1) { tmp = k0; k0 = k1; k1 = tmp; }
+
+                redundant = ((k0 == v0) && (k1 == v1) && (k2 == v2));
+                slot = (slot + 1) & (tableSize-1);
+            }
+
+            // remove degenerate and redundant triangles
+            if (redundant)
+            {
+                m_vertices[t.m_indexVertex0].m_nTriangles--;
+                m_vertices[t.m_indexVertex1].m_nTriangles--;
+                m_vertices[t.m_indexVertex2].m_nTriangles--;
+                delete t.m_neighbors;
+                t.m_neighbors = NULL;
+                continue;
+            }
 
-        // Remove degenerate triangles
-        if (
-        t.m_indexVertex0 == t.m_indexVertex1 ||
-        t.m_indexVertex0 == t.m_indexVertex2 ||
-        t.m_indexVertex1 == t.m_indexVertex2)
-        continue;
+            // move the triangle down to its new place
+            table[slot] = numKept;
+            newIndex[i] = numKept;
+            if (numKept != i)
+            {
+                m_triangles[numKept] = t;
+                m_triangles[numKept].m_index = numKept;
+
+                // the destructor of a triangle clears its neighbor list, which is now the moved triangle's
+                t.m_neighbors = NULL;
+            }
+            numKept++;
+        }
+
+        const cTriangle* first = &m_triangles[0];
+        m_triangles.resize(numKept);
+        m_freeTriangles.clear();
+        cRemapNeighbors(m_triangles, first, ntris, newIndex);
 
-        // Put this triangle in the sorted list
-        sorted_tris.insert(t);
+        // the vertex buffer must render the remaining triangles
+        m_vertexBuffer.invalidateIndices();
     }
 
-    // clear the vector
-    m_triangles.clear();
+    // propagate changes to my children
+    if (a_affectChildren==false) return;
+
+    for (i=0; i<m_children.size(); i++)
+    {
+        cGenericObject *nextObject = m_children[i];
+        cMesh *nextMesh = dynamic_cast<cMesh*>(nextObject);
+        if (nextMesh)
+        {
+            nextMesh->removeRedundantTriangles(true);
+        }
+    }
+}
+
+
+//===========================================================================
+/*!
+    Merge the vertices that have the same position, normal, texture
+    coordinate and color, and point the triangles to the vertices that
+    remain. Vertices keep the order of their first copy; vertices on the
+    free list are removed, so the free list is empty afterwards. \n
+
+    Collision detectors refer to the vertices of the triangles, so they
+    must be created after the vertices are welded.
+
+    \fn        void cMesh::weldVertices(const bool a_affectChildren)
+    \param     a_affectChildren  If \b true, children are also modified.
+*/
+//===========================================================================
+void cMesh::weldVertices(const bool a_affectChildren)
+{
+    unsigned int numVertices = m_vertices.size();
+    unsigned int i;
+    if (numVertices > 0)
+    {
+        // vertices on the free list are dropped
+        vector<bool> isFree(numVertices, false);
+        list<unsigned int>::iterator it;
+        for (it = m_freeVertices.begin(); it != m_freeVertices.end(); it++)
+        {
+            isFree[*it] = true;
+        }
+
+        // hash table of the distinct vertices, by their index in the new array
+        unsigned int tableSize = cHashTableSize(numVertices);
+        vector<int> table(tableSize, -1);
+        vector<int> newIndex(numVertices, -1);
+        vector<cVertex> vertices;
+        vector<double> keys;
+        vertices.reserve(numVertices);
+        keys.reserve(numVertices * CHAI_MESH_WELD_KEY_SIZE);
+
+        double key[CHAI_MESH_WELD_KEY_SIZE];
+        for (i=0; i<numVertices; i++)
+        {
+            if (isFree[i]) { continue; }
+
+            // look for a vertex with the same values
+            unsigned int slot = cVertexWeldKey(m_vertices[i], key) & (tableSize-1);
+            while (table[slot] >= 0)
+            {
+                const double* other = &keys[table[slot] * CHAI_MESH_WELD_KEY_SIZE];
+                int j = 0;
+                while ((j < CHAI_MESH_WELD_KEY_SIZE) && (other[j] == key[j])) { j++; }
+                if (j == CHAI_MESH_WELD_KEY_SIZE) { break; }
+                slot = (slot + 1) & (tableSize-1);
+            }
+
+            // keep the first copy of each vertex
+            if (table[slot] < 0)
+            {
+                table[slot] = vertices.size();
+                vertices.push_back(m_vertices[i]);
+                vertices.back().m_index = table[slot];
+                vertices.back().m_nTriangles = 0;
+                keys.insert(keys.end(), key, key + CHAI_MESH_WELD_KEY_SIZE);
+            }
+            else if (m_vertices[i].m_allocated)
+            {
+                vertices[table[slot]].m_allocated = true;
+            }
+            newIndex[i] = table[slot];
+        }
+
+        // point the triangles to the remaining vertices
+        for (i=0; i<m_triangles.size(); i++)
+        {
+            cTriangle& t = m_triangles[i];
+            t.m_indexVertex0 = cWeldedIndex(newIndex, t.m_indexVertex0);
+            t.m_indexVertex1 = cWeldedIndex(newIndex, t.m_indexVertex1);
+            t.m_indexVertex2 = cWeldedIndex(newIndex, t.m_indexVertex2);
+            if (t.m_allocated)
+            {
+                vertices[t.m_indexVertex0].m_nTriangles++;
+                vertices[t.m_indexVertex1].m_nTriangles++;
+                vertices[t.m_indexVertex2].m_nTriangles++;
+            }
+        }
+
+        // keep only the memory the remaining vertices need
+        vector<cVertex>(vertices.begin(), vertices.end()).swap(m_vertices);
+        m_freeVertices.clear();
 
-    // move everything back from the set to the vector
-    ntris = sorted_tris.size();
+        // upload all vertices and triangles again
+        invalidateDisplayList(false);
+    }
+
+    // propagate changes to my children
+    if (a_affectChildren==false) return;
 
-    std::set<cTriangle,lt_ctriangle>::iterator iter = sorted_tris.begin();
-    std::set<cTriangle,lt_ctriangle>::iterator end = sorted_tris.end();
-    while(iter != end) 
+    for (i=0; i<m_children.size(); i++)
     {
-        m_triangles.push_back(*iter);
-        iter++;
+        cGenericObject *nextObject = m_children[i];
+        cMesh *nextMesh = dynamic_cast<cMesh*>(nextObject);
+        if (nextMesh)
+        {
+            nextMesh->weldVertices(true);
+        }
     }
+}
+
+
+//===========================================================================
+/*!
+    Reorder the triangles so that consecutive triangles share vertices
+    that are still in the vertex cache of the graphics card, then number
+    the vertices in the order the triangles first use them, so that
+    rendering and collision detection read the vertex array in order. \n
+
+    The triangles are ordered with Tipsify (Sander, Nehab and Barczak,
+    "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw",
+    2007) for a cache of CHAI_MESH_VERTEX_CACHE_SIZE vertices: it fans
+    around a vertex, then moves to the vertex used by those triangles that
+    will still be in the cache once its own triangles are drawn. Unused
+    vertices and unallocated triangles are moved to the end of their
+    arrays, and the free lists are updated. \n
+
+    Collision detectors point to the triangles, so they must be created
+    after the triangles are reordered.
+
+    \fn        void cMesh::optimizeTriangleOrder(const bool a_affectChildren)
+    \param     a_affectChildren  If \b true, children are also modified.
+*/
+//===========================================================================
+void cMesh::optimizeTriangleOrder(const bool a_affectChildren)
+{
+    unsigned int numVertices = m_vertices.size();
+    unsigned int numTriangles = m_triangles.size();
+    unsigned int i, j, k;
+    if ((numVertices > 0) && (numTriangles > 0))
+    {
+        // list the triangles around each vertex
+        vector<unsigned int> firstAdjacent(numVertices+1, 0);
+        for (i=0; i<numTriangles; i++)
+        {
+            const cTriangle& t = m_triangles[i];
+            if (t.m_allocated == false) { continue; }
+            firstAdjacent[t.m_indexVertex0+1]++;
+            firstAdjacent[t.m_indexVertex1+1]++;
+            firstAdjacent[t.m_indexVertex2+1]++;
+        }
+        for (i=0; i<numVertices; i++)
+        {
+            firstAdjacent[i+1] += firstAdjacent[i];
+        }
+
+        vector<unsigned int> adjacent(firstAdjacent[numVertices]);
+        vector<unsigned int> nextAdjacent(firstAdjacent.begin(), firstAdjacent.end()-1);
+        for (i=0; i<numTriangles; i++)
+        {
+            const cTriangle& t = m_triangles[i];
+            if (t.m_allocated == false) { continue; }
+            adjacent[nextAdjacent[t.m_indexVertex0]++] = i;
+            adjacent[nextAdjacent[t.m_indexVertex1]++] = i;
+            adjacent[nextAdjacent[t.m_indexVertex2]++] = i;
+        }
+
+        // number of triangles left to emit around each vertex
+        vector<int> live(numVertices);
+        for (i=0; i<numVertices; i++)
+        {
+            live[i] = firstAdjacent[i+1] - firstAdjacent[i];
+        }
+
+        // time at which each vertex last entered the cache
+        const int cacheSize = CHAI_MESH_VERTEX_CACHE_SIZE;
+        vector<int> cacheTime(numVertices, 0);
+        int time = cacheSize + 1;
 
-    // clear the set before recursing
-    sorted_tris.clear();
+        vector<bool> emitted(numTriangles, false);
+        vector<unsigned int> order;
+        vector<unsigned int> deadEnd;
+        vector<unsigned int> candidates;
+        order.reserve(numTriangles);
+
+        // start from the first vertex that has triangles
+        unsigned int cursor = 0;
+        while ((cursor < numVertices) && (live[cursor] == 0)) { cursor++; }
+        int fanning = (cursor < numVertices) ? (int)cursor : -1;
+
+        while (fanning >= 0)
+        {
+            // emit the triangles around the fanning vertex
+            candidates.clear();
+            for (j=firstAdjacent[fanning]; j<firstAdjacent[fanning+1]; j++)
+            {
+                unsigned int index = adjacent[j];
+                if (emitted[index]) { continue; }
+                emitted[index] = true;
+                order.push_back(index);
+
+                const cTriangle& t = m_triangles[index];
+                unsigned int v[3] = { t.m_indexVertex0, t.m_indexVertex1, t.m_indexVertex2 };
+                for (k=0; k<3; k++)
+                {
+                    deadEnd.push_back(v[k]);
+                    candidates.push_back(v[k]);
+                    live[v[k]]--;
+                    if (time - cacheTime[v[k]] > cacheSize)
+                    {
+                        cacheTime[v[k]] = time;
+                        time++;
+                    }
+                }
+            }
+
+            // fan next around the candidate that will still be in the cache
+            // after its triangles are emitted, and that entered it first
+            int best = -1;
+            int bestPriority = -1;
+            for (j=0; j<candidates.size(); j++)
+            {
+                unsigned int v = candidates[j];
+                if (live[v] <= 0) { continue; }
+
+                int priority = 0;
+                if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                {
+                    priority = time - cacheTime[v];
+                }
+                if (priority > bestPriority)
+                {
+                    best = v;
+                    bestPriority = priority;
+                }
+            }
+
+            // at a dead end, go back to a recently used vertex, or else to
+            // the next vertex in the array that still has triangles
+            while ((best < 0) && (deadEnd.size() > 0))
+            {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) { best = v; }
+            }
+            while ((best < 0) && (cursor < numVertices))
+            {
+                if (live[cursor] > 0) { best = cursor; }
+                else { cursor++; }
+            }
+            fanning = best;
+        }
+
+        // number the vertices in the order the triangles use them
+        vector<int> newVertexIndex(numVertices, -1);
+        unsigned int numUsed = 0;
+        for (i=0; i<order.size(); i++)
+        {
+            const cTriangle& t = m_triangles[order[i]];
+            unsigned int v[3] = { t.m_indexVertex0, t.m_indexVertex1, t.m_indexVertex2 };
+            for (k=0; k<3; k++)
+            {
+                if (newVertexIndex[v[k]] < 0) { newVertexIndex[v[k]] = numUsed++; }
+            }
+        }
+        for (i=0; i<numVertices; i++)
+        {
+            if (newVertexIndex[i] < 0) { newVertexIndex[i] = numUsed++; }
+        }
+
+        // unallocated triangles go after the others
+        vector<int> newTriangleIndex(numTriangles, -1);
+        for (i=0; i<order.size(); i++)
+        {
+            newTriangleIndex[order[i]] = i;
+        }
+        for (i=0; i<numTriangles; i++)
+        {
+            if (newTriangleIndex[i] < 0)
+            {
+                newTriangleIndex[i] = order.size();
+                order.push_back(i);
+            }
+        }
+
+        // move the vertices
+        vector<cVertex> vertices(numVertices);
+        for (i=0; i<numVertices; i++)
+        {
+            vertices[newVertexIndex[i]] = m_vertices[i];
+            vertices[newVertexIndex[i]].m_index = newVertexIndex[i];
+        }
+        m_vertices.swap(vertices);
+
+        // move the triangles
+        vector<cTriangle> triangles;
+        triangles.reserve(numTriangles);
+        for (i=0; i<numTriangles; i++)
+        {
+            triangles.push_back(m_triangles[order[i]]);
+            cTriangle& t = triangles.back();
+            t.m_indexVertex0 = newVertexIndex[t.m_indexVertex0];
+            t.m_indexVertex1 = newVertexIndex[t.m_indexVertex1];
+            t.m_indexVertex2 = newVertexIndex[t.m_indexVertex2];
+            t.m_index = i;
+        }
+        m_triangles.swap(triangles);
+        cRemapNeighbors(m_triangles, &triangles[0], numTriangles, newTriangleIndex);
+
+        // the destructor of a triangle clears its neighbor list, which the
+        // old copies share with the new ones
+        for (i=0; i<numTriangles; i++)
+        {
+            triangles[i].m_neighbors = NULL;
+        }
+
+        // update the free lists
+        list<unsigned int>::iterator it;
+        for (it = m_freeVertices.begin(); it != m_freeVertices.end(); it++)
+        {
+            *it = newVertexIndex[*it];
+        }
+        for (it = m_freeTriangles.begin(); it != m_freeTriangles.end(); it++)
+        {
+            *it = newTriangleIndex[*it];
+        }
+
+        // upload all vertices and triangles again
+        invalidateDisplayList(false);
+    }
 
     // propagate changes to my children
     if (a_affectChildren==false) return;
@@ -1221,7 +1766,7 @@ void cMesh::removeRedundantTriangles(const bool a_affectChildren)
         cMesh *nextMesh = dynamic_cast<cMesh*>(nextObject);
         if (nextMesh)
         {
-            nextMesh->removeRedundantTriangles(true);
+            nextMesh->optimizeTriangleOrder(true);
         }
     }
 }
@@ -1394,169 +1939,13 @@ void cMesh::scaleObject(const cVector3d& a_scaleFactors)
         m_vertices[i].m_normal.elementMul(a_scaleFactors);
         m_vertices[i].m_normal.normalize();
     }
+    invalidateVertices(0, numItems);
 
     m_boundaryBoxMax.elementMul(a_scaleFactors);
     m_boundaryBoxMin.elementMul(a_scaleFactors);
 }
 
 
-//===========================================================================
-/*!
-     Sorting functions to help in the findNeighbors method
-
-     \fn       bool TriangleSort0(const cTriangle* t1, const cTriangle* t2)
-     \param    t1  First triangle.
-     \param    t2  Second triangle.
-     \return   Return whether the x-coordinate of vertex X of the
-                   first triangle is less than that of the second triangle.
-*/
-//===========================================================================
-bool TriangleSort0(const cTriangle* t1, const cTriangle* t2)
-{
-    return (t1->getVertex0()->getPos().x < t2->getVertex0()->getPos().x);
-}
-
-
-//===========================================================================
-/*!
-    Sorting functions to help in the findNeighbors method
-
-    \fn       bool TriangleSort1(const cTriangle* t1, const cTriangle* t2)
-    \param    t1  First triangle.
-    \param    t2  Second triangle.
-    \return   Return whether the x-coordinate of vertex X of the
-    first triangle is less than that of the second triangle.
-*/
-//===========================================================================
-bool TriangleSort1(const cTriangle* t1, const cTriangle* t2)
-{
-    return (t1->getVertex1()->getPos().x < t2->getVertex1()->getPos().x);
-}
-
-
-//===========================================================================
-/*!
-    Sorting functions to help in the findNeighbors method
-
-    \fn       bool TriangleSort2(const cTriangle* t1, const cTriangle* t2)
-    \param    t1  First triangle.
-    \param    t2  Second triangle.
-    \return   Return whether the x-coordinate of vertex X of the
-    first triangle is less than that of the second triangle.
-*/
-//===========================================================================
-bool TriangleSort2(const cTriangle* t1, const cTriangle* t2)
-{
-    return (t1->getVertex2()->getPos().x < t2->getVertex2()->getPos().x);
-}
-
-
-//===========================================================================
-/*!
-    Find pairs of neighboring triangles that share specific vertices,
-    given vectors of those triangles sorted by the x-coordinates of those vertices
-    (first, second, or third), using a merge join.  We define two triangles to
-    be neighbors if and only if they have a common vertex (within some distance
-    tolerance).  In this function, we are only concerned about matching triangles
-    whose vertex v1 in search1 is shared (within tolerance) with vertex v2 in
-    search2; this function should be called once for each possible combination
-    (order doesn't matter) of v1=0..2 and v2=0..2 to find all neighbors.  Two
-    shared vertices must have equal x-coordinates (within tolerance), which allows
-    us to check for matches using a merge join on lists sorted by x-coordinate.
-    (Using y-coordinates or z-coordinates would have been equally valid.)
-
-     \fn       void cMesh::findNeighbors(std::vector<cTriangle*>* search1,
-                            std::vector<cTriangle*>* search2, const int& v1, const int& v2)
-     \param    search1   First vector of triangles, sorted by x-coords of some vertex.
-     \param    search2   Second vector of triangles, sorted by x-coords of some vertex.
-     \param    v1        Which vertex the first vector is sorted by (0, 1, or 2).
-     \param    v2        Which vertex the second vector is sorted by (0, 1, or 2).
-*/
-//===========================================================================
-void cMesh::findNeighbors(std::vector<cTriangle*>* search1,
-                             std::vector<cTriangle*>* search2, const int& v1, const int& v2)
-{
-    unsigned int i = 0;
-    unsigned int j = 0;
-
-        // In this loop, we want to find triangles from search1 that have vertex #v1
-        // (v1 = 0, 1, or 2) equal to vertex #v2 (v2 = 0, 1, or 2) of a triangle from
-        // search2.  Since both lists are sorted, we use a merge join.
-    while ((i < search1->size()) && (j < search2->size()))
-    {
-      // If the x coordinate of vertex #v1 of triangle #i in search1 is the same as
-            // the x-coordinate of vertex #v2 of triangle #j in search2 (matching x-
-            // coordinates is a necessary but not sufficient condition that the vertices
-            // are shared)...
-      if (fabs( (*search1)[i]->getVertex(v1)->getPos().x -
-                (*search2)[j]->getVertex(v2)->getPos().x) < 0.0000001)
-      {
-                // Keep matching triangles from search1 with triangle #j in search2 as
-                // long as the specified vertices' x-coordinates are shared.
-        while ((i<search1->size()) &&
-               (fabs( (*search1)[i]->getVertex(v1)->getPos().x -
-                      (*search2)[j]->getVertex(v2)->getPos().x) < 0.0000001))
-        {
-          unsigned int jj = j;
-
-                    // Keep matching triangles from search2 with triangle #i in search1 as
-                    // long as the specified vertices' x-coordinates are shared.
-          while ((jj<search2->size()) &&
-                 (fabs( (*search1)[i]->getVertex(v1)->getPos().x -
-                        (*search2)[jj]->getVertex(v2)->getPos().x) < 0.0000001))
-          {
-                        // If vertex #v1 of triangle #i in search1 is in fact equal (in x, y, and
-                        // z coordinates) to vertex #v2 of triangle #jj in search2, we have
-                        // found a pair of neighbors.
-            if (((*search1)[i] != (*search2)[jj]) &&
-                (cEqualPoints((*search1)[i]->getVertex(v1)->getPos(),
-                             (*search2)[jj]->getVertex(v2)->getPos())))
-            {
-              bool found = false;
-              unsigned int ii;
-
-                            // Check if triangle #jj from search2 has already been inserted into
-                            // the neighbors list for triangle #i from search1.
-              for (ii=0; (!found) && (ii<(*search1)[i]->m_neighbors->size()); ii++)
-                if ((*((*search1)[i]->m_neighbors))[ii] == (*search2)[jj])
-                  found = true;
-
-                            // If not, add it now.
-              if (!found)
-                (*search1)[i]->m_neighbors->push_back((*search2)[jj]);
-
-                            // Check if triangle #i from search1 has already been inserted into
-                            // the neighbors list for triangle #jj from search2.
-              found = false;
-              for (ii=0; (!found) && (ii<(*search2)[jj]->m_neighbors->size()); ii++)
-                if ((*((*search2)[jj]->m_neighbors))[ii] == (*search1)[i])
-                  found = true;
-
-                          // If not, add it now.
-              if (!found)
-                (*search2)[jj]->m_neighbors->push_back((*search1)[i]);
-            }
-            jj++;
-          }
-          i++;
-        }
-      }
-
-            // Since this is a merge join, we increment the counter for the search2 to
-            // "catch up to" search1 if the x-coordiante of vertex #v2 of triangle #j
-            // from search2 is smaller than that of vertex #v1 of triangle #i from search1...
-      else if ( (*search1)[i]->getVertex(v1)->getPos().x >
-                (*search2)[j]->getVertex(v2)->getPos().x )
-        j++;
-
-            // And vice versa.
-      else if ( (*search1)[i]->getVertex(v1)->getPos().x <
-                (*search2)[j]->getVertex(v2)->getPos().x )
-        i++;
-    }
-}
-
-
 //===========================================================================
 /*!
      Set up a Brute Force collision detector for this mesh and (optionally) its children
@@ -1608,9 +1997,72 @@ void cMesh::createBruteForceCollisionDetector(bool a_affectChildren,
 }
 
 
+//---------------------------------------------------------------------------
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+//---------------------------------------------------------------------------
+//! Size of the grid cells that createTriangleNeighborList() sorts vertices into.
+#define CHAI_MESH_NEIGHBOR_CELL_SIZE    0.000001
+//---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+/*!
+    Return the grid cell with the given coordinates (three per cell in
+    a_cells), from an open addressing hash table of the cells. If it is
+    not in the table, add it if a_add is \b true, or return -1.
+*/
+//---------------------------------------------------------------------------
+static int cFindNeighborCell(vector<int>& a_table,
+                             vector<double>& a_cells,
+                             const double* a_coords,
+                             const bool a_add)
+{
+    unsigned int hash = 0;
+    for (int i=0; i<3; i++)
+    {
+        // adding zero turns -0 into +0, which compares equal to it
+        double coord = a_coords[i] + 0.0;
+
+        unsigned int words[2];
+        memcpy(words, &coord, sizeof(words));
+        hash = cHashWord(cHashWord(hash, words[0]), words[1]);
+    }
+
+    unsigned int mask = (unsigned int)a_table.size() - 1;
+    unsigned int slot = hash & mask;
+    while (a_table[slot] >= 0)
+    {
+        const double* cell = &a_cells[3 * a_table[slot]];
+        if ((cell[0] == a_coords[0]) && (cell[1] == a_coords[1]) && (cell[2] == a_coords[2]))
+        {
+            return (a_table[slot]);
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (!a_add) { return (-1); }
+
+    int index = (int)a_cells.size() / 3;
+    a_cells.insert(a_cells.end(), a_coords, a_coords + 3);
+    a_table[slot] = index;
+    return (index);
+}
+//---------------------------------------------------------------------------
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+//---------------------------------------------------------------------------
+
+
 //===========================================================================
 /*!
-     Set up for each triangle a list of neighbor triangles
+     Set up for each triangle a list of neighbor triangles: the triangles
+     that have a vertex at the same position (within CHAI_SMALL) as one
+     of its own. Each triangle is the first of its own neighbors; the
+     others follow in the order of the mesh. \n
+
+     The triangles of each vertex are listed, and the vertices are put
+     into a hash table of grid cells, so that the vertices at the same
+     position as a vertex are found in its cell and, near the cell's
+     sides, the cells next to it. This takes time linear in the number
+     of triangles. The lists are then built in parallel (with OpenMP).
 
      \fn       void cMesh::createTriangleNeighborList(bool a_affectChildren)
      \param    a_affectChildren   Create neighborlists for children?
@@ -1618,69 +2070,160 @@ void cMesh::createBruteForceCollisionDetector(bool a_affectChildren,
 //===========================================================================
 void cMesh::createTriangleNeighborList(bool a_affectChildren)
 {
-    std::vector<cTriangle*>* sort0 = new std::vector<cTriangle*>;
-    unsigned int i;
-    for (i=0; i<m_triangles.size(); i++)
-      sort0->push_back(&(m_triangles[i]));
+    int numTriangles = (int)m_triangles.size();
+    unsigned int numVertices = (unsigned int)m_vertices.size();
+    unsigned int v;
+    int i;
+
+    // list the triangles of each vertex
+    vector<unsigned int> vertexFirst(numVertices + 1, 0);
+    for (i=0; i<numTriangles; i++)
+    {
+        vertexFirst[m_triangles[i].m_indexVertex0 + 1]++;
+        vertexFirst[m_triangles[i].m_indexVertex1 + 1]++;
+        vertexFirst[m_triangles[i].m_indexVertex2 + 1]++;
+    }
+    for (v=0; v<numVertices; v++)
+    {
+        vertexFirst[v+1] += vertexFirst[v];
+    }
+
+    vector<unsigned int> vertexTriangles(3 * numTriangles);
+    vector<unsigned int> next(vertexFirst.begin(), vertexFirst.end() - 1);
+    for (i=0; i<numTriangles; i++)
+    {
+        vertexTriangles[next[m_triangles[i].m_indexVertex0]++] = i;
+        vertexTriangles[next[m_triangles[i].m_indexVertex1]++] = i;
+        vertexTriangles[next[m_triangles[i].m_indexVertex2]++] = i;
+    }
 
-    std::vector<cTriangle*>* sort1 = new std::vector<cTriangle*>(*sort0);
-    std::vector<cTriangle*>* sort2 = new std::vector<cTriangle*>(*sort1);
+    // put the vertices of the triangles into grid cells
+    vector<int> table(cHashTableSize(numVertices), -1);
+    vector<double> cells;
+    vector<int> vertexCell(numVertices, -1);
+    double coords[3];
+    for (v=0; v<numVertices; v++)
+    {
+        if (vertexFirst[v] == vertexFirst[v+1]) { continue; }
 
-    // Sort each list by the appropriate vertex index
-    std::sort(sort0->begin(), sort0->end(), TriangleSort0);
-    std::sort(sort1->begin(), sort1->end(), TriangleSort1);
-    std::sort(sort2->begin(), sort2->end(), TriangleSort2);
+        const cVector3d& pos = m_vertices[v].m_localPos;
+        coords[0] = floor(pos.x / CHAI_MESH_NEIGHBOR_CELL_SIZE);
+        coords[1] = floor(pos.y / CHAI_MESH_NEIGHBOR_CELL_SIZE);
+        coords[2] = floor(pos.z / CHAI_MESH_NEIGHBOR_CELL_SIZE);
+        vertexCell[v] = cFindNeighborCell(table, cells, coords, true);
+    }
 
-    // Create neighbors for each triangle
-    for (i=0; i<m_triangles.size(); i++)
+    unsigned int numCells = (unsigned int)cells.size() / 3;
+    vector<unsigned int> cellFirst(numCells + 1, 0);
+    for (v=0; v<numVertices; v++)
     {
-      // Create the neighbor array
-      if (m_triangles[i].m_neighbors) {
-          m_triangles[i].m_neighbors->clear();
-      } else {
-          m_triangles[i].m_neighbors = new std::vector<cTriangle*>;
-      }
-      // Include each triangle as its own neighbor
-      m_triangles[i].m_neighbors->push_back(&(m_triangles[i]));
+        if (vertexCell[v] >= 0) { cellFirst[vertexCell[v] + 1]++; }
+    }
+    for (unsigned int c=0; c<numCells; c++)
+    {
+        cellFirst[c+1] += cellFirst[c];
+    }
+
+    vector<unsigned int> cellVertices(cellFirst[numCells]);
+    next.assign(cellFirst.begin(), cellFirst.end() - 1);
+    for (v=0; v<numVertices; v++)
+    {
+        if (vertexCell[v] >= 0) { cellVertices[next[vertexCell[v]]++] = v; }
     }
 
+    // find the vertices at the same position as each vertex (itself included),
+    // in the cells that are within CHAI_SMALL of it
+    vector<unsigned int> matchFirst(numVertices + 1, 0);
+    vector<unsigned int> matches;
+    matches.reserve(numVertices);
+    for (v=0; v<numVertices; v++)
+    {
+        matchFirst[v] = (unsigned int)matches.size();
+        if (vertexCell[v] < 0) { continue; }
 
-    // Find pairs of triangles for which vertex #0 of one is shared with
-    // vertex #0 of the other...
-    findNeighbors(sort0, sort0, 0, 0);
+        const cVector3d& pos = m_vertices[v].m_localPos;
+        double low[3], high[3];
+        for (int k=0; k<3; k++)
+        {
+            low[k]  = floor((pos[k] - CHAI_SMALL) / CHAI_MESH_NEIGHBOR_CELL_SIZE);
+            high[k] = floor((pos[k] + CHAI_SMALL) / CHAI_MESH_NEIGHBOR_CELL_SIZE);
+        }
 
-    // Find pairs of triangles for which vertex #0 of one is shared with
-    // vertex #1 of the other...
-    findNeighbors(sort0, sort1, 0, 1);
+        for (coords[0]=low[0]; coords[0]<=high[0]; coords[0]++)
+        for (coords[1]=low[1]; coords[1]<=high[1]; coords[1]++)
+        for (coords[2]=low[2]; coords[2]<=high[2]; coords[2]++)
+        {
+            int cell = cFindNeighborCell(table, cells, coords, false);
+            if (cell < 0) { continue; }
 
-    // Find pairs of triangles for which vertex #0 of one is shared with
-    // vertex #2 of the other...
-    findNeighbors(sort0, sort2, 0, 2);
+            for (unsigned int j=cellFirst[cell]; j<cellFirst[cell+1]; j++)
+            {
+                unsigned int u = cellVertices[j];
+                if (cEqualPoints(pos, m_vertices[u].m_localPos))
+                {
+                    matches.push_back(u);
+                }
+            }
+        }
+    }
+    matchFirst[numVertices] = (unsigned int)matches.size();
 
-    // Find pairs of triangles for which vertex #1 of one is shared with
-    // vertex #1 of the other...
-    findNeighbors(sort1, sort1, 1, 1);
+    // list the triangles around the vertices of each triangle
+    #pragma omp parallel
+    {
+        vector<unsigned int> found;
 
-    // Find pairs of triangles for which vertex #1 of one is shared with
-    // vertex #2 of the other...
-    findNeighbors(sort1, sort2, 1, 2);
+        #pragma omp for schedule(dynamic, 1024)
+        for (i=0; i<numTriangles; i++)
+        {
+            cTriangle& triangle = m_triangles[i];
+            unsigned int corners[3] = { triangle.m_indexVertex0,
+                                        triangle.m_indexVertex1,
+                                        triangle.m_indexVertex2 };
 
-    // Find pairs of triangles for which vertex #2 of one is shared with
-    // vertex #2 of the other...
-    findNeighbors(sort2, sort2, 2, 2);
+            found.clear();
+            for (int k=0; k<3; k++)
+            {
+                unsigned int corner = corners[k];
+                for (unsigned int m=matchFirst[corner]; m<matchFirst[corner+1]; m++)
+                {
+                    unsigned int u = matches[m];
+                    for (unsigned int j=vertexFirst[u]; j<vertexFirst[u+1]; j++)
+                    {
+                        if (vertexTriangles[j] != (unsigned int)i)
+                        {
+                            found.push_back(vertexTriangles[j]);
+                        }
+                    }
+                }
+            }
+            std::sort(found.begin(), found.end());
+            found.erase(std::unique(found.begin(), found.end()), found.end());
 
-    // Clean up
-    delete sort0;
-    delete sort1;
-    delete sort2;
+            // create the neighbor array, with each triangle as its own first neighbor
+            if (triangle.m_neighbors)
+            {
+                triangle.m_neighbors->clear();
+            }
+            else
+            {
+                triangle.m_neighbors = new std::vector<cTriangle*>;
+            }
+            triangle.m_neighbors->reserve(found.size() + 1);
+            triangle.m_neighbors->push_back(&triangle);
+            for (unsigned int j=0; j<found.size(); j++)
+            {
+                triangle.m_neighbors->push_back(&m_triangles[found[j]]);
+            }
+        }
+    }
 
     // update children if required
     if (a_affectChildren)
     {
-        unsigned int i;
-        for (i=0; i<m_children.size(); i++)
+        for (v=0; v<m_children.size(); v++)
         {
-            cGenericObject *nextObject = m_children[i];
+            cGenericObject *nextObject = m_children[v];
 
             cMesh *nextMesh = dynamic_cast<cMesh*>(nextObject);
             if (nextMesh)
@@ -1747,6 +2290,61 @@ void cMesh::createAABBCollisionDetector(double a_radius,
 }
 
 
+//===========================================================================
+/*!
+     Set up a BVH collision detector for this mesh and (optionally) its children
+
+     \fn       void cMesh::createBVHCollisionDetector(double a_radius,
+                                       bool a_affectChildren,
+                                       bool a_useNeighbors)
+	 \param	   a_radius  Bounding radius.
+     \param    a_affectChildren   Create collision detectors for children?
+     \param    a_useNeighbors     Create neighbor lists?
+*/
+//===========================================================================
+void cMesh::createBVHCollisionDetector(double a_radius,
+                                       bool a_affectChildren,
+                                       bool a_useNeighbors)
+{
+    // delete previous collision detector
+    if (m_collisionDetector != NULL)
+    {
+        delete m_collisionDetector;
+        m_collisionDetector = NULL;
+    }
+
+    // create BVH collision detector
+    cCollisionBVH* collisionDetectorBVH =
+                         new cCollisionBVH(pTriangles(), a_useNeighbors);
+    collisionDetectorBVH->initialize(a_radius);
+    m_collisionDetector = collisionDetectorBVH;
+
+    // create neighbor lists
+    if (a_useNeighbors)
+    {
+        createTriangleNeighborList(false);
+    }
+
+    // update children if required
+    if (a_affectChildren)
+    {
+        unsigned int i;
+        for (i=0; i<m_children.size(); i++)
+        {
+            cGenericObject *nextObject = m_children[i];
+
+            cMesh *nextMesh = dynamic_cast<cMesh*>(nextObject);
+            if (nextMesh)
+            {
+                nextMesh->createBVHCollisionDetector(a_radius,
+                                                     a_affectChildren,
+                                                     a_useNeighbors);
+            }
+        }
+    }
+}
+
+
 //===========================================================================
 /*!
      Set up a sphere tree collision detector for this mesh and (optionally) its children
@@ -1846,6 +2444,7 @@ void cMesh::render(const int a_renderMode)
 /*!
      Invalidate any existing display lists.  You should call this on if you're using
      display lists and you modify mesh options, vertex positions, etc.
+     This also sends the whole mesh to the vertex buffer again, if one is used.
 
      \fn       void cMesh::invalidateDisplayList(const bool a_affectChildren=true)
      \param    a_affectChildren  If \b true all children are updated
@@ -1860,6 +2459,9 @@ void cMesh::invalidateDisplayList(const bool a_affectChildren)
         m_displayList = -1;
     }
 
+    // Upload all vertices and triangles again
+    m_vertexBuffer.invalidate();
+
     // Propagate the operation to my children
     if (a_affectChildren)
     {
@@ -1996,12 +2598,15 @@ void cMesh::renderMesh(const int a_renderMode)
     // we are not currently creating a display list
     bool creating_display_list = false;
 
+    // vertex buffers replace display lists, where they are supported
+    bool use_vertex_buffer = m_useVertexBuffer && cVertexBuffer::isSupported();
+
 
     //-----------------------------------------------------------------------
     // DISPLAY LIST
     //-----------------------------------------------------------------------
     // Should we render with a display list?
-    if (m_useDisplayList)
+    if (m_useDisplayList && !use_vertex_buffer)
     {
         // If the display list doesn't exist, create it
         if (m_displayList == -1)
@@ -2040,7 +2645,9 @@ void cMesh::renderMesh(const int a_renderMode)
     glDisableClientState(GL_INDEX_ARRAY);
     glDisableClientState(GL_EDGE_FLAG_ARRAY);
 
-    if (m_useVertexArrays)
+    // (vertex arrays are also the fallback for vertex buffers)
+    bool use_vertex_arrays = (m_useVertexArrays || m_useVertexBuffer) && !use_vertex_buffer;
+    if (use_vertex_arrays)
     {
         glEnableClientState(GL_NORMAL_ARRAY);
         glEnableClientState(GL_VERTEX_ARRAY);
@@ -2071,7 +2678,7 @@ void cMesh::renderMesh(const int a_renderMode)
         // enable vertex colors
         glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
         glEnable(GL_COLOR_MATERIAL);
-        if (m_useVertexArrays)
+        if (use_vertex_arrays)
         {
             glEnableClientState(GL_COLOR_ARRAY);
         }
@@ -2100,7 +2707,7 @@ void cMesh::renderMesh(const int a_renderMode)
     if ((m_texture != NULL) && (m_useTextureMapping))
     {
         glEnable(GL_TEXTURE_2D);
-        if (m_useVertexArrays)
+        if (use_vertex_arrays)
         {
             glEnableClientState(GL_TEXTURE_COORD_ARRAY);
         }
@@ -2108,10 +2715,19 @@ void cMesh::renderMesh(const int a_renderMode)
     }
 
 
+    /////////////////////////////////////////////////////////////////////////
+    // RENDER TRIANGLES FROM THE VERTEX BUFFER
+    /////////////////////////////////////////////////////////////////////////
+    if (use_vertex_buffer)
+    {
+        m_vertexBuffer.render(m_vertices, m_triangles, m_useVertexColors,
+                              (m_texture != NULL) && (m_useTextureMapping));
+    }
+
     /////////////////////////////////////////////////////////////////////////
     // RENDER TRIANGLES WITH VERTEX ARRAYS
     /////////////////////////////////////////////////////////////////////////
-    if (m_useVertexArrays)
+    else if (use_vertex_arrays)
     {
         // Where does our vertex array live?
         vector<cVertex>* vertex_vector = pVertices();
@@ -2312,6 +2928,7 @@ void cMesh::renderMesh(const int a_renderMode)
 void cMesh::onDisplayReset(const bool a_affectChildren)
 {
     invalidateDisplayList();
+    m_vertexBuffer.deleteBuffers();
     if (m_texture != NULL) m_texture->markForUpdate();
 
     // Use the superclass method to call the same function on the rest of the
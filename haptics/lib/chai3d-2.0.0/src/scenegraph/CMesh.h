@@ -32,6 +32,7 @@
 #include "graphics/CMaterial.h"
 #include "graphics/CTexture2D.h"
 #include "graphics/CColor.h"
+#include "graphics/CVertexBuffer.h"
 #include <vector>
 #include <list>
 //---------------------------------------------------------------------------
@@ -42,6 +43,9 @@ class cWorld;
 class cTriangle;
 class cVertex;
 //---------------------------------------------------------------------------
+//! Number of vertices in the vertex cache that optimizeTriangleOrder() orders triangles for.
+#define CHAI_MESH_VERTEX_CACHE_SIZE     16
+//---------------------------------------------------------------------------
 
 //===========================================================================
 /*!
@@ -177,9 +181,21 @@ class cMesh : public cGenericObject
     //! Enable or disable the use vertex arrays for rendering, optionally propagating the operation to my children.
     void useVertexArrays(const bool a_useVertexArrays, const bool a_affectChildren=true);
 
+    //! Enable or disable the use of vertex buffer objects for rendering, optionally propagating the operation to my children.
+    void useVertexBuffer(const bool a_useVertexBuffer, const bool a_affectChildren=true);
+
     //! Ask whether I'm currently rendering with a display list.
     bool getDisplayListEnabled() const { return m_useDisplayList; }
 
+    //! Ask whether I'm currently rendering from a vertex buffer.
+    bool getVertexBufferEnabled() const { return m_useVertexBuffer; }
+
+    //! Mark a span of my vertices as modified, so that the vertex buffer sends them again.
+    void invalidateVertices(const unsigned int a_firstIndex, const unsigned int a_numVertices);
+
+    //! Access the vertex buffer used when vertex buffers are enabled.
+    const cVertexBuffer& getVertexBuffer() const { return m_vertexBuffer; }
+
     //! Invalidate any existing display lists.
     void invalidateDisplayList(const bool a_affectChildren=true);
 
@@ -209,16 +225,15 @@ class cMesh : public cGenericObject
     //! Set up an AABB collision detector for this mesh and (optionally) its children.
     virtual void createAABBCollisionDetector(double a_radius, bool a_affectChildren, bool a_useNeighbors);
 
+    //! Set up an SAH-built BVH collision detector for this mesh and (optionally) its children.
+    virtual void createBVHCollisionDetector(double a_radius, bool a_affectChildren, bool a_useNeighbors);
+
     //! Set up a sphere tree collision detector for this mesh and (optionally) its children.
     virtual void createSphereTreeCollisionDetector(double a_radius, bool a_affectChildren, bool a_useNeighbors);
 
-    //! Create a lists for neighbor triangles for each triangle of the mesh.
+    //! Create a list of the triangles that share a vertex position with each triangle of the mesh.
     void createTriangleNeighborList(bool a_affectChildren);
 
-    //! Search for triangle neighbors.
-    void findNeighbors(std::vector<cTriangle*>* search1,
-                             std::vector<cTriangle*>* search2, const int& v1, const int& v2);
-
 
     //-----------------------------------------------------------------------
     // METHODS - MESH MANIPULATION:
@@ -257,6 +272,12 @@ class cMesh : public cGenericObject
     //! Remove redundant triangles from this model.
     virtual void removeRedundantTriangles(const bool a_affectChildren=0);
 
+    //! Merge the vertices that are identical in position, normal, texture coordinate and color.
+    void weldVertices(const bool a_affectChildren=true);
+
+    //! Reorder triangles for the vertex cache, then vertices in the order the triangles use them.
+    void optimizeTriangleOrder(const bool a_affectChildren=true);
+
 
   protected:
 
@@ -305,6 +326,12 @@ class cMesh : public cGenericObject
     //! The openGL display list used to draw this mesh, if display lists are enabled.
     int m_displayList;
 
+    //! Should we use vertex buffer objects to render this mesh?
+    bool m_useVertexBuffer;
+
+    //! The vertex and index buffers used to draw this mesh, if vertex buffers are enabled.
+    cVertexBuffer m_vertexBuffer;
+
 
     //-----------------------------------------------------------------------
     // MEMBERS - ARRAYS: